@@ -0,0 +1,436 @@
+///=== Standalone benchmark of the track finding algorithms, which replays events from a snapshot file,
+///=== so needs neither cmsRun, EDM event data nor tracker geometry.
+///=== It runs the same sequence as TMTrackProducer::produce() (sectors -> HT -> duplicate removal -> track fitters),
+///=== but without histograms or EDM output, and reports the processing rate & time spent in each stage.
+
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Sector.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DigitalStub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DigitalStubBatch.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleInfo.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HTpair.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TrackFitGeneric.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DupTrkMerger.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TrackFitCache.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/PythonParameterSet/interface/MakeParameterSets.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include "DataFormats/Math/interface/deltaPhi.h"
+
+#include "boost/numeric/ublas/matrix.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <vector>
+#include <map>
+#include <string>
+
+using namespace std;
+using  boost::numeric::ublas::matrix;
+
+typedef chrono::steady_clock Clock;
+
+//=== Accumulates wall-clock time spent in one processing stage.
+
+class StageTimer {
+public:
+  StageTimer() : total_(0.) {}
+  void   start() {t0_ = Clock::now();}
+  void   stop()  {total_ += chrono::duration<double>(Clock::now() - t0_).count();}
+  double total() const {return total_;}
+private:
+  Clock::time_point t0_;
+  double            total_; // seconds
+};
+
+//=== Compares the results of fitting the same track candidate in two ways, counting how often they differ
+//=== by more than a relative tolerance.
+//=== Approximate fits (e.g. TrackFitIncremental) differ from the exact ones beyond the tolerance for a small
+//=== fraction of the fits, so a comparison only fails if this fraction exceeds maxFracDiffer.
+
+class FitComparison {
+public:
+  static constexpr float maxFracDiffer = 0.01;
+
+  FitComparison(float tolerance = 1.e-3) : tolerance_(tolerance), numChecked_(0), numAccDiffer_(0), numOutsideTol_(0),
+					   maxDiffQoverPt_(0.), maxDiffPhi0_(0.), maxDiffZ0_(0.), maxDiffTanLambda_(0.), maxDiffChi2_(0.) {}
+  void compare(const L1fittedTrack& fitA, const L1fittedTrack& fitB) {
+    numChecked_++;
+    if (fitA.accepted() != fitB.accepted()) {
+      numAccDiffer_++;
+    } else if (fitB.accepted()) {
+      const float dQoverPt   = fabs(fitA.qOverPt()   - fitB.qOverPt());
+      const float dPhi0      = fabs(reco::deltaPhi(fitA.phi0(), fitB.phi0()));
+      const float dZ0        = fabs(fitA.z0()        - fitB.z0());
+      const float dTanLambda = fabs(fitA.tanLambda() - fitB.tanLambda());
+      const float dChi2      = fabs(fitA.chi2()      - fitB.chi2());
+      maxDiffQoverPt_   = max(maxDiffQoverPt_,   dQoverPt);
+      maxDiffPhi0_      = max(maxDiffPhi0_,      dPhi0);
+      maxDiffZ0_        = max(maxDiffZ0_,        dZ0);
+      maxDiffTanLambda_ = max(maxDiffTanLambda_, dTanLambda);
+      maxDiffChi2_      = max(maxDiffChi2_,      dChi2);
+      if (dQoverPt   > tolerance_*(1. + fabs(fitB.qOverPt()))   || dPhi0 > tolerance_*(1. + fabs(fitB.phi0())) ||
+	  dZ0        > tolerance_*(1. + fabs(fitB.z0()))        ||
+	  dTanLambda > tolerance_*(1. + fabs(fitB.tanLambda())) || dChi2 > tolerance_*(1. + fabs(fitB.chi2()))) numOutsideTol_++;
+    }
+  }
+  void print(const string& what) const {
+    cout<<what<<": "<<numChecked_<<" fits compared ; of which accepted differently = "<<numAccDiffer_
+	<<" ; outside relative tolerance "<<tolerance_<<" = "<<numOutsideTol_<<(this->failed() ? " ; FAILED" : "")<<endl;
+    cout<<"  max. difference of accepted (q/Pt, phi0, z0, tanLambda, chi2) = ("
+	<<maxDiffQoverPt_<<", "<<maxDiffPhi0_<<", "<<maxDiffZ0_<<", "<<maxDiffTanLambda_<<", "<<maxDiffChi2_<<")"<<endl;
+  }
+  unsigned int numDiffer() const {return numAccDiffer_ + numOutsideTol_;}
+  // True if more than fraction maxFracDiffer of the fits differ.
+  bool         failed()    const {return numDiffer() > maxFracDiffer * numChecked_;}
+private:
+  float        tolerance_;
+  unsigned int numChecked_;
+  unsigned int numAccDiffer_;
+  unsigned int numOutsideTol_;
+  float        maxDiffQoverPt_;
+  float        maxDiffPhi0_;
+  float        maxDiffZ0_;
+  float        maxDiffTanLambda_;
+  float        maxDiffChi2_;
+};
+
+// Configuration of TMTrackProducer with the given boolean option in TrackFitSettings inverted.
+edm::ParameterSet invertTrackFitOption(const edm::ParameterSet& iConfig, const string& name) {
+  edm::ParameterSet trackFitSettings = iConfig.getParameter<edm::ParameterSet>("TrackFitSettings");
+  trackFitSettings.addParameter<bool>(name, ! trackFitSettings.getParameter<bool>(name));
+  edm::ParameterSet iConfigAlt(iConfig);
+  iConfigAlt.addParameter<edm::ParameterSet>("TrackFitSettings", trackFitSettings);
+  return iConfigAlt;
+}
+
+// Create track fitting algorithms (without histograms).
+map<string, TrackFitGeneric*> createFitters(const Settings* settings) {
+  map<string, TrackFitGeneric*> fitterWorkerMap;
+  for (const string& fitterName : settings->trackFitters()) {
+    fitterWorkerMap[ fitterName ] = TrackFitGeneric::create(fitterName, settings);
+    fitterWorkerMap[ fitterName ]->initRun();
+  }
+  return fitterWorkerMap;
+}
+
+int main(int argc, char* argv[]) {
+
+  if (argc < 3) {
+    cout<<"Usage: "<<argv[0]<<" config_cfg.py snapshot.bin [numPasses] [checks] [allowTruncated]"<<endl;
+    cout<<"  checks = sum of the following (these are excluded from the timing):"<<endl;
+    cout<<"    1 to check that digitizing stubs together (BatchDigitize) & individually give bit-identical results;"<<endl;
+    cout<<"    2 to compare fit results reused by FitCache with those of refitting each candidate;"<<endl;
+    cout<<"    4 to compare chi2 fits with & without TrackFitIncremental;"<<endl;
+    cout<<"    8 to compare & time KF fits with & without KalmanFixedSizeMaths."<<endl;
+    cout<<"    (Checks 4 & 8 give exit code 3 if more than "<<100*FitComparison::maxFracDiffer<<"% of fits differ by more than the tolerance)."<<endl;
+    cout<<"  allowTruncated = 1 to use the complete events of a truncated snapshot, instead of failing."<<endl;
+    return 1;
+  }
+  const string       cfgFile  = argv[1];
+  const string       snapFile = argv[2];
+  const unsigned int numPasses = (argc > 3) ? atoi(argv[3]) : 1;
+  const unsigned int checks    = (argc > 4) ? atoi(argv[4]) : 0;
+  const bool         allowTruncated = (argc > 5) ? (atoi(argv[5]) != 0) : false;
+  const bool         checkDigi     = (checks & 1);
+  const bool         checkFitCache = (checks & 2);
+  const bool         checkIncremental = (checks & 4);
+  const bool         checkFixedMaths  = (checks & 8);
+
+  try {
+
+    // Get configuration parameters of TMTrackProducer from python config.
+    auto processPSet = edm::readConfig(cfgFile);
+    edm::ParameterSet iConfig = processPSet->getParameter<edm::ParameterSet>("TMTrackProducer");
+    const uint64_t configHash = snapshot::configHash(iConfig);
+
+    // Internal KF histograms need TFileService, which is not available here.
+    edm::ParameterSet trackFitSettings = iConfig.getParameter<edm::ParameterSet>("TrackFitSettings");
+    trackFitSettings.addParameter<bool>("KalmanFillInternalHists", false);
+    iConfig.addParameter<edm::ParameterSet>("TrackFitSettings", trackFitSettings);
+
+    Settings settings(iConfig);
+
+    // Same configuration, but with the opposite choice of incremental or full refit in the chi2 fit iterations.
+    Settings settingsAlt(invertTrackFitOption(iConfig, "TrackFitIncremental"));
+    // Same configuration, but with the opposite choice of fixed-size or generic matrix maths in the KF.
+    Settings settingsMaths(invertTrackFitOption(iConfig, "KalmanFixedSizeMaths"));
+
+    const EventSnapshotReader reader(snapFile, allowTruncated);
+    cout<<"Read "<<reader.events().size()<<" events from "<<snapFile<<(reader.truncated() ? " (truncated)" : "")<<endl;
+    settings.setBfield(reader.bField());
+    settingsAlt.setBfield(reader.bField());
+    settingsMaths.setBfield(reader.bField());
+    if (reader.configHash() != configHash) cout<<"WARNING: Snapshot "<<snapFile<<" was written with a different configuration to "<<cfgFile<<endl;
+
+    map<string, TrackFitGeneric*> fitterWorkerMap = createFitters(&settings);
+    map<string, TrackFitGeneric*> fitterWorkerMapAlt;
+    if (checkIncremental) fitterWorkerMapAlt = createFitters(&settingsAlt);
+    map<string, TrackFitGeneric*> fitterWorkerMapMaths;
+    if (checkFixedMaths) fitterWorkerMapMaths = createFitters(&settingsMaths);
+
+    StageTimer timeInput, timeHTstore, timeHTend, timeDupMerge;
+    StageTimer timeChecks; // Time taken by the optional checks, excluded from all other timings.
+    map<string, StageTimer> timeFit;
+    map<string, StageTimer> timeFitMaths; // KF fits with the opposite KalmanFixedSizeMaths setting.
+    unsigned int numEvents = 0;
+    unsigned int numStubs  = 0;
+    unsigned int numTrksHT = 0;
+    unsigned int numTrksNotFit = 0; // Duplicates of tracks found in other sectors.
+    unsigned int numTrksHTfake = 0; // HT tracks not matched to any TP.
+    unsigned int numTPsForAlgEff = 0;
+    unsigned int numTPsRecoHT = 0;  // TPs used for algorithmic efficiency, which were found by HT.
+    vector<bool> tpRecoHT;
+    unsigned int numDigiChecked = 0;
+    unsigned int numDigiDiffer  = 0; // Stubs whose digitization in batch & individually differ.
+    map<string, unsigned int> numTrksFit;
+    map<string, FitComparison> fitCacheCheck;
+    map<string, FitComparison> incrementalCheck;
+    map<string, FitComparison> fixedMathsCheck;
+
+    // Stubs inside each sector, and work space used to digitize them all together.
+    vector<const Stub*> insideStubs;
+    DigitalStubBatch    digiBatch(&settings);
+    // Info about each tracker module, shared by all stubs in it over all events.
+    ModuleInfoCache     moduleInfoCache;
+    // Removal of duplicate tracks found in different sectors.
+    DupTrkMerger        dupTrkMerger(&settings);
+    // Reuse of fit results for identical track candidates.
+    TrackFitCache       fitCache(&settings);
+
+    // Sectors and their Hough-Transform arrays, initialized once and reset for each event.
+    matrix<Sector>  mSectors(settings.numPhiSectors(), settings.numEtaRegions());
+    matrix<HTpair>  mHtPairs(settings.numPhiSectors(), settings.numEtaRegions());
+    for (unsigned int iPhiSec = 0; iPhiSec < settings.numPhiSectors(); iPhiSec++) {
+      for (unsigned int iEtaReg = 0; iEtaReg < settings.numEtaRegions(); iEtaReg++) {
+	Sector& sector = mSectors(iPhiSec, iEtaReg);
+	sector.init(&settings, iPhiSec, iEtaReg); 
+	mHtPairs(iPhiSec, iEtaReg).init(&settings, sector.etaMin(), sector.etaMax(), sector.phiCentre());
+      }
+    }
+
+    const Clock::time_point tStart = Clock::now();
+
+    for (unsigned int iPass = 0; iPass < numPasses; iPass++) {
+      for (const SnapshotEvent& snapEvent : reader.events()) {
+
+	timeInput.start();
+	InputData inputData(snapEvent, &settings, &moduleInfoCache);
+	const vector<const Stub*>& vStubs = inputData.getStubs(); 
+	timeInput.stop();
+
+	// Optionally remove duplicate stubs in overlap regions within each sector.
+	matrix< vector<const Stub*> > mSectorStubs;
+	if (settings.overlapPerSector()) {
+	  timeHTstore.start();
+	  Sector::stubsInsideAllNoOverlap(&settings, vStubs, mSectors, mSectorStubs);
+	  timeHTstore.stop();
+	}
+
+	for (unsigned int iPhiSec = 0; iPhiSec < settings.numPhiSectors(); iPhiSec++) {
+	  for (unsigned int iEtaReg = 0; iEtaReg < settings.numEtaRegions(); iEtaReg++) {
+
+	    const Sector& sector = mSectors(iPhiSec, iEtaReg);
+	    HTpair&       htPair = mHtPairs(iPhiSec, iEtaReg);
+
+	    timeHTstore.start();
+	    htPair.reset();
+
+	    const vector<const Stub*>& sectorStubs = settings.overlapPerSector()  ?  mSectorStubs(iPhiSec, iEtaReg)  :  vStubs;
+
+	    insideStubs.clear();
+	    for (const Stub* stub: sectorStubs) {
+	      if (settings.enableDigitize()) (const_cast<Stub*>(stub))->reset_digitize();
+	      if (sector.inside( stub )) insideStubs.push_back(stub);
+	    }
+	    if (settings.enableDigitize()) {
+	      if (settings.batchDigitize()) {
+		digiBatch.clear();
+		for (const Stub* stub: insideStubs) digiBatch.add( stub->digitalStub() );
+		digiBatch.make(iPhiSec);
+		for (unsigned int i = 0; i < insideStubs.size(); i++) (const_cast<Stub*>(insideStubs[i]))->digitize(iPhiSec, digiBatch, i);
+		if (checkDigi) {
+		  // Compare with reference implementation, digitizing each stub individually.
+		  timeHTstore.stop();
+		  timeChecks.start();
+		  for (const Stub* stub: insideStubs) {
+		    DigitalStub digiRef(stub->digitalStub());
+		    digiRef.make(iPhiSec);
+		    if (! stub->digitalStub().identical(digiRef)) numDigiDiffer++;
+		    numDigiChecked++;
+		  }
+		  timeChecks.stop();
+		  timeHTstore.start();
+		}
+	      } else {
+		for (const Stub* stub: insideStubs) (const_cast<Stub*>(stub))->digitize(iPhiSec);
+	      }
+	    }
+	    for (const Stub* stub: insideStubs) {
+	      const vector<bool> inEtaSubSecs =  sector.insideEtaSubSecs( stub );
+	      htPair.store( stub, inEtaSubSecs );
+	    }
+	    timeHTstore.stop();
+
+	    timeHTend.start();
+	    htPair.end();
+	    timeHTend.stop();
+
+	    numTrksHT += htPair.trackCands3D().size();
+	  }
+	}
+
+	// HT algorithmic efficiency & fake rate, so options that should not change the HT results (e.g. HierarchicalHT)
+	// can be checked by comparing them.
+	const vector<TP>& vTPs = inputData.getTPs();
+	tpRecoHT.assign(vTPs.size(), false);
+	for (unsigned int iPhiSec = 0; iPhiSec < settings.numPhiSectors(); iPhiSec++) {
+	  for (unsigned int iEtaReg = 0; iEtaReg < settings.numEtaRegions(); iEtaReg++) {
+	    for (const L1track3D& trk : mHtPairs(iPhiSec, iEtaReg).trackCands3D()) {
+	      if (trk.getMatchedTP() != nullptr) {
+		tpRecoHT[trk.getMatchedTP()->index()] = true;
+	      } else {
+		numTrksHTfake++;
+	      }
+	    }
+	  }
+	}
+	for (const TP& tp : vTPs) {
+	  if (tp.useForAlgEff()) {
+	    numTPsForAlgEff++;
+	    if (tpRecoHT[tp.index()]) numTPsRecoHT++;
+	  }
+	}
+
+	// Optionally remove duplicate track candidates found in different sectors, so they are not fitted.
+	timeDupMerge.start();
+	dupTrkMerger.run(mHtPairs);
+	timeDupMerge.stop();
+	numTrksNotFit += dupTrkMerger.numKilled();
+
+	// Fit track candidates found in each sector with each fitter.
+	fitCache.clear();
+	for (unsigned int iPhiSec = 0; iPhiSec < settings.numPhiSectors(); iPhiSec++) {
+	  for (unsigned int iEtaReg = 0; iEtaReg < settings.numEtaRegions(); iEtaReg++) {
+	    const vector<L1track3D>& vecTrk3D = mHtPairs(iPhiSec, iEtaReg).trackCands3D();
+	    for (const string& fitterName : settings.trackFitters()) {
+	      TrackFitGeneric* fitter = fitterWorkerMap[fitterName];
+	      timeFit[fitterName].start();
+	      for (unsigned int iTrk = 0; iTrk < vecTrk3D.size(); iTrk++) {
+		if (! dupTrkMerger.keep(iPhiSec, iEtaReg, iTrk)) continue;
+		bool reused;
+		L1fittedTrack fitTrack = fitCache.fit(fitterName, fitter, vecTrk3D[iTrk], iPhiSec, iEtaReg, &reused);
+		if (fitTrack.accepted()) numTrksFit[fitterName]++;
+		const bool checkMaths = checkFixedMaths && fitterName.find("KF") == 0;
+		if ((checkFitCache && reused) || checkIncremental || checkMaths) {
+		  timeFit[fitterName].stop();
+		  timeChecks.start();
+		  L1fittedTrack refitTrack = fitter->fit(vecTrk3D[iTrk], iPhiSec, iEtaReg);
+		  if (checkFitCache && reused) fitCacheCheck[fitterName].compare(fitTrack, refitTrack);
+		  if (checkIncremental) {
+		    // (Incremental fit compared to full one).
+		    L1fittedTrack altTrack = fitterWorkerMapAlt[fitterName]->fit(vecTrk3D[iTrk], iPhiSec, iEtaReg);
+		    if (settings.trackFitIncremental()) {
+		      incrementalCheck[fitterName].compare(refitTrack, altTrack);
+		    } else {
+		      incrementalCheck[fitterName].compare(altTrack, refitTrack);
+		    }
+		  }
+		  if (checkMaths) {
+		    // (Fixed-size maths compared to generic one).
+		    timeFitMaths[fitterName].start();
+		    L1fittedTrack mathsTrack = fitterWorkerMapMaths[fitterName]->fit(vecTrk3D[iTrk], iPhiSec, iEtaReg);
+		    timeFitMaths[fitterName].stop();
+		    if (settings.kalmanFixedSizeMaths()) {
+		      fixedMathsCheck[fitterName].compare(refitTrack, mathsTrack);
+		    } else {
+		      fixedMathsCheck[fitterName].compare(mathsTrack, refitTrack);
+		    }
+		  }
+		  timeChecks.stop();
+		  timeFit[fitterName].start();
+		}
+	      }
+	      timeFit[fitterName].stop();
+	    }
+	  }
+	}
+
+	numEvents++;
+	numStubs += vStubs.size();
+      }
+    }
+
+    // (Excluding the optional checks).
+    const double tTotal = chrono::duration<double>(Clock::now() - tStart).count() - timeChecks.total();
+
+    //=== Print summary.
+
+    cout.setf(ios::fixed, ios::floatfield);
+    cout.precision(4);
+    cout<<endl<<"=== Replay benchmark: "<<numEvents<<" events ("<<reader.events().size()<<" x "<<numPasses<<" passes) from "<<snapFile<<" ==="<<endl;
+    if (numEvents == 0) return 0;
+    cout<<"Mean number of stubs per event = "<<float(numStubs)/numEvents<<" ; of HT tracks = "<<float(numTrksHT)/numEvents<<endl;
+    cout<<"HT algorithmic efficiency = "<<float(numTPsRecoHT)/max(1u, numTPsForAlgEff)<<" ; fraction of HT tracks that are fake = "<<float(numTrksHTfake)/max(1u, numTrksHT)<<endl;
+    if (settings.dupTrkMergeEvent() > 0) cout<<"Mean number of HT tracks not fitted, as duplicates of tracks in other sectors = "<<float(numTrksNotFit)/numEvents<<endl;
+    for (const string& fitterName : settings.trackFitters()) {
+      cout<<"Mean number of tracks accepted by "<<fitterName<<" = "<<float(numTrksFit[fitterName])/numEvents<<endl;
+      if (settings.fitCache() > 0) cout<<"Fraction of "<<fitterName<<" fits avoided by reusing earlier fit result = "<<float(fitCache.numHits(fitterName))/max(1u, fitCache.numFits(fitterName))<<endl;
+      if (checkFitCache) fitCacheCheck[fitterName].print("Reused "+fitterName+" fit results v. refit");
+      if (checkIncremental) incrementalCheck[fitterName].print(fitterName+" incremental v. full refit");
+      if (fixedMathsCheck.count(fitterName) > 0) fixedMathsCheck[fitterName].print(fitterName+" fixed-size v. generic maths");
+    }
+    if (checkFitCache && settings.fitCache() == 0) cout<<"WARNING: Fit cache check needs FitCache enabled"<<endl;
+    if (checkDigi) {
+      if (settings.enableDigitize() && settings.batchDigitize()) {
+	cout<<"Stubs digitized together & individually: "<<numDigiChecked<<" ; of which differ = "<<numDigiDiffer<<endl;
+      } else {
+	cout<<"WARNING: Digitization check needs EnableDigitize & BatchDigitize both enabled"<<endl;
+      }
+    }
+    cout<<"Events/s = "<<numEvents/tTotal<<endl;
+    cout<<"Time per event (ms):"<<endl;
+    cout<<"  "<<setw(28)<<left<<"InputData"   <<1000.*timeInput.total()  /numEvents<<endl;
+    cout<<"  "<<setw(28)<<left<<"Sectors+HT fill"<<1000.*timeHTstore.total()/numEvents<<endl;
+    cout<<"  "<<setw(28)<<left<<"HT end"      <<1000.*timeHTend.total()  /numEvents<<endl;
+    cout<<"  "<<setw(28)<<left<<"Dup merge"   <<1000.*timeDupMerge.total()/numEvents<<endl;
+    for (const string& fitterName : settings.trackFitters()) {
+      cout<<"  "<<setw(28)<<left<<fitterName  <<1000.*timeFit[fitterName].total()/numEvents<<endl;
+    }
+    cout<<"  "<<setw(28)<<left<<"Total"       <<1000.*tTotal/numEvents<<endl;
+    if (checks != 0) {
+      cout<<"Time per event (ms) of checks, excluded from the above:"<<endl;
+      cout<<"  "<<setw(28)<<left<<"All checks"<<1000.*timeChecks.total()/numEvents<<endl;
+      for (const auto& t : timeFitMaths) {
+	const string mathsName = t.first + (settings.kalmanFixedSizeMaths() ? " generic" : " fixed-size");
+	cout<<"  "<<setw(28)<<left<<mathsName<<1000.*t.second.total()/numEvents<<endl;
+      }
+    }
+
+    for (auto& f : fitterWorkerMap) delete f.second;
+    for (auto& f : fitterWorkerMapAlt) delete f.second;
+    for (auto& f : fitterWorkerMapMaths) delete f.second;
+
+    if (numDigiDiffer > 0) return 2;
+    for (const auto& c : incrementalCheck) {
+      if (c.second.failed()) return 3;
+    }
+    for (const auto& c : fixedMathsCheck) {
+      if (c.second.failed()) return 3;
+    }
+
+  } catch (cms::Exception& e) {
+    cerr<<e.what()<<endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -6,6 +6,8 @@
 class ChiSquared4ParamsTrackletStyle : public L1ChiSquared{
  
 public:
+    enum PAR_IDS { RINV, PHI0, T, Z0 };
+
     ChiSquared4ParamsTrackletStyle(const Settings* settings, const uint nPar);
  
     ~ChiSquared4ParamsTrackletStyle(){}
@@ -17,11 +19,7 @@ protected:
     std::vector<double> residuals(std::vector<double> x);
     Matrix<double> D(std::vector<double> x);
     Matrix<double> Vinv();
-    std::map<std::string, double> convertParams(std::vector<double> x);
- 
-private:
-    std::vector<double> mapToVec(std::map<std::string, double> x);
-    std::map<std::string, double> vecToMap(std::vector<double> x);
+    HelixParams convertParams(std::vector<double> x);
 };
  
 #endif
@@ -46,8 +46,7 @@ private:
     std::vector<TTStubRef> ttstubrefs;
     const std::vector<const Stub*> stubs = trk.getStubs();
     for (size_t ii = 0; ii < stubs.size(); ii++) {
-	TTStubRef ref = *stubs.at(ii);
-	ttstubrefs.push_back(ref);
+	ttstubrefs.push_back(stubs.at(ii)->ttStubRef());
     }
 
     return ttstubrefs;
@@ -3,10 +3,11 @@
 
 #include "FWCore/Utilities/interface/Exception.h"
 
-#include <vector>
-#include <map>
+#include <array>
 #include <set>
 #include <utility>
+#include <algorithm>
+#include <cmath>
 
 using namespace std;
 
@@ -42,125 +43,112 @@ public:
   //--- return the degraded stub bend, a boolean indicatng if stub bend was outside the assumed window
   //--- size programmed below, and an integer indicating how many values of the original bend
   //--- were grouped together into this single value of the degraded bend.
+  //--- (Uses a look-up table, filled on first call, so is fast & thread safe).
   static void ConvertBarrelBend(float bend, unsigned int layer,
 			        float& degradedBend, bool& reject, unsigned int& num) {
-
-    // Get degraded bend value
-    DataCorrection::ConvertBarrelBendWork(bend, layer, degradedBend, reject);
-
-    // Determine number of bend values that would lead to same degraded bend value.
-    // This helps understand the loss in bend resolution caused by the bit encoding.
-
-    // Stores number of bend values merged into a single one by bit encoding, for each layer & bend value.
-    static vector< map<float, unsigned int> > barrelNums(30); // Dimension to larger than number of barrel laye
-    map<float, unsigned int>& storedNum = barrelNums[layer];
-    if (storedNum.find(degradedBend) != storedNum.end()) {
-
-      // Calculation already done, so just retrieve it.
-      num = storedNum[degradedBend];
-
-    } else {
-
-      // Calculation not yet done, so do it.
-
-      num = 0;
-
-      const int maxI = 30; // A number larger than the number of unique bend values.
-      int maxAcceptedI = -1;
-      float degradedBendI;
-      bool rejectI;
-      set<float> uniqueDegradedBends;
-      for (int i = -maxI; i <= maxI; i++) {
-	float bendI = 0.5*float(i);
-	DataCorrection::ConvertBarrelBendWork(bendI, layer, degradedBendI, rejectI);
-	if ( ! rejectI) {
-	  if (abs(maxAcceptedI) < abs(i)) maxAcceptedI = abs(i);
-	  if (degradedBend == degradedBendI) num++;
-	  uniqueDegradedBends.insert(degradedBendI);
-	}
-      }
-
-      //cout<<"Barrel layer="<<layer<<" Bend="<<bend<<" --> "<<degradedBend<<" reject=" <<reject<<" num="<<num<<endl;
-
-      // Store result
-      storedNum[degradedBend] = num;
-    
-      //--- Sanity checks
-      if (maxAcceptedI < 0 || maxAcceptedI == (unsigned int) maxI) throw cms::Exception("DataCorrection:: barrel stub window size wrong. ")<<layer<<" "<<maxAcceptedI<<endl;
-      // Number of degraded bend values should correspond to 3 bits (PS modules) or 4 bits (2S modules),
-      // minus one, where the latter is because the encoding must be symmetric about 0.
-      // Or perhaps less if no bit encoding was required.
-      unsigned int numDegradedBendsExp = (layer <= 3)  ?  pow(2,3) - 1  :  pow(2,4) - 1;
-      numDegradedBendsExp = min(numDegradedBendsExp, (unsigned int)(2*maxAcceptedI + 1)); 
-      if (uniqueDegradedBends.size() != numDegradedBendsExp) throw cms::Exception("DataCorrection:: barrel stub encoding corresponds to wrong number of bits. ")<<layer<<" "<<numDegradedBendsExp<<" "<<uniqueDegradedBends.size()<<endl;
-    }
+    static const BendTable barrelTable = DataCorrection::MakeBendTable(true);
+    DataCorrection::LookUp(barrelTable, bend, layer, degradedBend, reject, num);
   }
 
   //--- Given the original bend and endcap ring number,
   //--- return the degraded stub bend, a boolean indicating if stub bend was outside the assumed window
   //--- size programmed below, and an integer indicating how many values of the original bend
   //--- were grouped together into this single value of the degraded bend.
+  //--- (Uses a look-up table, filled on first call, so is fast & thread safe).
 
   static void ConvertEndcapBend(float bend, unsigned int ring,
    			        float& degradedBend, bool& reject, unsigned int& num) {
+    static const BendTable endcapTable = DataCorrection::MakeBendTable(false);
+    DataCorrection::LookUp(endcapTable, bend, ring, degradedBend, reject, num);
+  }
 
-    // Get degraded bend value
-    DataCorrection::ConvertEndcapBendWork(bend, ring, degradedBend, reject);
+private:
 
-    // Determine number of bend values that would lead to same degraded bend value.
-    // This helps understand the loss in bend resolution caused by the bit encoding.
+  // No constructor needed, since all function members are static.
+  DataCorrection() = delete;
+
+  //--- Look-up tables of degraded bend, indexed by barrel layer (or endcap ring) & by bend in units of half a strip.
+
+  enum {maxBendIndex   = 30,                 // Tables cover |bend| <= 15 strips. All larger bends are rejected.
+        numBendIndex   = 2*maxBendIndex + 1,
+        maxLayerOrRing = 15};
+
+  struct BendEntry {
+    float        degradedBend;
+    bool         reject;
+    unsigned int num;
+  };
+
+  struct BendTable {
+    array<bool, maxLayerOrRing + 1>                                  known; // Is this layer/ring defined?
+    array<array<BendEntry, numBendIndex>, maxLayerOrRing + 1>        entries;
+  };
+
+  static void LookUp(const BendTable& table, float bend, unsigned int layerOrRing,
+		     float& degradedBend, bool& reject, unsigned int& num) {
+    if (layerOrRing > maxLayerOrRing || ! table.known[layerOrRing]) throw cms::Exception("DataCorrection:: unknown barrel layer or endcap ring.")<<layerOrRing<<endl;
+    // Stub bends are multiples of half a strip. Larger bends are treated as the largest one in the table, which is also rejected.
+    const int iBend = min(max(int(lround(2*bend)), -int(maxBendIndex)), int(maxBendIndex));
+    const BendEntry& entry = table.entries[layerOrRing][iBend + maxBendIndex];
+    degradedBend = entry.degradedBend;
+    reject       = entry.reject;
+    num          = entry.num;
+  }
 
-    // Stores number of bend values merged into a single one by bit encoding, for each ring & bend value
-    static vector< map<float, unsigned int> > endcapNums(30); // Dimension to larger than number of endcap ring
+  //--- Fill look-up table for barrel or endcap, also determining the number of bend values that lead to
+  //--- the same degraded bend value. This helps understand the loss in bend resolution caused by the bit encoding.
 
-    map<float, unsigned int>& storedNum = endcapNums[ring];
-    if (storedNum.find(degradedBend) != storedNum.end()) {
+  static BendTable MakeBendTable(bool barrel) {
 
-      // Calculation already done, so just retrieve it.
-      num = storedNum[degradedBend];
+    BendTable table;
+    table.known.fill(false);
 
-    } else {
+    // Layers 1-6 in barrel or rings 1-15 in endcap.
+    const unsigned int numLayerOrRing = barrel  ?  6  :  15;
+    // Layers 1-3 and rings 1-9 have PS modules. The others have 2S modules.
+    const unsigned int maxPS = barrel  ?  3  :  9;
 
-      // Calculation not yet done, so do it.
+    for (unsigned int layer = 1; layer <= numLayerOrRing; layer++) {
 
-      num = 0;
+      array<BendEntry, numBendIndex>& entries = table.entries[layer];
+      table.known[layer] = true;
 
-      const int maxI = 30; // A number larger than the number of unique bend values.
       int maxAcceptedI = -1;
-      float degradedBendI;
-      bool rejectI;
       set<float> uniqueDegradedBends;
-      for (int i = -maxI; i <= maxI; i++) {
+      for (int i = -int(maxBendIndex); i <= int(maxBendIndex); i++) {
+	BendEntry& entry = entries[i + maxBendIndex];
 	float bendI = 0.5*float(i);
-	DataCorrection::ConvertEndcapBendWork(bendI, ring, degradedBendI, rejectI);
-	if ( ! rejectI) {
+	if (barrel) {
+	  DataCorrection::ConvertBarrelBendWork(bendI, layer, entry.degradedBend, entry.reject);
+	} else {
+	  DataCorrection::ConvertEndcapBendWork(bendI, layer, entry.degradedBend, entry.reject);
+	}
+	if ( ! entry.reject) {
 	  if (abs(maxAcceptedI) < abs(i)) maxAcceptedI = abs(i);
-	  maxAcceptedI = i;
-	  if (degradedBend == degradedBendI) num++;
-	  uniqueDegradedBends.insert(degradedBendI);
+	  uniqueDegradedBends.insert(entry.degradedBend);
 	}
       }
 
-      //cout<<"Endcap ring="<<ring<<" Bend="<<bend<<" --> "<<degradedBend<<" reject=" <<reject<<" num="<<num<<endl;
+      // Count accepted bend values merged into each degraded one (zero for rejected ones).
+      for (BendEntry& entry : entries) {
+	entry.num = 0;
+	for (const BendEntry& entryI : entries) {
+	  if ( ! entryI.reject && entry.degradedBend == entryI.degradedBend) entry.num++;
+	}
+      }
 
-      // Store result
-      storedNum[degradedBend] = num;
-    
       //--- Sanity checks
-      if (maxAcceptedI < 0 || maxAcceptedI == (unsigned int) maxI) throw cms::Exception("DataCorrection:: endcap stub window size wrong. ")<<ring<<" "<<maxAcceptedI<<endl;
+      if (maxAcceptedI < 0 || maxAcceptedI == int(maxBendIndex)) throw cms::Exception("DataCorrection:: stub window size wrong. ")<<(barrel ? "barrel layer " : "endcap ring ")<<layer<<" "<<maxAcceptedI<<endl;
       // Number of degraded bend values should correspond to 3 bits (PS modules) or 4 bits (2S modules),
       // minus one, where the latter is because the encoding must be symmetric about 0.
       // Or perhaps less if no bit encoding was required.
-      unsigned int numDegradedBendsExp = (ring <= 9)  ?  pow(2,3) - 1  :  pow(2,4) - 1;
+      unsigned int numDegradedBendsExp = (layer <= maxPS)  ?  pow(2,3) - 1  :  pow(2,4) - 1;
       numDegradedBendsExp = min(numDegradedBendsExp, (unsigned int)(2*maxAcceptedI + 1)); 
-      if (uniqueDegradedBends.size() != numDegradedBendsExp) throw cms::Exception("DataCorrection:: endcap stub encoding corresponds to wrong number of bits. ")<<ring<<" "<<numDegradedBendsExp<<" "<<uniqueDegradedBends.size()<<endl;
+      if (uniqueDegradedBends.size() != numDegradedBendsExp) throw cms::Exception("DataCorrection:: stub encoding corresponds to wrong number of bits. ")<<(barrel ? "barrel layer " : "endcap ring ")<<layer<<" "<<numDegradedBendsExp<<" "<<uniqueDegradedBends.size()<<endl;
     }
-  }
 
-private:
-
-  // No constructor needed, since all function members are static.
-  DataCorrection() = delete;
+    return table;
+  }
 
   //--- Given the original bend and barrel layer number,
   //--- return the degraded stub bend & a boolean indicating if stub bend was outside the assumed window
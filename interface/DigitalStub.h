@@ -6,6 +6,7 @@
 using namespace std;
 
 class Settings;
+class DigitalStubBatch;
 
 //=== Used to digitize stubs both for GP and for MP.
 //=== N.B. After constructing an object of type DigitalStub, you must call functions 
@@ -34,6 +35,13 @@ public:
   // Digitize stub, with its phi coord. measured relative to specified phi sector.
   void make(unsigned int iPhiSec);
 
+  // Alternatively, take digitized stub from results of digitizing all stubs in sector together.
+  // (Stub number iStub in batch must correspond to this stub, and the batch must be for the same phi sector).
+  void make(unsigned int iPhiSec, const DigitalStubBatch& batch, unsigned int iStub);
+
+  // Check if this digitized stub is bit-identical to another one, (e.g. the same stub digitized individually & in a batch).
+  bool identical(const DigitalStub& other) const;
+
   //--- Note that the variables related to "dphi" and "rho" are not digitized when using the "daisy chain"
   //--- firmware, so no attempt should be made to access them in this case. They are replaced by the
   //--- m_min and m_max variables.
@@ -91,6 +99,12 @@ private:
   // Check that stub coords. & bend angle are within assumed digitization range.
   void         checkInRange(float phiS, float rt, float phiO) const;
 
+  // Check that digitization followed by undigitization doesn't change stub coords. too much (printing a warning if it does).
+  void         checkResolution(float phiO_orig) const;
+
+  // Recast integer data (q/Pt bin range & layer ID) into form used by hardware.
+  void         makeIntegerData();
+
   // Check that make() is called before accessing digitized stub info.
   void         ok()    const {if (! ranMake_) throw cms::Exception("DigitalStub:: You forgot to call make()!");}
 
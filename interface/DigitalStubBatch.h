@@ -0,0 +1,135 @@
+#ifndef __DIGITALSTUBBATCH_H__
+#define __DIGITALSTUBBATCH_H__
+
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+class Settings;
+class DigitalStub;
+
+//=== Digitizes all stubs in a sector in one go, giving identical results to DigitalStub::make(),
+//=== which remains the reference implementation. The stub coords. are held as arrays (one per variable),
+//=== so the fixed-point arithmetic is done in simple loops over all stubs that the compiler can vectorize.
+//=== Stubs outside the assumed digitization range are flagged in a bit mask, rather than by an exception.
+//=== N.B. Call add() for each stub, then make(), then pass the results to DigitalStub::make(iPhiSec, batch, iStub).
+
+class DigitalStubBatch {
+
+public:
+
+  // Bits set in outOfRange() if stub variable is outside assumed digitization range.
+  enum RangeViolation {badPhiS = 1, badRt = 2, badZ = 4, badDphi = 8, badRho = 16, badPhiO = 32, badBend = 64};
+
+  // Note configuration parameters.
+  DigitalStubBatch(const Settings* settings);
+
+  ~DigitalStubBatch(){}
+
+  // Remove all stubs, keeping memory allocated for reuse in the next sector.
+  void clear();
+
+  // Add a stub with the given original, floating point coords.
+  void add(float phi, float r, float z, float dphi, float rho, float bend);
+  // Add a stub, taking its original coords. from a DigitalStub on which init() was already called.
+  void add(const DigitalStub& digiStub);
+
+  // Digitize all stubs added, with their phi coord. measured relative to specified phi sector.
+  void make(unsigned int iPhiSec);
+
+  unsigned int size()           const {return phi_orig_.size();}
+  unsigned int iPhiSec()        const {return iPhiSec_;}
+
+  //--- Results for stub number iStub (in the order it was added).
+
+  // Zero unless the stub is outside the assumed digitization range, in which case bits from RangeViolation are set.
+  uint8_t      outOfRange(unsigned int iStub) const {return outOfRange_[iStub];}
+
+  // Digits corresponding to stub coords.
+  unsigned int iDigi_Octant()                 const {return iDigi_Octant_;}
+  int          iDigi_PhiS(unsigned int iStub) const {return iDigi_PhiS_[iStub];}
+  int          iDigi_Rt  (unsigned int iStub) const {return iDigi_Rt_  [iStub];}
+  int          iDigi_Z   (unsigned int iStub) const {return iDigi_Z_   [iStub];}
+  int          iDigi_Dphi(unsigned int iStub) const {return iDigi_Dphi_[iStub];}
+  unsigned int iDigi_Rho (unsigned int iStub) const {return iDigi_Rho_ [iStub];}
+  int          iDigi_PhiO(unsigned int iStub) const {return iDigi_PhiO_[iStub];}
+  int          iDigi_Bend(unsigned int iStub) const {return iDigi_Bend_[iStub];}
+
+  // Floating point stub coords derived from digitized info (so with degraded resolution).
+  float        phi (unsigned int iStub) const {return phi_ [iStub];}
+  float        r   (unsigned int iStub) const {return r_   [iStub];}
+  float        z   (unsigned int iStub) const {return z_   [iStub];}
+  float        dphi(unsigned int iStub) const {return dphi_[iStub];}
+  float        rho (unsigned int iStub) const {return rho_ [iStub];}
+  float        phiS(unsigned int iStub) const {return phiS_[iStub];}
+  float        rt  (unsigned int iStub) const {return rt_  [iStub];}
+  float        phiO(unsigned int iStub) const {return phiO_[iStub];}
+  float        bend(unsigned int iStub) const {return bend_[iStub];}
+
+private:
+
+  //--- configuration (as in class DigitalStub).
+
+  int          iFirmwareType_;
+  float        phiSRange_;
+  float        rtRange_;
+  float        zRange_;
+  float        dPhiRange_;
+  float        rhoRange_;
+  float        phiORange_;
+  float        bendRange_;
+
+  float        phiSMult_;
+  float        rtMult_;
+  float        zMult_;
+  float        dPhiMult_;
+  float        rhoMult_;
+  float        phiOMult_;
+  float        bendMult_;
+
+  unsigned int numPhiSectors_;
+  unsigned int numPhiOctants_;
+  float        phiSectorWidth_;
+  float        phiOctantWidth_;
+  float        chosenRofPhi_;
+
+  //--- Phi sector & octant used by last call to make().
+  unsigned int iPhiSec_;
+  unsigned int iDigi_Octant_;
+
+  //--- Original floating point stub coords.
+  vector<float>        phi_orig_;
+  vector<float>        r_orig_;
+  vector<float>        z_orig_;
+  vector<float>        dphi_orig_;
+  vector<float>        rho_orig_;
+  vector<float>        bend_orig_;
+
+  //--- Work space for coords. relative to sector, octant and chosen radius.
+  vector<float>        phiS_orig_;
+  vector<float>        rt_orig_;
+  vector<float>        phiO_orig_;
+
+  //--- Results.
+  vector<uint8_t>      outOfRange_;
+  vector<int>          iDigi_PhiS_;
+  vector<int>          iDigi_Rt_;
+  vector<int>          iDigi_Z_;
+  vector<int>          iDigi_Dphi_;
+  vector<unsigned int> iDigi_Rho_;
+  vector<int>          iDigi_PhiO_;
+  vector<int>          iDigi_Bend_;
+
+  vector<float>        phi_;
+  vector<float>        r_;
+  vector<float>        z_;
+  vector<float>        dphi_;
+  vector<float>        rho_;
+  vector<float>        phiS_;
+  vector<float>        rt_;
+  vector<float>        phiO_;
+  vector<float>        bend_;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef __DIGITIZATIONMATHS_H__
+#define __DIGITIZATIONMATHS_H__
+
+#include "DataFormats/Math/interface/deltaPhi.h"
+
+#include <cmath>
+
+using namespace std;
+
+//=== Fixed-point arithmetic used to digitize stubs. Shared by DigitalStub::make() and DigitalStubBatch::make(),
+//=== so both give bit-identical digitized stubs. Inline, so DigitalStubBatch's loops over stubs can be vectorized.
+
+namespace digitization {
+
+  // Point in phi sector from which stub phiS is measured.
+  inline float phiSectorRef(unsigned int iPhiSec, float phiSectorWidth, int iFirmwareType) {
+    // Centre of this sector in phi
+    float phiSectorCentre = phiSectorWidth * (0.5 + float(iPhiSec)) - M_PI;
+    // Systolic array firmware measures might measure phiS from start of sector, not centre.
+    return (iFirmwareType == 9)  ?  phiSectorCentre - phiSectorWidth*0.5  :  phiSectorCentre;
+  }
+
+  // Phi octant containing phi sector.
+  inline unsigned int phiOctant(unsigned int iPhiSec, unsigned int numPhiOctants, unsigned int numPhiSectors) {
+    return floor(iPhiSec*numPhiOctants/numPhiSectors);
+  }
+
+  // Centre of phi octant.
+  inline float phiOctantCentre(unsigned int iPhiOct, float phiOctantWidth) {
+    return phiOctantWidth * (0.5 + float(iPhiOct)) - M_PI;
+  }
+
+  // Phi coord. relative to given reference point (e.g. sector or octant centre).
+  inline float relPhi(float phi, float phiRef) {return reco::deltaPhi(phi, phiRef);}
+
+  // Digitize floating point number, given multiplier 2^(number of bits)/range.
+  inline int   digitize  (float x, float mult) {return floor(x*mult);}
+
+  // Floating point number corresponding to centre of digitization bin (so with degraded resolution).
+  inline float undigitize(int iDigi, float mult) {return (iDigi + 0.5)/mult;}
+
+  // Ditto for stub bend, which is known to be half-integer, so has no bin offset.
+  inline float undigitizeBend(int iDigi, float mult) {return (iDigi)/mult;}
+
+  // Phi coord. from one measured relative to sector.
+  inline float absPhi(float phiS, float phiSectorRef) {return reco::deltaPhi(phiS, -phiSectorRef);}
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef __DUPTRKMERGER_H__
+#define __DUPTRKMERGER_H__
+
+#include "boost/numeric/ublas/matrix.hpp"
+#include <vector>
+
+using  boost::numeric::ublas::matrix;
+
+class Settings;
+class HTpair;
+class L1track3D;
+
+using namespace std;
+
+//=== Removes duplicate track candidates found by the HT in different (eta,phi) sectors, before they are fitted.
+//=== (KillDupTrks only compares tracks found within a single sector, so a track in the overlap between sectors
+//=== may be found, and so fitted, several times).
+//===
+//=== Two tracks are duplicates if they share stubs and/or have similar helix parameters, according to the
+//=== policy chosen by cfg param DupTrkMergeEvent. Tracks are considered in order of decreasing number of layers
+//=== with stubs (then number of stubs, then sector order), and each is killed if it is a duplicate of a track already kept.
+
+class DupTrkMerger {
+
+public:
+
+  // Policies for deciding if two tracks are duplicates.
+  enum Policy {none = 0, commonStubs = 1, commonStubsAndHelix = 2, helix = 3};
+
+  // Note configuration parameters.
+  DupTrkMerger(const Settings* settings);
+
+  ~DupTrkMerger() {}
+
+  // Find duplicates amongst the track candidates found by the HT in all sectors.
+  void run(const matrix<HTpair>& mHtPairs);
+
+  // Should track candidate number iTrk in the given sector be kept (so fitted)?
+  bool keep(unsigned int iPhiSec, unsigned int iEtaReg, unsigned int iTrk) const {
+    return (policy_ == none) || keep_[ sectorOffset_[iPhiSec*numEtaRegions_ + iEtaReg] + iTrk ];
+  }
+
+  // Number of track candidates considered, and number killed as duplicates (which is the number of fits avoided per fitter).
+  unsigned int numTracks() const {return tracks_.size();}
+  unsigned int numKilled() const {return numKilled_;}
+  // Number of tracking particles matched to a killed track, but not to any kept track, (so lost by the duplicate removal).
+  unsigned int numTPsLost() const {return numTPsLost_;}
+
+private:
+
+  // Check if the helix params of two tracks are similar.
+  bool similarHelix(const L1track3D* trk1, const L1track3D* trk2) const;
+
+private:
+
+  // Configuration parameters.
+  Policy       policy_;
+  unsigned int minCommonStubs_;
+  float        maxDiffQoverPt_;
+  float        maxDiffPhi0_;
+  float        maxDiffZ0_;
+  float        maxDiffTanLambda_;
+  unsigned int numEtaRegions_;
+
+  // Track candidates in all sectors, and position of first one from each sector in this list.
+  vector<const L1track3D*> tracks_;
+  vector<unsigned int>     sectorOffset_;
+
+  // Results.
+  vector<char>             keep_;
+  unsigned int             numKilled_;
+  unsigned int             numTPsLost_;
+
+  // Work space, reused by each event: tracks kept so far containing each stub (indexed by Stub::index()), 
+  // and number of stubs they share with current track; order in which tracks are considered; tracks kept so far; 
+  // and tracks sharing stubs with current track.
+  vector< vector<unsigned int> > keptTrksWithStub_;
+  vector<unsigned int>           numCommon_;
+  vector<unsigned int>           order_;
+  vector<unsigned int>           keptTrks_;
+  vector<unsigned int>           touchedTrks_;
+};
+
+#endif
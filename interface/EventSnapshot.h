@@ -0,0 +1,160 @@
+#ifndef __EVENTSNAPSHOT_H__
+#define __EVENTSNAPSHOT_H__
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+using namespace std;
+
+namespace edm {
+  class ParameterSet;
+}
+
+class InputData;
+
+//=== Flat binary snapshot of the stub & tracking particle data used by the track finding algorithms,
+//=== allowing them to be replayed & benchmarked outside cmsRun, without access to EDM or geometry.
+//===
+//=== The file consists of a SnapshotFileHeader, followed by any number of events. Each event is a
+//=== SnapshotEventHeader, followed by arrays of SnapshotTP, SnapshotStub and TP truth links (int32_t).
+//=== All cross-references are indices into these arrays, matching Stub::index() and TP::index().
+//=== Records are written in native byte order & layout, so the file can be memory-mapped & used in place.
+
+namespace snapshot {
+  const char         magic[8] = {'T','M','T','T','S','N','A','P'};
+  const uint32_t     version  = 2;
+
+  // Hash of the tracked parameters of the TMTrackProducer config, used to check a snapshot is replayed with
+  // the config that wrote it. (Modules run before TMTrackProducer, that make the stubs, are not covered).
+  uint64_t configHash(const edm::ParameterSet& iConfig);
+}
+
+struct SnapshotFileHeader {
+  char               magic[8];
+  uint32_t           version;
+  float              bField;     // B-field in Tesla, needed by Settings.
+  uint64_t           configHash; // Hash of tracked TMTrackProducer config used to write the file.
+};
+
+struct SnapshotEventHeader {
+  uint32_t           run;
+  uint32_t           event;
+  uint32_t           numTPs;
+  uint32_t           numStubs;
+  uint32_t           numTPlinks; // Total number of entries in stub -> TP truth link array.
+};
+
+//=== Tracking particle kinematics & flags, as stored by class TP.
+
+struct SnapshotTP {
+  int32_t            pdgId;
+  int32_t            charge;
+  float              mass;
+  float              pt;
+  float              eta;
+  float              theta;
+  float              tanLambda;
+  float              phi0;
+  float              vx;
+  float              vy;
+  float              vz;
+  float              d0;
+  float              z0;
+  uint32_t           flags; // Bits defined by SnapshotTP::Flags
+  enum Flags {inTimeBx = 1, physicsCollision = 2, use = 4, useForEff = 8};
+};
+
+//=== Stub coordinates, bend prior to any degradation & module info, as stored by class Stub.
+
+struct SnapshotStub {
+  float              phi;
+  float              r;
+  float              z;
+  float              bendInFrontend; // Stub bend (in strips) as available inside front-end chip.
+  float              localU_cluster[2];
+  float              localV_cluster[2];
+  float              moduleMinR;
+  float              moduleMaxR;
+  float              moduleMinPhi;
+  float              moduleMaxPhi;
+  float              moduleMinZ;
+  float              moduleMaxZ;
+  float              stripPitch;
+  float              stripLength;
+  float              sensorWidth;
+  uint32_t           idDet;
+  uint32_t           nStrips;
+  uint32_t           layerId;
+  uint32_t           endcapRing;
+  uint32_t           flags; // Bits defined by SnapshotStub::Flags
+  //--- Truth info, as indices into SnapshotTP array (-1 if none).
+  int32_t            assocTP;
+  int32_t            assocTPofCluster[2];
+  uint32_t           firstTPlink; // Location in TP truth link array of TPs associated to this stub.
+  uint32_t           numTPlinks;
+  enum Flags {psModule = 1, barrel = 2};
+};
+
+//=== A single event read from a snapshot file. The pointers refer to memory mapped by the EventSnapshotReader.
+
+struct SnapshotEvent {
+  SnapshotEventHeader header;
+  const SnapshotTP*   tps;
+  const SnapshotStub* stubs;
+  const int32_t*      tpLinks;
+};
+
+//=== Writes the stubs & tracking particles unpacked by InputData for each event to a snapshot file.
+
+class EventSnapshotWriter {
+
+public:
+
+  EventSnapshotWriter(const string& fileName, float bField, uint64_t configHash);
+  ~EventSnapshotWriter() {}
+
+  // Must be called before any stub is digitized, since the snapshot stores the original stub coordinates.
+  void write(unsigned int run, unsigned int event, const InputData& inputData);
+
+private:
+
+  ofstream              out_;
+  string                fileName_;
+  // Work space, reused for each event.
+  vector<SnapshotTP>    tps_;
+  vector<SnapshotStub>  stubs_;
+  vector<int32_t>       tpLinks_;
+};
+
+//=== Memory-maps a snapshot file, giving access to its events without copying them.
+//=== A truncated file (e.g. if the job writing it crashed) is an error, unless allowTruncated is set,
+//=== in which case only the complete events before the truncation are read & a warning is printed.
+
+class EventSnapshotReader {
+
+public:
+
+  EventSnapshotReader(const string& fileName, bool allowTruncated = false);
+  ~EventSnapshotReader();
+
+  EventSnapshotReader(const EventSnapshotReader&) = delete;
+  EventSnapshotReader& operator=(const EventSnapshotReader&) = delete;
+
+  float                        bField()     const {return fileHeader_.bField;}
+  uint64_t                     configHash() const {return fileHeader_.configHash;}
+  const vector<SnapshotEvent>& events()     const {return events_;}
+  // True if the file was truncated, (only possible if allowTruncated set).
+  bool                         truncated()  const {return truncated_;}
+
+private:
+
+  SnapshotFileHeader    fileHeader_;
+  const char*           data_; // Mapped file contents.
+  size_t                size_;
+  vector<SnapshotEvent> events_;
+  bool                  truncated_;
+};
+
+#endif
@@ -33,6 +33,10 @@ public:
   // N.B. The argument lists for this are different for r-phi & r-z HT, so unfortunately it can't be declared in base class.
   //virtual void store(const Stub*) = 0;
 
+  // Remove all stubs and track candidates, keeping the array configuration, so it can be reused for the next event.
+  // Only the cells filled since the last reset are visited.
+  virtual void reset();
+
   // Termination. Causes HT array to search for tracks etc.
   virtual void end();
 
@@ -91,6 +95,19 @@ public:
 
 protected:
 
+  // Add stub to cell (i,j) of HT array, noting the cell as filled if it was empty.
+  void storeInCell(unsigned int i, unsigned int j, const Stub* stub) {
+    HTcell& cell = htArray_(i,j);
+    if (cell.numUnfilteredStubs() == 0) filledCells_.push_back( pair<unsigned int, unsigned int>(i, j) );
+    cell.store( stub ); // Calls HTcell::store()
+  }
+  // Ditto, indicating also which subsectors within the sector the stub is consistent with.
+  void storeInCell(unsigned int i, unsigned int j, const Stub* stub, const vector<bool>& inSubSecs) {
+    HTcell& cell = htArray_(i,j);
+    if (cell.numUnfilteredStubs() == 0) filledCells_.push_back( pair<unsigned int, unsigned int>(i, j) );
+    cell.store( stub, inSubSecs ); // Calls HTcell::store()
+  }
+
   // Given a range in one of the coordinates specified by coordRange, calculate the corresponding range of bins. The other arguments specify the axis. And also if some cells nominally associated to stub are to be killed.
   virtual pair<unsigned int, unsigned int> convertCoordRangeToBinRange( pair<float, float> coordRange, unsigned int nBinsAxis, float coordAxisMin, float coordAxisBinSize, unsigned int killSomeHTcells, bool debug = false) const;
 
@@ -100,6 +117,9 @@ private:
   // and the track helix parameters, plus the associated truth particle (if any).
   virtual vector<L1track2D> calcTrackCands2D() const;
 
+  // Create track candidate from the stubs in cell (i,j) of the HT array.
+  L1track2D trackCand2D(unsigned int i, unsigned int j) const;
+
   // If requested, kill those tracks in this sector that can't be read out during the time-multiplexed period, because 
   // the HT has associated too many stubs to tracks.
   virtual vector<L1track2D> killTracksBusySec(const vector<L1track2D>& tracks) const;
@@ -118,6 +138,9 @@ protected:
   // This has two dimensions, representing the two track helix parameters being varied.
   matrix<HTcell> htArray_; 
 
+  // Cells of the HT array that contain stubs. (All other cells are empty, so need no processing).
+  vector< pair<unsigned int, unsigned int> > filledCells_;
+
   // Contains algorithm used for duplicate track removal.
   KillDupTrks<L1track2D> killDupTrks_;
 
@@ -29,6 +29,18 @@ public:
   // and (if called from r-phi HT) the bin number of the cell along the q/Pt axis of the r-phi HT array.
   void init(const Settings* settings, bool isRphiHT, float etaMinSector, float etaMaxSector, float qOverPt, unsigned int ibin_qOverPt = 0);
 
+  // Remove all stubs from this cell, keeping its configuration, so it can be reused for the next event.
+  void reset() {
+    vStubs_.clear();
+    vFilteredStubs_.clear();
+    subSectors_.clear();
+    numFilteredLayersInCell_ = 0;
+    numFilteredLayersInCellBestSubSec_ = 0;
+  }
+
+  // Change the estimated q/Pt of the cell. (Used when an r-z HT array is reused for another r-phi track candidate).
+  void setQoverPt(float qOverPt) { qOverPtCell_ = qOverPt; }
+
   // Add stub to this cell in HT array.
   void store (const Stub* stub) { vStubs_.push_back(stub); }
 
@@ -64,11 +76,18 @@ public:
   // N.B. If subsectors within a sector are not being used, then numFilteredLayersInCellBestSubSec_ = numFilteredLayersInCell_.
   // WARNING: If some tracks are killed as the r-phi HT array can't read them out within the TM period, 
   // killed tracks are still found by this function. It is in HTbase::calcTrackCands2D() that they are killed.
-  bool trackCandFound() const { 
+  bool trackCandFound() const { return this->enoughLayers(numFilteredLayersInCellBestSubSec_); }
+
+  // Check if filtered stubs in the given number of tracker layers would be enough to form a track candidate in this cell.
+  bool enoughLayers(unsigned int numLayers) const { 
     return ( (fabs(qOverPtCell_) > 1/minPtToReduceLayers_)  ?  
-             (numFilteredLayersInCellBestSubSec_ >= minStubLayers_)  :  (numFilteredLayersInCellBestSubSec_ >= minStubLayers_ - 1) );
+             (numLayers >= minStubLayers_)  :  (numLayers >= minStubLayers_ - 1) );
   }
 
+  //=== Check if a stub would survive the bend filter in this cell (or if the filter is not used).
+
+  bool passBendFilter( const Stub* stub ) const { return (! (isRphiHT_ && useBendFilter_)) || this->bendConsistent(stub); }
+
   //=== Disable filters (used for debugging).
 
   void disableBendFilter() {useBendFilter_ = false;}
@@ -88,6 +107,9 @@ private:
   // Produce a filtered collection of stubs in this cell that all have consistent bend
   vector<const Stub*> bendFilter( const vector<const Stub*>& stubs ) const;
 
+  // Check if stub bend is consistent with q/Pt of this cell.
+  bool bendConsistent( const Stub* stub ) const;
+
   // Filter stubs so as to prevent more than specified number of stubs being stored in one cell.
   // This reflects finite memory of hardware.
   vector<const Stub*> maxStubCountFilter( const vector<const Stub*>& stubs ) const;
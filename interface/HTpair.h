@@ -2,6 +2,7 @@
 #define __HTpair_H__
 
 #include "TMTrackTrigger/TMTrackFinder/interface/HTrphi.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HTrz.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/TrkRZfilter.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/KillDupTrks.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
@@ -37,6 +38,10 @@ public:
   // Initialization
   void init(const Settings* settings, float etaMinSector, float etaMaxSector, float phiCentreSector);
 
+  // Remove all stubs & tracks from the previous event, keeping the configuration.
+  // This is much faster than init(), so the HTpair can be created once per run and reused for each event.
+  void reset();
+
   // Add stub to r-phi HT array.
   // If eta subsectors are being used within each sector, specify which ones the stub is compatible with.
   void store( const Stub* stub, const vector<bool>& inEtaSubSecs);
@@ -92,7 +97,9 @@ private:
 
   // r-phi Hough transform
   HTrphi htArrayRphi_; 
-  // Don't bother storing r-z HT array, as would need one for each r-phi track cand, taking too much memory.
+  // r-z Hough transform (if used). This is reused for each r-phi track cand, being reset between them,
+  // so only needs to be created once. (After the event, it only contains the stubs from the last track cand).
+  HTrz   htArrayRz_;
 
   // Track filter(s), such as r-z filters, run after the r-phi Hough transform.
   TrkRZfilter rzFilters_;
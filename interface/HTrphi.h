@@ -5,6 +5,7 @@
 
 #include <vector>
 #include <utility>
+#include <cstdint>
 
 class Settings;
 class Stub;
@@ -31,8 +32,12 @@ public:
   // If eta subsectors are being used within each sector, specify which ones the stub is compatible with.
   void store( const Stub* stub, const vector<bool>& inEtaSubSecs);
 
+  // Remove all stubs and track candidates, keeping the array configuration.
+  void reset();
+
   // Termination. Causes HT array to search for tracks etc.
-  // ... function end() is in base class ...
+  // (If the HT is filled in two passes or hierarchically, first stores stubs in the cells that may contain track candidates).
+  void end();
 
   //=== Info about track candidates found.
 
@@ -69,11 +74,30 @@ public:
 
 private:
 
+  // Ways of filling HT array with a stub: store it in all cells it is consistent with, 
+  // or (when filling HT in two passes) just note which layers have stubs in each cell,
+  // or store it only in those cells that may contain track candidates,
+  // or (when filling HT hierarchically) store it in the cells inside a single coarse cell.
+  enum FillPass {storeAll, countLayers, storeInCandCells, storeInCoarseCell};
+
+  // Fill HT array with a stub, considering only the given range of q/Pt and phiTrk bins.
+  void fill( const Stub* stub, const vector<bool>& inEtaSubSecs, FillPass pass, 
+             unsigned int iQoverPtBinMin, unsigned int iQoverPtBinMax, unsigned int jPhiTrkBinMin, unsigned int jPhiTrkBinMax);
+
+  // Add stub to coarse HT array, noting which layers have stubs in each coarse cell.
+  void storeCoarse( const Stub* stub, const vector<bool>& inEtaSubSecs);
+
+  // For a given coarse Q/Pt bin, find the range of coarse phi bins that a given stub is consistent with.
+  // This range includes all coarse cells containing cells the stub would be stored in by store().
+  pair<unsigned int, unsigned int> iPhiRangeCoarse( const Stub* stub, unsigned int iCoarseQoverPtBin) const;
+
   // For a given Q/Pt bin, find the range of phi bins that a given stub is consistent with.
   pair<unsigned int, unsigned int> iPhiRange( const Stub* stub, unsigned int iQoverPtBin, bool debug = false) const;
 
   // Check that limitations of firmware would not prevent stub being stored correctly in this HT column.
   void countFirmwareErrors(unsigned int iQoverPtBin, unsigned int iPhiTrkBinMin, unsigned int iPhiTrkBinMax);
+  // Ditto for all HT columns (needed if HT array is filled hierarchically).
+  void countFirmwareErrors(const Stub* stub);
 
   // Calculate maximum |gradient| that any stub's line across this HT array could have, so can check it doesn't exceed 1.
   float calcMaxLineGradArray() const;
@@ -110,6 +134,24 @@ private:
   unsigned int killSomeHTCellsRphi_; // Take all cells in HT array crossed by line corresponding to each stub (= 0) or take only some to reduce rate at cost of efficiency ( > 0)
   bool handleStripsRphiHT_; // Should algorithm allow for uncertainty in stub (r,z) coordinate caused by length of 2S module strips when fill stubs in r-phi HT?
 
+  //--- Work space used if HT array is filled in two passes.
+
+  bool twoPassHT_;
+  unsigned int numSubSecs_; // Number of eta subsectors in sector.
+  vector<const Stub*>    passStubs_;    // Stubs stored in HT, with the subsectors they are compatible with.
+  vector< vector<bool> > passSubSecs_;
+  vector<uint32_t>       layerMask_;    // Tracker layers with stubs passing bend filter, in each cell and subsector.
+  vector<bool>           candCell_;     // Cells that may contain a track candidate.
+
+  //--- Coarse HT array used if HT array is filled hierarchically. (The two pass work space above is also used).
+
+  bool hierarchicalHT_;
+  unsigned int coarseFactorPt_;  // Number of cells in each coarse cell along q/Pt axis.
+  unsigned int coarseFactorPhi_; // Number of cells in each coarse cell along phiTrk axis.
+  unsigned int nBinsQoverPtCoarse_;
+  unsigned int nBinsPhiTrkCoarse_;
+  vector< vector<unsigned int> > coarseStubs_; // Indices in passStubs_ of stubs in each coarse cell.
+
   //--- Checks that stub filling is compatible with limitations of firmware.
 
   // Maximum |gradient| of line corresponding to any stub. Should be less than the value of 1.0 assumed by the firmware.
@@ -28,11 +28,18 @@ public:
   // Initialization with cfg params, eta range covered by sector, and estimated q/Pt from previously run r-phi HT.
   void init(const Settings* settings, float etaMinSector, float etaMaxSector, float qOverPt);
 
+  // Remove all stubs & tracks, keeping the array configuration.
+  using HTbase::reset;
+
+  // Remove all stubs & tracks, so the array can be reused for the stubs on another track candidate found by the r-phi HT,
+  // with the given estimated q/Pt. Only the cells filled since the last reset are visited.
+  void reset(float qOverPt);
+
   // Add stub to HT array.
   void store(const Stub* stub);
 
   // Termination. Causes HT array to search for tracks etc.
-  // ... function end() is in base class ...
+  void end();
 
   //=== Info about track candidates found.
 
@@ -97,6 +104,8 @@ private:
   float        maxZtrkAxis_;     // Upper end of range in zTrk in HT array.
   float        binSizeZtrkAxis_; // HT array bin size in zTrk.
 
+  float        qOverPt_;         // Estimated q/Pt of track from r-phi HT.
+
   // Options when filling HT array.
 
   unsigned int killSomeHTCellsRz_; // Take all cells in HT array crossed by line corresponding to each stub (= 0) or take only some to reduce rate at cost of efficiency ( > 0)
@@ -0,0 +1,18 @@
+#ifndef __HELIXPARAMS_H__
+#define __HELIXPARAMS_H__
+
+//=== Helix parameters of a track, as calculated by the track fitters from their internal fit parameters.
+//=== (Each fitter numbers its internal fit parameters with its own enum).
+
+struct HelixParams {
+
+  HelixParams() : qOverPt(0.), d0(0.), phi0(0.), z0(0.), tanLambda(0.) {}
+
+  double qOverPt;
+  double d0;        // Zero if not fitted.
+  double phi0;
+  double z0;
+  double tanLambda;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef __HISTOBUFFER_H__
+#define __HISTOBUFFER_H__
+
+#include <vector>
+#include <map>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+class TH1F;
+class TH2F;
+class TProfile;
+
+using namespace std;
+
+//=== Buffers histogram fills, recording (histogram, value(s), weight) in per-thread arrays, 
+//=== which are only copied into the ROOT histograms in bulk. This keeps the (non thread-safe) ROOT 
+//=== filling out of the per-event processing, and allows its cost to be measured.
+//===
+//=== Usage: call fill() instead of TH1::Fill(), endEvent() at the end of each event,
+//=== and flushAll() before reading the histograms at the end of the job.
+
+class HistoBuffer {
+
+public:
+
+  // Buffers are flushed to the histograms by endEvent() once they contain at least this many entries.
+  HistoBuffer(unsigned int flushSize = 100000) : id_(++lastId_), flushSize_(flushSize), numFlushes_(0), numEntries_(0), flushTime_(0.) {}
+  ~HistoBuffer() {}
+
+  HistoBuffer(const HistoBuffer&) = delete;
+  HistoBuffer& operator=(const HistoBuffer&) = delete;
+
+  // Record histogram fills (same arguments as the corresponding ROOT Fill() methods).
+  void fill(TH1F*     his, double x,           double w = 1.) {this->localBuffer().push_back( Entry{his, x, 0., w, H1}      );}
+  void fill(TH2F*     his, double x, double y, double w = 1.) {this->localBuffer().push_back( Entry{his, x, y,  w, H2}      );}
+  void fill(TProfile* his, double x, double y, double w = 1.) {this->localBuffer().push_back( Entry{his, x, y,  w, Profile} );}
+  // (Fill of bin with alphanumeric label. Slower, so only use for rare fills).
+  void fill(TH1F*     his, const char* label,  double w = 1.) {this->localBuffer().push_back( Entry{his, double(this->labelIndex(label)), 0., w, H1Label} );}
+
+  // Called at end of each event. Flushes buffer of calling thread if it is full.
+  void endEvent();
+
+  // Flush the buffers of all threads into the histograms. (Call before reading the histograms).
+  void flushAll();
+
+  // Print number of entries buffered & time spent filling the ROOT histograms.
+  void printStats() const;
+
+private:
+
+  enum Kind {H1, H2, Profile, H1Label};
+
+  struct Entry {
+    void*  his; // Histogram, of type indicated by kind.
+    double x;   // (For kind H1Label, index of bin label in labels_).
+    double y;
+    double w;
+    Kind   kind;
+  };
+
+  // Get buffer of calling thread, creating it if needed.
+  vector<Entry>& localBuffer();
+
+  // Get index of bin label in labels_, adding it if needed.
+  unsigned int labelIndex(const string& label);
+
+  // Copy buffer contents into the ROOT histograms & empty it. Must hold mutex_.
+  void flush(vector<Entry>& buffer);
+
+private:
+
+  // Unique to each instance, even if a later one reuses the address of a deleted one,
+  // so that threads never use a buffer cached from a deleted instance.
+  const unsigned long id_;
+  static atomic<unsigned long> lastId_;
+
+  const unsigned int flushSize_;
+
+  mutable mutex mutex_; // Protects the ROOT histograms, buffers_ and statistics.
+  map<thread::id, unique_ptr<vector<Entry> > > buffers_;
+  vector<string> labels_; // Bin labels used by fills of kind H1Label.
+
+  // Statistics
+  unsigned int numFlushes_;
+  unsigned long numEntries_;
+  double flushTime_; // seconds
+};
+#endif
@@ -5,6 +5,7 @@
 #include "CommonTools/UtilAlgos/interface/TFileService.h"
 #include <TMTrackTrigger/TMTrackFinder/interface/Settings.h>
 #include <TMTrackTrigger/TMTrackFinder/interface/Stub.h>
+#include <TMTrackTrigger/TMTrackFinder/interface/HistoBuffer.h>
 
 #include "boost/numeric/ublas/matrix.hpp"
 using  boost::numeric::ublas::matrix;
@@ -12,6 +13,8 @@ using  boost::numeric::ublas::matrix;
 #include <vector>
 #include <map>
 #include <string>
+#include <array>
+#include <chrono>
 
 class InputData;
 class TP;
@@ -20,6 +23,8 @@ class HTpair;
 class L1fittedTrack;
 class L1fittedTrk4and5;
 class KillOverlapStubs;
+class OverlapStubPairs;
+class DupTrkMerger;
 class TH1F;
 class TH2F;
 class TProfile;
@@ -29,7 +34,7 @@ class Histos {
 
 public:
   // Store cfg parameters.
-  Histos(const Settings* settings) : settings_(settings), numPerfRecoTPforAlg_(0) {}
+  Histos(const Settings* settings) : settings_(settings), numPerfRecoTPforAlg_(0) {groupTime_.fill(0.);}
 
   ~Histos(){}
 
@@ -39,7 +44,7 @@ public:
   // Fill histograms with stubs and tracking particles from input data.
   void fillInputData(const InputData& inputData);
   // Fill histograms relating the stub-pairs algorithm
-  void fillStubPairs(const vector<const Stub*>& vStubs);
+  void fillStubPairs(const OverlapStubPairs& pairs);
   // Fill histograms that check if choice of (eta,phi) sectors is good.
   void fillEtaPhiSectors(const InputData& inputData, const matrix<Sector>& mSectors);
   // Fill histograms checking filling of r-phi HT array.
@@ -50,14 +55,32 @@ public:
   void fillTrackCands(const InputData& inputData, const matrix<Sector>& mSectors, const matrix<HTpair>& mHtPairs);
   // Fill histograms studying freak, events with too many stubs..
   void fillStudyBusyEvents(const InputData& inputData, const matrix<Sector>& mSectors, const matrix<HTpair>& mHtPairs);
-  // Fill histograms relating to track fitting performance.
-  void fillTrackFitting(const InputData& inputData, const vector<std::pair<std::string,L1fittedTrack>>& fittedTracks, float chi2dofCutPlots);
+  // Fill histograms relating to track fitting performance, including the number of fits avoided by removing
+  // duplicate tracks found in different sectors before the fit.
+  void fillTrackFitting(const InputData& inputData, const vector<std::pair<std::string,L1fittedTrack>>& fittedTracks, float chi2dofCutPlots, const DupTrkMerger& dupTrkMerger);
+
+  // Call after all fill functions for an event. Transfers buffered fills to the histograms in bulk when appropriate.
+  void endEvent() {numStubsInSec_.clear(); buffer_.endEvent();}
 
   void endJobAnalysis();
 
 private:
 
+  // Groups of histograms, which can be switched on/off individually with cfg param HistogramGroups.
+  enum HistGroup {grpMonitoring, grpInputData, grpStubPairs, grpEtaPhiSectors, grpRphiHT, grpRZfilters, grpTrackCands, grpStudyBusyEvents, grpTrackFitting, numHistGroups};
+
+  // Adds the wall-clock time spent in its scope to the time recorded for a group of histograms.
+  class GroupTimer {
+  public:
+    GroupTimer(double& time) : time_(time), start_(std::chrono::steady_clock::now()) {}
+    ~GroupTimer() {time_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();}
+  private:
+    double& time_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
   // Book histograms for specific topics.
+  void bookMonitoring();
   void bookInputData();
   void bookStubPairs();
   void bookEtaPhiSectors();
@@ -67,6 +90,13 @@ private:
   void bookStudyBusyEvents();
   void bookTrackFitting();
 
+  // Print cheap monitoring summary (run at end of job).
+  void printMonitoring() const;
+  // Print tracking efficiency & performance summary (run at end of job).
+  void printTrackingSummary();
+  // Print time spent filling each group of histograms (run at end of job).
+  void printGroupTiming() const;
+
   // Produce plots of tracking efficiency prior to track fit (run at end of job).
   void plotTrackEfficiency();
   // Produce plots of tracking efficiency after track fit (run at end of job).
@@ -77,12 +107,36 @@ private:
   // Only considers TP used for algorithmic efficiency measurement.
   map<const TP*, string> diagnoseTracking(const InputData& inputData, const matrix<Sector>& mSectors, const matrix<HTpair>& mHtPairs) const;
 
+  // Number of stubs on a tracking particle inside a sector; or inside it if only the eta cuts are applied;
+  // or inside it if only the phi cuts are applied.
+  struct NumStubsInSec {
+    unsigned int etaPhi;
+    unsigned int eta;
+    unsigned int phi;
+  };
+
+  // Get these numbers for the given TP & sector. They are calculated for all sectors the first time a TP is used
+  // in an event, and then reused by all fill functions until endEvent().
+  const NumStubsInSec& numStubsInside(const vector<TP>& vTPs, const matrix<Sector>& mSectors, const TP& tp, unsigned int iPhiSec, unsigned int iEtaReg);
+
  private:
 
   const Settings *settings_; // Configuration parameters.
 
   edm::Service<TFileService> fs_;
 
+  // All histogram fills are recorded here, and only copied into the histograms in bulk.
+  HistoBuffer buffer_;
+
+  // Cache of numStubsInside() for current event, indexed by TP then sector. (Entries with etaPhi = -1 not yet calculated).
+  vector<NumStubsInSec> numStubsInSec_;
+
+  // Wall-clock time (s) spent filling each group of histograms, including calculations needed to fill them.
+  std::array<double, numHistGroups> groupTime_;
+
+  // Cheap monitoring histogram, always filled: mean numbers of stubs, TPs & tracks per event.
+  TProfile* profMonitoring_;
+
   // Histograms of input data.
   TProfile* profNumStubs_;
   TH1F* hisStubsVsEta_;
@@ -464,9 +518,9 @@ private:
   map<std::string, unsigned int> numFitPerfAlgEffPass_;
 
   // For filling histograms related to the stub-pairs algorithm
-  void analyse_PairFinding   (const vector<const Stub*>& vStubs);
-  void analyse_cuts          (const vector<const Stub*>& vStubs);
-  void analyse_Formulae(const vector<const Stub*>& vStubs);
+  void analyse_PairFinding   (const OverlapStubPairs& pairs);
+  void analyse_cuts          (const OverlapStubPairs& pairs);
+  void analyse_Formulae(const OverlapStubPairs& pairs);
   vector<const Stub*> depair(vector< pair<const Stub*, const Stub*> > vPairs) const;
 };
 
@@ -3,11 +3,15 @@
 
 #include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/KillOverlapStubs.h"
 #include "FWCore/Framework/interface/Frameworkfwd.h"
 
 #include <vector>
+#include <deque>
 
 class Settings;
+class ModuleInfoCache;
+struct SnapshotEvent;
 
 using namespace std;
 
@@ -18,7 +22,10 @@ class InputData {
 
 public:
   
-  InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Settings* settings);
+  // Info about the module containing each stub is taken from moduleInfoCache, which must outlive this object.
+  InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Settings* settings, ModuleInfoCache* moduleInfoCache);
+  // Unpack event from snapshot file instead (for replay outside cmsRun).
+  InputData(const SnapshotEvent& snapEvent, Settings* settings, ModuleInfoCache* moduleInfoCache);
 
   // Get tracking particles
   const vector<TP>&          getTPs()      const {return vTPs_;}
@@ -30,6 +37,12 @@ public:
   // Get number of stubs prior to applying tighted front-end readout electronics cuts specified in section StubCuts of Analyze_Defaults_cfi.py. (Only used to measure the efficiency of these cuts).
   const vector<Stub>&        getAllStubs() const {return vAllStubs_;}
 
+  // Get rarely used info about each stub, indexed by Stub::index(). (Normally accessed via the Stub class).
+  const deque<StubColdData>& getStubColdData() const {return vStubCold_;}
+
+  // Get pairs of stubs considered when removing duplicate stubs from overlap regions (only filled if histogramming them).
+  const OverlapStubPairs&    getOverlapPairs() const {return overlapPairs_;}
+
 private:
 
   vector<TP> vTPs_; // tracking particles
@@ -38,6 +51,10 @@ private:
   //--- of minor importance ...
 
   vector<Stub> vAllStubs_; // all stubs, even those that would fail any tightened front-end readout electronic cuts specified in section StubCuts of Analyze_Defaults_cfi.py. (Only used to measure the efficiency of these cuts).
+
+  deque<StubColdData> vStubCold_; // rarely used info about each stub in vAllStubs_ (a deque, so the stubs' pointers to it stay valid as it grows).
+
+  OverlapStubPairs overlapPairs_; // pairs of stubs found by overlap removal, prior to removing any stubs.
 };
 #endif
 
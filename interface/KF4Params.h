@@ -9,10 +9,11 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Matrix.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
-#include <map>
  
 class KF4Params : public L1Kalman{
  
+    public:
+        enum PAR_IDS { INV2R, PHI0, Z0, T };
     public:
         KF4Params(const Settings* settings, const uint nPar);
         ~KF4Params(){}
@@ -26,11 +27,7 @@ class KF4Params : public L1Kalman{
         Matrix<double> F(const Stub* stub);
         Matrix<double> PxxModel();
         Matrix<double> PddMeas(const Stub* stub);
-        std::map<std::string, double> convertParams(std::vector<double> x);
- 
-    private:
-        std::vector<double> mapToVec(std::map<std::string, double> x);
-        std::map<std::string, double> vecToMap(std::vector<double> x);
+        HelixParams convertParams(std::vector<double> x);
 };
 #endif
  
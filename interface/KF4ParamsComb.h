@@ -5,13 +5,15 @@
 #ifndef __KF4PARAMSCOMB__
 #define __KF4PARAMSCOMB__
  
-#include "TMTrackTrigger/TMTrackFinder/interface/L1KalmanComb.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/L1KalmanCombModel.h"
 //#include "TMTrackTrigger/TMTrackFinder/interface/Matrix.h"
 #include <TMatrixD.h>
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
 
-class KF4ParamsComb : public L1KalmanComb{
+class KF4ParamsComb : public L1KalmanCombModel<KF4ParamsComb, 4>{
+
+	friend class L1KalmanCombModel<KF4ParamsComb, 4>;
  
     public:
 	enum PAR_IDS { INV2R, PHI0, Z0, T }; 
@@ -22,7 +24,7 @@ class KF4ParamsComb : public L1KalmanComb{
         std::string getParams();
  
     protected:
-	virtual std::map<std::string, double> getTrackParams(const kalmanState *state )const;
+	virtual HelixParams getTrackParams(const kalmanState *state )const;
 	virtual std::vector<double> seedx(const L1track3D& l1track3D)const;
 	virtual TMatrixD seedP(const L1track3D& l1track3D)const;
 	virtual std::vector<double> d(const Stub* stub )const;
@@ -34,11 +36,19 @@ class KF4ParamsComb : public L1KalmanComb{
 	virtual TMatrixD PddMeas(const Stub* stub, const kalmanState *state )const;
 	virtual bool stubBelongs(const Stub* stub, kalmanState& state, unsigned itr )const;
 	virtual bool isGoodState( const kalmanState &state )const;
+	virtual bool predictionDependsOnStub()const{ return false; }
 
-    private:
-	std::vector<double> mapToVec(std::map<std::string, double> x)const;
-	std::map<std::string, double> vecToMap(std::vector<double> x)const;
+	// Fixed-size versions of the model, used by L1KalmanCombModel. (The virtual ones above call these).
+	void H(const Stub* stub, double h[2][4])const;
+	void dH(const Stub* stub, double h[2][4])const;
+	void d(const Stub* stub, double meas[2])const;
+	void F(const Stub* stub, const kalmanState *state, double f[4][4])const;
+	void PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr, double p[4][4] )const; 
+	void ErrMeas(const Stub* stub, const double x[4], double e[2])const;
+	void PddMeas(const Stub* stub, const double x[4], double p[2][2])const;
 };
+
+extern template class L1KalmanCombModel<KF4ParamsComb, 4>;
 #endif
 
 
@@ -4,7 +4,9 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/KF4ParamsComb.h"
 #include <TMatrixD.h>
 
-class KF4ParamsCombV2 : public KF4ParamsComb{
+class KF4ParamsCombV2 : public L1KalmanCombModel<KF4ParamsCombV2, 4, KF4ParamsComb>{
+
+	friend class L1KalmanCombModel<KF4ParamsCombV2, 4, KF4ParamsComb>;
 
     public:
 	enum PAR_IDS { BETA, Z0P, R0P, RHO0 };  
@@ -15,7 +17,7 @@ class KF4ParamsCombV2 : public KF4ParamsComb{
 	std::string getParams();
 
     protected:
-	std::map<std::string, double> getTrackParams( const kalmanState *state )const;
+	HelixParams getTrackParams( const kalmanState *state )const;
 	std::vector<double> seedx(const L1track3D& l1track3D)const;
 	TMatrixD seedP(const L1track3D& l1track3D)const;
 	std::vector<double> d(const Stub* stub )const;
@@ -24,13 +26,20 @@ class KF4ParamsCombV2 : public KF4ParamsComb{
 	TMatrixD PxxModel( const kalmanState* state, const Stub* stub, unsigned stub_itr )const;
 	std::vector<double> ErrMeas(const Stub* stub, std::vector<double> x )const;
 	TMatrixD PddMeas(const Stub* stub, const kalmanState *state )const;
-	std::map<std::string, double> convertParams(std::vector<double> x)const;
 	bool stubBelongs(const Stub* stub, kalmanState& state, std::vector<double> resid)const;
 	bool isGoodState( const kalmanState &state )const;
 
 	std::vector<double> residual(const Stub* stub, std::vector<double> &x )const;
 
+	// Fixed-size versions of the model, used by L1KalmanCombModel. (The virtual ones above call these).
+	void d(const Stub* stub, double meas[2])const;
+	void H(const Stub* stub, double h[2][4])const;
+	void dH(const Stub* stub, const double x[4], double h[2][4])const;
+	void PxxModel( const kalmanState* state, const Stub* stub, unsigned stub_itr, double p[4][4] )const;
+	void ErrMeas(const Stub* stub, const double x[4], double e[2])const;
+	void PddMeas(const Stub* stub, const double x[4], double p[2][2])const;
 };
 
+extern template class L1KalmanCombModel<KF4ParamsCombV2, 4, KF4ParamsComb>;
 #endif
 
@@ -1,10 +1,12 @@
 #ifndef __KF5ParamsComb_H__
 #define __KF5ParamsComb_H__
 
-#include "TMTrackTrigger/TMTrackFinder/interface/L1KalmanComb.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/L1KalmanCombModel.h"
 #include <TMatrixD.h>
 
-class KF5ParamsComb : public L1KalmanComb{
+class KF5ParamsComb : public L1KalmanCombModel<KF5ParamsComb, 5>{
+
+	friend class L1KalmanCombModel<KF5ParamsComb, 5>;
 
     public:
 	enum PAR_IDS { INV2R, PHI0, Z0, T, D0 }; 
@@ -17,7 +19,7 @@ class KF5ParamsComb : public L1KalmanComb{
 
     protected:
 
-	std::map<std::string, double> getTrackParams(const kalmanState *state )const;
+	HelixParams getTrackParams(const kalmanState *state )const;
 	std::vector<double> seedx(const L1track3D& l1track3D)const;
 	TMatrixD seedP(const L1track3D& l1track3D)const;
 	std::vector<double> d(const Stub* stub )const;
@@ -26,17 +28,27 @@ class KF5ParamsComb : public L1KalmanComb{
 	TMatrixD PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr )const; 
 	std::vector<double> ErrMeas(const Stub* stub, std::vector<double> x )const;
 	TMatrixD PddMeas(const Stub* stub, const kalmanState *state )const;
-	std::map<std::string, double> convertParams(std::vector<double> x)const;
 	bool stubBelongs(const Stub* stub, kalmanState& state, unsigned itr )const;
 
 	std::vector<double> residual(const Stub* stub, const std::vector<double> &x )const;
 	const kalmanState *updateSeedWithStub( const kalmanState &state, const Stub *stub );
+	bool updatesSeedWithStub()const{ return true; }
 	bool isGoodState( const kalmanState &state )const;
+	bool predictionDependsOnStub()const{ return getSettings()->kalmanMultiScattFactor() != 0; } // PxxModel uses stub eta.
 
 	double getRofState( unsigned layerId, const vector<double> &xa )const;
 	TMatrixD dH(const Stub* stub)const;
 
+	// Fixed-size versions of the model, used by L1KalmanCombModel. (The virtual ones above call these).
+	void d(const Stub* stub, double meas[2])const;
+	void H(const Stub* stub, double h[2][5])const;
+	void dH(const Stub* stub, double h[2][5])const;
+	void F(const Stub* stub, const kalmanState *state, double f[5][5])const;
+	void PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr, double p[5][5] )const; 
+	void PddMeas(const Stub* stub, const double x[5], double p[2][2])const;
+	void calcResidual(const Stub* stub, const double h[2][5], const double meas[2], const double x[5], double delta[2])const;
 };
 
+extern template class L1KalmanCombModel<KF5ParamsComb, 5>;
 #endif
 
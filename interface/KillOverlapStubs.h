@@ -5,44 +5,94 @@
 
 #include <vector>
 #include <string>
+#include <utility>
 
 class Settings;
 class Stub;
 class TP;
 
+// Pairs of stubs on different modules in the same layer, found once per event together with the variables
+// used to decide if they are duplicates. The pairs passing any given cuts can then be selected cheaply.
+// Pairs are ordered as the stubs in the input list, with the first stub of each pair being the earlier one.
+
+class OverlapStubPairs {
+
+  public:
+    // Pair of stubs on neighbouring modules, as considered by the pairFinder algorithm.
+    struct Candidate {
+      const Stub* s1;
+      const Stub* s2;
+      double      z0;           // z0 and pt/q of track through both stubs.
+      double      ptOverQ;
+      bool        qOverPtMatch; // Is q/pt of both stubs (from bend) consistent with ptOverQ?
+    };
+
+    // Pair of stubs produced by the same tracking particle, as considered by the truePairFinder algorithm.
+    struct TruePair {
+      const Stub* s1;
+      const Stub* s2;
+      const TP*   commonTP;
+      double      z0;
+      double      ptOverQ;
+    };
+
+    OverlapStubPairs() {}
+
+    // Select pairs found by the pairFinder algorithm with the given cuts.
+    std::vector< std::pair<const Stub*, const Stub*> > selectFound(double pt_cut, double z0_cut, bool genuineOnly = false) const;
+    // Select true pairs with the given cut on the pt of the tracking particle.
+    std::vector< std::pair<const Stub*, const Stub*> > selectTrue(double pt_cut) const;
+
+    std::vector<const Stub*>  stubs;       // Stubs amongst which pairs were sought.
+    std::vector<Candidate>    candidates;  // Empty unless pairFinder candidates were sought.
+    std::vector<TruePair>     truePairs;   // Empty unless true pairs were sought.
+};
+
 class KillOverlapStubs {
 
   public:
-    KillOverlapStubs(const std::vector<const Stub*>& vStubs, const Settings* settings, double pt_cut, double z0_cut)
-      : settings_(settings), vStubs_(vStubs), pt_cut_(pt_cut), z0_cut_(z0_cut) {}
-    KillOverlapStubs(const std::vector<const Stub*>& vStubs, const Settings* settings)
-      : settings_(settings), vStubs_(vStubs) {
-        pt_cut_ = settings_->overlapPtCut();
-        z0_cut_ = settings_->overlapZ0Cut();
-    }
+    enum Method {none, pairFinder, truePairFinder};
+
+    KillOverlapStubs(const std::vector<const Stub*>& vStubs, const Settings* settings, double pt_cut, double z0_cut);
+    KillOverlapStubs(const std::vector<const Stub*>& vStubs, const Settings* settings);
 
-    const std::vector<const Stub*> getFiltered(std::string method) const;
-    std::vector< std::pair<const Stub*, const Stub*> > getPairs(std::string method) const;
+    // Remove first stub of each duplicate pair, using method from cfg or specified here.
+    const std::vector<const Stub*> getFiltered() const {return getFiltered(method_);}
+    const std::vector<const Stub*> getFiltered(Method method) const;
+    std::vector< std::pair<const Stub*, const Stub*> > getPairs(Method method) const;
+
+    // Get all pairs, with the variables used to select them, for further study.
+    // Pairs already found by getFiltered() or getPairs() are reused, not recomputed.
+    const OverlapStubPairs& getAllPairs() const;
+
+    // Convert name of method used in cfg to enum.
+    static Method methodFromName(const std::string& name);
 
     std::pair<double,double> getTrackParams(const Stub* s1, const Stub* s2) const { return trackParams(s1, s2); }
-    const TP* getCommonTP (const Stub* s1, const Stub* s2) const { return commonTP(s1, s2); }
-    const TP* getFirstTP(const Stub* s) const { return firstTP(s); }
+    static const TP* getCommonTP (const Stub* s1, const Stub* s2) { return commonTP(s1, s2); }
+    static const TP* getFirstTP(const Stub* s) { return firstTP(s); }
 
   private:
-    // identify pairs of stubs
-    std::vector< std::pair<const Stub*, const Stub*> > pairFinder () const;
-    std::vector< std::pair<const Stub*, const Stub*> > truePairFinder() const;
+    // identify pairs of stubs (only done once)
+    void findCandidates() const;
+    void findTruePairs() const;
 
     // helper functions for the above
     bool neighb_modules (const Stub* s1, const Stub* s2) const;
-    const TP* commonTP (const Stub* s1, const Stub* s2) const;
+    void addCandidate (const Stub* s1, const Stub* s2) const;
+    static const TP* commonTP (const Stub* s1, const Stub* s2);
     std::pair<double,double> trackParams(const Stub* s1, const Stub* s2) const;
-    const TP* firstTP(const Stub* s) const;
+    static const TP* firstTP(const Stub* s);
 
     // data members
     const Settings *settings_;
-    const std::vector<const Stub*> vStubs_;
     double pt_cut_, z0_cut_;
+    Method method_;
+
+    // pairs found so far
+    mutable OverlapStubPairs pairs_;
+    mutable bool foundCandidates_;
+    mutable bool foundTruePairs_;
 
 };
 
@@ -10,8 +10,8 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/TrackFitGeneric.h"
 #include"TMTrackTrigger/TMTrackFinder/interface/Settings.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HelixParams.h"
 #include <vector>
-#include <map>
 #include <utility>
  
  
@@ -31,11 +31,10 @@ protected:
     virtual std::vector<double> residuals(std::vector<double> x)=0;
     virtual Matrix<double> D(std::vector<double> x)=0; // derivatives
     virtual Matrix<double> Vinv()=0; // Covariances
-    virtual std::map<std::string, double> convertParams(std::vector<double> x)=0;
+    virtual HelixParams convertParams(std::vector<double> x)=0;
  
     /* Variables */
     std::vector<const Stub*> stubs_;
-    std::map<std::string, double> trackParams_;
     uint nPar_;
     float largestresid_;
     int ilargestresid_;
@@ -45,11 +44,14 @@ private:
 
     void calculateChiSq( std::vector<double> resids );
     void calculateDeltaChiSq( std::vector<double> deltaX, std::vector<double> covX );
+    // Remove killed stub from linearisation & residuals of previous fit iteration (Sherman-Morrison downdate).
+    bool downdate( int ikilled, Matrix<double>& Minv, Matrix<double>& dtVinv, std::vector<double>& resids );
 
     int numFittingIterations_;
     int killTrackFitWorstHit_;
     double generalResidualCut_;
     double killingResidualCut_;
+    bool incrementalFit_;
 
     unsigned int minStubLayers_;
     float minPtToReduceLayers_;
@@ -11,7 +11,7 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
-#include <map>
+#include "TMTrackTrigger/TMTrackFinder/interface/HelixParams.h"
 #include <vector>
  
 class L1Kalman : public TrackFitGeneric{
@@ -34,7 +34,7 @@ class L1Kalman : public TrackFitGeneric{
         virtual Matrix<double> F(const Stub* stub)=0;
         virtual Matrix<double> PxxModel()=0;
         virtual Matrix<double> PddMeas(const Stub* stub)=0;
-        virtual std::map<std::string, double> convertParams(std::vector<double>)=0;
+        virtual HelixParams convertParams(std::vector<double>)=0;
  
     private:
         unsigned nPar_;
@@ -13,6 +13,7 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/kalmanState.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HelixParams.h"
 #include <map>
 #include <vector>
 #include <fstream>
@@ -33,15 +34,28 @@ class L1KalmanComb : public TrackFitGeneric{
         L1fittedTrack fit(const L1track3D& l1track3D, unsigned int iPhiSec, unsigned int iEtaReg);
 	void bookHists();
     protected:
-	static  std::map<std::string, double> getTrackParams( const L1KalmanComb *p, const kalmanState *state );
-	virtual std::map<std::string, double> getTrackParams( const kalmanState *state )const=0;
+	static  HelixParams getTrackParams( const L1KalmanComb *p, const kalmanState *state );
+	virtual HelixParams getTrackParams( const kalmanState *state )const=0;
 
 	double sectorPhi()const
 	{
 	    return 2.*M_PI * (0.5 + float(iCurrentPhiSec_)) / float(getSettings()->numPhiSectors()) - M_PI; // Centre of sector in phi
 	}
+	// Prediction of a state to the next layer, (shared by all stubs in that layer if predictionDependsOnStub() is false).
+	struct Prediction {
+	    const kalmanState*  state;
+	    std::vector<double> xa;     // State params, (converted to endcap params if going from barrel to endcap).
+	    TMatrixD            cov_xa;
+	    TMatrixD            f;
+	    std::vector<double> fx;     // Predicted params, F*x.
+	    TMatrixD            pxxm;   // Process noise.
+	    TMatrixD            pxcov;  // Predicted covariance, F*P*Ft + pxxm.
+	};
+
 	bool kalmanUpdate( const Stub *stub, kalmanState &state, kalmanState &new_state, const TP *tpa );
-	const kalmanState *kalmanUpdate( unsigned nItr, const Stub* stub, const kalmanState &state, const TP *);
+	// Update the state with a stub, (overridden with fixed-size maths by L1KalmanCombModel).
+	virtual const kalmanState *kalmanUpdate( unsigned nItr, const Stub* stub, const kalmanState &state, const TP *, const Prediction *pred = 0 );
+	void predict( const kalmanState &state, const Stub *stub, unsigned stub_itr, Prediction &pred )const;
 	void resetStates();
 	const kalmanState *mkState( unsigned nIterations, unsigned layerId, double r, const kalmanState *last_state, 
 		const std::vector<double> &x, const TMatrixD &pxx, const Stub* stub, double chi2 );
@@ -74,17 +88,24 @@ class L1KalmanComb : public TrackFitGeneric{
 
 	virtual std::vector<double> residual(const Stub* stub, const std::vector<double> &x )const;
 	virtual const kalmanState *updateSeedWithStub( const kalmanState &state, const Stub *stub ){ return 0; }
+	// Is the seed updated with updateSeedWithStub() for each stub in the first layer?
+	virtual bool updatesSeedWithStub()const{ return false; }
 	virtual bool isGoodState( const kalmanState &state )const{ return true; }
+	// Do F or PxxModel depend on the stub, (as opposed to only its layer)? If not, the prediction of each state is done once per layer.
+	virtual bool predictionDependsOnStub()const{ return true; }
 
 	bool validationGate( const Stub *stub, unsigned stub_itr, const kalmanState &state, double &e2, bool debug = false )const; 
+	// Validation gate chi2 of each stub in a layer, (overridden with fixed-size maths by L1KalmanCombModel).
+	virtual void validationGates( const Stub * const *stubs, unsigned nStubs, const Prediction &pred, std::vector<double> &e2s )const; 
 	double calcChi2( unsigned itr, const kalmanState &state )const;
 	void printTP( std::ostream &os, const TP *tp )const;
 
 
 	unsigned getNextLayer( unsigned state_layer, unsigned next_stub_layer );
-	std::vector<const Stub *> getNextLayerStubs( const kalmanState *state, std::vector<const Stub *> &stubs, unsigned &next_layer );
 	virtual double getRofState( unsigned layerId, const vector<double> &xa )const{ return 0;}
-	std::vector<const kalmanState *> doKF( unsigned nItr, const std::vector<const kalmanState *> &states, std::vector<const Stub *> stubs, const TP *tpa );
+	// Run the KF over the stubs sorted by layer, starting from the seed state. The stubs in layer i are those 
+	// from position layerStart[i] to layerStart[i+1] (excluded) in the list.
+	std::vector<const kalmanState *> doKF( const kalmanState *state0, const std::vector<const Stub *> &stubs, const std::vector<unsigned> &layerStart, const TP *tpa );
 
 	void fillCandHists( const kalmanState &state, const TP *tpa=0 );
 	void fillTrackHists( const kalmanState *state, const TP *tpa, std::vector<const Stub *> &stubs );
@@ -140,6 +161,12 @@ class L1KalmanComb : public TrackFitGeneric{
 	bool     dump_;
 	unsigned int      iCurrentPhiSec_;
 	unsigned int      iCurrentEtaReg_;
+
+	// Work space reused by each fit: position of first stub in each layer, stubs passing the validation gate
+	// of a state, and their validation gate chi2.
+	std::vector<unsigned>      layerStart_;
+	std::vector<const Stub *>  nextStubs_;
+	std::vector<double>        e2s_;
 };
 #endif
 
@@ -0,0 +1,286 @@
+///=== This is a base class for Kalman Combinatorial Filter track fit algorithms, which implements the per stub
+///=== steps of the filter (validation gate & state update) with fixed-size arrays, for a track model known at
+///=== compile time. It avoids the TMatrixD & std::vector objects created by the generic implementation in
+///=== L1KalmanComb, which calls the virtual model methods for every stub.
+///
+///=== The track model class derives from it (curiously recurring template pattern), giving itself as Model,
+///=== its number of helix params as NPAR and its own base class as Base. It must provide these non-virtual
+///=== methods, filling the given arrays, in addition to the virtual TMatrixD ones of L1KalmanComb:
+///===     void H( const Stub *stub, double h[2][NPAR] )const;
+///===     void d( const Stub *stub, double m[2] )const;
+///===     void F( const Stub *stub, const kalmanState *state, double f[NPAR][NPAR] )const;
+///===     void PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr, double p[NPAR][NPAR] )const;
+///===     void PddMeas( const Stub *stub, const double x[NPAR], double p[2][2] )const;
+///=== A model that overrides the virtual residual() must also provide the fixed-size version used here, (and can
+///=== implement the virtual one with it). Otherwise the default, equal to L1KalmanComb::residual(), is used:
+///===     void calcResidual( const Stub *stub, const double h[2][NPAR], const double m[2], const double x[NPAR], double delta[2] )const;
+///=== As in L1KalmanComb, the state is predicted to the next layer with F, (x -> F*x, P -> F*P*Ft + PxxModel).
+///=== The fitter is chosen at run time, as before, by TrackFitGeneric::create().
+
+#ifndef __L1_KALMAN_COMB_MODEL__
+#define __L1_KALMAN_COMB_MODEL__
+
+#include "TMTrackTrigger/TMTrackFinder/interface/L1KalmanComb.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/kalmanState.h"
+#include <TMatrixD.h>
+#include <vector>
+
+template <class Model, unsigned NPAR, class Base = L1KalmanComb>
+class L1KalmanCombModel : public Base{
+
+    public:
+	using Base::Base;
+	virtual ~L1KalmanCombModel(){}
+
+    protected:
+	typedef typename Base::Prediction Prediction;
+
+	void validationGates( const Stub * const *stubs, unsigned nStubs, const Prediction &pred, std::vector<double> &e2s )const;
+	const kalmanState *kalmanUpdate( unsigned nItr, const Stub* stub, const kalmanState &state, const TP *tpa, const Prediction *pred = 0 );
+
+	using Base::HxxH;
+	// H * xx * Ht, with the same order of operations as L1KalmanComb::HxxH().
+	static void HxxH( const double h[2][NPAR], const double xx[NPAR][NPAR], double hxxh[2][2] );
+	using Base::Fx;
+	// F * x, with the same order of operations as L1KalmanComb::Fx().
+	static void Fx( const double f[NPAR][NPAR], const double x[NPAR], double fx[NPAR] );
+
+	// Residual of the measurement m = d(stub) from the params x, (same as L1KalmanComb::residual()).
+	// Models that override residual() hide this with their own version.
+	void calcResidual( const Stub *stub, const double h[2][NPAR], const double m[2], const double x[NPAR], double delta[2] )const;
+
+    private:
+	const Model &model()const{ return static_cast<const Model &>( *this ); }
+	// Use the fixed-size model methods, (the generic ones print debug output)?
+	bool fixedSizeMaths()const{ return this->getSettings()->kalmanFixedSizeMaths() && this->getSettings()->kalmanDebugLevel() < 3; }
+
+	static void toArray( const std::vector<double> &v, double a[NPAR] );
+	static void toArray( const TMatrixD &m, double a[NPAR][NPAR] );
+	// Chi2 of residual delta with covariance c, (999 if c is singular).
+	static double chi2( const double c[2][2], const double delta[2] );
+};
+
+template <class Model, unsigned NPAR, class Base>
+void L1KalmanCombModel<Model, NPAR, Base>::HxxH( const double h[2][NPAR], const double xx[NPAR][NPAR], double hxxh[2][2] )
+{
+    double tmp[2][NPAR] = {};
+    for( unsigned i=0; i < 2; i++ ){
+	for( unsigned j=0; j < NPAR; j++ ){
+	    for( unsigned k=0; k < NPAR; k++ ){
+		tmp[i][k] += h[i][j] * xx[j][k];
+	    }
+	}
+    }
+    for( unsigned i=0; i < 2; i++ ){
+	for( unsigned k=0; k < 2; k++ ){
+	    hxxh[i][k] = 0;
+	}
+	for( unsigned j=0; j < NPAR; j++ ){
+	    for( unsigned k=0; k < 2; k++ ){
+		hxxh[i][k] += tmp[i][j] * h[k][j];
+	    }
+	}
+    }
+}
+
+template <class Model, unsigned NPAR, class Base>
+void L1KalmanCombModel<Model, NPAR, Base>::toArray( const std::vector<double> &v, double a[NPAR] )
+{
+    for( unsigned i=0; i < NPAR; i++ ) a[i] = v[i];
+}
+
+template <class Model, unsigned NPAR, class Base>
+void L1KalmanCombModel<Model, NPAR, Base>::toArray( const TMatrixD &m, double a[NPAR][NPAR] )
+{
+    for( unsigned i=0; i < NPAR; i++ ){
+	for( unsigned j=0; j < NPAR; j++ ) a[i][j] = m(i,j);
+    }
+}
+
+template <class Model, unsigned NPAR, class Base>
+void L1KalmanCombModel<Model, NPAR, Base>::Fx( const double f[NPAR][NPAR], const double x[NPAR], double fx[NPAR] )
+{
+    for( unsigned i=0; i < NPAR; i++ ) fx[i] = 0;
+    for( unsigned i=0; i < NPAR; i++ ){
+	for( unsigned j=0; j < NPAR; j++ ) fx[j] += f[j][i] * x[i];
+    }
+}
+
+template <class Model, unsigned NPAR, class Base>
+void L1KalmanCombModel<Model, NPAR, Base>::calcResidual( const Stub *stub, const double h[2][NPAR], const double m[2], const double x[NPAR], double delta[2] )const
+{
+    for( unsigned i=0; i < 2; i++ ){
+	double hx(0);
+	for( unsigned j=0; j < NPAR; j++ ) hx += h[i][j] * x[j];
+	delta[i] = m[i] - hx;
+    }
+    if( delta[0] > 0 ){
+	while( delta[0] > M_PI ) delta[0] -= 2*M_PI; 
+    }
+    else{
+	while( delta[0] < - M_PI ) delta[0] += 2*M_PI; 
+    }
+}
+
+template <class Model, unsigned NPAR, class Base>
+double L1KalmanCombModel<Model, NPAR, Base>::chi2( const double c[2][2], const double delta[2] )
+{
+    double det = c[0][0] * c[1][1] - c[0][1] * c[1][0];
+    if( det == 0 ) return 999;
+    return ( delta[0] * delta[0] * c[1][1] - delta[0] * delta[1] * ( c[0][1] + c[1][0] ) + delta[1] * delta[1] * c[0][0] ) / det;
+}
+
+template <class Model, unsigned NPAR, class Base>
+void L1KalmanCombModel<Model, NPAR, Base>::validationGates( const Stub * const *stubs, unsigned nStubs, const Prediction &pred, std::vector<double> &e2s )const
+{
+    if( ! fixedSizeMaths() ){
+	Base::validationGates( stubs, nStubs, pred, e2s );
+	return;
+    }
+
+    e2s.assign( nStubs, 0 );
+    if( pred.state->stubs().size() < 3 ) return;
+
+    double fx[NPAR], x[NPAR], pxcov[NPAR][NPAR];
+    toArray( pred.fx, fx );
+    toArray( pred.state->xa(), x );
+    toArray( pred.pxcov, pxcov );
+
+    for( unsigned s=0; s < nStubs; s++ ){
+
+	const Stub *stub = stubs[s];
+	double h[2][NPAR], m[2], delta[2], pddm[2][2], hxxh[2][2];
+	model().H( stub, h );
+	model().d( stub, m );
+	model().calcResidual( stub, h, m, fx, delta );
+	model().PddMeas( stub, x, pddm );
+	HxxH( h, pxcov, hxxh );
+
+	double c[2][2];
+	for( unsigned i=0; i < 2; i++ ){
+	    for( unsigned k=0; k < 2; k++ ) c[i][k] = pddm[i][k] + hxxh[i][k];
+	}
+	e2s[s] = chi2( c, delta );
+    }
+}
+
+template <class Model, unsigned NPAR, class Base>
+const kalmanState *L1KalmanCombModel<Model, NPAR, Base>::kalmanUpdate( unsigned nItr, const Stub *stub, const kalmanState &state, const TP *tpa, const Prediction *pred )
+{
+    if( ! fixedSizeMaths() ) return Base::kalmanUpdate( nItr, stub, state, tpa, pred );
+
+    //predict the state (fx = F * xa) & its covariance to this stub's layer, unless already done.
+    //(The generic prediction is used to change from barrel to endcap params).
+    double x[NPAR], fx[NPAR], pxcov[NPAR][NPAR], pxxm[NPAR][NPAR];
+    std::vector<double> state_xa = state.xa();
+    toArray( state_xa, x );
+    Prediction myPred;
+    if( pred == 0 && state.barrel() && !stub->barrel() ){
+	this->predict( state, stub, nItr, myPred );
+	pred = &myPred;
+    }
+    if( pred ){
+	toArray( pred->fx, fx );
+	toArray( pred->pxcov, pxcov );
+	toArray( pred->pxxm, pxxm );
+    }
+    else{
+	double f[NPAR][NPAR], cov_xa[NPAR][NPAR], fcov[NPAR][NPAR] = {};
+	toArray( state.pxxa(), cov_xa );
+	model().F( stub, &state, f );
+	Fx( f, x, fx );
+	model().PxxModel( &state, stub, nItr, pxxm );
+	for( unsigned i=0; i < NPAR; i++ ){
+	    for( unsigned k=0; k < NPAR; k++ ){
+		for( unsigned j=0; j < NPAR; j++ ) fcov[i][j] += f[i][k] * cov_xa[k][j];
+	    }
+	}
+	for( unsigned i=0; i < NPAR; i++ ){
+	    for( unsigned j=0; j < NPAR; j++ ){
+		pxcov[i][j] = 0;
+		for( unsigned k=0; k < NPAR; k++ ) pxcov[i][j] += fcov[i][k] * f[j][k];
+		pxcov[i][j] += pxxm[i][j];
+	    }
+	}
+    }
+
+    double h[2][NPAR], m[2], dcov[2][2];
+    model().H( stub, h );
+    model().d( stub, m );
+    model().PddMeas( stub, x, dcov );
+
+    //Kalman gain, K = P * Ht * ( V + H * P * Ht )^-1.
+    double pxcovht[NPAR][2] = {};
+    for( unsigned i=0; i < NPAR; i++ ){
+	for( unsigned j=0; j < NPAR; j++ ){
+	    for( unsigned k=0; k < 2; k++ ) pxcovht[i][k] += pxcov[i][j] * h[k][j];
+	}
+    }
+    double hxxh[2][2], pddf[2][2];
+    HxxH( h, pxcov, hxxh );
+    for( unsigned i=0; i < 2; i++ ){
+	for( unsigned j=0; j < 2; j++ ) pddf[i][j] = dcov[i][j] + hxxh[i][j];
+    }
+    double k[NPAR][2] = {};
+    double det = pddf[0][0] * pddf[1][1] - pddf[0][1] * pddf[1][0];
+    if( det != 0 ){
+	double pddfi[2][2] = { { pddf[1][1] / det, -pddf[0][1] / det }, { -pddf[1][0] / det, pddf[0][0] / det } };
+	for( unsigned i=0; i < NPAR; i++ ){
+	    for( unsigned j=0; j < 2; j++ ){
+		for( unsigned l=0; l < 2; l++ ) k[i][l] += pxcovht[i][j] * pddfi[j][l];
+	    }
+	}
+    }
+
+    //adjusted state, x + K * ( m - H * x ), and its covariance, ( 1 - K * H ) * P.
+    double tmpv[2];
+    for( unsigned i=0; i < 2; i++ ){
+	tmpv[i] = m[i];
+	for( unsigned j=0; j < NPAR; j++ ) tmpv[i] += -1. * h[i][j] * fx[j];
+    }
+    std::vector<double> new_xa(NPAR);
+    double new_x[NPAR];
+    for( unsigned i=0; i < NPAR; i++ ){
+	new_x[i] = fx[i];
+	for( unsigned j=0; j < 2; j++ ) new_x[i] += k[i][j] * tmpv[j];
+	new_xa[i] = new_x[i];
+    }
+    double ikh[NPAR][NPAR] = {};
+    for( unsigned i=0; i < NPAR; i++ ){
+	ikh[i][i] = 1;
+	for( unsigned j=0; j < 2; j++ ){
+	    for( unsigned l=0; l < NPAR; l++ ) ikh[i][l] += -1 * k[i][j] * h[j][l];
+	}
+    }
+    double new_cov[NPAR][NPAR] = {};
+    TMatrixD new_pxxa( NPAR, NPAR );
+    for( unsigned i=0; i < NPAR; i++ ){
+	for( unsigned j=0; j < NPAR; j++ ){
+	    for( unsigned l=0; l < NPAR; l++ ) new_cov[i][l] += ikh[i][j] * pxcov[j][l];
+	}
+	for( unsigned l=0; l < NPAR; l++ ) new_pxxa(i,l) = new_cov[i][l];
+    }
+
+    //chi2 of the new state, as in L1KalmanComb::calcChi2().
+    double delta[2], new_dcov[2][2], new_hxxh[2][2], covR[2][2];
+    model().calcResidual( stub, h, m, new_x, delta );
+    model().PddMeas( stub, new_x, new_dcov );
+    HxxH( h, new_cov, new_hxxh );
+    for( unsigned i=0; i < 2; i++ ){
+	for( unsigned j=0; j < 2; j++ ) covR[i][j] = new_dcov[i][j] - new_hxxh[i][j];
+    }
+    double new_chi2 = state.chi2() + chi2( covR, delta );
+
+    const kalmanState *new_state = this->mkState( nItr, stub->layerId(), stub->r(), &state, new_xa, new_pxxa, stub, new_chi2 );
+
+    if( this->getSettings()->kalmanFillInternalHists() ){
+	TMatrixD mpxcov( NPAR, NPAR, &pxcov[0][0] ), mpxxm( NPAR, NPAR, &pxxm[0][0] ), mk( NPAR, 2, &k[0][0] );
+	TMatrixD mdcov( 2, 2, &dcov[0][0] ), mpddf( 2, 2, &pddf[0][0] );
+	this->fillStepHists( tpa, nItr, mpxcov, mpxxm, mdcov, mpddf, mk, new_state );
+    }
+
+    return new_state;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef __MODULEADJACENCY_H__
+#define __MODULEADJACENCY_H__
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+using namespace std;
+
+class StackedTrackerGeometry;
+
+//=== Table of which tracker modules can overlap each other, used to find stubs duplicated in overlap regions.
+//=== Two modules are neighbours if they are in the same layer (or endcap disk) and the area covered by their
+//=== sensors overlaps (or nearly touches) in both phi and z (barrel) or r (endcap).
+//=== Built once per run from the tracker geometry, as it is the same for all events.
+
+class ModuleAdjacency {
+
+public:
+
+  // Build the table from all modules in the tracker.
+  ModuleAdjacency(const StackedTrackerGeometry* stackedGeometry);
+
+  ~ModuleAdjacency() {}
+
+  // Modules neighbouring the module with the given ID (empty if module unknown).
+  const vector<uint32_t>& neighbours(uint32_t idDet) const {
+    auto it = neighbours_.find(idDet);
+    return (it != neighbours_.end())  ?  it->second  :  noNeighbours_;
+  }
+
+  // Check if two modules are neighbours.
+  bool adjacent(uint32_t idDet1, uint32_t idDet2) const;
+
+  unsigned int numModules() const {return neighbours_.size();}
+
+private:
+
+  // Area covered by the sensors of one module.
+  struct ModuleArea {
+    uint32_t idDet;
+    uint32_t layerId;
+    bool     barrel;
+    float    phiCentre;
+    float    halfDeltaPhi; // Half phi range covered.
+    float    minR, maxR, minZ, maxZ;
+  };
+
+  static bool overlap(const ModuleArea& mod1, const ModuleArea& mod2);
+
+private:
+
+  unordered_map<uint32_t, vector<uint32_t> > neighbours_;
+  const vector<uint32_t>                     noNeighbours_;
+};
+
+#endif
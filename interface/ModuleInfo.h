@@ -0,0 +1,115 @@
+#ifndef __MODULEINFO_H__
+#define __MODULEINFO_H__
+
+#include <unordered_map>
+#include <cstdint>
+
+using namespace std;
+
+class StackedTrackerGeometry;
+class StackedTrackerDetId;
+struct SnapshotStub;
+
+//=== Info about a tracker module, which is common to all stubs in it.
+//=== Each Stub points to the ModuleInfo of its module, rather than storing its own copy of this info.
+
+class ModuleInfo {
+
+public:
+
+  // Get info about the module from the tracker geometry.
+  ModuleInfo(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId);
+  // Take info about the module from a stub in an event snapshot (for replay outside cmsRun).
+  ModuleInfo(const SnapshotStub& snapStub);
+
+  ~ModuleInfo() {}
+
+  // Unique identifier for each stacked module.
+  unsigned int    idDet()         const {return idDet_;}
+  // Uncertainty in stub coordinates due to strip length, assumed equal to 0.5*strip-length in 2S modules and zero in PS modules.
+  float           rErr()          const {return rErr_;}
+  float           zErr()          const {return zErr_;}
+  // Coordinates of centre of two sensors in (r,phi,z)
+  float           minR()          const {return minR_;}
+  float           maxR()          const {return maxR_;}
+  float           minPhi()        const {return minPhi_;}
+  float           maxPhi()        const {return maxPhi_;}
+  float           minZ()          const {return minZ_;}
+  float           maxZ()          const {return maxZ_;}
+  // Separation of the two sensors, and sensor pitch over separation.
+  float           sensorSpacing() const {return sensorSpacing_;}
+  float           pitchOverSep()  const {return pitchOverSep_;}
+  // Module type: PS or 2S?
+  bool            psModule()      const {return psModule_;}
+  // Tracker layer ID number (1-6 = barrel layer; 11-15 = endcap A disk; 21-25 = endcap B disk)
+  unsigned int    layerId()       const {return layerId_;}
+  // Endcap ring of module (returns zero in case of barrel)
+  unsigned int    endcapRing()    const {return endcapRing_;}
+  bool            barrel()        const {return barrel_;}
+  // Strip pitch (or pixel pitch along shortest axis).
+  float           stripPitch()    const {return stripPitch_;}
+  // Strip length (or pixel pitch along longest axis).
+  float           stripLength()   const {return stripLength_;}
+  // No. of strips in sensor.
+  unsigned int    nStrips()       const {return nStrips_;}
+  // Width of sensitive region of sensor.
+  float           sensorWidth()   const {return sensorWidth_;}
+  // Hit resolution perpendicular & parallel to strip (or to longest pixel axis).
+  float           sigmaPerp()     const {return sigmaPerp_;}
+  float           sigmaPar()      const {return sigmaPar_;}
+
+private:
+
+  // Calculate quantities derived from the others.
+  void calcDerived();
+
+private:
+
+  unsigned int    idDet_;
+  float           rErr_;
+  float           zErr_;
+  float           minR_;
+  float           maxR_;
+  float           minPhi_;
+  float           maxPhi_;
+  float           minZ_;
+  float           maxZ_;
+  float           sensorSpacing_;
+  float           pitchOverSep_;
+  bool            psModule_;
+  unsigned int    layerId_;
+  unsigned int    endcapRing_;
+  bool            barrel_;
+  float           stripPitch_;
+  float           stripLength_;
+  unsigned int    nStrips_;
+  float           sensorWidth_;
+  float           sigmaPerp_;
+  float           sigmaPar_;
+};
+
+//=== Cache of ModuleInfo for each module, filled as modules are first encountered.
+//=== It should be kept while the tracker geometry is unchanged, so the info is only derived once for each module.
+//=== The ModuleInfo objects are never moved, so pointers to them stay valid while the cache exists.
+
+class ModuleInfoCache {
+
+public:
+
+  ModuleInfoCache() {}
+
+  ~ModuleInfoCache() {}
+
+  // Get info about the module from the cache, first adding it from the tracker geometry if necessary.
+  const ModuleInfo* get(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId);
+  // Ditto, but adding it from a stub in an event snapshot if necessary.
+  const ModuleInfo* get(const SnapshotStub& snapStub);
+
+  unsigned int numModules() const {return modules_.size();}
+
+private:
+
+  unordered_map<uint32_t, ModuleInfo> modules_;
+};
+
+#endif
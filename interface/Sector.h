@@ -4,6 +4,9 @@
 #include <vector>
 #include <unordered_map>
 
+#include "boost/numeric/ublas/matrix.hpp"
+using  boost::numeric::ublas::matrix;
+
 class Settings;
 class Stub;
 class TP;
@@ -28,6 +31,15 @@ public:
   // Check if stub is within subsectors in eta that sector may be divided into.
   vector<bool> insideEtaSubSecs( const Stub* stub) const;
 
+  // Find the stubs inside this sector, removing any duplicates amongst them in overlap regions.
+  // Must be called before the stubs are digitized. Thread safe.
+  vector<const Stub*> stubsInsideNoOverlap( const vector<const Stub*>& vStubs ) const;
+
+  // Find the stubs inside each of the (already initialized) sectors, after removing duplicates in overlap regions
+  // separately within each sector (cfg param OverlapPerSector). Sectors in different phi are processed in parallel.
+  static void stubsInsideAllNoOverlap( const Settings* settings, const vector<const Stub*>& vStubs,
+                                       const matrix<Sector>& mSectors, matrix< vector<const Stub*> >& mSectorStubs );
+
   float phiCentre() const { return phiCentre_; } // Return phi of centre of this sector.
   float etaMin()    const { return etaMin_; } // Eta range covered by this sector.
   float etaMax()    const { return etaMax_; } // Eta range covered by this sector.
@@ -9,6 +9,8 @@
 
 using namespace std;
 
+class ModuleAdjacency;
+
 // Stores all configuration parameters + some hard-wired constants.
 
 class Settings {
@@ -45,6 +47,9 @@ public:
   //=== Optional stub digitization configuration
 
   bool                 enableDigitize()          const   {return enableDigitize_;}
+  bool                 batchDigitize()           const   {return batchDigitize_;}
+  // If batchDigitize(), check in each event that it agrees with digitizing each stub individually for one phi sector (exception if not).
+  bool                 checkBatchDigitize()      const   {return checkBatchDigitize_;}
   unsigned int         firmwareType()            const   {return firmwareType_;}
   //--- Parameters available in MP board.
   unsigned int         phiSectorBits()           const   {return phiSectorBits_;}
@@ -115,6 +120,15 @@ public:
   unsigned int         busySectorNumStubs()      const   {return busySectorNumStubs_;}
   // If this is True, then the BusySectorNumStubs cut is applied to +ve and -ve charge track seperately. (Irrelevant if BusySectorKill = False).
   bool                 busySectorEachCharge()    const   {return busySectorEachCharge_;}
+  // Fill r-phi HT in two passes, first only counting the layers with stubs in each cell, and then storing stubs 
+  // only in cells that might contain track candidates? Other cells are left empty. (Not yet validated, so off by default).
+  bool                 twoPassHT()               const   {return twoPassHT_;}
+  // Fill a coarse r-phi HT array first, and then fill the full resolution array only within coarse cells with stubs in enough 
+  // layers, using only the stubs in them? Each coarse cell covers coarseFactorPt() x coarseFactorPhi() full resolution cells.
+  // Other cells are left empty. (Not yet validated to find identical tracks faster, so off by default).
+  bool                 hierarchicalHT()          const   {return hierarchicalHT_;}
+  unsigned int         coarseFactorPt()          const   {return coarseFactorPt_;}
+  unsigned int         coarseFactorPhi()         const   {return coarseFactorPhi_;}
 
   //=== Rules governing how stubs are filled into the r-z Hough Transform array. (Irrelevant if enableRzHT = false.)
                                 
@@ -134,6 +148,8 @@ public:
   bool                 useSeedFilter()           const   {return useSeedFilter_;}
   // Use z of track at this radius (relevant for Ztrk filter). 
   double               chosenRofZFilter()        const   {return chosenRofZFilter_;}
+  // Use faster implementation of Ztrk filter, with correlation between stubs calculated analytically? 
+  bool                 fastZTrkFilter()          const   {return fastZTrkFilter_;}
   // Added resolution beyond that estimated from hit resolution (relevant for Seed filter).
   double               seedResolution()          const   {return seedResolution_;}     
   // Store stubs compatible with all possible good seed (relevant for Seed filter)?
@@ -142,6 +158,8 @@ public:
   unsigned int         maxSeedCombinations()     const   {return maxSeedCombinations_;}
   // Check that estimated zTrk from seeding stub is within the sector boundaries (relevant for Seed filter)?
   bool                 zTrkSectorCheck()         const   {return zTrkSectorCheck_;}       
+  // Use faster implementation of Seed filter (giving identical results)?
+  bool                 fastSeedFilter()          const   {return fastSeedFilter_;}
 
   //=== Rules for deciding when the track finding has found an L1 track candidate
 
@@ -172,12 +190,23 @@ public:
   double               dupMaxPhi0Scan()          const   {return dupMaxPhi0Scan_;}
   double               dupMaxZ0Scan()            const   {return dupMaxZ0Scan_;}
   double               dupMaxTanLambdaScan()     const   {return dupMaxTanLambdaScan_;}
+  // --- Removal of duplicate tracks found in different sectors, before they are fitted.
+  // Policy: 0 = disabled; 1 = tracks sharing stubs; 2 = tracks sharing stubs with similar helix params; 3 = tracks with similar helix params.
+  unsigned int         dupTrkMergeEvent()             const {return dupTrkMergeEvent_;}
+  // Min. number of stubs two tracks must share to be duplicates (policies 1 & 2).
+  unsigned int         dupTrkMergeMinCommonStubs()    const {return dupTrkMergeMinCommonStubs_;}
+  // Max. difference in helix params of two tracks for them to be duplicates (policies 2 & 3).
+  double               dupTrkMergeMaxDiffQoverPt()    const {return dupTrkMergeMaxDiffQoverPt_;}
+  double               dupTrkMergeMaxDiffPhi0()       const {return dupTrkMergeMaxDiffPhi0_;}
+  double               dupTrkMergeMaxDiffZ0()         const {return dupTrkMergeMaxDiffZ0_;}
+  double               dupTrkMergeMaxDiffTanLambda()  const {return dupTrkMergeMaxDiffTanLambda_;}
 
   //=== Specification of algorithm to eliminate overlap stubs
 
   std::string          overlapAlg()             const    {return overlapAlg_;}
   double               overlapPtCut()           const    {return overlapPtCut_;}
   double               overlapZ0Cut()           const    {return overlapZ0Cut_;}
+  bool                 overlapPerSector()       const    {return overlapPerSector_;} // Remove overlap stubs within each sector, not whole event.
 
   //=== Rules for deciding when a reconstructed L1 track matches a MC truth particle (i.e. tracking particle).
 
@@ -204,6 +233,8 @@ public:
   // "Killing" cut, the hit is killed even if that kills the track.
   double               generalResidualCut()      const   {return generalResidualCut_;}
   double               killingResidualCut()      const   {return killingResidualCut_;}
+  // Reuse linearisation of previous fit iteration, downdated for any killed stub, in all but first & last iterations?
+  bool                 trackFitIncremental()     const   {return trackFitIncremental_;}
 
   //--- Options for Kalman filter track fitters ---
 
@@ -225,6 +256,9 @@ public:
   unsigned             kalmanMaxNumStatesCutValue()     const { return kalmanMaxNumStatesCutValue_; } 
   // The state is removed if the reduced chisquare is more than this number.
   double               kalmanStateReducedChi2CutValue() const { return kalmanStateReducedChi2CutValue_; }
+  // Use the fixed-size (non-virtual) model functions of the KF fitter for its gating & update steps, rather than the generic
+  // TMatrixD ones? (Faster, with results identical up to rounding. The generic ones are always used if KalmanDebugLevel >= 3).
+  bool                 kalmanFixedSizeMaths()           const { return kalmanFixedSizeMaths_; }
 
   //--- Options applicable to all track fitters ---
 
@@ -234,6 +268,23 @@ public:
   double               chi2OverNdfCut()          const   {return chi2OverNdfCut_;}
   // Print detailed summary of track fit performance at end of job (as opposed to a brief one)?
   bool                 detailedFitOutput()       const   {return detailedFitOutput_;} 
+  // Reuse fit result of earlier track candidate with identical stubs in same event & sector, irrespective of
+  // their HT helix params? (0 = never, 1 = yes; higher values are rejected by TrackFitCache).
+  unsigned int         fitCache()                const   {return fitCache_;}
+
+  //=== Histogram groups to make.
+
+  // Only make a few cheap monitoring plots, overriding all the options below.
+  bool                 minimalMonitoring()       const   {return minimalMonitoring_;}
+  // Which groups of histograms to book & fill (see Histos.h).
+  bool                 histInputData()           const   {return histInputData_       && ! minimalMonitoring_;}
+  bool                 histStubPairs()           const   {return histStubPairs_       && ! minimalMonitoring_;}
+  bool                 histEtaPhiSectors()       const   {return histEtaPhiSectors_   && ! minimalMonitoring_;}
+  bool                 histRphiHT()              const   {return histRphiHT_          && ! minimalMonitoring_;}
+  bool                 histRZfilters()           const   {return histRZfilters_       && ! minimalMonitoring_;}
+  bool                 histTrackCands()          const   {return histTrackCands_      && ! minimalMonitoring_;}
+  bool                 histStudyBusyEvents()     const   {return histStudyBusyEvents_ && this->histTrackCands();}
+  bool                 histTrackFitting()        const   {return histTrackFitting_    && ! minimalMonitoring_;}
 
   //=== Debug printout
   unsigned int         debug()                   const   {return debug_;}
@@ -255,6 +306,11 @@ public:
   void                 setBfield(float bField)           {bField_ = bField;}
   float                getBfield()               const   {if (bField_ == 0.) throw cms::Exception("Settings.h:You attempted to access the B field before it was initialized"); return bField_;}
 
+  //=== Set and get table of neighbouring tracker modules, built from the geometry at the start of each run.
+  // N.B. This is null if the geometry is unavailable (e.g. when replaying snapshot files).
+  void                 setModuleAdjacency(const ModuleAdjacency* adj)  {moduleAdjacency_ = adj;}
+  const ModuleAdjacency* moduleAdjacency()       const   {return moduleAdjacency_;}
+
 private:
 
   // Parameter sets for differents types of configuration parameter.
@@ -273,6 +329,7 @@ private:
   edm::ParameterSet    overlapRemoval_;
   edm::ParameterSet    trackMatchDef_;
   edm::ParameterSet    trackFitSettings_;
+  edm::ParameterSet    histogramGroups_;
 
   // Cuts on truth tracking particles.
   double               genMinPt_;
@@ -291,6 +348,8 @@ private:
 
   // Optional stub digitization.
   bool                 enableDigitize_;
+  bool                 batchDigitize_;
+  bool                 checkBatchDigitize_;
   unsigned int         firmwareType_;
   unsigned int         phiSectorBits_;
   unsigned int         phiSBits_;
@@ -345,6 +404,10 @@ private:
   bool                 busySectorKill_;
   unsigned int         busySectorNumStubs_;
   bool                 busySectorEachCharge_; 
+  bool                 twoPassHT_;
+  bool                 hierarchicalHT_;
+  unsigned int         coarseFactorPt_;
+  unsigned int         coarseFactorPhi_;
   
   // Rules governing how stubs are filled into the r-z Hough Transform array. (Irrelevant if enableRzHT = false.)
   bool                 handleStripsRzHT_;
@@ -355,10 +418,12 @@ private:
   bool                 useZTrkFilter_;
   bool                 useSeedFilter_;
   double               chosenRofZFilter_;
+  bool                 fastZTrkFilter_;
   double               seedResolution_;
   bool                 keepAllSeed_;
   unsigned int         maxSeedCombinations_;
   bool                 zTrkSectorCheck_;
+  bool                 fastSeedFilter_;
 
   // Rules for deciding when the track-finding has found an L1 track candidate
   unsigned int         minStubLayers_;
@@ -377,11 +442,18 @@ private:
   double               dupMaxPhi0Scan_;
   double               dupMaxZ0Scan_;
   double               dupMaxTanLambdaScan_;
+  unsigned int         dupTrkMergeEvent_;
+  unsigned int         dupTrkMergeMinCommonStubs_;
+  double               dupTrkMergeMaxDiffQoverPt_;
+  double               dupTrkMergeMaxDiffPhi0_;
+  double               dupTrkMergeMaxDiffZ0_;
+  double               dupTrkMergeMaxDiffTanLambda_;
 
   //=== Specification of algorithm to eliminate overlap stubs
   std::string          overlapAlg_;
   double               overlapPtCut_;
   double               overlapZ0Cut_;
+  bool                 overlapPerSector_;
 
   // Rules for deciding when a reconstructed L1 track matches a MC truth particle (i.e. tracking particle).
   double               minFracMatchStubsOnReco_;
@@ -394,6 +466,7 @@ private:
   bool                 killTrackFitWorstHit_;
   double               generalResidualCut_;
   double               killingResidualCut_;
+  bool                 trackFitIncremental_;
   unsigned             kalmanDebugLevel_;
   bool                 kalmanFillInternalHists_;
   double               kalmanMultiScattFactor_; 
@@ -403,19 +476,35 @@ private:
   unsigned             kalmanMaxNumVirtualStubs_;
   unsigned             kalmanMaxNumStatesCutValue_;
   double               kalmanStateReducedChi2CutValue_;
+  bool                 kalmanFixedSizeMaths_;
   std::vector<std::string> trackFitters_;
   double               chi2OverNdfCut_;
   bool                 detailedFitOutput_;
+  unsigned int         fitCache_;
   
   // Text file output for comparison of L1 tracks with emulator & hardware.
   bool                 writetxt_;
   string               txtfilename_;
   
+  // Histogram groups
+  bool                 minimalMonitoring_;
+  bool                 histInputData_;
+  bool                 histStubPairs_;
+  bool                 histEtaPhiSectors_;
+  bool                 histRphiHT_;
+  bool                 histRZfilters_;
+  bool                 histTrackCands_;
+  bool                 histStudyBusyEvents_;
+  bool                 histTrackFitting_;
+
   // Debug printout
   unsigned int         debug_;
 
   // B-field in Tesla
   float                bField_;
+
+  // Table of neighbouring tracker modules (not owned).
+  const ModuleAdjacency* moduleAdjacency_;
 };
 
 #endif
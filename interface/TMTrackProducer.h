@@ -8,21 +8,31 @@
 #include "DataFormats/Demonstrator/interface/HardwareStub.h"
 #include "DataFormats/Demonstrator/interface/HardwareTrack.h"
 
+#include "boost/numeric/ublas/matrix.hpp"
 #include <vector>
 #include <map>
 #include <string>
+#include <cstdint>
 
 using namespace std;
+using  boost::numeric::ublas::matrix;
 
 class Settings;
 class Histos;
 class TrackFitGeneric;
+class TrackFitCache;
+class DupTrkMerger;
+class EventSnapshotWriter;
+class ModuleAdjacency;
+class ModuleInfoCache;
+class Sector;
+class HTpair;
 
 class TMTrackProducer : public edm::EDProducer {
 
 public:
   explicit TMTrackProducer(const edm::ParameterSet&);	
-  ~TMTrackProducer(){}
+  ~TMTrackProducer();
 
 private:
 
@@ -39,6 +49,30 @@ private:
   Settings *settings_;
   Histos   *hists_;
   map<string, TrackFitGeneric*> fitterWorkerMap_;
+  // Avoids refitting track candidates identical to one already fitted in the same event.
+  TrackFitCache*       fitCache_;
+  // Removes duplicate track candidates found in different sectors, so they are not fitted.
+  DupTrkMerger*        dupTrkMerger_;
+  // Totals over all events, of tracks found by HT and of those not fitted as duplicates from other sectors.
+  unsigned long        numTrksHT_;
+  unsigned long        numDupTrksKilled_;
+
+  // Optional dump of input data to snapshot file, for replay outside cmsRun.
+  string               snapshotFile_;
+  uint64_t             configHash_;
+  EventSnapshotWriter* snapshotWriter_;
+
+  // Identifies version of tracker geometry used to create moduleAdjacency_ & moduleInfoCache_.
+  unsigned long long   geometryCacheId_;
+  // Table of neighbouring tracker modules, used to kill duplicate stubs in overlap regions.
+  ModuleAdjacency*     moduleAdjacency_;
+  // Info about each tracker module, shared by all stubs in it. (Emptied if the tracker geometry changes).
+  ModuleInfoCache*     moduleInfoCache_;
+
+  // (eta,phi) sectors and their Hough-Transform arrays. These are initialized at the start of each run
+  // (as the HT depends on the B-field), and then only reset for each event.
+  matrix<Sector>*      mSectors_;
+  matrix<HTpair>*      mHtPairs_;
 
 };
 #endif
@@ -12,6 +12,7 @@
 using namespace std;
 
 class Stub;
+struct SnapshotTP;
 
 typedef edm::Ptr<TrackingParticle> TrackingParticlePtr;
 
@@ -20,6 +21,8 @@ class TP : public TrackingParticlePtr {
 public:
   // Fill useful info about tracking particle.
   TP(TrackingParticlePtr tpPtr, unsigned int index_in_vTPs, const Settings* settings);
+  // Restore tracking particle from event snapshot (used for replay outside cmsRun, so no TrackingParticle is available).
+  TP(const SnapshotTP& snapTP, unsigned int index_in_vTPs, const Settings* settings);
   ~TP(){}
 
   bool operator==(const TP& tpOther) {return (this->index() == tpOther.index());}
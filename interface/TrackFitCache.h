@@ -0,0 +1,79 @@
+#ifndef __TRACKFITCACHE_H__
+#define __TRACKFITCACHE_H__
+
+#include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <string>
+
+using namespace std;
+
+class Settings;
+class TrackFitGeneric;
+class L1track3D;
+
+//=== Per-event cache of track fit results, so that a track candidate with exactly the same stubs as one
+//=== already fitted in this event is not fitted again. (Different HT cells often give such identical candidates).
+//===
+//=== The cache key is the fitter, the (eta,phi) sector, as the fit depends on it, and the sorted stub indices.
+//=== It does not include the HT helix params used to seed the fit, as these differ for each HT cell, so a cache
+//=== including them would never be used. The cached result is therefore an approximation to that refitting
+//=== would give, as all fitters depend slightly on their seed. (TMTrackReplayBenchmark can measure the differences).
+//===
+//=== N.B. When a fit result is reused, the fitter is not called, so fitter bookkeeping only counts the candidates
+//=== actually fitted. This concerns TrackFitGeneric::nDupStubs() and the KF internal histograms & debug printout.
+
+class TrackFitCache {
+
+public:
+
+  // Note configuration parameters.
+  TrackFitCache(const Settings* settings);
+
+  ~TrackFitCache() {}
+
+  // Forget all fit results. Must be called at the start of each event.
+  void clear() {cache_.clear();}
+
+  // Fit a track candidate in the given sector with the named fitter, unless an identical candidate was already fitted.
+  // Optionally tells if the result was reused.
+  L1fittedTrack fit(const string& fitterName, TrackFitGeneric* fitter, const L1track3D& l1track3D, unsigned int iPhiSec, unsigned int iEtaReg,
+		    bool* reused = nullptr);
+
+  // Number of track candidates given to each fitter, and number of these that reused an earlier fit result, summed over all events.
+  unsigned int numFits (const string& fitterName) const {auto it = numFits_.find(fitterName); return (it != numFits_.end()) ? it->second : 0;}
+  unsigned int numHits (const string& fitterName) const {auto it = numHits_.find(fitterName); return (it != numHits_.end()) ? it->second : 0;}
+
+private:
+
+  // Identifies track candidates whose fit results are the same.
+  struct Key {
+    const TrackFitGeneric* fitter;
+    unsigned int           iPhiSec;
+    unsigned int           iEtaReg;
+    vector<unsigned int>   stubIndices;
+
+    bool operator==(const Key& k) const {
+      return (fitter == k.fitter && iPhiSec == k.iPhiSec && iEtaReg == k.iEtaReg &&
+	      stubIndices == k.stubIndices);
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& k) const;
+  };
+
+private:
+
+  // Configuration parameters.
+  const Settings* settings_;
+
+  unordered_map<Key, L1fittedTrack, KeyHash> cache_;
+
+  map<string, unsigned int> numFits_;
+  map<string, unsigned int> numHits_;
+};
+
+#endif
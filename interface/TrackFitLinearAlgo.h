@@ -48,8 +48,12 @@ private:
   // Method to calculate residuals
   void residuals( float& largestresid,int& ilargestresid );
 
-  // Linear track fitting method
-  void linearTrackFit( bool withd0 );
+  // Linear track fitting method (optionally using residuals already calculated by residuals() at current helix params).
+  void linearTrackFit( bool withd0, bool useStoredResids = false );
+
+  // Method to remove a killed stub from the derivatives & inverted matrix of the previous fit iteration,
+  // (Sherman-Morrison downdate) and from its residuals. Returns false if this is not numerically safe.
+  bool downdate( int ikilled );
 
 private:
 
@@ -90,11 +94,15 @@ private:
   
   float MinvDt_[5][2*__MAX_STUBS_PER_TRK__];
 
+  // Residuals calculated by residuals().
+  double delta_[2*__MAX_STUBS_PER_TRK__];
+
   // Configuration parameters
   int numFittingIterations_;
   bool killTrackFitWorstHit_;
   double generalResidualCut_;
   double killingResidualCut_;
+  bool incrementalFit_;
   unsigned int minStubLayers_;
   float minPtToReduceLayers_;
 
@@ -5,6 +5,7 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/HTrphi.h"
 
 #include <vector>
+#include <cstdint>
 
 class Settings;
 class Stub;
@@ -32,6 +33,9 @@ public:
   // Initialize configuration parameters, and note eta range covered by sector and phi coordinate of its centre.
   void init(const Settings* settings, float etaMinSector, float etaMaxSector, float phiCentreSector);
 
+  // Forget info about tracks filtered in the previous event, keeping the configuration.
+  void reset();
+
   // Filters track candidates (found by the r-phi Hough transform), removing inconsistent stubs from the tracks, 
   // also killing some of the tracks altogether if they are left with too few stubs.
   // Also adds an estimate of r-z helix parameters to the selected track objects, if the filters used provide this.
@@ -60,8 +64,28 @@ private:
   vector<const Stub*> etaFilter ( const vector<const Stub*>& stubs, float trkQoverPt ) const;
   // Produce a filtered collection of stubs from the input ones (on original track) that all have consistent zR.
   vector<const Stub*> zTrkFilter (const vector<const Stub*>& stubs, float trkQoverPt );
+  // Faster implementation of zTrkFilter() seed selection, giving identical results.
+  // Returns the stubs compatible with the best seed, also giving the number of seeds tried and layers on the best one. 
+  vector<const Stub*> zTrkFilterFast (const vector<const Stub*>& stubs, unsigned int& numSeedCombinations, unsigned int& numLayersBest );
+  // Check if stub j is compatible in zTrk with seed stub i, using info about them in the zTrkFilterFast() work space.
+  bool zTrkCompatible (unsigned int i, unsigned int j) const;
   // Produce a filtered collection of stubs from the input ones (on original track)that are consistent with a straight line in r-z using tracklet algo.
   vector<const Stub*> seedFilter (const vector<const Stub*>& stubs, float trkQoverPt );
+  // Faster implementation of seedFilter(), giving identical results. Returns the filtered stubs, also giving the number of 
+  // seeds tried (in total & compatible with the beam spot) and the number of layers on the best seed.
+  vector<const Stub*> seedFilterFast (const vector<const Stub*>& stubs, float trkQoverPt, unsigned int& numSeedCombinations, unsigned int& numGoodSeedCombinations, unsigned int& numLayersBest );
+
+  // Pair of stubs used as seed by Seed filter, identified by their position in the input stub vector.
+  struct SeedPair {
+    unsigned int i0;
+    unsigned int i1;
+    bool         good;  // Seed compatible with beam spot (& sector)?
+    double       z0;    // Estimated z0 of track.
+  };
+
+  // Find which stubs are compatible with the straight line through the given seed (setting wsCompat_),
+  // returning a mask of the layers of these stubs & the seed, and the mean distance of these stubs from the line.
+  uint32_t seedCompatStubs (const vector<const Stub*>& stubs, const SeedPair& seed, double& sumSeedDist);
 
 private:
 
@@ -85,10 +109,30 @@ private:
 
   // Options for Ztrk filter
   float chosenRofZFilter_;
+  bool  fastZTrkFilter_;
+  // Beam spot positions summed over by Ztrk filter to calculate correlation between stubs.
+  static const unsigned int numZBeam_ = 100;
+  vector<double>   zBeam_;
+  // Work space for fast Ztrk & Seed filters, containing info about each stub on track.
+  vector<float>    wsZTrk_;
+  vector<float>    wsZTrkRes_;
+  vector<double>   wsZAtBeam_; // z of track at chosenRofZFilter for each beam spot position, for each stub.
+  vector<uint32_t> wsLayerBit_;
+  vector<char>     wsCompat_;  // Compatibility of each stub with current seed.
+  vector<float>    wsDist_;    // Distance of each stub from current seed.
+  vector<float>    wsR_;
+  vector<float>    wsZ_;
+  vector<float>    wsRErr_;
+  vector<float>    wsZErr_;
+  vector<char>     wsKeep_;    // Stubs kept by any seed.
+  vector<unsigned int> wsFirstSeedStubs_;  // Stubs that can be used as first or second seeding stub.
+  vector<unsigned int> wsSecondSeedStubs_;
+  vector<SeedPair> wsSeeds_;
 
   // Options for Seed filter.
   float seedResolution_;
   bool  keepAllSeed_;
+  bool  fastSeedFilter_;
 
   // Number of seed combinations considered by the ZTrk Filter, for each input track.
   vector<unsigned int>  numZtrkSeedCombsPerTrk_;
@@ -2,6 +2,7 @@
 #define __UTILITY_H__
 
 #include <vector>
+#include <cstdint>
 
 using namespace std;
 
@@ -26,6 +27,10 @@ namespace Utility {
   
   unsigned int countLayers(const Settings* settings, const vector<const Stub*>& stubs, bool disableReducedLayerID = false, bool onlyPS = false);
 
+  // Bit corresponding to the tracker layer that countLayers() (with default options) would assign this stub to.
+  // The number of bits set in the OR of these over several stubs is then equal to countLayers() for them.
+  uint32_t layerBit(const Settings* settings, const Stub* stub);
+
   // Given a set of stubs (presumably on a reconstructed track candidate)
   // return the best matching Tracking Particle (if any),
   // the number of tracker layers in which one of the stubs matched one from this tracking particle,
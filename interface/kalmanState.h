@@ -5,11 +5,11 @@
 #include <TMatrixD.h>
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1KalmanComb.h"
-#include <map>
+#include "TMTrackTrigger/TMTrackFinder/interface/HelixParams.h"
 
 class L1KalmanComb;
 class kalmanState;
-typedef std::map<std::string, double> (*GET_TRACK_PARAMS)( const L1KalmanComb *p, const kalmanState *state );
+typedef HelixParams (*GET_TRACK_PARAMS)( const L1KalmanComb *p, const kalmanState *state );
  
 class kalmanState{
     public:
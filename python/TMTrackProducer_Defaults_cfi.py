@@ -39,6 +39,8 @@ TMTrackProducer = cms.EDProducer('TMTrackProducer',
 
   StubDigitize = cms.PSet(
      EnableDigitize  = cms.bool(False),  # Digitize stub coords? If not, use floating point coords.
+     BatchDigitize   = cms.bool(True),   # Digitize all stubs in a sector together (faster)? If not, digitize each stub individually. Results are identical.
+     CheckBatchDigitize = cms.bool(True), # If BatchDigitize, check in each event that it agrees with digitizing stubs individually, for one phi sector (chosen in turn). Exception if not.
      FirmwareType    = cms.uint32(1),    # 0 = Old Thomas 2-cbin data format, 1 = new Thomas data format used for daisy chain, 2-4 = reserved for demonstrator use, 9 = Systolic array data format.
      #
      #--- Parameters available in MP board.
@@ -133,7 +135,21 @@ TMTrackProducer = cms.EDProducer('TMTrackProducer',
      BusySectorKill       = cms.bool(False),
      BusySectorNumStubs   = cms.uint32(216),
      # If this is True, then the BusySectorNumStubs cut is applied to +ve and -ve charge track seperately. (Irrelevant if BusySectorKill = False).
-     BusySectorEachCharge = cms.bool(False)
+     BusySectorEachCharge = cms.bool(False),
+     # Fill r-phi HT in two passes, first only counting the layers with stubs in each cell, and then storing stubs only in
+     # cells that might contain track candidates? This is intended to be faster & find identical tracks, but other cells are
+     # left empty, so histograms of the HT cell contents are affected.
+     TwoPassHT            = cms.bool(False),
+     # Fill a coarse r-phi HT array first, and then fill the full resolution array only within coarse cells with stubs in enough layers,
+     # using only the stubs in them (faster)? Each coarse cell covers CoarseFactorPt x CoarseFactorPhi cells of the full resolution array,
+     # so these must divide the numbers of bins in it (and be even if HTArraySpecRphi.EnableMerge2x2 = True). This is intended to find
+     # identical tracks, but other cells are left empty, and the firmware limitation checks (HTrphi::fracErrorsTypeA etc.) are not made.
+     HierarchicalHT       = cms.bool(False),
+     # N.B. Neither TwoPassHT nor HierarchicalHT has yet been validated against the normal HT fill, either for giving identical
+     # track candidates or for being faster, so both are off by default. Before using them, compare the HT efficiency & fake rate
+     # and the "Sectors+HT fill" & "HT end" times printed by TMTrackReplayBenchmark with & without them (see tmtt_replay_benchmark_cfg.py).
+     CoarseFactorPt       = cms.uint32(4),
+     CoarseFactorPhi      = cms.uint32(4)
   ),
 
   #=== Rules governing how stubs are filled into the r-z Hough Transform array. (Irrelevant if HTArraySpecRz.enableRzHT = false)
@@ -159,6 +175,10 @@ TMTrackProducer = cms.EDProducer('TMTrackProducer',
      #--- Options for Ztrk filter, (so only relevant if UseZtrkFilter=true).
      # Use z of track at this radius for ZTrkFilter. 
      ChosenRofZFilter    = cms.double(23.),
+     # Use faster implementation of ZTrk filter, which calculates z of track at each beam spot position once per stub, 
+     # rather than once per pair of stubs? It uses the same arithmetic, so chooses identical seeds & stubs.
+     # (In a standalone test, it was 3 times faster for track candidates with 8-14 stubs, and 5 times for 40-60 stubs).
+     FastZTrkFilter      = cms.bool(True),
      #--- Options relevant for Seed filter, (so only relevant if useSeedFilter=true).
      # Added resolution for a tracklet-like filter algorithm, beyond that estimated from hit resolution. 
      SeedResolution      = cms.double(0.),
@@ -167,7 +187,10 @@ TMTrackProducer = cms.EDProducer('TMTrackProducer',
      # Maximum number of seed combinations to bother checking per track candidate.
      MaxSeedCombinations = cms.uint32(1000),
      # Reject tracks whose estimated rapidity from seed filter is inconsistent range of with eta sector. (Kills some duplicate tracks).
-     zTrkSectorCheck     = cms.bool(True)
+     zTrkSectorCheck     = cms.bool(True),
+     # Use faster implementation of Seed filter, which precomputes info about each stub and only tries seeds from allowed layers?
+     # Results are identical. (In a standalone test, it was 2-3 times faster, for track candidates with 8 to 60 stubs).
+     FastSeedFilter      = cms.bool(True)
   ),
 
   #=== Rules for deciding when the track finding has found an L1 track candidate
@@ -213,7 +236,18 @@ TMTrackProducer = cms.EDProducer('TMTrackProducer',
     # Max diff in z0 of 2 tracks in Algo15
     DupMaxZ0Scan = cms.double(0.2),
     # Max diff in tanLambda of 2 tracks in Algo 15
-    DupMaxTanLambdaScan = cms.double(0.01)
+    DupMaxTanLambdaScan = cms.double(0.01),
+    #--- Removal of duplicate tracks found in different (eta,phi) sectors, run on all tracks in the event before they are fitted.
+    # Policy: 0 = disabled; 1 = kill tracks sharing stubs with a better track; 2 = ditto, but only if they also have similar helix params; 
+    # 3 = kill tracks with similar helix params to a better track. (Tracks with stubs in more layers, then more stubs, are better).
+    DupTrkMergeEvent            = cms.uint32(0),
+    # Min. number of stubs two tracks must share to be duplicates (policies 1 & 2).
+    DupTrkMergeMinCommonStubs   = cms.uint32(4),
+    # Max. difference in q/Pt, phi0, z0 & tanLambda of two tracks for them to be duplicates (policies 2 & 3).
+    DupTrkMergeMaxDiffQoverPt   = cms.double(0.025),
+    DupTrkMergeMaxDiffPhi0      = cms.double(0.01),
+    DupTrkMergeMaxDiffZ0        = cms.double(1.0),
+    DupTrkMergeMaxDiffTanLambda = cms.double(0.05)
   ),
 
   OverlapRemoval = cms.PSet(
@@ -221,6 +255,8 @@ TMTrackProducer = cms.EDProducer('TMTrackProducer',
     OverlapAlg = cms.string("none"),
     OverlapPtCut = cms.double("3.0"),
     OverlapZ0Cut = cms.double("15.0"),
+    #--- If True, run the removal separately on the stubs inside each (eta,phi) sector, instead of on the whole event.
+    OverlapPerSector = cms.bool(False),
   ),
 
   #=== Rules for deciding when a reconstructed L1 track matches a MC truth particle (i.e. tracking particle).
@@ -250,6 +286,9 @@ TMTrackProducer = cms.EDProducer('TMTrackProducer',
      # Cuts in standard deviations used to kill hits with big residuals during fit. If the residual exceeds the "General" cut, the hit is killed providing it leaves the track with enough hits to survive. If the residual exceeds the "Killing" cut, the hit is killed even if that kills the track.
      GeneralResidualCut = cms.double(3.0),
      KillingResidualCut = cms.double(20.0),
+     # If True, the fit iterations after the first (except the last) reuse the linearisation of the previous one, downdating it
+     # (Sherman-Morrison) for any stub killed, instead of recalculating it. Much faster, but results differ slightly from full refit.
+     TrackFitIncremental = cms.bool(False),
      #
      #--- Options for Kalman filter track fitters ---
      #
@@ -271,6 +310,9 @@ TMTrackProducer = cms.EDProducer('TMTrackProducer',
      KalmanMaxNumStatesCutValue      = cms.uint32(10),
      # The state is removed if the reduced chisquare is more than this number.
      KalmanStateReducedChi2CutValue  = cms.double(100),
+     # Use the fixed-size (non-virtual) model functions of the KF fitter for its gating & update steps, rather than the generic
+     # TMatrixD ones. Faster, with results identical up to rounding. (The generic ones are always used if KalmanDebugLevel >= 3).
+     KalmanFixedSizeMaths            = cms.bool(True),
      #
      #--- Options applicable to all track fitters ---
      #
@@ -290,9 +332,35 @@ TMTrackProducer = cms.EDProducer('TMTrackProducer',
      # Cut on chi2/dof of fitted track when making histograms.
      Chi2OverNdfCut = cms.double(999999.),
      # Print detailed summary of track fit performance at end of job (as opposed to a brief one). 
-     DetailedFitOutput = cms.bool(False)
+     DetailedFitOutput = cms.bool(False),
+     # Reuse the fit result of an earlier track candidate in the same event & sector with identical stubs, instead of refitting it?
+     # 0 = never; 1 = yes, irrespective of the HT helix params used to seed the fit. This is an approximation, as the fit result 
+     # depends slightly on its seed, (measure the fraction of fits avoided & the differences with TMTrackReplayBenchmark checks = 2).
+     # If enabled, the fitters' duplicate stub count & KF internal histograms only count the candidates actually fitted.
+     FitCache = cms.uint32(0)
   ),
 
+  #=== Histograms to produce. Groups that are disabled are neither booked nor filled, and the calculations 
+  #=== needed only to fill them are skipped. The wall-clock time spent on each group is printed at the end of the job.
+
+  HistogramGroups = cms.PSet(
+     # If True, only a few cheap per-event monitoring plots (numbers of stubs, TPs & tracks) are made, 
+     # and all the groups below are disabled regardless of their setting. Intended for production running.
+     MinimalMonitoring = cms.bool(False),
+     InputData         = cms.bool(True),  # Stubs & tracking particles.
+     StubPairs         = cms.bool(True),  # Study of algorithms killing duplicate stubs in overlap regions (slow).
+     EtaPhiSectors     = cms.bool(True),  # Choice of (eta,phi) sectors.
+     RphiHT            = cms.bool(True),  # Filling of r-phi HT arrays.
+     RZfilters         = cms.bool(True),  # r-z filters run after the r-phi HT.
+     TrackCands        = cms.bool(True),  # Track candidates found by the HT, including tracking efficiency.
+     StudyBusyEvents   = cms.bool(True),  # Events with too many stubs for the firmware (only filled if TrackCands is True).
+     TrackFitting      = cms.bool(True)   # Track fitting performance.
+  ),
+
+  # If not empty, write stubs & tracking particles of each event to this binary snapshot file, 
+  # so they can be replayed by the standalone TMTrackReplayBenchmark executable.
+  SnapshotFile = cms.untracked.string(""),
+
   # Debug printout
   Debug  = cms.uint32(0) #(0=none, 1=print tracks/sec, 2=show filled cells in HT array in each sector of each event, 3=print all HT cells each TP is found in, to look for duplicates, 4=print missed tracking particles by r-z filters, 5 = show debug info about duplicate track removal, 6 = show debug info about fitters)
 )
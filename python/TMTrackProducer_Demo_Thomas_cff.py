@@ -20,6 +20,8 @@ TMTrackProducer.StubCuts.BendResolution = cms.double(1.30)
 
 TMTrackProducer.StubDigitize = cms.PSet(
    EnableDigitize  = cms.bool(True),   # Digitize stub coords? If not, use floating point coords.
+   BatchDigitize   = cms.bool(True),   # Digitize all stubs in a sector together (faster)? If not, digitize each stub individually. Results are identical.
+   CheckBatchDigitize = cms.bool(True), # If BatchDigitize, check in each event that it agrees with digitizing stubs individually, for one phi sector (chosen in turn). Exception if not.
    FirmwareType    = cms.uint32(0),    # 0 = Old Thomas 2-cbin data format, 1 = new Thomas data format for daisy chain, 2-4 = reserved for demonstrator use, 9 = Systolic array data format.
    #--- Parameters available in MP board.
    PhiSectorBits   = cms.uint32(6),    # Bits used to store phi sector number
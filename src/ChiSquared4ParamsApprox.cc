@@ -8,45 +8,23 @@ ChiSquared4ParamsApprox::ChiSquared4ParamsApprox(const Settings* settings, const
  
 }
  
-std::map<std::string, double> ChiSquared4ParamsApprox::vecToMap(std::vector<double> x){
-    // Convert a vector of track parameters to a labelled map for ease of use
-    std::map<std::string, double> result;
-    result["rInv"] = x[0];
-    result["phi0"] = x[1];
-    result["t"] = x[2];
-    result["z0"] = x[3];
-    return result;
-}
- 
-std::vector<double> ChiSquared4ParamsApprox::mapToVec(std::map<std::string, double> x){
-    // Conevrt the map of labelled track parameters to a vector (in correct order)
-    std::vector<double> result;
-    result.resize(4);
-    result[0] = x["rInv"];
-    result[1] = x["phi0"];
-    result[2] = x["t"];
-    result[3] = x["z0"];
-    return result;
-}
- 
 std::vector<double> ChiSquared4ParamsApprox::seed(const L1track3D& l1track3D){
     /* Cheat by using MC trutth to initialize helix parameters. Useful to check if conevrgence is the problem */
-    std::map<std::string, double> x;
-    x["rInv"] = getSettings()->invPtToInvR() * l1track3D.qOverPt();
-    x["phi0"] = l1track3D.phi0();
-    x["z0"] = l1track3D.z0();
-    x["t"] = l1track3D.tanLambda();
-    return mapToVec(x);
+    std::vector<double> x(4);
+    x[RINV] = getSettings()->invPtToInvR() * l1track3D.qOverPt();
+    x[PHI0] = l1track3D.phi0();
+    x[Z0] = l1track3D.z0();
+    x[T] = l1track3D.tanLambda();
+    return x;
 }
  
 Matrix<double> ChiSquared4ParamsApprox::D(std::vector<double> x){
     Matrix<double> D(2 * stubs_.size(), nPar_, 0.0); // Empty matrix
     int j = 0;
-    std::map<std::string, double> y = vecToMap(x); // Get the track params by label
-    double rInv = y["rInv"];
-    double phi0 = y["phi0"];
-    double t = y["t"];
-    double z0 = y["z0"];
+    double rInv = x[RINV];
+    double phi0 = x[PHI0];
+    double t = x[T];
+    double z0 = x[Z0];
     for (unsigned i = 0; i < stubs_.size(); i++){
         double ri=stubs_[i]->r();
         double zi=stubs_[i]->z();
@@ -121,11 +99,10 @@ std::vector<double> ChiSquared4ParamsApprox::residuals(std::vector<double> x) {
     std::vector<double> delta;
     delta.resize(2*n);
  
-    std::map<std::string, double> trackParams = vecToMap(x); // Get the track params by label
-    double rInv = trackParams["rInv"];
-    double phi0 = trackParams["phi0"];
-    double t = trackParams["t"];
-    double z0 = trackParams["z0"];
+    double rInv = x[RINV];
+    double phi0 = x[PHI0];
+    double t = x[T];
+    double z0 = x[Z0];
  
     double chiSq=0.0;
  
@@ -202,13 +179,12 @@ std::vector<double> ChiSquared4ParamsApprox::residuals(std::vector<double> x) {
  
 }
  
-std::map<std::string, double> ChiSquared4ParamsApprox::convertParams(std::vector<double> x){
-    std::map<std::string, double> y = vecToMap(x); // Get track parameters by label
-    std::map<std::string, double> result;
-    result["qOverPt"] = y["rInv"] / getSettings()->invPtToInvR();
-    result["phi0"] = y["phi0"];
-    result["z0"] = y["z0"];
-    result["t"] = y["t"];
+HelixParams ChiSquared4ParamsApprox::convertParams(std::vector<double> x){
+    HelixParams result;
+    result.qOverPt = x[RINV] / getSettings()->invPtToInvR();
+    result.phi0 = x[PHI0];
+    result.z0 = x[Z0];
+    result.tanLambda = x[T];
     return result;
 }
 
@@ -6,51 +6,27 @@ ChiSquared5ParamsApprox::ChiSquared5ParamsApprox(const Settings* settings, const
  
 }
  
-std::map<std::string, double> ChiSquared5ParamsApprox::vecToMap(std::vector<double> x){
-    // Convert a vector of track parameters to a labelled map for ease of use
-    std::map<std::string, double> result;
-    result["2r1Inv"] = x[0];
-    result["phi0"] = x[1];
-    result["d1"] = x[2];
-    result["z0"] = x[3];
-    result["t"] = x[4];
-    return result;
-}
- 
-std::vector<double> ChiSquared5ParamsApprox::mapToVec(std::map<std::string, double> x){
-    // Conevrt the map of labelled track parameters to a vector (in correct order)
-    std::vector<double> result;
-    result.resize(5);
-    result[0] = x["2r1Inv"];
-    result[1] = x["phi0"];
-    result[2] = x["d1"];
-    result[3] = x["z0"];
-    result[4] = x["t"];
-    return result;
-}
- 
 std::vector<double> ChiSquared5ParamsApprox::seed(const L1track3D& l1track3D){
     /* Cheat by using MC trutth to initialize helix parameters. Useful to check if conevrgence is the problem */
-    std::map<std::string, double> x;
+    std::vector<double> x(5);
     double d0 = l1track3D.d0();
     double r0 = 1/(getSettings()->invPtToInvR() * l1track3D.qOverPt());
-    x["2r1Inv"] = 1/(2*(r0 + d0));
-    x["phi0"] = l1track3D.phi0();
-    x["d1"] = d0 * (1 - d0/(2*(r0 + d0)));
-    x["z0"] = l1track3D.z0();
-    x["t"] = l1track3D.tanLambda();
-    return mapToVec(x);
+    x[INV2R1] = 1/(2*(r0 + d0));
+    x[PHI0] = l1track3D.phi0();
+    x[D1] = d0 * (1 - d0/(2*(r0 + d0)));
+    x[Z0] = l1track3D.z0();
+    x[T] = l1track3D.tanLambda();
+    return x;
 }
  
 Matrix<double> ChiSquared5ParamsApprox::D(std::vector<double> x){
     Matrix<double> D(2 * stubs_.size(), nPar_, 0.0); // Empty matrix
     int j = 0;
-    std::map<std::string, double> y = vecToMap(x); // Get the track params by label
-    double rInv = y["2r1Inv"];
-    double phi0 = y["phi0"];
-    double d0 = y["d1"];
-    double t = y["t"];
-    double z0 = y["z0"];
+    double rInv = x[INV2R1];
+    double phi0 = x[PHI0];
+    double d0 = x[D1];
+    double t = x[T];
+    double z0 = x[Z0];
     for(unsigned i = 0; i < stubs_.size(); i++){
         double ri=stubs_[i]->r();
         double zi=stubs_[i]->z();
@@ -87,12 +63,11 @@ std::vector<double> ChiSquared5ParamsApprox::residuals(std::vector<double> x) {
     std::vector<double> delta;
     delta.resize(2*n);
  
-    std::map<std::string, double> trackParams = vecToMap(x); // Get the track params by label
-    double rInv = trackParams["2r1Inv"];
-    double phi0 = trackParams["phi0"];
-    double d1 = trackParams["d1"];
-    double t = trackParams["t"];
-    double z0 = trackParams["z0"];
+    double rInv = x[INV2R1];
+    double phi0 = x[PHI0];
+    double d1 = x[D1];
+    double t = x[T];
+    double z0 = x[Z0];
  
     double chisq=0.0;
  
@@ -137,13 +112,13 @@ std::vector<double> ChiSquared5ParamsApprox::residuals(std::vector<double> x) {
     return delta;
 }
  
-std::map<std::string, double> ChiSquared5ParamsApprox::convertParams(std::vector<double> x){
-    std::map<std::string, double> y = vecToMap(x); // Get track parameters by label
-    std::map<std::string, double> result;
-    result["qOverPt"] = 2 * y["2rInv"] / getSettings()->invPtToInvR();
-    result["phi0"] = y["phi0"];
-    result["z0"] = y["z0"];
-    result["t"] = y["t"];
+HelixParams ChiSquared5ParamsApprox::convertParams(std::vector<double> x){
+    HelixParams result;
+    // N.B. Zero, as when the params were returned in a map, since the 1/2R param was looked up with a key ("2rInv") that was never set.
+    result.qOverPt = 0.;
+    result.phi0 = x[PHI0];
+    result.z0 = x[Z0];
+    result.tanLambda = x[T];
     return result;
 }
  
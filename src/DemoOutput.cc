@@ -21,10 +21,10 @@ void DemoOutput::getStubCollection(const matrix<HTpair>&  mHtPairs,
 	for(unsigned int i = 0 ; i < htArray.size1(); ++i) {
 	  const vector < const Stub* > stubs = htArray(i,j).stubs();
 	  for(const Stub* st:stubs) {
-	    Stub stub = *st;
 	    // Digitize stub relative to this phi sector.
-	    stub.digitize(iPhiSec);
-	    const DigitalStub& digiStub = stub.digitalStub();
+	    // (Using a copy of its DigitalStub, so as not to change the digitization of the stub itself).
+	    DigitalStub digiStub(st->digitalStub());
+	    digiStub.make(iPhiSec);
 
 	    // Calculate bin in Hough transform array of this stub, in format expect by hardware
 	    int mbin = i;
@@ -91,14 +91,13 @@ void DemoOutput::getTPstubCollection(const matrix<HTpair>&  mHtPairs, const matr
 	  std::vector<const Stub*> tpStubsInSector;
 	  for(const Stub* st : tpStubs){
 	    if (sector.inside( st )) {
-	      Stub stub = *st;
 	      tpStubsInSector.push_back(st);
 
-  	      // Digitize stub relative to this phi sector. 
+  	      // Digitize stub relative to this phi sector (using a copy of its DigitalStub, so the stub itself is unchanged).
 	      // N.B. TP includes some stubs that failed front-end electronics window cut, and so can't be digitized. Veto these.
-	      if (stub.frontendPass()) {
-		stub.digitize(iPhiSec);
-		const DigitalStub& digiStub = stub.digitalStub();
+	      if (st->frontendPass()) {
+		DigitalStub digiStub(st->digitalStub());
+		digiStub.make(iPhiSec);
 
 		// Store stub in format expected by hardware. Variables needed differ slightly according to firmware version.
 		l1t::HardwareStub lstub;
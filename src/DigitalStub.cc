@@ -1,5 +1,7 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/DigitalStub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DigitalStubBatch.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DigitizationMaths.h"
 
 #include "DataFormats/Math/interface/deltaPhi.h"
 
@@ -109,62 +111,114 @@ void DigitalStub::make(unsigned int iPhiSec) {
 
   //--- Shift axes of coords. if required.
 
-  // Centre of this sector in phi
-  float phiSectorCentre = phiSectorWidth_ * (0.5 + float(iPhiSec)) - M_PI; 
   // Point in sector from which stub phiS should be measured.
-  float phiSectorRef = phiSectorCentre;
-  // Systolic array firmware measures might measure phiS from start of sector, not centre.
-  if (iFirmwareType_ == 9) phiSectorRef = phiSectorCentre - phiSectorWidth_*0.5;
+  float phiSectorRef = digitization::phiSectorRef(iPhiSec, phiSectorWidth_, iFirmwareType_);
 
   // Phi coord. of stub relative to centre of sector.
-  float phiS_orig = reco::deltaPhi(phi_orig_, phiSectorRef); 
+  float phiS_orig = digitization::relPhi(phi_orig_, phiSectorRef); 
 
   // r coordinate relative to specified point.
   float rt_orig = r_orig_ - chosenRofPhi_;
 
   // Phi coord. of stub relative to centre of octant.
-  unsigned int iPhiOct = floor(iPhiSec*numPhiOctants_/numPhiSectors_);
-  float phiOctantCentre = phiOctantWidth_ * (0.5 + float(iPhiOct)) - M_PI;
-  float phiO_orig = reco::deltaPhi(phi_orig_, phiOctantCentre);
+  unsigned int iPhiOct = digitization::phiOctant(iPhiSec, numPhiOctants_, numPhiSectors_);
+  float phiO_orig = digitization::relPhi(phi_orig_, digitization::phiOctantCentre(iPhiOct, phiOctantWidth_));
 
   // Check that stub coords. are within assumed digitization range.
   this->checkInRange(phiS_orig, rt_orig, phiO_orig);
 
   //--- Digitize variables used in MP.
   iDigi_PhiSec_ = iPhiSec;
-  iDigi_PhiS_   = floor(phiS_orig*phiSMult_);
-  iDigi_Rt_     = floor(rt_orig*rtMult_);
-  iDigi_Z_      = floor(z_orig_*zMult_);
-  iDigi_Dphi_   = floor(dphi_orig_*dPhiMult_);
-  iDigi_Rho_    = floor(rho_orig_*rhoMult_);
+  iDigi_PhiS_   = digitization::digitize(phiS_orig,  phiSMult_);
+  iDigi_Rt_     = digitization::digitize(rt_orig,    rtMult_);
+  iDigi_Z_      = digitization::digitize(z_orig_,    zMult_);
+  iDigi_Dphi_   = digitization::digitize(dphi_orig_, dPhiMult_);
+  iDigi_Rho_    = digitization::digitize(rho_orig_,  rhoMult_);
   //--- Digitize variables used exclusively in GP.
   iDigi_Octant_ = iPhiOct;
-  iDigi_PhiO_   = floor(phiO_orig*phiOMult_);
-  iDigi_Bend_   = floor(bend_orig_*bendMult_); 
+  iDigi_PhiO_   = digitization::digitize(phiO_orig,  phiOMult_);
+  iDigi_Bend_   = digitization::digitize(bend_orig_, bendMult_); 
   
   //--- Determine floating point stub coords. from digitized numbers (so with degraded resolution).
   //--- First for variables used in MP.
-  phiS_      = (iDigi_PhiS_ + 0.5)/phiSMult_;
-  phi_       = reco::deltaPhi(phiS_, -phiSectorRef);
-  rt_        = (iDigi_Rt_   + 0.5)/rtMult_;  
+  phiS_      = digitization::undigitize(iDigi_PhiS_, phiSMult_);
+  phi_       = digitization::absPhi(phiS_, phiSectorRef);
+  rt_        = digitization::undigitize(iDigi_Rt_,   rtMult_);  
   r_         = rt_ + chosenRofPhi_;
-  z_         = (iDigi_Z_    + 0.5)/zMult_; 
-  dphi_      = (iDigi_Dphi_ + 0.5)/dPhiMult_;
-  rho_       = (iDigi_Rho_  + 0.5)/rhoMult_;
+  z_         = digitization::undigitize(iDigi_Z_,    zMult_); 
+  dphi_      = digitization::undigitize(iDigi_Dphi_, dPhiMult_);
+  rho_       = digitization::undigitize(iDigi_Rho_,  rhoMult_);
   //--- Then for variables used exclusively in GP.
-  phiO_      = (iDigi_PhiO_ + 0.5)/phiOMult_;
-  bend_      = (iDigi_Bend_      )/bendMult_; // Different eqn. as bend is known to be half-integer.
+  phiO_      = digitization::undigitize(iDigi_PhiO_, phiOMult_);
+  bend_      = digitization::undigitizeBend(iDigi_Bend_, bendMult_); // Different eqn. as bend is known to be half-integer.
 
-  // DEBUG - check that digitization followed by undigitization doesn't change results too much.
-  float TA = reco::deltaPhi(phi_, phi_orig_);
-  float TB = r_    - r_orig_;
-  float TC = z_    - z_orig_;
-  float TD = dphi_ - dphi_orig_;
-  float TE = rho_  - rho_orig_;
-  float TF = phiO_ - phiO_orig;
-  float TG = bend_ - bend_orig_;
+  this->checkResolution(phiO_orig);
 
-  if (fabs(TA) > 0.001 || fabs(TB) > 0.3 || fabs(TC) > 0.2 || fabs(TD) > 0.005 || fabs(TE) > 0.005 || fabs(TF) > 0.005 || fabs(TG) > 0.1) cout<<"STUB DIGI MESS UP "<<TA<<" "<<TB<<" "<<TC<<" "<<TD<<" "<<TE<<" "<<TF<<" "<<TG<<endl;
+  this->makeIntegerData();
+}
+
+//=== Take digitized stub from results of digitizing all stubs in sector together.
+
+void DigitalStub::make(unsigned int iPhiSec, const DigitalStubBatch& batch, unsigned int iStub) {
+
+  if (! ranInit_) throw cms::Exception("DigitalStub:: You forgot to call init() before make()!");
+  if (batch.iPhiSec() != iPhiSec) throw cms::Exception("DigitalStub:: Batch of digitized stubs is for wrong phi sector!");
+
+  // If stub is outside the assumed digitization range, digitize it individually, so as to throw an exception describing the problem.
+  if (batch.outOfRange(iStub) != 0) {
+    this->make(iPhiSec);
+    return;
+  }
+
+  ranMake_ = true; // Note we ran make().
+
+  //--- Digits.
+  iDigi_PhiSec_ = iPhiSec;
+  iDigi_PhiS_   = batch.iDigi_PhiS(iStub);
+  iDigi_Rt_     = batch.iDigi_Rt(iStub);
+  iDigi_Z_      = batch.iDigi_Z(iStub);
+  iDigi_Dphi_   = batch.iDigi_Dphi(iStub);
+  iDigi_Rho_    = batch.iDigi_Rho(iStub);
+  iDigi_Octant_ = batch.iDigi_Octant();
+  iDigi_PhiO_   = batch.iDigi_PhiO(iStub);
+  iDigi_Bend_   = batch.iDigi_Bend(iStub);
+
+  //--- Floating point stub coords. derived from them.
+  phiS_         = batch.phiS(iStub);
+  phi_          = batch.phi(iStub);
+  rt_           = batch.rt(iStub);
+  r_            = batch.r(iStub);
+  z_            = batch.z(iStub);
+  dphi_         = batch.dphi(iStub);
+  rho_          = batch.rho(iStub);
+  phiO_         = batch.phiO(iStub);
+  bend_         = batch.bend(iStub);
+
+  // (No checkResolution() here, since the arithmetic is identical to make(iPhiSec), which checks it).
+
+  this->makeIntegerData();
+}
+
+//=== Check if this digitized stub is bit-identical to another one, (e.g. the same stub digitized individually & in a batch).
+
+bool DigitalStub::identical(const DigitalStub& other) const {
+  this->ok();
+  other.ok();
+  bool same = (iDigi_PhiSec_  == other.iDigi_PhiSec_  && iDigi_PhiS_  == other.iDigi_PhiS_  && iDigi_Rt_   == other.iDigi_Rt_   &&
+	       iDigi_Z_       == other.iDigi_Z_       && iDigi_Octant_ == other.iDigi_Octant_ && iDigi_PhiO_ == other.iDigi_PhiO_ &&
+	       iDigi_Bend_    == other.iDigi_Bend_    && m_min_       == other.m_min_       && m_max_      == other.m_max_      &&
+	       iDigi_LayerID_ == other.iDigi_LayerID_ &&
+	       phi_  == other.phi_  && r_    == other.r_    && z_    == other.z_    && phiS_ == other.phiS_ &&
+	       rt_   == other.rt_   && phiO_ == other.phiO_ && bend_ == other.bend_);
+  // (Digitized dphi & rho not used with daisy-chain firmware).
+  if (iFirmwareType_ != 1) same = same && (iDigi_Dphi_ == other.iDigi_Dphi_ && iDigi_Rho_ == other.iDigi_Rho_ &&
+					   dphi_       == other.dphi_       && rho_       == other.rho_);
+  return same;
+}
+
+//=== Recast integer data (q/Pt bin range & layer ID) into form used by hardware.
+
+void DigitalStub::makeIntegerData() {
 
   // Hardware counts q/Pt bins in HT array using a signed integer in a symmetric range about zero.
 
@@ -197,6 +251,20 @@ void DigitalStub::make(unsigned int iPhiSec) {
   }
 }
 
+//=== DEBUG - check that digitization followed by undigitization doesn't change results too much.
+
+void DigitalStub::checkResolution(float phiO_orig) const {
+  float TA = reco::deltaPhi(phi_, phi_orig_);
+  float TB = r_    - r_orig_;
+  float TC = z_    - z_orig_;
+  float TD = dphi_ - dphi_orig_;
+  float TE = rho_  - rho_orig_;
+  float TF = phiO_ - phiO_orig;
+  float TG = bend_ - bend_orig_;
+
+  if (fabs(TA) > 0.001 || fabs(TB) > 0.3 || fabs(TC) > 0.2 || fabs(TD) > 0.005 || fabs(TE) > 0.005 || fabs(TF) > 0.005 || fabs(TG) > 0.1) cout<<"STUB DIGI MESS UP "<<TA<<" "<<TB<<" "<<TC<<" "<<TD<<" "<<TE<<" "<<TF<<" "<<TG<<endl;
+}
+
 //--- Check that stub coords. are within assumed digitization range.
 
 void DigitalStub::checkInRange(float phiS_orig, float rt_orig, float phiO_orig) const {
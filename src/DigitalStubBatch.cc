@@ -0,0 +1,156 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DigitalStubBatch.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DigitalStub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DigitizationMaths.h"
+
+//--- N.B. The digitization arithmetic is shared with DigitalStub::make() via DigitizationMaths.h,
+//--- so that both give bit-identical digitized stubs.
+
+//=== Note configuration parameters.
+
+DigitalStubBatch::DigitalStubBatch(const Settings* settings) :
+
+  iFirmwareType_ (settings->firmwareType()),
+  phiSRange_     (settings->phiSRange()),
+  rtRange_       (settings->rtRange()),
+  zRange_        (settings->zRange()),
+  dPhiRange_     (settings->dPhiRange()),
+  rhoRange_      (settings->rhoRange()),
+  phiORange_     (settings->phiORange()),
+
+  numPhiSectors_ (settings->numPhiSectors()),
+  numPhiOctants_ (8),
+  phiSectorWidth_(2.*M_PI / float(numPhiSectors_)),
+  phiOctantWidth_(2.*M_PI / float(numPhiOctants_)),
+  chosenRofPhi_  (settings->chosenRofPhi()),
+
+  iPhiSec_       (0),
+  iDigi_Octant_  (0)
+{
+  // Calculate multipliers to digitize the floating point numbers.
+  phiSMult_ = pow(2, settings->phiSBits())/phiSRange_;
+  rtMult_   = pow(2, settings->rtBits()  )/rtRange_;
+  zMult_    = pow(2, settings->zBits()   )/zRange_;
+  dPhiMult_ = pow(2, settings->dPhiBits())/dPhiRange_;
+  rhoMult_  = pow(2, settings->rhoBits() )/rhoRange_;
+  phiOMult_ = pow(2, settings->phiOBits())/phiORange_;
+
+  bendMult_ = 4.;
+  bendRange_ = pow(2, settings->bendBits())/bendMult_;
+}
+
+//=== Remove all stubs, keeping memory allocated for reuse in the next sector.
+
+void DigitalStubBatch::clear() {
+  phi_orig_.clear();
+  r_orig_.clear();
+  z_orig_.clear();
+  dphi_orig_.clear();
+  rho_orig_.clear();
+  bend_orig_.clear();
+}
+
+//=== Add a stub with the given original, floating point coords.
+
+void DigitalStubBatch::add(float phi, float r, float z, float dphi, float rho, float bend) {
+  phi_orig_.push_back(phi);
+  r_orig_.push_back(r);
+  z_orig_.push_back(z);
+  dphi_orig_.push_back(dphi);
+  rho_orig_.push_back(rho);
+  bend_orig_.push_back(bend);
+}
+
+//=== Add a stub, taking its original coords. from a DigitalStub on which init() was already called.
+
+void DigitalStubBatch::add(const DigitalStub& digiStub) {
+  this->add(digiStub.orig_phi(), digiStub.orig_r(), digiStub.orig_z(), digiStub.orig_dphi(), digiStub.orig_rho(), digiStub.orig_bend());
+}
+
+//=== Digitize all stubs added, with their phi coord. measured relative to specified phi sector.
+
+void DigitalStubBatch::make(unsigned int iPhiSec) {
+
+  const unsigned int n = this->size();
+
+  phiS_orig_.resize(n);
+  rt_orig_.resize(n);
+  phiO_orig_.resize(n);
+
+  outOfRange_.resize(n);
+  iDigi_PhiS_.resize(n);
+  iDigi_Rt_.resize(n);
+  iDigi_Z_.resize(n);
+  iDigi_Dphi_.resize(n);
+  iDigi_Rho_.resize(n);
+  iDigi_PhiO_.resize(n);
+  iDigi_Bend_.resize(n);
+
+  phi_.resize(n);
+  r_.resize(n);
+  z_.resize(n);
+  dphi_.resize(n);
+  rho_.resize(n);
+  phiS_.resize(n);
+  rt_.resize(n);
+  phiO_.resize(n);
+  bend_.resize(n);
+
+  //--- Shift axes of coords. as in DigitalStub::make().
+
+  float phiSectorRef = digitization::phiSectorRef(iPhiSec, phiSectorWidth_, iFirmwareType_);
+
+  unsigned int iPhiOct = digitization::phiOctant(iPhiSec, numPhiOctants_, numPhiSectors_);
+  float phiOctantCentre = digitization::phiOctantCentre(iPhiOct, phiOctantWidth_);
+
+  iPhiSec_      = iPhiSec;
+  iDigi_Octant_ = iPhiOct;
+
+  for (unsigned int i = 0; i < n; i++) {
+    phiS_orig_[i] = digitization::relPhi(phi_orig_[i], phiSectorRef);
+    phiO_orig_[i] = digitization::relPhi(phi_orig_[i], phiOctantCentre);
+    rt_orig_[i]   = r_orig_[i] - chosenRofPhi_;
+  }
+
+  //--- Flag stubs outside assumed digitization range. (Branch-free, so all stubs are processed in the same way).
+
+  for (unsigned int i = 0; i < n; i++) {
+    outOfRange_[i] =
+      (fabs(phiS_orig_[i]) >= 0.5*phiSRange_)                 * badPhiS |
+      (fabs(rt_orig_[i])   >= 0.5*rtRange_)                   * badRt   |
+      (fabs(z_orig_[i])    >= 0.5*zRange_)                    * badZ    |
+      (fabs(dphi_orig_[i]) >= 0.5*dPhiRange_)                 * badDphi |
+      (rho_orig_[i] <= 0. || rho_orig_[i] >= rhoRange_)       * badRho  |
+      (fabs(phiO_orig_[i]) >= 0.5*phiORange_)                 * badPhiO |
+      (fabs(bend_orig_[i]) >= 0.5*bendRange_)                 * badBend;
+  }
+
+  //--- Digitize.
+
+  for (unsigned int i = 0; i < n; i++) {
+    iDigi_PhiS_[i] = digitization::digitize(phiS_orig_[i], phiSMult_);
+    iDigi_Rt_[i]   = digitization::digitize(rt_orig_[i],   rtMult_);
+    iDigi_Z_[i]    = digitization::digitize(z_orig_[i],    zMult_);
+    iDigi_Dphi_[i] = digitization::digitize(dphi_orig_[i], dPhiMult_);
+    iDigi_Rho_[i]  = digitization::digitize(rho_orig_[i],  rhoMult_);
+    iDigi_PhiO_[i] = digitization::digitize(phiO_orig_[i], phiOMult_);
+    iDigi_Bend_[i] = digitization::digitize(bend_orig_[i], bendMult_);
+  }
+
+  //--- Determine floating point stub coords. from digitized numbers (so with degraded resolution).
+
+  for (unsigned int i = 0; i < n; i++) {
+    phiS_[i] = digitization::undigitize(iDigi_PhiS_[i], phiSMult_);
+    rt_[i]   = digitization::undigitize(iDigi_Rt_[i],   rtMult_);
+    r_[i]    = rt_[i] + chosenRofPhi_;
+    z_[i]    = digitization::undigitize(iDigi_Z_[i],    zMult_);
+    dphi_[i] = digitization::undigitize(iDigi_Dphi_[i], dPhiMult_);
+    rho_[i]  = digitization::undigitize(iDigi_Rho_[i],  rhoMult_);
+    phiO_[i] = digitization::undigitize(iDigi_PhiO_[i], phiOMult_);
+    bend_[i] = digitization::undigitizeBend(iDigi_Bend_[i], bendMult_);
+  }
+
+  for (unsigned int i = 0; i < n; i++) {
+    phi_[i]  = digitization::absPhi(phiS_[i], phiSectorRef);
+  }
+}
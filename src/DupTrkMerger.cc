@@ -0,0 +1,147 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/DupTrkMerger.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HTpair.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
+
+#include "DataFormats/Math/interface/deltaPhi.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+#include <cmath>
+
+using namespace std;
+
+//=== Note configuration parameters.
+
+DupTrkMerger::DupTrkMerger(const Settings* settings) :
+  minCommonStubs_   (settings->dupTrkMergeMinCommonStubs()),
+  maxDiffQoverPt_   (settings->dupTrkMergeMaxDiffQoverPt()),
+  maxDiffPhi0_      (settings->dupTrkMergeMaxDiffPhi0()),
+  maxDiffZ0_        (settings->dupTrkMergeMaxDiffZ0()),
+  maxDiffTanLambda_ (settings->dupTrkMergeMaxDiffTanLambda()),
+  numEtaRegions_    (settings->numEtaRegions()),
+  numKilled_        (0),
+  numTPsLost_       (0)
+{
+  unsigned int policy = settings->dupTrkMergeEvent();
+  if (policy > helix) throw cms::Exception("DupTrkMerger: Unknown option for DupTrkMergeEvent: ")<<policy;
+  policy_ = Policy(policy);
+}
+
+//=== Find duplicates amongst the track candidates found by the HT in all sectors.
+
+void DupTrkMerger::run(const matrix<HTpair>& mHtPairs) {
+
+  tracks_.clear();
+  sectorOffset_.clear();
+  keep_.clear();
+  numKilled_  = 0;
+  numTPsLost_ = 0;
+
+  if (policy_ == none) return;
+
+  // Collect tracks from all sectors, noting the largest stub index on them.
+  unsigned int maxStubIndex = 0;
+  for (unsigned int iPhiSec = 0; iPhiSec < mHtPairs.size1(); iPhiSec++) {
+    for (unsigned int iEtaReg = 0; iEtaReg < mHtPairs.size2(); iEtaReg++) {
+      sectorOffset_.push_back(tracks_.size());
+      for (const L1track3D& trk : mHtPairs(iPhiSec, iEtaReg).trackCands3D()) {
+	tracks_.push_back(&trk);
+	for (const Stub* s : trk.getStubs()) maxStubIndex = max(maxStubIndex, s->index());
+      }
+    }
+  }
+
+  const unsigned int nTrks = tracks_.size();
+  keep_.assign(nTrks, 0);
+  numCommon_.assign(nTrks, 0);
+  if (keptTrksWithStub_.size() <= maxStubIndex) keptTrksWithStub_.resize(maxStubIndex + 1);
+
+  // Consider best tracks first (most layers, then most stubs), otherwise taking them in sector order.
+  vector<unsigned int>& order = order_;
+  order.resize(nTrks);
+  iota(order.begin(), order.end(), 0);
+  stable_sort(order.begin(), order.end(), [this](unsigned int i, unsigned int j) {
+      const L1track3D* ti = tracks_[i];
+      const L1track3D* tj = tracks_[j];
+      if (ti->getNumLayers() != tj->getNumLayers()) return (ti->getNumLayers() > tj->getNumLayers());
+      return (ti->getNumStubs() > tj->getNumStubs());
+    } );
+
+  vector<unsigned int>& keptTrks    = keptTrks_;
+  vector<unsigned int>& touchedTrks = touchedTrks_;
+  keptTrks.clear();
+
+  for (unsigned int iTrk : order) {
+    const L1track3D* trk = tracks_[iTrk];
+    bool duplicate = false;
+
+    if (policy_ == helix) {
+
+      // Compare helix params with all tracks kept so far.
+      for (unsigned int k : keptTrks) {
+	if (this->similarHelix(trk, tracks_[k])) {
+	  duplicate = true;
+	  break;
+	}
+      }
+
+    } else {
+
+      // Count stubs shared with each track kept so far, finding these tracks via the stubs.
+      touchedTrks.clear();
+      for (const Stub* s : trk->getStubs()) {
+	for (unsigned int k : keptTrksWithStub_[s->index()]) {
+	  if (numCommon_[k]++ == 0) touchedTrks.push_back(k);
+	}
+      }
+      for (unsigned int k : touchedTrks) {
+	if (numCommon_[k] >= minCommonStubs_ && (policy_ == commonStubs || this->similarHelix(trk, tracks_[k]))) duplicate = true;
+	numCommon_[k] = 0;
+      }
+    }
+
+    if (duplicate) {
+      numKilled_++;
+    } else {
+      keep_[iTrk] = 1;
+      keptTrks.push_back(iTrk);
+      if (policy_ != helix) {
+	for (const Stub* s : trk->getStubs()) keptTrksWithStub_[s->index()].push_back(iTrk);
+      }
+    }
+  }
+
+  // Clear work space for next event.
+  if (policy_ != helix) {
+    for (unsigned int k : keptTrks) {
+      for (const Stub* s : tracks_[k]->getStubs()) keptTrksWithStub_[s->index()].clear();
+    }
+  }
+
+  // Count tracking particles only found by killed tracks.
+  unordered_set<unsigned int> tpsKept;
+  unordered_set<unsigned int> tpsLost;
+  for (unsigned int k : keptTrks) {
+    const TP* tp = tracks_[k]->getMatchedTP();
+    if (tp != nullptr) tpsKept.insert(tp->index());
+  }
+  for (unsigned int iTrk = 0; iTrk < nTrks; iTrk++) {
+    const TP* tp = tracks_[iTrk]->getMatchedTP();
+    if (! keep_[iTrk] && tp != nullptr && tpsKept.count(tp->index()) == 0) tpsLost.insert(tp->index());
+  }
+  numTPsLost_ = tpsLost.size();
+}
+
+//=== Check if the helix params of two tracks are similar.
+
+bool DupTrkMerger::similarHelix(const L1track3D* trk1, const L1track3D* trk2) const {
+  return (fabs(trk1->qOverPt()   - trk2->qOverPt())           < maxDiffQoverPt_ &&
+	  fabs(reco::deltaPhi(trk1->phi0(), trk2->phi0()))    < maxDiffPhi0_    &&
+	  fabs(trk1->z0()        - trk2->z0())                < maxDiffZ0_      &&
+	  fabs(trk1->tanLambda() - trk2->tanLambda())         < maxDiffTanLambda_);
+}
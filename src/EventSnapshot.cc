@@ -0,0 +1,206 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
+
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <iostream>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+//=== Hash of the tracked TMTrackProducer configuration parameters (64 bit FNV-1a, so stable across platforms & releases).
+
+uint64_t snapshot::configHash(const edm::ParameterSet& iConfig) {
+  // Exclude the module label etc., which cmsRun adds but the python config read by the replay may not.
+  edm::ParameterSet pset = iConfig.trackedPart();
+  pset.eraseSimpleParameter("@module_label");
+  pset.eraseSimpleParameter("@module_type");
+  pset.eraseSimpleParameter("@module_edm_type");
+  const string cfg = pset.toString();
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : cfg) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+//=== Open snapshot file & write its header.
+
+EventSnapshotWriter::EventSnapshotWriter(const string& fileName, float bField, uint64_t configHash) :
+  out_(fileName.c_str(), ios::binary | ios::trunc),
+  fileName_(fileName)
+{
+  if (! out_) throw cms::Exception("EventSnapshotWriter: Can't open file ")<<fileName<<endl;
+
+  SnapshotFileHeader fileHeader;
+  memset(&fileHeader, 0, sizeof(SnapshotFileHeader));
+  memcpy(fileHeader.magic, snapshot::magic, sizeof(snapshot::magic));
+  fileHeader.version    = snapshot::version;
+  fileHeader.bField     = bField;
+  fileHeader.configHash = configHash;
+  out_.write(reinterpret_cast<const char*>(&fileHeader), sizeof(SnapshotFileHeader));
+}
+
+//=== Append the stubs & tracking particles of one event to the file.
+
+void EventSnapshotWriter::write(unsigned int run, unsigned int event, const InputData& inputData) {
+
+  const vector<TP>&   vTPs   = inputData.getTPs();
+  const vector<Stub>& vStubs = inputData.getAllStubs();
+
+  tps_.resize(vTPs.size());
+  stubs_.resize(vStubs.size());
+  tpLinks_.clear();
+
+  for (const TP& tp : vTPs) {
+    SnapshotTP& snapTP = tps_[tp.index()];
+    snapTP.pdgId     = tp.pdgId();
+    snapTP.charge    = tp.charge();
+    snapTP.mass      = tp.mass();
+    snapTP.pt        = tp.pt();
+    snapTP.eta       = tp.eta();
+    snapTP.theta     = tp.theta();
+    snapTP.tanLambda = tp.tanLambda();
+    snapTP.phi0      = tp.phi0();
+    snapTP.vx        = tp.vx();
+    snapTP.vy        = tp.vy();
+    snapTP.vz        = tp.vz();
+    snapTP.d0        = tp.d0();
+    snapTP.z0        = tp.z0();
+    snapTP.flags     = (tp.inTimeBx()         ? SnapshotTP::inTimeBx         : 0)
+                     | (tp.physicsCollision() ? SnapshotTP::physicsCollision : 0)
+                     | (tp.use()              ? SnapshotTP::use              : 0)
+                     | (tp.useForEff()        ? SnapshotTP::useForEff        : 0);
+  }
+
+  for (const Stub& stub : vStubs) {
+    SnapshotStub& snapStub = stubs_[stub.index()];
+    snapStub.phi            = stub.phi();
+    snapStub.r              = stub.r();
+    snapStub.z              = stub.z();
+    snapStub.bendInFrontend = stub.bendInFrontend();
+    for (unsigned int iClus = 0; iClus <= 1; iClus++) {
+      snapStub.localU_cluster[iClus] = stub.localU_cluster()[iClus];
+      snapStub.localV_cluster[iClus] = stub.localV_cluster()[iClus];
+    }
+    snapStub.moduleMinR     = stub.minR();
+    snapStub.moduleMaxR     = stub.maxR();
+    snapStub.moduleMinPhi   = stub.minPhi();
+    snapStub.moduleMaxPhi   = stub.maxPhi();
+    snapStub.moduleMinZ     = stub.minZ();
+    snapStub.moduleMaxZ     = stub.maxZ();
+    snapStub.stripPitch     = stub.stripPitch();
+    snapStub.stripLength    = stub.stripLength();
+    snapStub.sensorWidth    = stub.sensorWidth();
+    snapStub.idDet          = stub.idDet();
+    snapStub.nStrips        = stub.nStrips();
+    snapStub.layerId        = stub.layerId();
+    snapStub.endcapRing     = stub.endcapRing();
+    snapStub.flags          = (stub.psModule() ? SnapshotStub::psModule : 0)
+                            | (stub.barrel()   ? SnapshotStub::barrel   : 0);
+
+    // Truth, converted from pointers to indices in vTPs.
+    snapStub.assocTP = (stub.assocTP() != nullptr)  ?  int32_t(stub.assocTP()->index())  :  -1;
+    for (unsigned int iClus = 0; iClus <= 1; iClus++) {
+      const TP* tp = stub.assocTPofCluster()[iClus];
+      snapStub.assocTPofCluster[iClus] = (tp != nullptr)  ?  int32_t(tp->index())  :  -1;
+    }
+    const set<const TP*> assocTPs = stub.assocTPs();
+    snapStub.firstTPlink = tpLinks_.size();
+    snapStub.numTPlinks  = assocTPs.size();
+    for (const TP* tp : assocTPs) tpLinks_.push_back(tp->index());
+  }
+
+  SnapshotEventHeader header;
+  header.run        = run;
+  header.event      = event;
+  header.numTPs     = tps_.size();
+  header.numStubs   = stubs_.size();
+  header.numTPlinks = tpLinks_.size();
+
+  out_.write(reinterpret_cast<const char*>(&header),         sizeof(SnapshotEventHeader));
+  out_.write(reinterpret_cast<const char*>(tps_.data()),     tps_.size()     * sizeof(SnapshotTP));
+  out_.write(reinterpret_cast<const char*>(stubs_.data()),   stubs_.size()   * sizeof(SnapshotStub));
+  out_.write(reinterpret_cast<const char*>(tpLinks_.data()), tpLinks_.size() * sizeof(int32_t));
+  out_.flush();
+  if (! out_) throw cms::Exception("EventSnapshotWriter: Error writing to file ")<<fileName_<<endl;
+}
+
+//=== Memory-map snapshot file & locate the events inside it.
+
+EventSnapshotReader::EventSnapshotReader(const string& fileName, bool allowTruncated) : data_(nullptr), size_(0), truncated_(false) {
+
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) throw cms::Exception("EventSnapshotReader: Can't open file ")<<fileName<<endl;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw cms::Exception("EventSnapshotReader: Can't stat file ")<<fileName<<endl;
+  }
+  size_ = st.st_size;
+  if (size_ < sizeof(SnapshotFileHeader)) {
+    close(fd);
+    throw cms::Exception("EventSnapshotReader: File too short to be a snapshot ")<<fileName<<endl;
+  }
+  void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // Mapping remains valid after closing file.
+  if (addr == MAP_FAILED) throw cms::Exception("EventSnapshotReader: Can't memory-map file ")<<fileName<<endl;
+  data_ = static_cast<const char*>(addr);
+
+  memcpy(&fileHeader_, data_, sizeof(SnapshotFileHeader));
+  if (memcmp(fileHeader_.magic, snapshot::magic, sizeof(snapshot::magic)) != 0) {
+    munmap(addr, size_);
+    throw cms::Exception("EventSnapshotReader: Not a snapshot file ")<<fileName<<endl;
+  }
+  if (fileHeader_.version != snapshot::version) {
+    munmap(addr, size_);
+    throw cms::Exception("EventSnapshotReader: Unsupported snapshot version ")<<fileHeader_.version<<" in "<<fileName<<endl;
+  }
+
+  // All records are multiples of 4 bytes long, so can be accessed in place.
+  size_t pos = sizeof(SnapshotFileHeader);
+  while (pos < size_) {
+    SnapshotEvent ev;
+    const size_t posEvent = pos;
+    bool complete = (pos + sizeof(SnapshotEventHeader) <= size_);
+    if (complete) {
+      memcpy(&ev.header, data_ + pos, sizeof(SnapshotEventHeader));
+      pos += sizeof(SnapshotEventHeader);
+      size_t size = size_t(ev.header.numTPs)     * sizeof(SnapshotTP)
+                  + size_t(ev.header.numStubs)   * sizeof(SnapshotStub)
+                  + size_t(ev.header.numTPlinks) * sizeof(int32_t);
+      complete = (pos + size <= size_);
+    }
+    if (! complete) {
+      // Truncated, e.g. by job crash while writing.
+      if (! allowTruncated) {
+        munmap(addr, size_);
+        throw cms::Exception("EventSnapshotReader: File ")<<fileName<<" truncated at byte "<<posEvent<<" of "<<size_
+                                                          <<", after "<<events_.size()<<" complete events"<<endl;
+      }
+      cout<<"WARNING: EventSnapshotReader: File "<<fileName<<" truncated at byte "<<posEvent<<" of "<<size_
+          <<", so only its first "<<events_.size()<<" events are used"<<endl;
+      truncated_ = true;
+      break;
+    }
+
+    ev.tps     = reinterpret_cast<const SnapshotTP*>  (data_ + pos);
+    pos += ev.header.numTPs     * sizeof(SnapshotTP);
+    ev.stubs   = reinterpret_cast<const SnapshotStub*>(data_ + pos);
+    pos += ev.header.numStubs   * sizeof(SnapshotStub);
+    ev.tpLinks = reinterpret_cast<const int32_t*>     (data_ + pos);
+    pos += ev.header.numTPlinks * sizeof(int32_t);
+
+    events_.push_back(ev);
+  }
+}
+
+EventSnapshotReader::~EventSnapshotReader() {
+  munmap(const_cast<char*>(data_), size_);
+}
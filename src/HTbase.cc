@@ -6,18 +6,29 @@
 
 #include <vector>
 #include <unordered_set>
+#include <algorithm>
 
 using namespace std;
 
+//=== Remove all stubs and track candidates, keeping the array configuration, so it can be reused for the next event.
+//=== Only the cells filled since the last reset are visited.
+
+void HTbase::reset() {
+  for (const pair<unsigned int, unsigned int>& cell : filledCells_) {
+    htArray_(cell.first, cell.second).reset(); // Calls HTcell::reset()
+  }
+  filledCells_.clear();
+  trackCands2D_.clear();
+}
+
 //=== Termination. Causes HT array to search for tracks etc.
 
 void HTbase::end() {
 
   // Calculate useful info about each cell in array.
-  for (unsigned int i = 0; i < htArray_.size1(); i++) {
-    for (unsigned int j = 0; j < htArray_.size2(); j++) {
-      htArray_(i,j).end(); // Calls HTcell::end()
-    }
+  // (Empty cells are skipped, as HTcell::end() would leave them unchanged).
+  for (const pair<unsigned int, unsigned int>& cell : filledCells_) {
+    htArray_(cell.first, cell.second).end(); // Calls HTcell::end()
   }
 
   // Produce a list of all track candidates found in this array, each containing all the stubs on each one
@@ -40,11 +51,9 @@ unsigned int HTbase::numStubsInc() const {
 
   unsigned int nStubs = 0;
 
-  // Loop over cells in HT array.
-  for (unsigned int i = 0; i < htArray_.size1(); i++) {
-    for (unsigned int j = 0; j < htArray_.size2(); j++) {
-      nStubs += htArray_(i,j).numStubs(); // Calls HTcell::numStubs()
-    }
+  // Loop over filled cells in HT array.
+  for (const pair<unsigned int, unsigned int>& cell : filledCells_) {
+    nStubs += htArray_(cell.first, cell.second).numStubs(); // Calls HTcell::numStubs()
   }
 
   return nStubs;
@@ -56,14 +65,12 @@ unsigned int HTbase::numStubsExc() const {
 
   unordered_set<unsigned int> stubIDs; // Each ID stored only once, no matter how often it is added.
 
-  // Loop over cells in HT array.
-  for (unsigned int i = 0; i < htArray_.size1(); i++) {
-    for (unsigned int j = 0; j < htArray_.size2(); j++) {
-      // Loop over stubs in each cells, storing their IDs.
-      const vector<const Stub*>& vStubs = htArray_(i,j).stubs(); // Calls HTcell::stubs()
-      for (const Stub* stub : vStubs) {
-        stubIDs.insert( stub->index() );
-      }
+  // Loop over filled cells in HT array.
+  for (const pair<unsigned int, unsigned int>& cell : filledCells_) {
+    // Loop over stubs in each cells, storing their IDs.
+    const vector<const Stub*>& vStubs = htArray_(cell.first, cell.second).stubs(); // Calls HTcell::stubs()
+    for (const Stub* stub : vStubs) {
+      stubIDs.insert( stub->index() );
     }
   }
 
@@ -193,8 +200,29 @@ vector<L1track2D> HTbase::calcTrackCands2D() const {
   const vector<unsigned int> iOrder = this->rowOrder(numRows);
   bool wantOrdering = (iOrder.size() > 0);
 
-  unsigned int numStubsLeft = 0;
-  unsigned int numStubsRight = 0;
+  // If empty cells can't contain a track candidate, and few cells are filled, it is faster to only check the filled cells,
+  // taking them in the same order as the loop over all cells below. (N.B. Not done if debug printout of all cells is wanted).
+  const bool emptyCellsNoTrack = (settings_->minStubLayers() > 1);
+  if (emptyCellsNoTrack && 4*filledCells_.size() < numRows*numCols && settings_->debug() != 2) {
+
+    // Note position of each row in the order that rows are processed.
+    vector<unsigned int> rowPos(numRows);
+    for (unsigned int i = 0; i < numRows; i++) {
+      unsigned int iPos = wantOrdering  ?   iOrder[i]  :  i;
+      rowPos[iPos] = i;
+    }
+
+    vector< pair<unsigned int, unsigned int> > cells = filledCells_;
+    std::sort(cells.begin(), cells.end(), 
+	      [&rowPos](const pair<unsigned int, unsigned int>& a, const pair<unsigned int, unsigned int>& b) 
+	      {return (rowPos[a.first] < rowPos[b.first]) || (rowPos[a.first] == rowPos[b.first] && a.second < b.second);} );
+
+    for (const pair<unsigned int, unsigned int>& cell : cells) {
+      if (htArray_(cell.first, cell.second).trackCandFound()) trackCands2D.push_back( this->trackCand2D(cell.first, cell.second) );
+    }
+
+    return trackCands2D;
+  }
 
   // Loop over cells in HT array.
   for (unsigned int i = 0; i < numRows; i++) {
@@ -205,24 +233,8 @@ vector<L1track2D> HTbase::calcTrackCands2D() const {
     for (unsigned int j = 0; j < numCols; j++) {
       if (htArray_(iPos,j).trackCandFound()) { // track candidate found in this cell.
 
-	// Get stubs on this track candidate.
-        const vector<const Stub*>& stubs = htArray_(iPos,j).stubs();
-
-	// And note location of cell inside HT array.
-        const pair<unsigned int, unsigned int> cellLocation(iPos, j);
-
-        // Get (q/Pt, phi0) or (tan_lambda, z0) corresponding to middle of this cell.
-        const pair<float, float> helixParams2D = this->helix2Dconventional(iPos, j);
-
-	// Note if this track was produced by r-phi or r-z Hough transform.
-        const bool isRphi = this->isRphiHT();
-
-	// Store all this reconstruction info about this track.
-	// The L1track2D class automatically finds the associated MC truth Tracking Particle particle (if any)
-        L1track2D l1Trk2D(settings_, stubs, cellLocation, helixParams2D, isRphi);
-
-	// Store all this info about the track.        
-	trackCands2D.push_back( l1Trk2D );
+	// Store all reconstruction info about this track.        
+	trackCands2D.push_back( this->trackCand2D(iPos, j) );
 
       } else {
 	if (settings_->debug() == 2) cout<<" ."; // Indicate no track in this cell.
@@ -234,6 +246,27 @@ vector<L1track2D> HTbase::calcTrackCands2D() const {
   return trackCands2D;
 }
 
+//=== Create track candidate from the stubs in cell (i,j) of the HT array.
+
+L1track2D HTbase::trackCand2D(unsigned int i, unsigned int j) const {
+
+  // Get stubs on this track candidate.
+  const vector<const Stub*>& stubs = htArray_(i,j).stubs();
+
+  // And note location of cell inside HT array.
+  const pair<unsigned int, unsigned int> cellLocation(i, j);
+
+  // Get (q/Pt, phi0) or (tan_lambda, z0) corresponding to middle of this cell.
+  const pair<float, float> helixParams2D = this->helix2Dconventional(i, j);
+
+  // Note if this track was produced by r-phi or r-z Hough transform.
+  const bool isRphi = this->isRphiHT();
+
+  // Store all this reconstruction info about the track.
+  // The L1track2D class automatically finds the associated MC truth Tracking Particle particle (if any)
+  return L1track2D(settings_, stubs, cellLocation, helixParams2D, isRphi);
+}
+
 
 //=== If requested, kill those tracks in this sector that can't be read out during the time-multiplexed period, because
 //=== the HT has associated too many stubs to tracks.
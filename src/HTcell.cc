@@ -45,6 +45,9 @@ void HTcell::init(const Settings* settings, bool isRphiHT, float etaMinSector, f
 
   // Check if subsectors are being used within each sector. These are only ever used for r-phi HT.
   numSubSecs_ = isRphiHT_   ?   settings->numSubSecsEta()  :  1;
+
+  // Start with no stubs.
+  this->reset();
 }
 
 //=== Termination. Search for track in this HT cell etc.
@@ -104,24 +107,28 @@ vector<const Stub*> HTcell::bendFilter( const vector<const Stub*>& stubs ) const
   // Create bend-filtered stub collection.
   vector<const Stub*> filteredStubs;
   for (const Stub* s : stubs) {
-
     // Require stub bend to be consistent with q/Pt of this cell.
-
-    if (daisyChainFirmware_) {
-      // Daisy chain firmware doesn't have access to variables needed to calculate dphi of stub,
-      // but instead knows integer range of q/Pt bins that stub bend is compatible with, so use these.
-      if (s->min_qOverPt_bin() <= ibin_qOverPt_ && ibin_qOverPt_ <= s->max_qOverPt_bin() )  filteredStubs.push_back(s);
-    } else {
-      // Systolic array & 2-c-bin firmware do hace access to stub dphi, so can use it.
-      // Predict track bend angle based on q/Pt of this HT cell and radius of stub.
-      float predictedDphi = this->dphi( s->r() );
-      // Require reconstructed and predicted values of this quantity to be consistent within estimated resolution. 
-      if (fabs(s->dphi() - predictedDphi) < s->dphiRes()) filteredStubs.push_back(s);
-    }
+    if (this->bendConsistent(s)) filteredStubs.push_back(s);
   }
   return filteredStubs;
 }
 
+//=== Check if stub bend is consistent with q/Pt of this cell.
+
+bool HTcell::bendConsistent( const Stub* s ) const {
+  if (daisyChainFirmware_) {
+    // Daisy chain firmware doesn't have access to variables needed to calculate dphi of stub,
+    // but instead knows integer range of q/Pt bins that stub bend is compatible with, so use these.
+    return (s->min_qOverPt_bin() <= ibin_qOverPt_ && ibin_qOverPt_ <= s->max_qOverPt_bin() );
+  } else {
+    // Systolic array & 2-c-bin firmware do hace access to stub dphi, so can use it.
+    // Predict track bend angle based on q/Pt of this HT cell and radius of stub.
+    float predictedDphi = this->dphi( s->r() );
+    // Require reconstructed and predicted values of this quantity to be consistent within estimated resolution. 
+    return (fabs(s->dphi() - predictedDphi) < s->dphiRes());
+  }
+}
+
 //=== Filter stubs so as to prevent more than specified number of stubs being stored in one cell.
 //=== This reflects finite memory of hardware.
 
@@ -22,12 +22,28 @@ void HTpair::init(const Settings* settings, float etaMinSector, float etaMaxSect
   // Initialize r-phi Hough transform array.
   htArrayRphi_.init(settings_, etaMinSector_, etaMaxSector_, phiCentreSector_);
 
+  // Initialize r-z Hough transform array, if used. (The q/Pt is set for each r-phi track candidate).
+  if (enableRzHT_) htArrayRz_.init(settings_, etaMinSector_, etaMaxSector_, 0.);
+
   // Initialize any track filters (e.g. r-z) run after the r-phi Hough transform.
   rzFilters_.init(settings_, etaMinSector_, etaMaxSector_, phiCentreSector_);  
 
   //--- Option for duplicate track removal on collection of L1track3D produced after running all track-finding steps.
   unsigned int dupTrkAlgRzSeg = settings->dupTrkAlgRzSeg();
   killDupTrks_.init(settings, dupTrkAlgRzSeg);
+
+  // Start with no stubs or tracks.
+  this->reset();
+}
+
+//=== Remove all stubs & tracks from the previous event, keeping the configuration.
+
+void HTpair::reset() {
+  htArrayRphi_.reset();
+  if (enableRzHT_) htArrayRz_.reset();
+  rzFilters_.reset();
+  vecTracks3D_.clear();
+  fracCellsWithNoNeighboursRz_.clear();
 }
 
 //=== Add stub to r-phi HT array.
@@ -75,17 +91,17 @@ vector<L1track3D> HTpair::make3Dtracks() {
 
       // --- Run r-z HT on stubs assigned to each track by r-phi HT.
 
+      // (The r-z HT array is reused for each r-phi track, removing the stubs from the previous one).
       float qOverPt = trkRphi.getHelix2D().first; // Estimated q/Pt of this track from r-phi HT.
-      HTrz  htArrayRz; 
-      htArrayRz.init(settings_, etaMinSector_, etaMaxSector_, qOverPt);
+      htArrayRz_.reset(qOverPt);
       // Loop over stubs on each track and pass them to r-z HT.
       for (const Stub* s : stubsOnTrkRphi) {
-	htArrayRz.store( s );
+	htArrayRz_.store( s );
       }
-      htArrayRz.end();
+      htArrayRz_.end();
 
       // Loop over tracks found by r-z HT obtained using stubs on tracks found by r-phi HT..
-      const vector<L1track2D>& trackCandsRz = htArrayRz.trackCands2D();
+      const vector<L1track2D>& trackCandsRz = htArrayRz_.trackCands2D();
       for (const L1track2D& trkRz : trackCandsRz) {
 
 	// Create 3D track (N.B. Set stubs equal to those on r-z track, which are filtered with respect to those on the r-phi track by the r-z HT).
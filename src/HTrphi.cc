@@ -2,11 +2,14 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Utility.h"
 
 #include "DataFormats/Math/interface/deltaPhi.h"
 #include "FWCore/Utilities/interface/Exception.h"
 
 #include <vector>
+#include <bitset>
+#include <algorithm>
 
 //=== The r-phi Hough Transform array for a single (eta,phi) sector.
 //===
@@ -90,6 +93,32 @@ void HTrphi::init(const Settings* settings, float etaMinSector, float etaMaxSect
 
   // Resize HT array to suit these specifications, and initialise each cell with configuration parameters.
   HTbase::htArray_.resize(nBinsQoverPtAxis_, nBinsPhiTrkAxis_, false);
+  HTbase::filledCells_.clear();
+  HTbase::trackCands2D_.clear();
+
+  // Optionally fill HT array in two passes, first counting only the layers with stubs in each cell.
+  twoPassHT_  = settings->twoPassHT();
+  numSubSecs_ = settings->numSubSecsEta();
+  passStubs_.clear();
+  passSubSecs_.clear();
+  if (twoPassHT_) {
+    layerMask_.assign(nBinsQoverPtAxis_ * nBinsPhiTrkAxis_ * numSubSecs_, 0);
+    candCell_.assign(nBinsQoverPtAxis_ * nBinsPhiTrkAxis_, false);
+  }
+
+  // Optionally fill HT array hierarchically, using a coarse HT array to find where the full resolution one need be filled.
+  hierarchicalHT_  = settings->hierarchicalHT();
+  coarseFactorPt_  = settings->coarseFactorPt();
+  coarseFactorPhi_ = settings->coarseFactorPhi();
+  if (hierarchicalHT_) {
+    if (twoPassHT_) throw cms::Exception("HTrphi: You are not allowed to set both TwoPassHT=True and HierarchicalHT=True");
+    if (coarseFactorPt_ == 0 || coarseFactorPhi_ == 0 || nBinsQoverPtAxis_%coarseFactorPt_ != 0 || nBinsPhiTrkAxis_%coarseFactorPhi_ != 0) throw cms::Exception("HTrphi: CoarseFactorPt and CoarseFactorPhi must divide the number of bins in r-phi HT array ")<<nBinsQoverPtAxis_<<" "<<nBinsPhiTrkAxis_<<endl;
+    if (enableMerge2x2_ && (coarseFactorPt_%2 != 0 || coarseFactorPhi_%2 != 0)) throw cms::Exception("HTrphi: You are not allowed to set EnableMerge2x2=True if CoarseFactorPt or CoarseFactorPhi are odd");
+    nBinsQoverPtCoarse_ = nBinsQoverPtAxis_ / coarseFactorPt_;
+    nBinsPhiTrkCoarse_  = nBinsPhiTrkAxis_  / coarseFactorPhi_;
+    layerMask_.assign(nBinsQoverPtCoarse_ * nBinsPhiTrkCoarse_ * numSubSecs_, 0);
+    coarseStubs_.assign(nBinsQoverPtCoarse_ * nBinsPhiTrkCoarse_, vector<unsigned int>());
+  }
 
   const bool isRphiHT = true;
   for (unsigned int i = 0; i < nBinsQoverPtAxis_; i++) {
@@ -113,8 +142,139 @@ void HTrphi::init(const Settings* settings, float etaMinSector, float etaMaxSect
 
 void HTrphi::store(const Stub* stub, const vector<bool>& inEtaSubSecs) {
 
+  if (twoPassHT_) {
+    // First pass only notes which layers have stubs in each cell. The stubs are stored in cells later by end().
+    if (inEtaSubSecs.size() != numSubSecs_) throw cms::Exception("HTrphi: Wrong number of subsectors!");
+    passStubs_.push_back(stub);
+    passSubSecs_.push_back(inEtaSubSecs);
+    this->fill(stub, inEtaSubSecs, countLayers, 0, nBinsQoverPtAxis_ - 1, 0, nBinsPhiTrkAxis_ - 1);
+  } else if (hierarchicalHT_) {
+    // Only the coarse HT array is filled now. The full resolution one is filled later by end().
+    if (inEtaSubSecs.size() != numSubSecs_) throw cms::Exception("HTrphi: Wrong number of subsectors!");
+    passStubs_.push_back(stub);
+    passSubSecs_.push_back(inEtaSubSecs);
+    this->storeCoarse(stub, inEtaSubSecs);
+    // Not all columns of the full resolution array will be filled, so check for firmware limitations separately.
+    this->countFirmwareErrors(stub);
+  } else {
+    this->fill(stub, inEtaSubSecs, storeAll, 0, nBinsQoverPtAxis_ - 1, 0, nBinsPhiTrkAxis_ - 1);
+  }
+}
+
+//=== Add stub to coarse HT array, noting which layers have stubs in each coarse cell.
+
+void HTrphi::storeCoarse(const Stub* stub, const vector<bool>& inEtaSubSecs) {
+
+  const unsigned int iStub = passStubs_.size() - 1;
+  const uint32_t layerBit = Utility::layerBit(HTbase::settings_, stub);
+
+  for (unsigned int i = 0; i < nBinsQoverPtCoarse_; i++) {
+    pair<unsigned int, unsigned int> iRange = this->iPhiRangeCoarse( stub, i);
+    for (unsigned int j = iRange.first; j <= iRange.second; j++) {  
+      unsigned int iCell = i*nBinsPhiTrkCoarse_ + j;
+      coarseStubs_[iCell].push_back(iStub);
+      // The bend filter can't be applied to the coarse cells, so the layer count is relaxed compared to that in the cells inside it. 
+      for (unsigned int k = 0; k < numSubSecs_; k++) {
+	if (numSubSecs_ == 1 || inEtaSubSecs[k]) layerMask_[iCell*numSubSecs_ + k] |= layerBit;
+      }
+    }
+  }
+}
+
+//=== Remove all stubs and track candidates, keeping the array configuration.
+
+void HTrphi::reset() {
+  if (twoPassHT_ && ! passStubs_.empty()) {
+    passStubs_.clear();
+    passSubSecs_.clear();
+    std::fill(layerMask_.begin(), layerMask_.end(), 0);
+    std::fill(candCell_.begin(), candCell_.end(), false);
+  }
+  if (hierarchicalHT_ && ! passStubs_.empty()) {
+    passStubs_.clear();
+    passSubSecs_.clear();
+    std::fill(layerMask_.begin(), layerMask_.end(), 0);
+    for (vector<unsigned int>& stubs : coarseStubs_) stubs.clear();
+  }
+  HTbase::reset();
+}
+
+//=== Termination. Causes HT array to search for tracks etc.
+
+void HTrphi::end() {
+
+  if (twoPassHT_ && ! passStubs_.empty()) {
+    // Find cells that may contain track candidates. The stub count filter only removes stubs, so the number of layers with stubs
+    // passing the bend filter in a cell (in the best subsector) is an upper limit on the number of layers HTcell::end() will find.
+    bool foundCand = false;
+    for (unsigned int i = 0; i < nBinsQoverPtAxis_; i++) {
+      for (unsigned int j = 0; j < nBinsPhiTrkAxis_; j++) {
+	unsigned int iCell = i*nBinsPhiTrkAxis_ + j;
+	unsigned int maxLayers = 0;
+	for (unsigned int k = 0; k < numSubSecs_; k++) {
+	  maxLayers = max(maxLayers, (unsigned int) bitset<32>(layerMask_[iCell*numSubSecs_ + k]).count());
+	}
+	// (Cells with no stubs passing the bend filter would be left with no stubs, so can also be skipped). 
+	candCell_[iCell] = (maxLayers > 0 && HTbase::htArray_(i,j).enoughLayers(maxLayers));
+	if (candCell_[iCell]) foundCand = true;
+      }
+    }
+
+    // Second pass stores all stubs, in their original order, in these cells, so they are filtered exactly as usual.
+    if (foundCand) {
+      for (unsigned int iStub = 0; iStub < passStubs_.size(); iStub++) {
+	this->fill(passStubs_[iStub], passSubSecs_[iStub], storeInCandCells, 0, nBinsQoverPtAxis_ - 1, 0, nBinsPhiTrkAxis_ - 1);
+      }
+    }
+  }
+
+  if (hierarchicalHT_ && ! passStubs_.empty()) {
+    // Find coarse cells with stubs in enough layers for any of the cells inside them to contain a track candidate.
+    // (Since the coarse cells contain all the stubs of the cells inside them, their layer count can't be lower).
+    for (unsigned int iC = 0; iC < nBinsQoverPtCoarse_; iC++) {
+      for (unsigned int jC = 0; jC < nBinsPhiTrkCoarse_; jC++) {
+	unsigned int iCell = iC*nBinsPhiTrkCoarse_ + jC;
+	unsigned int maxLayers = 0;
+	for (unsigned int k = 0; k < numSubSecs_; k++) {
+	  maxLayers = max(maxLayers, (unsigned int) bitset<32>(layerMask_[iCell*numSubSecs_ + k]).count());
+	}
+	if (maxLayers == 0) continue;
+
+	// Range of cells inside this coarse cell.
+	unsigned int iMin = iC*coarseFactorPt_;
+	unsigned int iMax = iMin + coarseFactorPt_ - 1;
+	unsigned int jMin = jC*coarseFactorPhi_;
+	unsigned int jMax = jMin + coarseFactorPhi_ - 1;
+
+	// Layers required for a track candidate only depend on q/Pt.
+	bool refine = false;
+	for (unsigned int i = iMin; i <= iMax; i++) {
+	  if (HTbase::htArray_(i, jMin).enoughLayers(maxLayers)) refine = true;
+	}
+
+	// If so, fill the cells inside it with the stubs in it, in their original order, so they are filtered exactly as usual.
+	if (refine) {
+	  for (unsigned int iStub : coarseStubs_[iCell]) {
+	    this->fill(passStubs_[iStub], passSubSecs_[iStub], storeInCoarseCell, iMin, iMax, jMin, jMax);
+	  }
+	}
+      }
+    }
+  }
+
+  HTbase::end();
+}
+
+//=== Fill HT array with a stub, considering only the given range of q/Pt and phiTrk bins.
+
+void HTrphi::fill(const Stub* stub, const vector<bool>& inEtaSubSecs, FillPass pass,
+		  unsigned int iQoverPtBinMin, unsigned int iQoverPtBinMax, unsigned int jPhiTrkBinMin, unsigned int jPhiTrkBinMax) {
+
+  // Note which tracker layer stub is in, if needed.
+  const uint32_t layerBit = (pass == countLayers)  ?  Utility::layerBit(HTbase::settings_, stub)  :  0;
+
   // Loop over q/Pt related bins in HT array.
-  for (unsigned int i = 0; i < nBinsQoverPtAxis_; i++) {
+  for (unsigned int i = iQoverPtBinMin; i <= iQoverPtBinMax; i++) {
 
     // In this q/Pt bin, find the range of phi bins that this stub is consistent with.
     pair<unsigned int, unsigned int> iRange = this->iPhiRange( stub, i);
@@ -122,9 +282,10 @@ void HTrphi::store(const Stub* stub, const vector<bool>& inEtaSubSecs) {
     unsigned int iPhiTrkBinMax = iRange.second;
 
     // Store stubs in these cells.
-    for (unsigned int j = iPhiTrkBinMin; j <= iPhiTrkBinMax; j++) {  
+    for (unsigned int j = max(iPhiTrkBinMin, jPhiTrkBinMin); j <= min(iPhiTrkBinMax, jPhiTrkBinMax); j++) {  
 
       bool canStoreStub = true;
+      bool merged = false;
       unsigned int iStore = i;
       unsigned int jStore = j;
 
@@ -133,20 +294,39 @@ void HTrphi::store(const Stub* stub, const vector<bool>& inEtaSubSecs) {
       if (enableMerge2x2_) {
 	// Check if this cell is merged with its neighbours (as in low Pt region).
 	if (this->mergedCell(i, j)) {
+	  merged = true;
 	  // Get location of cell that this cell is merged into (iStore, jStore).
 	  // Calculation assumes HT array has even number of bins in both dimensions.
 	  if (i%2 == 1) iStore = i - 1;
 	  if (j%2 == 1) jStore = j - 1;
-	  // If this stub was already stored in this merged 2x2 cell, then don't store it again.
-	  if (HTbase::htArray_(iStore, jStore).stubStoredInCell( stub )) canStoreStub = false;
 	}
       }
 
-      if (canStoreStub) HTbase::htArray_(iStore, jStore).store( stub, inEtaSubSecs ); // Calls HTcell::store()
+      if (pass == countLayers) {
+
+	// Note layer of stub in this cell (and in each subsector it is compatible with), if it passes the bend filter.
+	if (HTbase::htArray_(iStore, jStore).passBendFilter( stub )) {
+	  unsigned int iCell = iStore*nBinsPhiTrkAxis_ + jStore;
+	  for (unsigned int k = 0; k < numSubSecs_; k++) {
+	    if (numSubSecs_ == 1 || inEtaSubSecs[k]) layerMask_[iCell*numSubSecs_ + k] |= layerBit;
+	  }
+	}
+
+      } else {
+
+	if (pass == storeInCandCells && ! candCell_[iStore*nBinsPhiTrkAxis_ + jStore]) canStoreStub = false;
+	// If this stub was already stored in this merged 2x2 cell, then don't store it again.
+	if (canStoreStub && merged) {
+	  if (HTbase::htArray_(iStore, jStore).stubStoredInCell( stub )) canStoreStub = false;
+	}
+
+	if (canStoreStub) HTbase::storeInCell(iStore, jStore, stub, inEtaSubSecs);
+      }
     }
 
     // Check that limitations of firmware would not prevent stub being stored correctly in this HT column.
-    this->countFirmwareErrors(i, iPhiTrkBinMin, iPhiTrkBinMax);
+    // (Only done once per stub. If the HT array is filled hierarchically, not all columns are filled, so store() does it instead).
+    if (pass == storeAll || pass == countLayers) this->countFirmwareErrors(i, iPhiTrkBinMin, iPhiTrkBinMax);
   }
 }
 
@@ -201,6 +381,51 @@ pair<unsigned int, unsigned int> HTrphi::iPhiRange( const Stub* stub, unsigned i
   return iPhiTrkBinRange;
 }
 
+//=== For a given coarse Q/Pt bin, find the range of coarse phi bins that a given stub is consistent with.
+//=== This range includes all coarse cells containing cells the stub would be stored in by store().
+//=== If it range lies outside the HT array, then the min bin will be set larger than the max bin.
+
+pair<unsigned int, unsigned int> HTrphi::iPhiRangeCoarse( const Stub* stub, unsigned int iCoarseQoverPtBin) const {
+
+  // Range of q/Pt covered by the bins in this coarse bin.
+  float qOverPtMin    = -maxAbsQoverPtAxis_ + iCoarseQoverPtBin * coarseFactorPt_ * binSizeQoverPtAxis_;
+  float qOverPtMax    = qOverPtMin + coarseFactorPt_ * binSizeQoverPtAxis_;
+  float qOverPtBin    = 0.5*(qOverPtMin + qOverPtMax);
+  float qOverPtBinVar = 0.5*(qOverPtMax - qOverPtMin);
+
+  // Calculate range of track-phi as in iPhiRange(). As this is linear in q/Pt, it covers the ranges of all the bins inside.
+  // Add one phiTrk bin either side, so that rounding errors can't make it smaller than them.
+  float phiTrk    = stub->phi() + invPtToDphi_ * qOverPtBin    *     (stub->r() - chosenRofPhi_);
+  float phiTrkVar =               invPtToDphi_ * qOverPtBinVar * fabs(stub->r() - chosenRofPhi_) + binSizePhiTrkAxis_;
+
+  // Allow for uncertainty due to strip length if requested, taking the largest |q/Pt| in the coarse bin.
+  if (handleStripsRphiHT_ && ! stub->barrel()) {
+    phiTrkVar += invPtToDphi_ * max(fabs(qOverPtMin), fabs(qOverPtMax)) * stub->rErr();
+  }
+
+  float deltaPhiMin = reco::deltaPhi(phiTrk - phiTrkVar, phiCentreSector_); // Offset to centre of sector.
+  float deltaPhiMax = reco::deltaPhi(phiTrk + phiTrkVar, phiCentreSector_);
+  pair<float, float> phiTrkRange( deltaPhiMin, deltaPhiMax );
+
+  // Determine which range of phiTrk bins this corresponds to, taking all bins even if killSomeHTCellsRphi is set, 
+  // (as this only removes some of them), and so which range of coarse bins.
+  const unsigned int killSomeHTCells = 0;
+  pair<unsigned int, unsigned int> iPhiTrkBinRange = this->HTbase::convertCoordRangeToBinRange(phiTrkRange, nBinsPhiTrkAxis_, (-maxAbsPhiTrkAxis_), binSizePhiTrkAxis_, killSomeHTCells);
+  if (iPhiTrkBinRange.first > iPhiTrkBinRange.second) return pair<unsigned int, unsigned int>(nBinsPhiTrkCoarse_ - 1, 0);
+
+  return pair<unsigned int, unsigned int>(iPhiTrkBinRange.first / coarseFactorPhi_, iPhiTrkBinRange.second / coarseFactorPhi_);
+}
+
+//=== Check that limitations of firmware would not prevent stub being stored correctly in any HT column.
+//=== (Used when filling HT array hierarchically, as fill() is then not called for all columns).
+
+void HTrphi::countFirmwareErrors(const Stub* stub) {
+  for (unsigned int i = 0; i < nBinsQoverPtAxis_; i++) {
+    pair<unsigned int, unsigned int> iRange = this->iPhiRange( stub, i);
+    this->countFirmwareErrors(i, iRange.first, iRange.second);
+  }
+}
+
 //=== Check that limitations of firmware would not prevent stub being stored correctly in this HT column.
 
 void HTrphi::countFirmwareErrors(unsigned int iQoverPtBin, unsigned int iPhiTrkBinMin, unsigned int iPhiTrkBinMax) {
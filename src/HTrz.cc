@@ -78,8 +78,12 @@ void HTrz::init(const Settings* settings, float etaMinSector, float etaMaxSector
   unsigned int dupTrkAlgRz = settings->dupTrkAlgRz();
   HTbase::killDupTrks_.init(settings, dupTrkAlgRz);
 
+  qOverPt_ = qOverPt;
+
   // Resize HT array to suit these specifications, and initialise each cell with configuration parameters.
   HTbase::htArray_.resize(nBinsZ0Axis_, nBinsZtrkAxis_, false);
+  HTbase::filledCells_.clear();
+  HTbase::trackCands2D_.clear();
 
   const bool isRphiHT = false;
   for (unsigned int i = 0; i < nBinsZ0Axis_; i++) {
@@ -96,6 +100,34 @@ void HTrz::init(const Settings* settings, float etaMinSector, float etaMaxSector
   }
 }
 
+//=== Remove all stubs & tracks, so the array can be reused for the stubs on another track candidate found by the r-phi HT,
+//=== with the given estimated q/Pt. Only the cells filled since the last reset are visited.
+
+void HTrz::reset(float qOverPt) {
+  HTbase::reset();
+  qOverPt_ = qOverPt;
+}
+
+//=== Termination. Causes HT array to search for tracks etc.
+
+void HTrz::end() {
+  // Note the estimated q/Pt in the cells, which is used to decide if they contain a track candidate.
+  // If empty cells could contain a track candidate, this must be done for all cells.
+  if (settings_->minStubLayers() > 1) {
+    for (const pair<unsigned int, unsigned int>& cell : HTbase::filledCells_) {
+      HTbase::htArray_(cell.first, cell.second).setQoverPt(qOverPt_);
+    }
+  } else {
+    for (unsigned int i = 0; i < nBinsZ0Axis_; i++) {
+      for (unsigned int j = 0; j < nBinsZtrkAxis_; j++) {
+	HTbase::htArray_(i,j).setQoverPt(qOverPt_);
+      }
+    }
+  }
+
+  HTbase::end();
+}
+
 //=== Add stub to HT array.
 
 void HTrz::store( const Stub* stub) {
@@ -111,7 +143,7 @@ void HTrz::store( const Stub* stub) {
 
     // Store stubs in these cells.
     for (unsigned int j = iZtrkBinMin; j <= iZtrkBinMax; j++) {  
-      HTbase::htArray_(i, j).store( stub ); // Calls HTcell::store()
+      HTbase::storeInCell(i, j, stub);
     }
 
     // Check that limitations of firmware would not prevent stub being stored correctly in this HT column.
@@ -95,160 +95,159 @@ void Histos::bookStubPairs() {
 }
 
 // Fill histograms relating the stub-pairs algorithm
-void Histos::fillStubPairs(const vector<const Stub*>& vStubs)
+// (The pairs were already found once per event when removing overlap stubs, so need only be selected here).
+void Histos::fillStubPairs(const OverlapStubPairs& pairs)
 {
-  analyse_Formulae(vStubs);
-  analyse_PairFinding(vStubs);
-  analyse_cuts(vStubs);
+  analyse_Formulae(pairs);
+  analyse_PairFinding(pairs);
+  analyse_cuts(pairs);
 }
 
 // Stats on the input data
-void Histos::analyse_Formulae(const vector<const Stub*>& vStubs)
+void Histos::analyse_Formulae(const OverlapStubPairs& pairs)
 {
   // The formulae for z0 and ptOverQ of a pair of stubs having any q/pt
-  KillOverlapStubs killOverlapStubs_ = KillOverlapStubs(vStubs, settings_, -1, 15.0);
-  vector< pair<const Stub*, const Stub*> > true_pairs  = killOverlapStubs_.getPairs("truePairFinder");
-  for ( auto p : true_pairs ) {
-    const Stub* s1   = p.first; const Stub* s2 = p.second;
-    double z0_f      = killOverlapStubs_.getTrackParams(s1,s2).first;
-    double ptOverQ_f = killOverlapStubs_.getTrackParams(s1,s2).second;
-    double z0_t      = killOverlapStubs_.getCommonTP(s1,s2)->z0();
-    double qOverPt_t = killOverlapStubs_.getCommonTP(s1,s2)->qOverPt();
-    hisZ0PairVsTruth_    -> Fill( z0_f, z0_t              );
-    hisPtPairVsTruth_    -> Fill( 1/ptOverQ_f, qOverPt_t  );
-    hisPtPairMinusTruth_ -> Fill( qOverPt_t - 1/ptOverQ_f );
-    hisZ0PairMinusTruth_ -> Fill( z0_t - z0_f );
+  for ( const OverlapStubPairs::TruePair& p : pairs.truePairs ) {
+    const Stub* s1   = p.s1;
+    double z0_f      = p.z0;
+    double ptOverQ_f = p.ptOverQ;
+    double z0_t      = p.commonTP->z0();
+    double qOverPt_t = p.commonTP->qOverPt();
+    buffer_.fill(hisZ0PairVsTruth_, z0_f, z0_t              );
+    buffer_.fill(hisPtPairVsTruth_, 1/ptOverQ_f, qOverPt_t  );
+    buffer_.fill(hisPtPairMinusTruth_, qOverPt_t - 1/ptOverQ_f );
+    buffer_.fill(hisZ0PairMinusTruth_, z0_t - z0_f );
     if ( s1->barrel() ) {
-      hisZ0PairVsTruth_barrel_ -> Fill( z0_f, z0_t );
-      hisPtPairVsTruth_barrel_ -> Fill( 1/ptOverQ_f, qOverPt_t );
+      buffer_.fill(hisZ0PairVsTruth_barrel_, z0_f, z0_t );
+      buffer_.fill(hisPtPairVsTruth_barrel_, 1/ptOverQ_f, qOverPt_t );
       if ( s1->psModule() ) {
-        hisZ0PairVsTruth_barrel_PS_ -> Fill( z0_f, z0_t );
-        hisPtPairVsTruth_barrel_PS_ -> Fill( 1/ptOverQ_f, qOverPt_t );
-        hisZ0PairMinusTruth_barrel_PS_ -> Fill( z0_f - z0_t );
-        hisZ0PairMinusTruth_barrel_PS_abs_ -> Fill( fabs(z0_f - z0_t) );
+        buffer_.fill(hisZ0PairVsTruth_barrel_PS_, z0_f, z0_t );
+        buffer_.fill(hisPtPairVsTruth_barrel_PS_, 1/ptOverQ_f, qOverPt_t );
+        buffer_.fill(hisZ0PairMinusTruth_barrel_PS_, z0_f - z0_t );
+        buffer_.fill(hisZ0PairMinusTruth_barrel_PS_abs_, fabs(z0_f - z0_t) );
       } else { // 2S
-        hisZ0PairVsTruth_barrel_2S_ -> Fill( z0_f, z0_t );
-        hisPtPairVsTruth_barrel_2S_ -> Fill( 1/ptOverQ_f, qOverPt_t );
+        buffer_.fill(hisZ0PairVsTruth_barrel_2S_, z0_f, z0_t );
+        buffer_.fill(hisPtPairVsTruth_barrel_2S_, 1/ptOverQ_f, qOverPt_t );
       }
     } else { // endcap
-      hisZ0PairVsTruth_endcap_ -> Fill( z0_f, z0_t );
-      hisPtPairVsTruth_endcap_ -> Fill( 1/ptOverQ_f, qOverPt_t );
+      buffer_.fill(hisZ0PairVsTruth_endcap_, z0_f, z0_t );
+      buffer_.fill(hisPtPairVsTruth_endcap_, 1/ptOverQ_f, qOverPt_t );
       if ( s1->psModule() ) {
-        hisZ0PairVsTruth_endcap_PS_ -> Fill( z0_f, z0_t );
-        hisPtPairVsTruth_endcap_PS_ -> Fill( 1/ptOverQ_f, qOverPt_t );
+        buffer_.fill(hisZ0PairVsTruth_endcap_PS_, z0_f, z0_t );
+        buffer_.fill(hisPtPairVsTruth_endcap_PS_, 1/ptOverQ_f, qOverPt_t );
       } else { // 2S
-        hisZ0PairVsTruth_endcap_2S_ -> Fill( z0_f, z0_t );
-        hisPtPairVsTruth_endcap_2S_ -> Fill( 1/ptOverQ_f, qOverPt_t );
+        buffer_.fill(hisZ0PairVsTruth_endcap_2S_, z0_f, z0_t );
+        buffer_.fill(hisPtPairVsTruth_endcap_2S_, 1/ptOverQ_f, qOverPt_t );
       }
     }
     if ( s1->psModule() ) {
-      hisZ0PairVsTruth_PS_ -> Fill( z0_f, z0_t );
-      hisPtPairVsTruth_PS_ -> Fill( 1/ptOverQ_f, qOverPt_t );
+      buffer_.fill(hisZ0PairVsTruth_PS_, z0_f, z0_t );
+      buffer_.fill(hisPtPairVsTruth_PS_, 1/ptOverQ_f, qOverPt_t );
     } else { // 2S
-      hisZ0PairVsTruth_2S_ -> Fill( z0_f, z0_t );
-      hisPtPairVsTruth_2S_ -> Fill( 1/ptOverQ_f, qOverPt_t );
+      buffer_.fill(hisZ0PairVsTruth_2S_, z0_f, z0_t );
+      buffer_.fill(hisPtPairVsTruth_2S_, 1/ptOverQ_f, qOverPt_t );
     }
   }
 }
 
 // Stats on my pair-finding algorithm;
-void Histos::analyse_PairFinding(const vector<const Stub*>& vStubs)
+void Histos::analyse_PairFinding(const OverlapStubPairs& pairs)
 {
   // filter out non-genuine stubs
   vector<const Stub*> vStubs_filt;
-  for (const Stub* s : vStubs)
+  for (const Stub* s : pairs.stubs)
     if ( s->genuine() )
       vStubs_filt.push_back(s);
 
-  KillOverlapStubs killOverlapStubs_ = KillOverlapStubs(vStubs_filt, settings_);
-  vector< pair<const Stub*, const Stub*> > true_pairs  = killOverlapStubs_.getPairs("truePairFinder");
-  vector< pair<const Stub*, const Stub*> > found_pairs = killOverlapStubs_.getPairs("pairFinder");
+  // the pairs amongst the genuine stubs only
+  vector< pair<const Stub*, const Stub*> > true_pairs  = pairs.selectTrue(settings_->overlapPtCut());
+  vector< pair<const Stub*, const Stub*> > found_pairs = pairs.selectFound(settings_->overlapPtCut(), settings_->overlapZ0Cut(), true);
 
   for (const Stub* s : vStubs_filt) {
-    his_AllStubs_Pt    -> Fill( killOverlapStubs_.getFirstTP(s)->qOverPt() );
-    his_AllStubs_AbsPt -> Fill( fabs(killOverlapStubs_.getFirstTP(s)->qOverPt()) );
-    his_AllStubs_Eta   -> Fill( killOverlapStubs_.getFirstTP(s)->eta()     );
-    his_AllStubs_Loc   -> Fill( fabs(s->z()), s->r()  );
+    buffer_.fill(his_AllStubs_Pt, KillOverlapStubs::getFirstTP(s)->qOverPt() );
+    buffer_.fill(his_AllStubs_AbsPt, fabs(KillOverlapStubs::getFirstTP(s)->qOverPt()) );
+    buffer_.fill(his_AllStubs_Eta, KillOverlapStubs::getFirstTP(s)->eta()     );
+    buffer_.fill(his_AllStubs_Loc, fabs(s->z()), s->r()  );
   }
 
   for ( const Stub* s : depair(found_pairs) ) {
-    his_StubsInFound_Pt  -> Fill( killOverlapStubs_.getFirstTP(s)->qOverPt() );
-    his_StubsInFound_Eta -> Fill( killOverlapStubs_.getFirstTP(s)->eta()     );
-    his_StubsInFound_Loc -> Fill( fabs(s->z()), s->r()  );
+    buffer_.fill(his_StubsInFound_Pt, KillOverlapStubs::getFirstTP(s)->qOverPt() );
+    buffer_.fill(his_StubsInFound_Eta, KillOverlapStubs::getFirstTP(s)->eta()     );
+    buffer_.fill(his_StubsInFound_Loc, fabs(s->z()), s->r()  );
   }
 
   set<const Stub*> true_stubs;
 
   for (auto p : true_pairs) {
-    his_AllTruePairs_Pt  -> Fill( killOverlapStubs_.getCommonTP(p.first,p.second)->qOverPt() );
-    his_AllTruePairs_Eta -> Fill( killOverlapStubs_.getCommonTP(p.first,p.second)->eta()     );
-    his_AllTruePairs_Loc -> Fill( fabs(p.first->z()), p.first->r()      );
+    buffer_.fill(his_AllTruePairs_Pt, KillOverlapStubs::getCommonTP(p.first,p.second)->qOverPt() );
+    buffer_.fill(his_AllTruePairs_Eta, KillOverlapStubs::getCommonTP(p.first,p.second)->eta()     );
+    buffer_.fill(his_AllTruePairs_Loc, fabs(p.first->z()), p.first->r()      );
     true_stubs.insert(p.first);
     true_stubs.insert(p.second);
   }
 
   for (const Stub* s : true_stubs) {
-    his_AllTrueStubs_Pt    -> Fill( killOverlapStubs_.getFirstTP(s)->qOverPt() );
-    his_AllTrueStubs_AbsPt -> Fill( fabs(killOverlapStubs_.getFirstTP(s)->qOverPt()) );
-    his_AllTrueStubs_Eta   -> Fill( killOverlapStubs_.getFirstTP(s)->eta() );
-    his_AllTrueStubs_Loc   -> Fill( fabs(s->z()), s->r()  );
+    buffer_.fill(his_AllTrueStubs_Pt, KillOverlapStubs::getFirstTP(s)->qOverPt() );
+    buffer_.fill(his_AllTrueStubs_AbsPt, fabs(KillOverlapStubs::getFirstTP(s)->qOverPt()) );
+    buffer_.fill(his_AllTrueStubs_Eta, KillOverlapStubs::getFirstTP(s)->eta() );
+    buffer_.fill(his_AllTrueStubs_Loc, fabs(s->z()), s->r()  );
 
     set<const Stub*> wrong_stubs;
     set<const Stub*> true_found_stubs;
     set<const Stub*> found_stubs;
 
     for (auto p : found_pairs) {
-      if ( killOverlapStubs_.getCommonTP(p.first, p.second) ) {
-        his_TrueFoundPairs_Pt  -> Fill( killOverlapStubs_.getCommonTP(p.first,p.second)->qOverPt() );
-        his_TrueFoundPairs_Eta -> Fill( killOverlapStubs_.getCommonTP(p.first,p.second)->eta()     );
-        his_TrueFoundPairs_Loc -> Fill( fabs(p.first->z()), p.first->r()      );
+      if ( KillOverlapStubs::getCommonTP(p.first, p.second) ) {
+        buffer_.fill(his_TrueFoundPairs_Pt, KillOverlapStubs::getCommonTP(p.first,p.second)->qOverPt() );
+        buffer_.fill(his_TrueFoundPairs_Eta, KillOverlapStubs::getCommonTP(p.first,p.second)->eta()     );
+        buffer_.fill(his_TrueFoundPairs_Loc, fabs(p.first->z()), p.first->r()      );
         true_found_stubs.insert(p.first);
         true_found_stubs.insert(p.second);
       } else {
-        his_WrongFoundPairs_Pt  -> Fill( killOverlapStubs_.getFirstTP(p.first)->qOverPt() );
-        his_WrongFoundPairs_Eta -> Fill( killOverlapStubs_.getFirstTP(p.first)->eta()     );
-        his_WrongFoundPairs_Loc -> Fill( fabs(p.first->z()), p.first->r()      );
+        buffer_.fill(his_WrongFoundPairs_Pt, KillOverlapStubs::getFirstTP(p.first)->qOverPt() );
+        buffer_.fill(his_WrongFoundPairs_Eta, KillOverlapStubs::getFirstTP(p.first)->eta()     );
+        buffer_.fill(his_WrongFoundPairs_Loc, fabs(p.first->z()), p.first->r()      );
         wrong_stubs.insert(p.first);
         wrong_stubs.insert(p.second);
       }
-      his_AllFoundPairs_Pt  -> Fill( killOverlapStubs_.getFirstTP(p.first) -> qOverPt()    );
-      his_AllFoundPairs_Eta -> Fill( killOverlapStubs_.getFirstTP(p.first) -> eta()        );
-      his_AllFoundPairs_Loc -> Fill( fabs(p.first->z()), p.first->r() );
+      buffer_.fill(his_AllFoundPairs_Pt, KillOverlapStubs::getFirstTP(p.first) -> qOverPt()    );
+      buffer_.fill(his_AllFoundPairs_Eta, KillOverlapStubs::getFirstTP(p.first) -> eta()        );
+      buffer_.fill(his_AllFoundPairs_Loc, fabs(p.first->z()), p.first->r() );
       found_stubs.insert(p.first);
       found_stubs.insert(p.second);
     }
 
     for (const Stub* s : wrong_stubs) {
-      his_WrongStubs_Pt    -> Fill( killOverlapStubs_.getFirstTP(s)->qOverPt() );
-      his_WrongStubs_AbsPt -> Fill( fabs(killOverlapStubs_.getFirstTP(s)->qOverPt()) );
-      his_WrongStubs_Eta   -> Fill( killOverlapStubs_.getFirstTP(s)->eta()     );
-      his_WrongStubs_Loc   -> Fill( fabs(s->z()), s->r()  );
+      buffer_.fill(his_WrongStubs_Pt, KillOverlapStubs::getFirstTP(s)->qOverPt() );
+      buffer_.fill(his_WrongStubs_AbsPt, fabs(KillOverlapStubs::getFirstTP(s)->qOverPt()) );
+      buffer_.fill(his_WrongStubs_Eta, KillOverlapStubs::getFirstTP(s)->eta()     );
+      buffer_.fill(his_WrongStubs_Loc, fabs(s->z()), s->r()  );
     }
 
     for (const Stub* s : true_found_stubs) {
-      his_TrueFoundStubs_Pt    -> Fill( killOverlapStubs_.getFirstTP(s)->qOverPt() );
-      his_TrueFoundStubs_AbsPt -> Fill( fabs(killOverlapStubs_.getFirstTP(s)->qOverPt()) );
-      his_TrueFoundStubs_Eta   -> Fill( killOverlapStubs_.getFirstTP(s)->eta() );
-      his_TrueFoundStubs_Loc   -> Fill( fabs(s->z()), s->r()  );
+      buffer_.fill(his_TrueFoundStubs_Pt, KillOverlapStubs::getFirstTP(s)->qOverPt() );
+      buffer_.fill(his_TrueFoundStubs_AbsPt, fabs(KillOverlapStubs::getFirstTP(s)->qOverPt()) );
+      buffer_.fill(his_TrueFoundStubs_Eta, KillOverlapStubs::getFirstTP(s)->eta() );
+      buffer_.fill(his_TrueFoundStubs_Loc, fabs(s->z()), s->r()  );
     }
 
     for (const Stub* s : found_stubs) {
-      his_AllFoundStubs_Pt    -> Fill( killOverlapStubs_.getFirstTP(s)->qOverPt() );
-      his_AllFoundStubs_AbsPt -> Fill( fabs(killOverlapStubs_.getFirstTP(s)->qOverPt()) );
-      his_AllFoundStubs_Eta   -> Fill( killOverlapStubs_.getFirstTP(s)->eta() );
-      his_AllFoundStubs_Loc   -> Fill( fabs(s->z()), s->r()  );
+      buffer_.fill(his_AllFoundStubs_Pt, KillOverlapStubs::getFirstTP(s)->qOverPt() );
+      buffer_.fill(his_AllFoundStubs_AbsPt, fabs(KillOverlapStubs::getFirstTP(s)->qOverPt()) );
+      buffer_.fill(his_AllFoundStubs_Eta, KillOverlapStubs::getFirstTP(s)->eta() );
+      buffer_.fill(his_AllFoundStubs_Loc, fabs(s->z()), s->r()  );
     }
   }
 }
 
 
 // Determining ideal cuts
-void Histos::analyse_cuts(const vector<const Stub*>& vStubs)
+void Histos::analyse_cuts(const OverlapStubPairs& pairs)
 {
 
   // filter out non-genuine stubs
   vector<const Stub*> vStubs_filt;
-  for (const Stub* s : vStubs)
+  for (const Stub* s : pairs.stubs)
     if ( s->genuine() )
       vStubs_filt.push_back(s);
 
@@ -257,37 +256,36 @@ void Histos::analyse_cuts(const vector<const Stub*>& vStubs)
   ////////////////////////////////////////////////////////////////////////////////////////////
 
   for (double pt_cut=4.0/100; pt_cut<4.0; pt_cut+=4.0/50) {
-    KillOverlapStubs killOverlapStubs_ = KillOverlapStubs(vStubs_filt, settings_, pt_cut, 15.0);
-    vector< pair<const Stub*, const Stub*> > true_pairs  = killOverlapStubs_.getPairs("truePairFinder");
-    vector< pair<const Stub*, const Stub*> > found_pairs = killOverlapStubs_.getPairs("pairFinder");
+    vector< pair<const Stub*, const Stub*> > true_pairs  = pairs.selectTrue(pt_cut);
+    vector< pair<const Stub*, const Stub*> > found_pairs = pairs.selectFound(pt_cut, 15.0, true);
 
     // find the number of all stubs
     size_t numOfStubs = vStubs_filt.size();
-    his_pt_cut_AllStubs -> Fill( pt_cut, numOfStubs );
+    buffer_.fill(his_pt_cut_AllStubs, pt_cut, numOfStubs );
 
     // find the number of stubs in found pairs
     size_t numOfFoundStubs = depair(found_pairs).size();
-    his_pt_cut_StubsInFoundPairs -> Fill( pt_cut, numOfFoundStubs);
+    buffer_.fill(his_pt_cut_StubsInFoundPairs, pt_cut, numOfFoundStubs);
 
     // find the number of stubs in true and wrong found pairs
     size_t numOfTrueFoundStubs = 0;
     size_t numOfWrongHighPtStubs = 0;
     for (auto p : found_pairs)
-      if ( killOverlapStubs_.getCommonTP(p.first, p.second) ) {
+      if ( KillOverlapStubs::getCommonTP(p.first, p.second) ) {
         ++numOfTrueFoundStubs;
         ++numOfTrueFoundStubs;
       } else {
-        if (killOverlapStubs_.getFirstTP(p.first)->pt() >= 3.00 )
+        if (KillOverlapStubs::getFirstTP(p.first)->pt() >= 3.00 )
           ++numOfWrongHighPtStubs;
-        if (killOverlapStubs_.getFirstTP(p.second)->pt() >= 3.00 )
+        if (KillOverlapStubs::getFirstTP(p.second)->pt() >= 3.00 )
           ++numOfWrongHighPtStubs;
       }
-    his_pt_cut_StubsInTrueFoundPairs  -> Fill( pt_cut, numOfTrueFoundStubs );
-    his_pt_cut_StubsInWrongFoundPairs -> Fill( pt_cut, numOfWrongHighPtStubs );
+    buffer_.fill(his_pt_cut_StubsInTrueFoundPairs, pt_cut, numOfTrueFoundStubs );
+    buffer_.fill(his_pt_cut_StubsInWrongFoundPairs, pt_cut, numOfWrongHighPtStubs );
 
     // find the number of stubs in all true pairs
     size_t numOfTrueStubs = depair(true_pairs).size();
-    his_pt_cut_StubsInAllTruePairs -> Fill( pt_cut, numOfTrueStubs );
+    buffer_.fill(his_pt_cut_StubsInAllTruePairs, pt_cut, numOfTrueStubs );
   }
 
 
@@ -296,37 +294,36 @@ void Histos::analyse_cuts(const vector<const Stub*>& vStubs)
   ////////////////////////////////////////////////////////////////////////////////////////////
 
   for (double z0_cut=60.0/100; z0_cut<60.0; z0_cut+=60.0/50) {
-    KillOverlapStubs killOverlapStubs_ = KillOverlapStubs(vStubs_filt, settings_, 3.0, z0_cut);
-    vector< pair<const Stub*, const Stub*> > true_pairs  = killOverlapStubs_.getPairs("truePairFinder");
-    vector< pair<const Stub*, const Stub*> > found_pairs = killOverlapStubs_.getPairs("pairFinder");
+    vector< pair<const Stub*, const Stub*> > true_pairs  = pairs.selectTrue(3.0);
+    vector< pair<const Stub*, const Stub*> > found_pairs = pairs.selectFound(3.0, z0_cut, true);
 
     // find the number of all stubs
     size_t numOfStubs = vStubs_filt.size();
-    his_z0_cut_AllStubs -> Fill( z0_cut, numOfStubs );
+    buffer_.fill(his_z0_cut_AllStubs, z0_cut, numOfStubs );
 
     // find the number of stubs in found pairs
     size_t numOfFoundStubs = depair(found_pairs).size();
-    his_z0_cut_StubsInFoundPairs -> Fill( z0_cut, numOfFoundStubs);
+    buffer_.fill(his_z0_cut_StubsInFoundPairs, z0_cut, numOfFoundStubs);
 
     // find the number of stubs in true and wrong found pairs
     size_t numOfTrueFoundStubs = 0;
     size_t numOfWrongHighPtStubs = 0;
     for (auto p : found_pairs)
-      if ( killOverlapStubs_.getCommonTP(p.first, p.second) ) {
+      if ( KillOverlapStubs::getCommonTP(p.first, p.second) ) {
         ++numOfTrueFoundStubs;
         ++numOfTrueFoundStubs;
       } else {
-        if (killOverlapStubs_.getFirstTP(p.first)->pt() >= 3.00 )
+        if (KillOverlapStubs::getFirstTP(p.first)->pt() >= 3.00 )
           ++numOfWrongHighPtStubs;
-        if (killOverlapStubs_.getFirstTP(p.second)->pt() >= 3.00 )
+        if (KillOverlapStubs::getFirstTP(p.second)->pt() >= 3.00 )
           ++numOfWrongHighPtStubs;
       }
-    his_z0_cut_StubsInTrueFoundPairs  -> Fill( z0_cut, numOfTrueFoundStubs );
-    his_z0_cut_StubsInWrongFoundPairs -> Fill( z0_cut, numOfWrongHighPtStubs );
+    buffer_.fill(his_z0_cut_StubsInTrueFoundPairs, z0_cut, numOfTrueFoundStubs );
+    buffer_.fill(his_z0_cut_StubsInWrongFoundPairs, z0_cut, numOfWrongHighPtStubs );
 
     // find the number of stubs in all true pairs
     size_t numOfTrueStubs = depair(true_pairs).size();
-    his_z0_cut_StubsInAllTruePairs -> Fill( z0_cut, numOfTrueStubs );
+    buffer_.fill(his_z0_cut_StubsInAllTruePairs, z0_cut, numOfTrueStubs );
   }
 }
 
@@ -0,0 +1,89 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/HistoBuffer.h"
+
+#include <TH1F.h>
+#include <TH2F.h>
+#include <TProfile.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+atomic<unsigned long> HistoBuffer::lastId_(0);
+
+//=== Get buffer of calling thread, creating it if needed.
+
+vector<HistoBuffer::Entry>& HistoBuffer::localBuffer() {
+  // Cache the buffer of this thread, to avoid locking on every fill.
+  // (Keyed on instance id, not address, which could be reused by a new instance after this one is deleted).
+  thread_local unsigned long  owner  = 0;
+  thread_local vector<Entry>* buffer = nullptr;
+  if (owner != id_) {
+    lock_guard<mutex> lock(mutex_);
+    unique_ptr<vector<Entry> >& buf = buffers_[this_thread::get_id()];
+    if (buf == nullptr) {
+      buf.reset(new vector<Entry>);
+      buf->reserve(flushSize_);
+    }
+    owner  = id_;
+    buffer = buf.get();
+  }
+  return *buffer;
+}
+
+//=== Get index of bin label in labels_, adding it if needed.
+
+unsigned int HistoBuffer::labelIndex(const string& label) {
+  lock_guard<mutex> lock(mutex_);
+  for (unsigned int i = 0; i < labels_.size(); i++) {
+    if (labels_[i] == label) return i;
+  }
+  labels_.push_back(label);
+  return labels_.size() - 1;
+}
+
+//=== Called at end of each event. Flushes buffer of calling thread if it is full.
+
+void HistoBuffer::endEvent() {
+  vector<Entry>& buffer = this->localBuffer();
+  if (buffer.size() >= flushSize_) {
+    lock_guard<mutex> lock(mutex_);
+    this->flush(buffer);
+  }
+}
+
+//=== Flush the buffers of all threads into the histograms.
+
+void HistoBuffer::flushAll() {
+  lock_guard<mutex> lock(mutex_);
+  for (auto& buf : buffers_) this->flush(*(buf.second));
+}
+
+//=== Copy buffer contents into the ROOT histograms & empty it.
+
+void HistoBuffer::flush(vector<Entry>& buffer) {
+  if (buffer.empty()) return;
+
+  auto t0 = chrono::steady_clock::now();
+
+  for (const Entry& e : buffer) {
+    switch (e.kind) {
+      case H1:      static_cast<TH1F*>    (e.his)->Fill(e.x,      e.w); break;
+      case H2:      static_cast<TH2F*>    (e.his)->Fill(e.x, e.y, e.w); break;
+      case Profile: static_cast<TProfile*>(e.his)->Fill(e.x, e.y, e.w); break;
+      case H1Label: static_cast<TH1F*>    (e.his)->Fill(labels_[size_t(e.x)].c_str(), e.w); break;
+    }
+  }
+
+  numFlushes_++;
+  numEntries_ += buffer.size();
+  flushTime_  += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+  buffer.clear();
+}
+
+//=== Print number of entries buffered & time spent filling the ROOT histograms.
+
+void HistoBuffer::printStats() const {
+  lock_guard<mutex> lock(mutex_);
+  cout<<"Histogram buffers: "<<numEntries_<<" fills from "<<buffers_.size()<<" thread(s), flushed in "<<numFlushes_<<" bulk updates taking "<<flushTime_<<" s"<<endl;
+}
@@ -7,6 +7,7 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/TrkRZfilter.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrk4and5.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DupTrkMerger.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Utility.h"
 
 #include "DataFormats/Math/interface/deltaPhi.h"
@@ -21,6 +22,7 @@
 #include <algorithm>
 #include <array>
 #include <unordered_set>
+#include <iomanip>
 
 using namespace std;
 
@@ -29,20 +31,62 @@ using namespace std;
 void Histos::book() {
   TH1::SetDefaultSumw2(true);
 
-  // Book histograms about various topics.
-  this->bookInputData();
+  // Book cheap monitoring histograms, which are always made.
+  this->bookMonitoring();
+
+  // Book histograms about various topics, if requested.
+  if (settings_->histInputData())     this->bookInputData();
   // Book histograms for testing the stub-pair algorithm
-  this->bookStubPairs();
+  if (settings_->histStubPairs())     this->bookStubPairs();
   // Book histograms checking if (eta,phi) sector definition choices are good.
-  this->bookEtaPhiSectors();
+  if (settings_->histEtaPhiSectors()) this->bookEtaPhiSectors();
   // Book histograms checking filling of r-phi HT array.
-  this->bookRphiHT();
+  if (settings_->histRphiHT())        this->bookRphiHT();
   // Book histograms about r-z track filters (or other filters applied after r-phi HT array).
-  this->bookRZfilters();
+  if (settings_->histRZfilters())     this->bookRZfilters();
   // Book histograms studying track candidates found by Hough Transform.
-  this->bookTrackCands();
+  if (settings_->histTrackCands())    this->bookTrackCands();
   // Book histograms studying track fitting performance
-  this->bookTrackFitting();
+  if (settings_->histTrackFitting())  this->bookTrackFitting();
+}
+
+//=== Book cheap monitoring histograms of numbers of stubs, TPs & tracks per event.
+
+void Histos::bookMonitoring() {
+  TFileDirectory inputDir = fs_->mkdir("Monitoring");
+
+  const vector<string>& fitters = settings_->trackFitters();
+  const unsigned int nBins = 3 + fitters.size();
+  profMonitoring_ = inputDir.make<TProfile>("Monitoring", ";; Mean number per event", nBins, 0.5, nBins + 0.5);
+  profMonitoring_->GetXaxis()->SetBinLabel(1, "Stubs");
+  profMonitoring_->GetXaxis()->SetBinLabel(2, "TPs");
+  profMonitoring_->GetXaxis()->SetBinLabel(3, "HT track cands");
+  for (unsigned int i = 0; i < fitters.size(); i++) {
+    profMonitoring_->GetXaxis()->SetBinLabel(4 + i, (fitters[i] + " tracks").c_str());
+  }
+}
+
+//=== Print summary of monitoring histograms.
+
+void Histos::printMonitoring() const {
+  const vector<string>& fitters = settings_->trackFitters();
+  cout<<"=========================================================================="<<endl;
+  cout<<"                        MONITORING (per event)                            "<<endl;
+  cout<<"Number of stubs = "<<profMonitoring_->GetBinContent(1)<<" ; TPs = "<<profMonitoring_->GetBinContent(2)<<" ; HT track candidates = "<<profMonitoring_->GetBinContent(3)<<endl;
+  for (unsigned int i = 0; i < fitters.size(); i++) {
+    cout<<"Number of tracks accepted by "<<fitters[i]<<" = "<<profMonitoring_->GetBinContent(4 + i)<<endl;
+  }
+  cout<<"=========================================================================="<<endl;
+}
+
+//=== Print wall-clock time spent on each group of histograms, including the calculations needed to fill them.
+
+void Histos::printGroupTiming() const {
+  const char* groupNames[numHistGroups] = {"Monitoring", "InputData", "StubPairs", "EtaPhiSectors", "RphiHT", "RZfilters", "TrackCands", "StudyBusyEvents", "TrackFitting"};
+  cout<<endl<<"Wall-clock time spent filling histogram groups (s), including supporting calculations:"<<endl;
+  for (unsigned int i = 0; i < numHistGroups; i++) {
+    cout<<"  "<<setw(16)<<left<<groupNames[i]<<right<<groupTime_[i]<<endl;
+  }
 }
 
 //=== Book histograms using input stubs and tracking particles.
@@ -115,8 +159,20 @@ void Histos::fillInputData(const InputData& inputData) {
   const vector<const Stub*>& vStubs = inputData.getStubs();
   const vector<TP>&          vTPs   = inputData.getTPs();
 
+  {
+    GroupTimer timer(groupTime_[grpMonitoring]);
+    buffer_.fill(profMonitoring_, 1, vStubs.size());
+    buffer_.fill(profMonitoring_, 2, vTPs.size());
+  }
+
   // Fill histograms relating the stub-pairs algorithm
-  this->fillStubPairs(vStubs);
+  if (settings_->histStubPairs()) {
+    GroupTimer timer(groupTime_[grpStubPairs]);
+    this->fillStubPairs(inputData.getOverlapPairs());
+  }
+
+  if (! settings_->histInputData()) return;
+  GroupTimer timer(groupTime_[grpInputData]);
 
   // Count stubs.
   unsigned int nStubsGenuine = 0;
@@ -131,14 +187,14 @@ void Histos::fillInputData(const InputData& inputData) {
       }
     }
   }
-  profNumStubs_->Fill(1, vStubs.size());
-  profNumStubs_->Fill(2, nStubsGenuine);
-  profNumStubs_->Fill(3, nStubsWithTP);
-  profNumStubs_->Fill(4, nStubsWithTPforEff);
+  buffer_.fill(profNumStubs_, 1, vStubs.size());
+  buffer_.fill(profNumStubs_, 2, nStubsGenuine);
+  buffer_.fill(profNumStubs_, 3, nStubsWithTP);
+  buffer_.fill(profNumStubs_, 4, nStubsWithTPforEff);
 
   for (const Stub* stub : vStubs) {
-    hisStubsVsEta_->Fill(stub->eta());
-    hisStubsVsR_->Fill(stub->r());    
+    buffer_.fill(hisStubsVsEta_, stub->eta());
+    buffer_.fill(hisStubsVsR_, stub->r());    
   }
 
   // Count tracking particles.
@@ -148,20 +204,20 @@ void Histos::fillInputData(const InputData& inputData) {
     if (tp.useForEff())  nTPforEff++; 
     if (tp.useForAlgEff()) nTPforAlgEff++; 
   }
-  profNumTPs_->Fill(1, vTPs.size());
-  profNumTPs_->Fill(2, nTPforEff);
-  profNumTPs_->Fill(3, nTPforAlgEff);
+  buffer_.fill(profNumTPs_, 1, vTPs.size());
+  buffer_.fill(profNumTPs_, 2, nTPforEff);
+  buffer_.fill(profNumTPs_, 3, nTPforAlgEff);
 
   // Study efficiency of stubs to pass front-end electronics cuts.
 
   const vector<Stub>& vAllStubs = inputData.getAllStubs(); // Get all stubs prior to FE cuts to do this.
-  for (const Stub s : vAllStubs) {
+  for (const Stub& s : vAllStubs) {
     unsigned int layerOrTenPlusRing = s.barrel()  ?  s.layerId()  :  10 + s.endcapRing(); 
     // Fraction of all stubs (good and bad) failing tightened front-end electronics cuts.
-    hisStubKillFE_->Fill(layerOrTenPlusRing, (! s.frontendPass()));
+    buffer_.fill(hisStubKillFE_, layerOrTenPlusRing, (! s.frontendPass()));
     // Fraction of stubs rejected by window cut in DataCorrection.h
     // If it is non-zero, then encoding in DataCorrection.h should ideally be changed to make it zero.
-    hisStubKillDataCorr_->Fill(layerOrTenPlusRing, s.stubFailedDataCorrWindow());
+    buffer_.fill(hisStubKillDataCorr_, layerOrTenPlusRing, s.stubFailedDataCorrWindow());
   }
 
   // Study efficiency for good stubs of tightened front end-electronics cuts.
@@ -169,69 +225,69 @@ void Histos::fillInputData(const InputData& inputData) {
     if (tp.useForAlgEff()) {// Only bother for stubs that are on TP that we have a chance of reconstructing.
       const vector<const Stub*> stubs = tp.assocStubs();
       for (const Stub* s : stubs) {
-        hisStubIneffiVsInvPt_->Fill(1./tp.pt()    , (! s->frontendPass()) );
-        hisStubIneffiVsEta_->Fill  (fabs(tp.eta()), (! s->frontendPass()) );
+        buffer_.fill(hisStubIneffiVsInvPt_, 1./tp.pt()    , (! s->frontendPass()) );
+        buffer_.fill(hisStubIneffiVsEta_, fabs(tp.eta()), (! s->frontendPass()) );
       }
     }
   }
 
   // Plot stub bend-derived information.
   for (const Stub* stub : vStubs) {
-    hisPtStub_->Fill(stub->qOverPt()); 
-    hisDelPhiStub_->Fill(stub->dphi()); 
-    hisBendStub_->Fill(stub->dphi() / stub->dphiOverBend());
+    buffer_.fill(hisPtStub_, stub->qOverPt()); 
+    buffer_.fill(hisDelPhiStub_, stub->dphi()); 
+    buffer_.fill(hisBendStub_, stub->dphi() / stub->dphiOverBend());
     // Number of bend values merged together by loss of a bit.
-    hisNumMergedBend_->Fill(stub->numMergedBend()); 
+    buffer_.fill(hisNumMergedBend_, stub->numMergedBend()); 
     // Min. & max allowed q/Pt obtained from stub bend.
     float minQoverPt = max(float(-1./(settings_->houghMinPt())), stub->qOverPt() - stub->qOverPtres());  
     float maxQoverPt = min(float(1./(settings_->houghMinPt())), stub->qOverPt() + stub->qOverPtres());  
     // Frac. of full q/Pt range allowed by stub bend.
     float fracAllowed = (maxQoverPt - minQoverPt)/(2./(settings_->houghMinPt()));
-    hisBendFilterPower_->Fill(fracAllowed);
+    buffer_.fill(hisBendFilterPower_, fracAllowed);
     unsigned int layerOrTenPlusRing = stub->barrel()  ?  stub->layerId()  :  10 + stub->endcapRing(); 
-    hisBendVsLayerOrRing_->Fill(layerOrTenPlusRing, stub->bend());
+    buffer_.fill(hisBendVsLayerOrRing_, layerOrTenPlusRing, stub->bend());
     // Also plot bend prior to degradation.
-    hisBendFEVsLayerOrRing_->Fill(layerOrTenPlusRing, stub->bendInFrontend());
+    buffer_.fill(hisBendFEVsLayerOrRing_, layerOrTenPlusRing, stub->bendInFrontend());
   }
 
   // Look at stub resolution.
   for (const TP& tp: vTPs) {
     if (tp.useForAlgEff()) {
       const vector<const Stub*>& assStubs= tp.assocStubs();
-      hisNumStubsPerTP_->Fill( assStubs.size() );
+      buffer_.fill(hisNumStubsPerTP_, assStubs.size() );
       //cout<<"=== TP === : index="<<tp.index()<<" pt="<<tp.pt()<<" q="<<tp.charge()<<" phi="<<tp.phi0()<<" eta="<<tp.eta()<<" z0="<<tp.z0()<<endl;
       for (const Stub* stub: assStubs) {
         //cout<<"    stub : index="<<stub->index()<<" barrel="<<stub->barrel()<<" r="<<stub->r()<<" phi="<<stub->phi()<<" z="<<stub->z()<<" bend="<<stub->bend()<<" assocTP="<<stub->assocTP()->index()<<endl; 
-        hisPtResStub_->Fill(stub->qOverPt() - tp.charge()/tp.pt()); 
-        hisDelPhiResStub_->Fill(stub->dphi() - tp.dphi(stub->r())); 
-        hisBendResStub_->Fill( (stub->dphi() - tp.dphi(stub->r())) / stub->dphiOverBend() ); 
+        buffer_.fill(hisPtResStub_, stub->qOverPt() - tp.charge()/tp.pt()); 
+        buffer_.fill(hisDelPhiResStub_, stub->dphi() - tp.dphi(stub->r())); 
+        buffer_.fill(hisBendResStub_, (stub->dphi() - tp.dphi(stub->r())) / stub->dphiOverBend() ); 
 	// This checks if the TP multiple scattered before producing the stub or hit resolution effects.
-        hisPhiStubVsPhiTP_->Fill( reco::deltaPhi(stub->phi(), tp.trkPhiAtStub( stub )) );
+        buffer_.fill(hisPhiStubVsPhiTP_, reco::deltaPhi(stub->phi(), tp.trkPhiAtStub( stub )) );
 	// This checks how wide overlap must be if using phi0 sectors, with no stub bend info used for assignment.
-        hisPhiStubVsPhi0TP_->Fill( reco::deltaPhi(stub->phi(), tp.phi0()) );
+        buffer_.fill(hisPhiStubVsPhi0TP_, reco::deltaPhi(stub->phi(), tp.phi0()) );
 	// This checks how wide overlap must be if using phi0 sectors, with stub bend info used for assignment
-        hisPhi0StubVsPhi0TP_->Fill( reco::deltaPhi(stub->trkPhiAtR(0.).first, tp.phi0()) );
+        buffer_.fill(hisPhi0StubVsPhi0TP_, reco::deltaPhi(stub->trkPhiAtR(0.).first, tp.phi0()) );
 	// This normalizes the previous distribution to the predicted resolution to check if the latter is OK.
-        hisPhi0StubVsPhi0TPres_->Fill( reco::deltaPhi(stub->trkPhiAtR(0.).first, tp.phi0()) / stub->trkPhiAtRres(0.));
+        buffer_.fill(hisPhi0StubVsPhi0TPres_, reco::deltaPhi(stub->trkPhiAtR(0.).first, tp.phi0()) / stub->trkPhiAtRres(0.));
 	// This checks how wide overlap must be if using phi65 sectors, with no stub bend info used for assignment.
-        hisPhiStubVsPhi65TP_->Fill( reco::deltaPhi(stub->phi(), tp.trkPhiAtR(65.)) );
+        buffer_.fill(hisPhiStubVsPhi65TP_, reco::deltaPhi(stub->phi(), tp.trkPhiAtR(65.)) );
 	// This checks how wide overlap must be if using phi65 sectors, with stub bend info used for assignment, optionally reducing discrepancy by uncertainty expected from 2S module strip length.
 	pair<float, float> phiAndErr = stub->trkPhiAtR(65.);
 	double dPhi = reco::deltaPhi( phiAndErr.first, tp.trkPhiAtR(65.));
-        hisPhi65StubVsPhi65TP_->Fill( dPhi );
+        buffer_.fill(hisPhi65StubVsPhi65TP_, dPhi );
 	// This normalizes the previous distribution to the predicted resolution to check if the latter is OK.
-        hisPhi65StubVsPhi65TPres_->Fill( dPhi / stub->trkPhiAtRres(65.));
+        buffer_.fill(hisPhi65StubVsPhi65TPres_, dPhi / stub->trkPhiAtRres(65.));
       }
     }
   }
 
   for (const Stub* stub : vStubs) {
     // Note ratio of sensor pitch to separation (needed to understand how many bits this can be packed into).
-    hisPitchOverSep_->Fill(stub->pitchOverSep());
+    buffer_.fill(hisPitchOverSep_, stub->pitchOverSep());
     // Also note this same quantity times 1.0 in the barrel or z/r in the endcap. This product is known as "rho".
     float rho = stub->pitchOverSep();
     if ( ! stub->barrel() ) rho *= fabs(stub->z())/stub->r();
-    hisRhoParameter_->Fill(rho);
+    buffer_.fill(hisRhoParameter_, rho);
   }
 
   // Check fraction of stubs sharing a common cluster.
@@ -253,9 +309,9 @@ void Histos::fillInputData(const InputData& inputData) {
       if (it->second != 1) nShare += it->second; // 2 or more stubs share a cluster at this detid*strip.
     }
     if (iClus == 0) {
-      hisFracStubsSharingClus0_->Fill(float(nShare)/float(vStubs.size()));
+      buffer_.fill(hisFracStubsSharingClus0_, float(nShare)/float(vStubs.size()));
     } else {
-      hisFracStubsSharingClus1_->Fill(float(nShare)/float(vStubs.size()));
+      buffer_.fill(hisFracStubsSharingClus1_, float(nShare)/float(vStubs.size()));
     }
   }
 }
@@ -292,6 +348,9 @@ void Histos::bookEtaPhiSectors() {
 
 void Histos::fillEtaPhiSectors(const InputData& inputData, const matrix<Sector>& mSectors) {
 
+  if (! settings_->histEtaPhiSectors()) return;
+  GroupTimer timer(groupTime_[grpEtaPhiSectors]);
+
   const vector<const Stub*>&  vStubs = inputData.getStubs();
   const vector<TP>&           vTPs   = inputData.getTPs();
 
@@ -311,24 +370,21 @@ void Histos::fillEtaPhiSectors(const InputData& inputData, const matrix<Sector>&
       for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
 	for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
 
-	  const Sector& sector = mSectors(iPhiSec, iEtaReg);
-
           // Count number of stubs in given tracking particle which are inside this (phi,eta) sector;
           // or inside it if only the eta cuts are applied; or inside it if only the phi cuts are applied.
-	  unsigned int nStubsInSec, nStubsInEtaSec, nStubsInPhiSec;
-          sector.numStubsInside( tp, nStubsInSec, nStubsInEtaSec, nStubsInPhiSec);
+	  const NumStubsInSec& nStubsIn = this->numStubsInside(vTPs, mSectors, tp, iPhiSec, iEtaReg);
 
 	  // Note best results obtained in any sector.
-          nStubsInBestSec    = max( nStubsInBestSec,    nStubsInSec);
-          nStubsInBestEtaSec = max( nStubsInBestEtaSec, nStubsInEtaSec);
-          nStubsInBestPhiSec = max( nStubsInBestPhiSec, nStubsInPhiSec);
+          nStubsInBestSec    = max( nStubsInBestSec,    nStubsIn.etaPhi);
+          nStubsInBestEtaSec = max( nStubsInBestEtaSec, nStubsIn.eta);
+          nStubsInBestPhiSec = max( nStubsInBestPhiSec, nStubsIn.phi);
 	}
       }
 
       // Plot fraction of stubs on each TP in its best sector.
-      hisFracStubsInSec_->Fill   ( float(nStubsInBestSec)    / float(nStubs) );
-      hisFracStubsInEtaSec_->Fill( float(nStubsInBestEtaSec) / float(nStubs) );
-      hisFracStubsInPhiSec_->Fill( float(nStubsInBestPhiSec) / float(nStubs) );
+      buffer_.fill(hisFracStubsInSec_, float(nStubsInBestSec)    / float(nStubs) );
+      buffer_.fill(hisFracStubsInEtaSec_, float(nStubsInBestEtaSec) / float(nStubs) );
+      buffer_.fill(hisFracStubsInPhiSec_, float(nStubsInBestPhiSec) / float(nStubs) );
     }
   }
 
@@ -360,8 +416,8 @@ void Histos::fillEtaPhiSectors(const InputData& inputData, const matrix<Sector>&
 	    if (assocTP->useForAlgEff()) {
 	      unsigned int lay = stub->layerId();
 	      if (lay > 20) lay -= 10; // Don't bother distinguishing two endcaps.
-	      hisLayerIDvsEtaSec_->Fill(iEtaReg, lay);
-	      hisLayerIDreducedvsEtaSec_->Fill(iEtaReg, stub->layerIdReduced()); // Plot also simplified layerID for hardware, which tries to avoid more than 8 ID in any given eta region.
+	      buffer_.fill(hisLayerIDvsEtaSec_, iEtaReg, lay);
+	      buffer_.fill(hisLayerIDreducedvsEtaSec_, iEtaReg, stub->layerIdReduced()); // Plot also simplified layerID for hardware, which tries to avoid more than 8 ID in any given eta region.
 	    }
 	  }
 	}
@@ -369,9 +425,9 @@ void Histos::fillEtaPhiSectors(const InputData& inputData, const matrix<Sector>&
     }
 
     // Plot number of sectors each stub appears in.
-    hisNumSecsPerStub_->Fill   ( nSecs );
-    hisNumEtaSecsPerStub_->Fill( nEtaSecs );
-    hisNumPhiSecsPerStub_->Fill( nPhiSecs );
+    buffer_.fill(hisNumSecsPerStub_, nSecs );
+    buffer_.fill(hisNumEtaSecsPerStub_, nEtaSecs );
+    buffer_.fill(hisNumPhiSecsPerStub_, nPhiSecs );
     if (nEtaSecs > 2)  throw cms::Exception("Histos ERROR: Stub assigned to more than 2 eta regions. Please redefine eta regions to avoid this!")<<" stub r="<<stub->r()<<" eta="<<stub->eta()<<endl;
   }
 
@@ -385,10 +441,10 @@ void Histos::fillEtaPhiSectors(const InputData& inputData, const matrix<Sector>&
       for (const Stub* stub : vStubs) {
 	if ( sector.inside( stub ) )  nStubs++;
       }
-      hisNumStubsPerSec_->Fill(nStubs);
+      buffer_.fill(hisNumStubsPerSec_, nStubs);
       nStubsInEtaSec += nStubs;
     }
-    profNumStubsPerEtaSec_->Fill(iEtaReg, nStubsInEtaSec);
+    buffer_.fill(profNumStubsPerEtaSec_, iEtaReg, nStubsInEtaSec);
   }
 }
 
@@ -410,6 +466,9 @@ void Histos::bookRphiHT() {
 
 void Histos::fillRphiHT(const matrix<HTpair>& mHtPairs) {
 
+  if (! settings_->histRphiHT()) return;
+  GroupTimer timer(groupTime_[grpRphiHT]);
+
   //--- Loop over (eta,phi) sectors, counting the number of stubs in the HT array of each.
  
   for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
@@ -418,9 +477,9 @@ void Histos::fillRphiHT(const matrix<HTpair>& mHtPairs) {
       const HTrphi& htRphi = htPair.getRphiHT();
 
       // Here, if a stub appears in multiple cells, it is counted multiple times.
-      hisIncStubsPerHT_->Fill( htRphi.numStubsInc() );
+      buffer_.fill(hisIncStubsPerHT_, htRphi.numStubsInc() );
       // Here, if a stub appears in multiple cells, it is counted only once.
-      hisExcStubsPerHT_->Fill( htRphi.numStubsExc() );
+      buffer_.fill(hisExcStubsPerHT_, htRphi.numStubsExc() );
     }
   }
 
@@ -446,7 +505,7 @@ void Histos::fillRphiHT(const matrix<HTpair>& mHtPairs) {
           nStubsInCellPhiSum += rphiHTcells(m,n).numStubs();
         }  
 	// Plot total number of stubs in this cell, summed over all phi sectors.
-        hisNumStubsInCellVsEta_->Fill( nStubsInCellPhiSum, iEtaReg );
+        buffer_.fill(hisNumStubsInCellVsEta_, nStubsInCellPhiSum, iEtaReg );
       }
     }
   }
@@ -457,7 +516,7 @@ void Histos::fillRphiHT(const matrix<HTpair>& mHtPairs) {
     for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
       const HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
       const HTrphi& htRphi = htPair.getRphiHT();
-      hisStubsOnRphiTracksPerHT_->Fill(htRphi.numStubsOnTrackCands2D()); 
+      buffer_.fill(hisStubsOnRphiTracksPerHT_, htRphi.numStubsOnTrackCands2D()); 
     }
   }
 }
@@ -494,6 +553,9 @@ void Histos::bookRZfilters() {
 
 void Histos::fillRZfilters(const matrix<HTpair>& mHtPairs) {
 
+  if (! settings_->histRZfilters()) return;
+  GroupTimer timer(groupTime_[grpRZfilters]);
+
   // Only fill histograms if one of the r-z filters was in use.
   if (settings_->useZTrkFilter() || settings_->useSeedFilter()) {
 
@@ -505,7 +567,7 @@ void Histos::fillRZfilters(const matrix<HTpair>& mHtPairs) {
 	  // Check number of track seeds per sector that r-z "Ztrk" filter checked.
 	  const vector<unsigned int>  numSeedComb = htPair.getRZfilters().numZtrkSeedCombsPerTrk();
 	  for (const unsigned int& num : numSeedComb) {
-	    hisNumZtrkSeedCombinations_->Fill(num) ;
+	    buffer_.fill(hisNumZtrkSeedCombinations_, num) ;
 	  }
 	}
 
@@ -513,12 +575,12 @@ void Histos::fillRZfilters(const matrix<HTpair>& mHtPairs) {
 	  // Check number of track seeds per sector that r-z "seed" filter checked.
 	  const vector<unsigned int>  numSeedComb = htPair.getRZfilters().numSeedCombsPerTrk();
 	  for (const unsigned int& num : numSeedComb) {
-	    hisNumSeedCombinations_->Fill(num) ;
+	    buffer_.fill(hisNumSeedCombinations_, num) ;
 	  }
 	  // Same again, but this time only considering seeds the r-z filters defined as "good".
 	  const vector<unsigned int>  numGoodSeedComb = htPair.getRZfilters().numGoodSeedCombsPerTrk();
 	  for (const unsigned int& num : numGoodSeedComb) {
-	    hisNumGoodSeedCombinations_->Fill(num) ;
+	    buffer_.fill(hisNumGoodSeedCombinations_, num) ;
 	  }
 	}
 	
@@ -546,7 +608,7 @@ void Histos::fillRZfilters(const matrix<HTpair>& mHtPairs) {
 			}
 			sum = (sum/100) - s->zTrk()*s2->zTrk();
 			r = sum/(s->zTrkRes()*s2->zTrkRes());
-			hisCorrelationZTrk_->Fill(r);
+			buffer_.fill(hisCorrelationZTrk_, r);
 		      }
 		    }
 		  }
@@ -565,7 +627,7 @@ void Histos::fillRZfilters(const matrix<HTpair>& mHtPairs) {
 void Histos::bookTrackCands() {
 
   // Book histograms for studying freak, extra large events.
-  this->bookStudyBusyEvents();
+  if (settings_->histStudyBusyEvents()) this->bookStudyBusyEvents();
 
   // Now book histograms for studying tracking in general.
 
@@ -665,9 +727,24 @@ void Histos::bookTrackCands() {
 
 void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mSectors, const matrix<HTpair>& mHtPairs) {
 
+  {
+    GroupTimer timer(groupTime_[grpMonitoring]);
+    unsigned int nTrackCands = 0;
+    for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
+      for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
+        nTrackCands += mHtPairs(iPhiSec, iEtaReg).trackCands3D().size();
+      }
+    }
+    buffer_.fill(profMonitoring_, 3, nTrackCands);
+  }
+
+  if (! settings_->histTrackCands()) return;
+
   // Fill histograms for studying freak, extra large events.
   this->fillStudyBusyEvents(inputData, mSectors, mHtPairs);
 
+  GroupTimer timer(groupTime_[grpTrackCands]);
+
   // Now fill histograms for studying tracking in general.
 
   const vector<TP>&  vTPs = inputData.getTPs();
@@ -684,9 +761,9 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
       if (settings_->debug() == 1 && htPair.numTrackCands3D() > 0) cout<<"Sector ("<<iPhiSec<<","<<iEtaReg<<") has ntracks = "<<htPair.numTrackCands3D()<<endl;
     }
     nTracks += nTracksInEtaReg;
-    profNumTracksVsEta_->Fill(iEtaReg, nTracksInEtaReg);
+    buffer_.fill(profNumTracksVsEta_, iEtaReg, nTracksInEtaReg);
   }
-  profNumTrackCands_->Fill(1.0, nTracks); // Plot mean number of tracks/event.
+  buffer_.fill(profNumTrackCands_, 1.0, nTracks); // Plot mean number of tracks/event.
 
   cout<<"NTRACKS = "<<nTracks<<endl;
 
@@ -697,13 +774,13 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
     unsigned int nStubsOnTracksInEtaReg = 0;
     for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
       const HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
-      hisStubsOnTracksPerSect_->Fill(htPair.numStubsOnTrackCands3D()); // Number of stubs assigned to tracks in this sector.
+      buffer_.fill(hisStubsOnTracksPerSect_, htPair.numStubsOnTrackCands3D()); // Number of stubs assigned to tracks in this sector.
       nStubsOnTracksInEtaReg += htPair.numStubsOnTrackCands3D();
     }
     nStubsOnTracks += nStubsOnTracksInEtaReg;
-    profStubsOnTracksVsEta_->Fill(iEtaReg, nStubsOnTracksInEtaReg);
+    buffer_.fill(profStubsOnTracksVsEta_, iEtaReg, nStubsOnTracksInEtaReg);
   }
-  profStubsOnTracks_->Fill(1.0, nStubsOnTracks);
+  buffer_.fill(profStubsOnTracks_, 1.0, nStubsOnTracks);
 
   // Plot q/pt spectrum of track candidates, and number of stubs/track.
   for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
@@ -712,15 +789,15 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
       // Loop over all reconstructed tracks in this sector
       const vector<L1track3D>& vecTrk3D = htPair.trackCands3D();
       for (const L1track3D& trk : vecTrk3D) {
-	hisNumTracksVsQoverPt_->Fill(trk.qOverPt()); // Plot reconstructed q/Pt of track cands.
-	hisStubsPerTrack_->Fill(trk.getNumStubs());  // Stubs per track.
+	buffer_.fill(hisNumTracksVsQoverPt_, trk.qOverPt()); // Plot reconstructed q/Pt of track cands.
+	buffer_.fill(hisStubsPerTrack_, trk.getNumStubs());  // Stubs per track.
 	// For genuine tracks, check how often they have too many stubs to be stored in cell memory. (Perhaps worse for high Pt particles in jets?).
 	const TP* tp = trk.getMatchedTP();
 	if (tp != nullptr) {
-	  if (tp->useForAlgEff()) profExcessStubsPerTrackVsPt_->Fill(1./tp->pt(), trk.getNumStubs() > 16);
+	  if (tp->useForAlgEff()) buffer_.fill(profExcessStubsPerTrackVsPt_, 1./tp->pt(), trk.getNumStubs() > 16);
 	}
-	hisLayersPerTrack_->Fill(trk.getNumLayers()); // Number of reduced layers with stubs per track.
-	hisPSLayersPerTrack_->Fill( Utility::countLayers(settings_, trk.getStubs(), false, true) ); // Number of reduced PS layers with stubs per track.
+	buffer_.fill(hisLayersPerTrack_, trk.getNumLayers()); // Number of reduced layers with stubs per track.
+	buffer_.fill(hisPSLayersPerTrack_, Utility::countLayers(settings_, trk.getStubs(), false, true) ); // Number of reduced PS layers with stubs per track.
       }
     }
   }  
@@ -737,7 +814,7 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
 	const TP* tp = trk.getMatchedTP();
 	if (tp != nullptr) {
 	  if (tp->useForAlgEff()) {
-            hisFracMatchStubsOnTracks_->Fill( trk.getPurity() );
+            buffer_.fill(hisFracMatchStubsOnTracks_, trk.getPurity() );
             const vector<const Stub*> stubs = trk.getStubs();
             for (const Stub* s : stubs) {
 	      // Was this stub produced by correct truth particle?
@@ -763,15 +840,15 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
 
 	      if (trueStub) {
   	        if (s->psModule()) {
-		  hisDeltaPhiRtruePS_->Fill(deltaPhiR);
-		  hisDeltaRorZtruePS_->Fill(deltaRorZ);
+		  buffer_.fill(hisDeltaPhiRtruePS_, deltaPhiR);
+		  buffer_.fill(hisDeltaRorZtruePS_, deltaRorZ);
 		} else {
 		  //if (tp->pt() > 20. && s->assocTP() != nullptr && fabs(tp->d0()) < 0.01) {
 		    //		    if ( ! (s->barrel()) ) cout<<"RATS "<<s->width()<<" "<<s->iphi()<<" "<<s->nstrip()<<" "<<s->r()<<" "<<s->z()<<endl;
 		    //if ( ! (s->barrel()) ) cout<<"DELTAPHI "<<stripAngle<<" "<<(tp->trkRAtStub(s) - s->r())<<" "<<phiCorr<<" : "<<deltaPhiR<<" "<<deltaPhiR1<<" "<<deltaPhiR2<<endl;
 		  //}
-		  hisDeltaPhiRtrue2S_->Fill(deltaPhiR);
-		  hisDeltaRorZtrue2S_->Fill(deltaRorZ);
+		  buffer_.fill(hisDeltaPhiRtrue2S_, deltaPhiR);
+		  buffer_.fill(hisDeltaRorZtrue2S_, deltaRorZ);
 		}
 		// More detailed plots for true stubs to study effect of multiple scattering.
 		float sigPerp = s->sigmaPerp(); // detector resolution
@@ -779,27 +856,27 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
 		float relpos = s->barrel()  ?   s->r() / settings_->trackerOuterRadius()  :  fabs(s->z()) / settings_->trackerHalfLength();
                 float sigmaScat = 0.01 * (ptThresh/tp->pt()) * pow(relpos, 1.5);
 		sigPerp += sigmaScat; // Estimated resolution allowing for scattering.
-		profNsigmaPhiRvsInvPt_->Fill(1./tp->pt(), fabs(deltaPhiR)/sigPerp);
-		profNsigmaPhiRvsFracDist_->Fill(relpos,   fabs(deltaPhiR)/sigPerp);
+		buffer_.fill(profNsigmaPhiRvsInvPt_, 1./tp->pt(), fabs(deltaPhiR)/sigPerp);
+		buffer_.fill(profNsigmaPhiRvsFracDist_, relpos,   fabs(deltaPhiR)/sigPerp);
 	      } else {
 		if (s->psModule()) {
-		  hisDeltaPhiRfakePS_->Fill(deltaPhiR);
-		  hisDeltaRorZfakePS_->Fill(deltaRorZ);
+		  buffer_.fill(hisDeltaPhiRfakePS_, deltaPhiR);
+		  buffer_.fill(hisDeltaRorZfakePS_, deltaRorZ);
 		} else {
-		  hisDeltaPhiRfake2S_->Fill(deltaPhiR);
-		  hisDeltaRorZfake2S_->Fill(deltaRorZ);
+		  buffer_.fill(hisDeltaPhiRfake2S_, deltaPhiR);
+		  buffer_.fill(hisDeltaRorZfake2S_, deltaRorZ);
 		}
 	      }
 
 	      // Fraction of wrong stubs vs. tracker layer.
-	      profFracTrueStubsVsLayer_->Fill(s->layerId(), trueStub);
+	      buffer_.fill(profFracTrueStubsVsLayer_, s->layerId(), trueStub);
 
 	      // Check how much stub bend differs from predicted one, relative to nominal bend resolution.
 	      float diffBend = (s->qOverPt() - trk.qOverPt()) / s->qOverPtOverBend();
 	      if (trueStub) {
-		hisDeltaBendTrue_->Fill(diffBend/s->bendRes());
+		buffer_.fill(hisDeltaBendTrue_, diffBend/s->bendRes());
 	      } else {
-		hisDeltaBendFake_->Fill(diffBend/s->bendRes());
+		buffer_.fill(hisDeltaBendFake_, diffBend/s->bendRes());
 	      }
 
 	      // Debug printout to understand for matched tracks, how far stubs lie from true particle trajectory
@@ -858,7 +935,7 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
           nSecsMatchingTPs += 1;      // Increment sum by no. of sectors this TP was reconstructed in
   	  nTrksMatchingTPs += nTrk; // Increment sum by no. of tracks this TP was reconstructed as
 	  nTrksMatchingTPsIgnoringRzDups += nCellsRphi; // Ditto, but if TP reconstructed in multiple cells of r-z HT, just count them as 1.
-          profDupTracksVsTPeta_->Fill(tp.eta(), nTrk); // Study duplication of tracks within an individual HT array.
+          buffer_.fill(profDupTracksVsTPeta_, tp.eta(), nTrk); // Study duplication of tracks within an individual HT array.
         }
       }
       if (tpRecoedInEtaSec) nEtaSecsMatchingTPs++; // Increment each time TP found in an eta sector.
@@ -874,17 +951,17 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
   //--- Plot mean number of tracks/event, counting number due to different kinds of duplicates
 
   // Plot number of TPs used for the efficiency measurement that are reconstructed. 
-  profNumTrackCands_->Fill(7.0, nRecoedTPsForEff);
+  buffer_.fill(profNumTrackCands_, 7.0, nRecoedTPsForEff);
   // Plot number of TPs that are reconstructed. 
-  profNumTrackCands_->Fill(6.0, nRecoedTPs);
+  buffer_.fill(profNumTrackCands_, 6.0, nRecoedTPs);
   // Plot number of TPs that are reconstructed. (Count +1 for each eta sector they are reconstructed in).
-  profNumTrackCands_->Fill(5.0, nEtaSecsMatchingTPs);
+  buffer_.fill(profNumTrackCands_, 5.0, nEtaSecsMatchingTPs);
   // Plot number of TPs that are reconstructed. (Count +1 for each etaxphisector they are reconstructed in).
-  profNumTrackCands_->Fill(4.0, nSecsMatchingTPs);
+  buffer_.fill(profNumTrackCands_, 4.0, nSecsMatchingTPs);
   // Plot number of TP that are reconstructed. (Ditto, but now multiplying by duplicate cells in r-phi HT).
-  profNumTrackCands_->Fill(3.0, nTrksMatchingTPsIgnoringRzDups);
+  buffer_.fill(profNumTrackCands_, 3.0, nTrksMatchingTPsIgnoringRzDups);
   // Plot number of TP that are reconstructed. (Ditto, but now multiplying by duplicate cells in r-phi x r-z HTs).
-  profNumTrackCands_->Fill(2.0, nTrksMatchingTPs);
+  buffer_.fill(profNumTrackCands_, 2.0, nTrksMatchingTPs);
 
   //=== Study tracking efficiency by looping over tracking particles.
 
@@ -893,17 +970,17 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
     if (tp.useForEff()) { // Check TP is good for efficiency measurement.
 
       // Plot kinematics of all good TP.
-      hisTPinvptForEff_->Fill(1./tp.pt());
-      hisTPetaForEff_->Fill(tp.eta());
-      hisTPphiForEff_->Fill(tp.phi0());
+      buffer_.fill(hisTPinvptForEff_, 1./tp.pt());
+      buffer_.fill(hisTPetaForEff_, tp.eta());
+      buffer_.fill(hisTPphiForEff_, tp.phi0());
 
       if (tp.useForAlgEff()) { // Check TP is good for algorithmic efficiency measurement.
-        hisTPinvptForAlgEff_->Fill(1./tp.pt());
-        hisTPetaForAlgEff_->Fill(tp.eta());
-        hisTPphiForAlgEff_->Fill(tp.phi0());
+        buffer_.fill(hisTPinvptForAlgEff_, 1./tp.pt());
+        buffer_.fill(hisTPetaForAlgEff_, tp.eta());
+        buffer_.fill(hisTPphiForAlgEff_, tp.phi0());
 	// Plot also production point of all good TP.
-        hisTPd0ForAlgEff_->Fill(fabs(tp.d0()));
-        hisTPz0ForAlgEff_->Fill(fabs(tp.z0()));
+        buffer_.fill(hisTPd0ForAlgEff_, fabs(tp.d0()));
+        buffer_.fill(hisTPz0ForAlgEff_, fabs(tp.z0()));
       }
 
       // Check if this TP was reconstructed anywhere in the tracker..
@@ -928,20 +1005,20 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
 
       // If TP was reconstucted by HT, then plot its kinematics.
       if (tpRecoed) {
-	hisRecoTPinvptForEff_->Fill(1./tp.pt());
-	hisRecoTPetaForEff_->Fill(tp.eta());
-	hisRecoTPphiForEff_->Fill(tp.phi0());
+	buffer_.fill(hisRecoTPinvptForEff_, 1./tp.pt());
+	buffer_.fill(hisRecoTPetaForEff_, tp.eta());
+	buffer_.fill(hisRecoTPphiForEff_, tp.phi0());
 	// Also plot efficiency to perfectly reconstruct the track (no fake hits)
-	if (tpRecoedPerfect) hisPerfRecoTPinvptForEff_->Fill(1./tp.pt());
+	if (tpRecoedPerfect) buffer_.fill(hisPerfRecoTPinvptForEff_, 1./tp.pt());
 	if (tp.useForAlgEff()) { // Check TP is good for algorithmic efficiency measurement.
-	  hisRecoTPinvptForAlgEff_->Fill(1./tp.pt());
-	  hisRecoTPetaForAlgEff_->Fill(tp.eta());
-	  hisRecoTPphiForAlgEff_->Fill(tp.phi0());
+	  buffer_.fill(hisRecoTPinvptForAlgEff_, 1./tp.pt());
+	  buffer_.fill(hisRecoTPetaForAlgEff_, tp.eta());
+	  buffer_.fill(hisRecoTPphiForAlgEff_, tp.phi0());
 	  // Plot also production point of all good reconstructed TP.
-	  hisRecoTPd0ForAlgEff_->Fill(fabs(tp.d0()));
-	  hisRecoTPz0ForAlgEff_->Fill(fabs(tp.z0()));
+	  buffer_.fill(hisRecoTPd0ForAlgEff_, fabs(tp.d0()));
+	  buffer_.fill(hisRecoTPz0ForAlgEff_, fabs(tp.z0()));
 	  // Also plot efficiency to perfectly reconstruct the track (no fake hits)
-	  if (tpRecoedPerfect) hisPerfRecoTPinvptForAlgEff_->Fill(1./tp.pt());
+	  if (tpRecoedPerfect) buffer_.fill(hisPerfRecoTPinvptForAlgEff_, 1./tp.pt());
 	}
       }
     }
@@ -959,10 +1036,10 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
 	  const HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
   	  const vector<const L1track3D*> trkVec = htPair.assocTrackCands3D( tp );
 	  for (const L1track3D* trk : trkVec) {
-	    hisQoverPtRes_->Fill(trk->qOverPt() - tp.qOverPt());
-	    hisPhi0Res_->Fill(reco::deltaPhi(trk->phi0(), tp.phi0()));
-	    hisEtaRes_->Fill(trk->eta() - tp.eta());
-	    hisZ0Res_->Fill(trk->z0() - tp.z0());
+	    buffer_.fill(hisQoverPtRes_, trk->qOverPt() - tp.qOverPt());
+	    buffer_.fill(hisPhi0Res_, reco::deltaPhi(trk->phi0(), tp.phi0()));
+	    buffer_.fill(hisEtaRes_, trk->eta() - tp.eta());
+	    buffer_.fill(hisZ0Res_, trk->z0() - tp.z0());
           }
 	}
       }
@@ -972,10 +1049,31 @@ void Histos::fillTrackCands(const InputData& inputData, const matrix<Sector>& mS
   // Diagnose reason why not all viable tracking particles were reconstructed.
   const map<const TP*, string> diagnosis = this->diagnoseTracking(inputData, mSectors, mHtPairs);
   for (const auto& iter: diagnosis) {
-    hisRecoFailureReason_->Fill(iter.second.c_str(), 1.); // Stores flag indicating failure reason.
+    buffer_.fill(hisRecoFailureReason_, iter.second.c_str(), 1.); // Stores flag indicating failure reason.
   }
 }
 
+//=== Get number of stubs on given tracking particle inside given sector; or inside it if only the eta cuts are applied;
+//=== or inside it if only the phi cuts are applied. Several fill functions need these for every TP & sector,
+//=== so they are calculated once per event & TP.
+
+const Histos::NumStubsInSec& Histos::numStubsInside(const vector<TP>& vTPs, const matrix<Sector>& mSectors, const TP& tp, unsigned int iPhiSec, unsigned int iEtaReg) {
+  const unsigned int numEtaRegions = settings_->numEtaRegions();
+  const unsigned int numSecs       = settings_->numPhiSectors() * numEtaRegions;
+  if (numStubsInSec_.empty()) numStubsInSec_.resize(vTPs.size() * numSecs, NumStubsInSec{(unsigned int)(-1), 0, 0});
+
+  NumStubsInSec* tpNumStubsInSec = &numStubsInSec_[tp.index() * numSecs];
+  if (tpNumStubsInSec->etaPhi == (unsigned int)(-1)) {
+    for (unsigned int jPhiSec = 0; jPhiSec < settings_->numPhiSectors(); jPhiSec++) {
+      for (unsigned int jEtaReg = 0; jEtaReg < numEtaRegions; jEtaReg++) {
+	NumStubsInSec& n = tpNumStubsInSec[jPhiSec * numEtaRegions + jEtaReg];
+	mSectors(jPhiSec, jEtaReg).numStubsInside(tp, n.etaPhi, n.eta, n.phi);
+      }
+    }
+  }
+  return tpNumStubsInSec[iPhiSec * numEtaRegions + iEtaReg];
+}
+
 //=== Understand why not all tracking particles were reconstructed.
 //=== Returns list of tracking particles that were not reconstructed and an string indicating why.
 //=== Only considers TP used for algorithmic efficiency measurement.
@@ -1238,6 +1336,9 @@ void Histos::bookStudyBusyEvents() {
 
 void Histos::fillStudyBusyEvents(const InputData& inputData, const matrix<Sector>& mSectors, const matrix<HTpair>& mHtPairs) {
 
+  if (! settings_->histStudyBusyEvents()) return;
+  GroupTimer timer(groupTime_[grpStudyBusyEvents]);
+
   const unsigned int numStubsCut = settings_->busySectorNumStubs();   // No. of stubs per HT array the hardware can output.
   const bool         eachCharge  = settings_->busySectorEachCharge(); // +ve & -ve tracks output on separate optical links?
 
@@ -1265,12 +1366,12 @@ void Histos::fillStudyBusyEvents(const InputData& inputData, const matrix<Sector
 	  nStubsIn++;
 	  // Plot fraction of input stubs that would be killed by 36BX period.
 	  bool kill = (nStubsIn > numStubsCut);
-	  profFracStubsKilledVsEtaReg_->Fill(iEtaReg, kill); 
+	  buffer_.fill(profFracStubsKilledVsEtaReg_, iEtaReg, kill); 
 	}
       }
       bool tooBusyIn = (nStubsIn > numStubsCut);      
       if (tooBusyIn) nBusySecIn++;
-      profFracBusyInVsEtaReg_->Fill(iEtaReg, tooBusyIn); // Sector had too many input stubs.
+      buffer_.fill(profFracBusyInVsEtaReg_, iEtaReg, tooBusyIn); // Sector had too many input stubs.
  
       //--- Look for too many stubs assigned to output tracks.
 
@@ -1310,8 +1411,8 @@ void Histos::fillStudyBusyEvents(const InputData& inputData, const matrix<Sector
 
 	if (kill) tooBusyOut = true; // Note that some tracks were killed in this sector.
 
-	profFracTracksKilledVsEtaReg_->Fill(iEtaReg, kill); 
-	profFracTracksKilledVsInvPt_->Fill(ptInv, kill); 
+	buffer_.fill(profFracTracksKilledVsEtaReg_, iEtaReg, kill); 
+	buffer_.fill(profFracTracksKilledVsInvPt_, ptInv, kill); 
 
 	// Form a map of all tracks in the entire tracker & also just in this sector, with a flag indicating if they were killed as in a busy sector.
 	trksInEntireTracker[trk] = kill;
@@ -1319,7 +1420,7 @@ void Histos::fillStudyBusyEvents(const InputData& inputData, const matrix<Sector
       }
 
       if (tooBusyOut) nBusySecOut++;
-      profFracBusyOutVsEtaReg_->Fill(iEtaReg, tooBusyOut); // Sector had too many output stubs.
+      buffer_.fill(profFracBusyOutVsEtaReg_, iEtaReg, tooBusyOut); // Sector had too many output stubs.
 
       //--- Compare properties of sectors with/without too many output stubs.
 
@@ -1329,20 +1430,20 @@ void Histos::fillStudyBusyEvents(const InputData& inputData, const matrix<Sector
       for (const string& tn : tnames) {
 	if ((tn == "BusyOutSec" && tooBusyOut) || (tn == "QuietOutSec" && (! tooBusyOut))) {
 
-	  hisNumInputStubs_[tn]->Fill(nStubsIn);
+	  buffer_.fill(hisNumInputStubs_[tn], nStubsIn);
 
 	  // Check if q/Pt estimated from stub bend differs in busy & quiet sectors.
           for (const Stub* stub : vStubs) {
-    	    if ( sector.inside( stub ) ) hisQoverPtInputStubs_[tn]->Fill(abs(stub->qOverPt()));
+    	    if ( sector.inside( stub ) ) buffer_.fill(hisQoverPtInputStubs_[tn], abs(stub->qOverPt()));
           }
 
 	  // Look at reconstructed tracks in this sector.
-	  hisNumOutputStubs_[tn]->Fill(nStubsOut);
-	  hisNumTracks_[tn]->Fill(tracks.size());
+	  buffer_.fill(hisNumOutputStubs_[tn], nStubsOut);
+	  buffer_.fill(hisNumTracks_[tn], tracks.size());
 	  for (const L1track3D& trk : tracks) {
-	    hisNumStubsPerTrack_[tn]->Fill(trk.getNumStubs());
-	    hisTrackQoverPt_[tn]->Fill(trk.qOverPt());
-	    hisTrackPurity_[tn]->Fill(trk.getPurity());
+	    buffer_.fill(hisNumStubsPerTrack_[tn], trk.getNumStubs());
+	    buffer_.fill(hisTrackQoverPt_[tn], trk.qOverPt());
+	    buffer_.fill(hisTrackPurity_[tn], trk.getPurity());
 	  }
 
 	  // Look at truth particles in this sector.
@@ -1351,8 +1452,7 @@ void Histos::fillStudyBusyEvents(const InputData& inputData, const matrix<Sector
 	  float sumPt_TP_physics = 0.;
 	  float sumPt_TP_pileup  = 0.;
 	  for (const TP& tp : vTPs) {
-	    unsigned int nStubsInsideEtaPhi, nStubsInsideEta, nStubsInsidePhi;
-	    sector.numStubsInside( tp, nStubsInsideEtaPhi, nStubsInsideEta, nStubsInsidePhi);
+	    unsigned int nStubsInsideEtaPhi = this->numStubsInside(vTPs, mSectors, tp, iPhiSec, iEtaReg).etaPhi;
 	    bool tpInSector = (nStubsInsideEtaPhi >= settings_->genMinStubLayers()); // Define TP to be in this sector if it produces a good number of stubs in it.
 	    if (tpInSector) {
 	      if (tp.physicsCollision()) { // distinguish truth particles from physics collision vs from pileup.
@@ -1364,10 +1464,10 @@ void Histos::fillStudyBusyEvents(const InputData& inputData, const matrix<Sector
 	      }
 	    }
 	  }
-	  hisNumTPphysics_[tn]->Fill(num_TP_physics);
-	  hisNumTPpileup_[tn]->Fill(num_TP_pileup);
-	  hisSumPtTPphysics_[tn]->Fill(sumPt_TP_physics);
-	  hisSumPtTPpileup_[tn]->Fill(sumPt_TP_pileup);
+	  buffer_.fill(hisNumTPphysics_[tn], num_TP_physics);
+	  buffer_.fill(hisNumTPpileup_[tn], num_TP_pileup);
+	  buffer_.fill(hisSumPtTPphysics_[tn], sumPt_TP_physics);
+	  buffer_.fill(hisSumPtTPpileup_[tn], sumPt_TP_pileup);
 	}
       }
 
@@ -1392,13 +1492,13 @@ void Histos::fillStudyBusyEvents(const InputData& inputData, const matrix<Sector
 	    if (tpKilled) nTPkilled++;
 	  }
 	}
-	hisNumTPkilledBusySec_->Fill(nTPkilled);
+	buffer_.fill(hisNumTPkilledBusySec_, nTPkilled);
       }
     }
   }
 
-  hisNumBusySecsInPerEvent_->Fill(nBusySecIn); // No. of sectors per event with too many input stubs.
-  hisNumBusySecsOutPerEvent_->Fill(nBusySecOut); // No. of sectors per event with too many output stubs.
+  buffer_.fill(hisNumBusySecsInPerEvent_, nBusySecIn); // No. of sectors per event with too many input stubs.
+  buffer_.fill(hisNumBusySecsOutPerEvent_, nBusySecOut); // No. of sectors per event with too many output stubs.
 
   //--- Check loss in tracking efficiency caused by killing tracks in busy sectors.
 
@@ -1416,8 +1516,8 @@ void Histos::fillStudyBusyEvents(const InputData& inputData, const matrix<Sector
 	}
       }
       bool tpKilled = tpRecoed && ( ! tpRecoedSurvived );
-      profFracTPKilledVsEta_->Fill(fabs(tp.eta()), tpKilled);
-      profFracTPKilledVsInvPt_->Fill(fabs(tp.qOverPt()), tpKilled);
+      buffer_.fill(profFracTPKilledVsEta_, fabs(tp.eta()), tpKilled);
+      buffer_.fill(profFracTPKilledVsInvPt_, fabs(tp.qOverPt()), tpKilled);
     }
   }
 }
@@ -1442,7 +1542,9 @@ void Histos::bookTrackFitting() {
     hisSeedZ0_[fitName]     = inputDir.make<TH1F>(("SeedZ0_"+(fitName)).c_str(), "; seed z_{0}"   , 100, -25., 25. );
     hisSeedEta_[fitName]    = inputDir.make<TH1F>(("SeedEta_"+(fitName)).c_str(), "; seed #eta"    , 70, -3.5, 3.5 );
  
-    profNumFittedCands_[fitName] = inputDir.make<TProfile>(("NumFittedCands_"+(fitName)).c_str(), "; class; # of fitted tracks", 11, 0.5, 11.5, -0.5, 9.9e6);
+    profNumFittedCands_[fitName] = inputDir.make<TProfile>(("NumFittedCands_"+(fitName)).c_str(), "; class; # of fitted tracks", 13, 0.5, 13.5, -0.5, 9.9e6);
+    profNumFittedCands_[fitName]->GetXaxis()->SetBinLabel(13, "TP lost by removing dups in different sectors");
+    profNumFittedCands_[fitName]->GetXaxis()->SetBinLabel(12, "Fits avoided by removing dups in different sectors");
     profNumFittedCands_[fitName]->GetXaxis()->SetBinLabel(11, "Num tracks exc dups passing cut");
     profNumFittedCands_[fitName]->GetXaxis()->SetBinLabel(10, "Num tracks exc dups");
     profNumFittedCands_[fitName]->GetXaxis()->SetBinLabel(9, "Num rejected fake tracks");
@@ -1570,7 +1672,22 @@ void Histos::bookTrackFitting() {
 
 //=== Fill histograms for studying track fitting.
 
-void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std::pair<std::string,L1fittedTrack>>& mFittedTracks, float chi2dofCutPlots ) {  
+void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std::pair<std::string,L1fittedTrack>>& mFittedTracks, float chi2dofCutPlots, const DupTrkMerger& dupTrkMerger ) {  
+
+  {
+    GroupTimer timer(groupTime_[grpMonitoring]);
+    const vector<string>& fitters = settings_->trackFitters();
+    for (unsigned int i = 0; i < fitters.size(); i++) {
+      unsigned int nAccepted = 0;
+      for (const auto& fitTrk : mFittedTracks) {
+        if (fitTrk.first == fitters[i] && fitTrk.second.accepted()) nAccepted++;
+      }
+      buffer_.fill(profMonitoring_, 4 + i, nAccepted);
+    }
+  }
+
+  if (! settings_->histTrackFitting()) return;
+  GroupTimer timer(groupTime_[grpTrackFitting]);
  
   map<std::string,uint> nFittedTracks;
   map<std::string,uint> nStubsOnTrack;
@@ -1677,11 +1794,11 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
       nTracksGenuine[j] += 1;
       if (tp != nullptr) {
 	  nTracksGenuineTP[j] += 1;
-	  hisFitVsTrueQinvPtGenCand_[j]->Fill( htTrk.qOverPt(), fitTrk.qOverPt() );
-	  hisFitVsTruePhi0GenCand_[j]->Fill( htTrk.phi0(), fitTrk.phi0() );
-	  hisFitVsTrueD0GenCand_[j]->Fill( htTrk.d0(), fitTrk.d0() );
-	  hisFitVsTrueZ0GenCand_[j]->Fill( htTrk.z0(), fitTrk.z0() );
-	  hisFitVsTrueEtaGenCand_[j]->Fill( htTrk.eta(), fitTrk.eta() );
+	  buffer_.fill(hisFitVsTrueQinvPtGenCand_[j], htTrk.qOverPt(), fitTrk.qOverPt() );
+	  buffer_.fill(hisFitVsTruePhi0GenCand_[j], htTrk.phi0(), fitTrk.phi0() );
+	  buffer_.fill(hisFitVsTrueD0GenCand_[j], htTrk.d0(), fitTrk.d0() );
+	  buffer_.fill(hisFitVsTrueZ0GenCand_[j], htTrk.z0(), fitTrk.z0() );
+	  buffer_.fill(hisFitVsTrueEtaGenCand_[j], htTrk.eta(), fitTrk.eta() );
 	  
 	  if ( fitTrk.chi2dof() <= chi2dofCutPlots ){
 	    nTracksGenuinePass[j] += 1;
@@ -1689,14 +1806,14 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 
 	  // Check if chi2/NDF is well behaved for perfectly reconstructed tracks.
           if (fitTrk.getPurity() == 1.) {
-            profChi2DofVsInvPtPERF_[j]->Fill(fabs(tp->qOverPt()), sqrt(fitTrk.chi2dof()));
-	    profBigChi2DofVsInvPtPERF_[j]->Fill(fabs(tp->qOverPt()), (fitTrk.chi2dof() > 10));
+            buffer_.fill(profChi2DofVsInvPtPERF_[j], fabs(tp->qOverPt()), sqrt(fitTrk.chi2dof()));
+	    buffer_.fill(profBigChi2DofVsInvPtPERF_[j], fabs(tp->qOverPt()), (fitTrk.chi2dof() > 10));
 	    // Are high Pt tracks sensitive to d0 impact parameter?
 	    if (tp->pt() > 10.) {
               if (fitTrk.chi2dof() > 10.) {
-    	        hisD0TPBigChi2DofPERF_[j]->Fill(fabs(tp->d0()));
+    	        buffer_.fill(hisD0TPBigChi2DofPERF_[j], fabs(tp->d0()));
  	      } else {
-	        hisD0TPSmallChi2DofPERF_[j]->Fill(fabs(tp->d0()));
+	        buffer_.fill(hisD0TPSmallChi2DofPERF_[j], fabs(tp->d0()));
 	      }
 	    }
 	  }
@@ -1707,11 +1824,11 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 	  if ( fitTrk.chi2dof() > chi2dofCutPlots ){
 	    nTracksFakeCut[j] += 1;
 	  }
-	  hisFitVsTrueQinvPtFakeCand_[j]->Fill( htTrk.qOverPt(), fitTrk.qOverPt() );
-	  hisFitVsTruePhi0FakeCand_[j]->Fill( htTrk.phi0(), fitTrk.phi0() );
-	  hisFitVsTrueD0FakeCand_[j]->Fill( htTrk.d0(), fitTrk.d0() );
-	  hisFitVsTrueZ0FakeCand_[j]->Fill( htTrk.z0(), fitTrk.z0() );
-	  hisFitVsTrueEtaFakeCand_[j]->Fill( htTrk.eta(), fitTrk.eta() );
+	  buffer_.fill(hisFitVsTrueQinvPtFakeCand_[j], htTrk.qOverPt(), fitTrk.qOverPt() );
+	  buffer_.fill(hisFitVsTruePhi0FakeCand_[j], htTrk.phi0(), fitTrk.phi0() );
+	  buffer_.fill(hisFitVsTrueD0FakeCand_[j], htTrk.d0(), fitTrk.d0() );
+	  buffer_.fill(hisFitVsTrueZ0FakeCand_[j], htTrk.z0(), fitTrk.z0() );
+	  buffer_.fill(hisFitVsTrueEtaFakeCand_[j], htTrk.eta(), fitTrk.eta() );
 	}
     }
     else if ( !fitTrk.accepted() ) {
@@ -1728,55 +1845,55 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
     // --- Study effect of the track fitter killing stubs with large residuals.
     // Count stubs per track removed track by fit (because they had large residuals),
     // distinguishing those which were good stubs (matched the best TP).
-    hisNumStubsKilledByFit_[j]->Fill( fitTrk.getNumKilledStubs(), fitTrk.getNumKilledMatchedStubs() );  
+    buffer_.fill(hisNumStubsKilledByFit_[j], fitTrk.getNumKilledStubs(), fitTrk.getNumKilledMatchedStubs() );  
 
     // --- Study purity against number of stubs to augement track fitter killing stubs due to large residual study
-    hisNumStubsVsPurity_[j]->Fill( fitTrk.getNumStubs(), fitTrk.getPurity() );
+    buffer_.fill(hisNumStubsVsPurity_[j], fitTrk.getNumStubs(), fitTrk.getPurity() );
 
     // Old way before accepted Kalman came along. 
     /*unsigned int nLayers = Utility::countLayers( settings_, fitTrk.getStubs() ); // Count tracker layers with stubs
       bool minLayers = nLayers >= settings_->minStubLayers(); // Set minimum number of layers
       if (fitTrk.getL1track3D().pt() > settings_->minPtToReduceLayers()) minLayers = nLayers >= settings_->minStubLayers()-1;
-      profTrksKilledByFit_[j]->Fill(ibin, !minLayers);*/
-    profTrksKilledByFit_[j]->Fill(ibin, !fitTrk.accepted());
+      buffer_.fill(profTrksKilledByFit_[j], ibin, !minLayers);*/
+    buffer_.fill(profTrksKilledByFit_[j], ibin, !fitTrk.accepted());
 
-    hisNumFittingIterations_[j]->Fill( fitTrk.getL1track3D().getNumStubs() - fitTrk.getNumStubs() ); 
-    hisNumFittingIterationsVsPurity_[j]->Fill( fitTrk.getL1track3D().getNumStubs() - fitTrk.getNumStubs(), fitTrk.getPurity() ); 
-    if (fitTrk.accepted()) hisNumFittingIterationsVsPurityMatched_[j]->Fill( fitTrk.getL1track3D().getNumStubs() - fitTrk.getNumStubs(), fitTrk.getPurity() );
-    else hisNumFittingIterationsVsPurityUnmatched_[j]->Fill( fitTrk.getL1track3D().getNumStubs() - fitTrk.getNumStubs(), fitTrk.getPurity() );
+    buffer_.fill(hisNumFittingIterations_[j], fitTrk.getL1track3D().getNumStubs() - fitTrk.getNumStubs() ); 
+    buffer_.fill(hisNumFittingIterationsVsPurity_[j], fitTrk.getL1track3D().getNumStubs() - fitTrk.getNumStubs(), fitTrk.getPurity() ); 
+    if (fitTrk.accepted()) buffer_.fill(hisNumFittingIterationsVsPurityMatched_[j], fitTrk.getL1track3D().getNumStubs() - fitTrk.getNumStubs(), fitTrk.getPurity() );
+    else buffer_.fill(hisNumFittingIterationsVsPurityUnmatched_[j], fitTrk.getL1track3D().getNumStubs() - fitTrk.getNumStubs(), fitTrk.getPurity() );
 
     if ( !fitTrk.accepted() ) continue; // If a rejected track, do not make plots for these.
 
     // Fill fitted parameter histograms and histograms of seed parameters against fitted parameters
  
     // Seed track parameter distributions
-    hisSeedQinvPt_[j]->Fill( htTrk.qOverPt() );
-    hisSeedPhi0_[j]->Fill( htTrk.phi0() );
-    hisSeedD0_[j]->Fill( htTrk.d0() );
-    hisSeedZ0_[j]->Fill( htTrk.z0() );
-    hisSeedEta_[j]->Fill( htTrk.eta() );
+    buffer_.fill(hisSeedQinvPt_[j], htTrk.qOverPt() );
+    buffer_.fill(hisSeedPhi0_[j], htTrk.phi0() );
+    buffer_.fill(hisSeedD0_[j], htTrk.d0() );
+    buffer_.fill(hisSeedZ0_[j], htTrk.z0() );
+    buffer_.fill(hisSeedEta_[j], htTrk.eta() );
     // Fitted track parameter distributions & chi2, separately for tracks that do/do not match a truth particle
     if ( tp != nullptr){
  
-      hisFitQinvPtMatched_[j]->Fill( fitTrk.qOverPt() );
-      hisFitPhi0Matched_[j]->Fill( fitTrk.phi0() );
-      hisFitD0Matched_[j]->Fill( fitTrk.d0() );
-      hisFitZ0Matched_[j]->Fill( fitTrk.z0() );
-      hisFitEtaMatched_[j]->Fill( fitTrk.eta() );
+      buffer_.fill(hisFitQinvPtMatched_[j], fitTrk.qOverPt() );
+      buffer_.fill(hisFitPhi0Matched_[j], fitTrk.phi0() );
+      buffer_.fill(hisFitD0Matched_[j], fitTrk.d0() );
+      buffer_.fill(hisFitZ0Matched_[j], fitTrk.z0() );
+      buffer_.fill(hisFitEtaMatched_[j], fitTrk.eta() );
  
-      hisFitChi2Matched_[j]->Fill( fitTrk.chi2() );
-      hisFitChi2DofMatched_[j]->Fill( fitTrk.chi2dof() );
+      buffer_.fill(hisFitChi2Matched_[j], fitTrk.chi2() );
+      buffer_.fill(hisFitChi2DofMatched_[j], fitTrk.chi2dof() );
  
     } else {
  
-      hisFitQinvPtUnmatched_[j]->Fill( fitTrk.qOverPt() );
-      hisFitPhi0Unmatched_[j]->Fill( fitTrk.phi0() );
-      hisFitD0Unmatched_[j]->Fill( fitTrk.d0() );
-      hisFitZ0Unmatched_[j]->Fill( fitTrk.z0() );
-      hisFitEtaUnmatched_[j]->Fill( fitTrk.eta() );
+      buffer_.fill(hisFitQinvPtUnmatched_[j], fitTrk.qOverPt() );
+      buffer_.fill(hisFitPhi0Unmatched_[j], fitTrk.phi0() );
+      buffer_.fill(hisFitD0Unmatched_[j], fitTrk.d0() );
+      buffer_.fill(hisFitZ0Unmatched_[j], fitTrk.z0() );
+      buffer_.fill(hisFitEtaUnmatched_[j], fitTrk.eta() );
  
-      hisFitChi2Unmatched_[j]->Fill( fitTrk.chi2() );
-      hisFitChi2DofUnmatched_[j]->Fill( fitTrk.chi2dof() );
+      buffer_.fill(hisFitChi2Unmatched_[j], fitTrk.chi2() );
+      buffer_.fill(hisFitChi2DofUnmatched_[j], fitTrk.chi2dof() );
  
     }
        
@@ -1786,32 +1903,32 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
       // Do seperately for those with good/poor chi2.
       if ( fitTrk.chi2dof() <= chi2dofCutPlots ){
 	// Fitted vs True parameter distribution 2D plots
-	hisFitVsTrueQinvPtGoodChi2_[j]->Fill( tp->qOverPt(), fitTrk.qOverPt() );
-	hisFitVsTruePhi0GoodChi2_[j]->Fill( tp->phi0(), fitTrk.phi0( ));
-	hisFitVsTrueD0GoodChi2_[j]->Fill( tp->d0(), fitTrk.d0() );
-	hisFitVsTrueZ0GoodChi2_[j]->Fill( tp->z0(), fitTrk.z0() );
-	hisFitVsTrueEtaGoodChi2_[j]->Fill( tp->eta(), fitTrk.eta() );
+	buffer_.fill(hisFitVsTrueQinvPtGoodChi2_[j], tp->qOverPt(), fitTrk.qOverPt() );
+	buffer_.fill(hisFitVsTruePhi0GoodChi2_[j], tp->phi0(), fitTrk.phi0( ));
+	buffer_.fill(hisFitVsTrueD0GoodChi2_[j], tp->d0(), fitTrk.d0() );
+	buffer_.fill(hisFitVsTrueZ0GoodChi2_[j], tp->z0(), fitTrk.z0() );
+	buffer_.fill(hisFitVsTrueEtaGoodChi2_[j], tp->eta(), fitTrk.eta() );
 	// Residuals between fitted and true helix params as 1D plot.
-	hisFitQinvPtResGoodChi2_[j]->Fill( fitTrk.qOverPt() - tp->qOverPt());
-	hisFitPhi0ResGoodChi2_[j]->Fill( reco::deltaPhi(fitTrk.phi0(), tp->phi0()) );
-	hisFitD0ResGoodChi2_[j]->Fill( fitTrk.d0() - tp->d0() );
-	hisFitZ0ResGoodChi2_[j]->Fill( fitTrk.z0() - tp->z0() );
-	hisFitEtaResGoodChi2_[j]->Fill( fitTrk.eta() - tp->eta() );  
+	buffer_.fill(hisFitQinvPtResGoodChi2_[j], fitTrk.qOverPt() - tp->qOverPt());
+	buffer_.fill(hisFitPhi0ResGoodChi2_[j], reco::deltaPhi(fitTrk.phi0(), tp->phi0()) );
+	buffer_.fill(hisFitD0ResGoodChi2_[j], fitTrk.d0() - tp->d0() );
+	buffer_.fill(hisFitZ0ResGoodChi2_[j], fitTrk.z0() - tp->z0() );
+	buffer_.fill(hisFitEtaResGoodChi2_[j], fitTrk.eta() - tp->eta() );  
 	// Residuals between true and seed helix params as 1D plot.
-	hisTrueVsSeedQinvPtResGoodChi2_[j]->Fill( tp->qOverPt() - htTrk.qOverPt());
-	hisTrueVsSeedPhi0ResGoodChi2_[j]->Fill( reco::deltaPhi(tp->phi0(), htTrk.phi0()) );
-	hisTrueVsSeedD0ResGoodChi2_[j]->Fill( tp->d0() - htTrk.d0() );
-	hisTrueVsSeedZ0ResGoodChi2_[j]->Fill( tp->z0() - htTrk.z0() );
-	hisTrueVsSeedEtaResGoodChi2_[j]->Fill( tp->eta() - htTrk.eta() );  
+	buffer_.fill(hisTrueVsSeedQinvPtResGoodChi2_[j], tp->qOverPt() - htTrk.qOverPt());
+	buffer_.fill(hisTrueVsSeedPhi0ResGoodChi2_[j], reco::deltaPhi(tp->phi0(), htTrk.phi0()) );
+	buffer_.fill(hisTrueVsSeedD0ResGoodChi2_[j], tp->d0() - htTrk.d0() );
+	buffer_.fill(hisTrueVsSeedZ0ResGoodChi2_[j], tp->z0() - htTrk.z0() );
+	buffer_.fill(hisTrueVsSeedEtaResGoodChi2_[j], tp->eta() - htTrk.eta() );  
 
 	// Understand which matched tracks have good/bad chi2.
-	hisTrueEtaMatchedGoodChi2_[j]->Fill( tp->eta() );
-	hisStubPurityMatchedGoodChi2_[j]->Fill( fitTrk.getPurity() );
+	buffer_.fill(hisTrueEtaMatchedGoodChi2_[j], tp->eta() );
+	buffer_.fill(hisStubPurityMatchedGoodChi2_[j], fitTrk.getPurity() );
       } else {
  
 	// Plot rapidity of matched tracks with bad chi2.
-	hisTrueEtaMatchedBadChi2_[j]->Fill( tp->eta() );
-	hisStubPurityMatchedBadChi2_[j]->Fill( fitTrk.getPurity() );
+	buffer_.fill(hisTrueEtaMatchedBadChi2_[j], tp->eta() );
+	buffer_.fill(hisStubPurityMatchedBadChi2_[j], fitTrk.getPurity() );
 	if (fitTrk.getPurity() > 0.99) {    
 	  // These tracks have no bad hits. So why do they have bad chi2?
 	  /*
@@ -1826,43 +1943,45 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 
       // Plot helix parameter resolution against eta.
 
-      hisPtResVsTrueEta_[j]->Fill( std::abs(tp->eta()), std::abs( fitTrk.qOverPt() - tp->qOverPt() ) );
-      hisPhi0ResVsTrueEta_[j]->Fill( std::abs(tp->eta()), std::abs(reco::deltaPhi(fitTrk.phi0(), tp->phi0()) ) );
-      hisEtaResVsTrueEta_[j]->Fill( std::abs(tp->eta()), std::abs( fitTrk.eta() - tp->eta() ) );
-      hisZ0ResVsTrueEta_[j]->Fill( std::abs(tp->eta()), std::abs( fitTrk.z0() - tp->z0() ) );
-      hisD0ResVsTrueEta_[j]->Fill( std::abs(tp->eta()), std::abs( fitTrk.d0() - tp->d0() ) );
+      buffer_.fill(hisPtResVsTrueEta_[j], std::abs(tp->eta()), std::abs( fitTrk.qOverPt() - tp->qOverPt() ) );
+      buffer_.fill(hisPhi0ResVsTrueEta_[j], std::abs(tp->eta()), std::abs(reco::deltaPhi(fitTrk.phi0(), tp->phi0()) ) );
+      buffer_.fill(hisEtaResVsTrueEta_[j], std::abs(tp->eta()), std::abs( fitTrk.eta() - tp->eta() ) );
+      buffer_.fill(hisZ0ResVsTrueEta_[j], std::abs(tp->eta()), std::abs( fitTrk.z0() - tp->z0() ) );
+      buffer_.fill(hisD0ResVsTrueEta_[j], std::abs(tp->eta()), std::abs( fitTrk.d0() - tp->d0() ) );
 
-      hisPtResVsTruePt_[j]->Fill( std::abs(1/tp->qOverPt()), std::abs( fitTrk.qOverPt() - tp->qOverPt() ) );
-      hisPhi0ResVsTruePt_[j]->Fill( std::abs(1/tp->qOverPt()), std::abs(reco::deltaPhi(fitTrk.phi0(), tp->phi0()) ) );
-      hisEtaResVsTruePt_[j]->Fill( std::abs(1/tp->qOverPt()), std::abs( fitTrk.eta() - tp->eta() ) );
-      hisZ0ResVsTruePt_[j]->Fill( std::abs(1/tp->qOverPt()), std::abs( fitTrk.z0() - tp->z0() ) );
-      hisD0ResVsTruePt_[j]->Fill( std::abs(1/tp->qOverPt()), std::abs( fitTrk.d0() - tp->d0() ) );
+      buffer_.fill(hisPtResVsTruePt_[j], std::abs(1/tp->qOverPt()), std::abs( fitTrk.qOverPt() - tp->qOverPt() ) );
+      buffer_.fill(hisPhi0ResVsTruePt_[j], std::abs(1/tp->qOverPt()), std::abs(reco::deltaPhi(fitTrk.phi0(), tp->phi0()) ) );
+      buffer_.fill(hisEtaResVsTruePt_[j], std::abs(1/tp->qOverPt()), std::abs( fitTrk.eta() - tp->eta() ) );
+      buffer_.fill(hisZ0ResVsTruePt_[j], std::abs(1/tp->qOverPt()), std::abs( fitTrk.z0() - tp->z0() ) );
+      buffer_.fill(hisD0ResVsTruePt_[j], std::abs(1/tp->qOverPt()), std::abs( fitTrk.d0() - tp->d0() ) );
 
       // Plot chi^2 vs eta, and # stubs vs eta.
-      hisTrueFittedChiSquaredVsTrueEta_[j]->Fill( fitTrk.chi2(), fitTrk.getL1track3D().eta() );
-      hisTrueFittedChiSquaredDofVsTrueEta_[j]->Fill( fitTrk.chi2dof(), fitTrk.getL1track3D().eta() );
-      hisTrueFittedChiSquaredVsFittedEta_[j]->Fill( fitTrk.chi2(), fitTrk.eta() );
-      hisTrueFittedChiSquaredDofVsFittedEta_[j]->Fill( fitTrk.chi2dof(), fitTrk.eta() );
+      buffer_.fill(hisTrueFittedChiSquaredVsTrueEta_[j], fitTrk.chi2(), fitTrk.getL1track3D().eta() );
+      buffer_.fill(hisTrueFittedChiSquaredDofVsTrueEta_[j], fitTrk.chi2dof(), fitTrk.getL1track3D().eta() );
+      buffer_.fill(hisTrueFittedChiSquaredVsFittedEta_[j], fitTrk.chi2(), fitTrk.eta() );
+      buffer_.fill(hisTrueFittedChiSquaredDofVsFittedEta_[j], fitTrk.chi2dof(), fitTrk.eta() );
  
-      hisFittedChiSquaredFunctionOfStubs_[j]->Fill( fitTrk.getStubs().size(), fitTrk.chi2() );
-      hisFittedChiSquaredDofFunctionOfStubs_[j]->Fill( fitTrk.getStubs().size(), fitTrk.chi2dof() );
+      buffer_.fill(hisFittedChiSquaredFunctionOfStubs_[j], fitTrk.getStubs().size(), fitTrk.chi2() );
+      buffer_.fill(hisFittedChiSquaredDofFunctionOfStubs_[j], fitTrk.getStubs().size(), fitTrk.chi2dof() );
  
     }
   }
 
   for ( const string& fitterName : settings_->trackFitters() ){
 
-    profNumFittedCands_[fitterName]->Fill(1.0, nFittedTracks[fitterName]);
-    profNumFittedCands_[fitterName]->Fill(2.0, nStubsOnTrack[fitterName]);
-    profNumFittedCands_[fitterName]->Fill(3.0, nTracksGenuine[fitterName]);
-    profNumFittedCands_[fitterName]->Fill(4.0, nTracksGenuineTP[fitterName]);
-    profNumFittedCands_[fitterName]->Fill(5.0, nTracksGenuinePass[fitterName]);
-    profNumFittedCands_[fitterName]->Fill(6.0, nTracksFakeCut[fitterName]);
-    profNumFittedCands_[fitterName]->Fill(7.0, nTracksFake[fitterName]);
-    profNumFittedCands_[fitterName]->Fill(8.0, nRejectedTracks[fitterName]);
-    profNumFittedCands_[fitterName]->Fill(9.0, nRejectedFake[fitterName]);
-    profNumFittedCands_[fitterName]->Fill(10.0, nTracksExcDups[fitterName]);
-    profNumFittedCands_[fitterName]->Fill(11.0, nTracksExcDupsPass[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 1.0, nFittedTracks[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 2.0, nStubsOnTrack[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 3.0, nTracksGenuine[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 4.0, nTracksGenuineTP[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 5.0, nTracksGenuinePass[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 6.0, nTracksFakeCut[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 7.0, nTracksFake[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 8.0, nRejectedTracks[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 9.0, nRejectedFake[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 10.0, nTracksExcDups[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 11.0, nTracksExcDupsPass[fitterName]);
+    buffer_.fill(profNumFittedCands_[fitterName], 12.0, dupTrkMerger.numKilled());
+    buffer_.fill(profNumFittedCands_[fitterName], 13.0, dupTrkMerger.numTPsLost());
   }
 
   //=== Study tracking efficiency by looping over tracking particles.
@@ -1900,20 +2019,20 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 
 	// If TP was reconstucted by HT, then plot its kinematics.
 	if (tpRecoed) {
-	  hisFitTPinvptForEff_[fitName]->Fill(1./tp.pt());
-	  hisFitTPetaForEff_[fitName]->Fill(tp.eta());
-	  hisFitTPphiForEff_[fitName]->Fill(tp.phi0());
+	  buffer_.fill(hisFitTPinvptForEff_[fitName], 1./tp.pt());
+	  buffer_.fill(hisFitTPetaForEff_[fitName], tp.eta());
+	  buffer_.fill(hisFitTPphiForEff_[fitName], tp.phi0());
 	  // Also plot efficiency to perfectly reconstruct the track (no fake hits)
-	  if (tpRecoedPerfect) hisPerfFitTPinvptForEff_[fitName]->Fill(1./tp.pt());
+	  if (tpRecoedPerfect) buffer_.fill(hisPerfFitTPinvptForEff_[fitName], 1./tp.pt());
 	  if (tp.useForAlgEff()) { // Check TP is good for algorithmic efficiency measurement.
-	    hisFitTPinvptForAlgEff_[fitName]->Fill(1./tp.pt());
-	    hisFitTPetaForAlgEff_[fitName]->Fill(tp.eta());
-	    hisFitTPphiForAlgEff_[fitName]->Fill(tp.phi0());
+	    buffer_.fill(hisFitTPinvptForAlgEff_[fitName], 1./tp.pt());
+	    buffer_.fill(hisFitTPetaForAlgEff_[fitName], tp.eta());
+	    buffer_.fill(hisFitTPphiForAlgEff_[fitName], tp.phi0());
 	    // Plot also production point of all good reconstructed TP.
-	    hisFitTPd0ForAlgEff_[fitName]->Fill(fabs(tp.d0()));
-	    hisFitTPz0ForAlgEff_[fitName]->Fill(fabs(tp.z0()));
+	    buffer_.fill(hisFitTPd0ForAlgEff_[fitName], fabs(tp.d0()));
+	    buffer_.fill(hisFitTPz0ForAlgEff_[fitName], fabs(tp.z0()));
 	    // Also plot efficiency to perfectly reconstruct the track (no fake hits)
-	    if (tpRecoedPerfect) hisPerfFitTPinvptForAlgEff_[fitName]->Fill(1./tp.pt());
+	    if (tpRecoedPerfect) buffer_.fill(hisPerfFitTPinvptForAlgEff_[fitName], 1./tp.pt());
 	  }
 	}
       }
@@ -1995,11 +2114,57 @@ void Histos::plotTrackEffAfterFit(string fitName) {
 
 void Histos::endJobAnalysis() {
 
+  // Transfer any remaining buffered fills to the histograms, before using them.
+  buffer_.flushAll();
+  buffer_.printStats();
+
+  this->printMonitoring();
+
+  // Efficiency plots & summaries of tracking performance, which need the track candidate histograms.
+  if (settings_->histTrackCands()) this->printTrackingSummary();
+
+  // Check that stub filling was consistent with known limitations of firmware design.
+
+  cout<<endl<<"Max. |gradients| of stub lines in HT arrays are: r-phi = "<<HTrphi::maxLineGrad()<<", r-z = "<<HTrz::maxLineGrad()<<endl;
+
+  if (HTrphi::maxLineGrad() > 1. || HTrz::maxLineGrad() > 1.) {
+
+    cout<<"WARNING: Line |gradient| exceeds 1, which firmware will not be able to cope with! Please adjust HT array size to avoid this."<<endl;
+
+  } else if (HTrphi::fracErrorsTypeA() > 0. || HTrz::fracErrorsTypeA() > 0.) {
+
+    cout<<"WARNING: Despite line gradients being less than one, some fraction of HT columns have filled cells with no filled neighbours in W, SW or NW direction. Firmware will object to this! ";
+    cout<<"This fraction = "<<HTrphi::fracErrorsTypeA()<<" for r-phi HT & "<<HTrz::fracErrorsTypeA()<<" for r-z HT"<<endl; 
+
+  } else if (HTrphi::fracErrorsTypeB() > 0. || HTrz::fracErrorsTypeB() > 0.) {
+
+    cout<<"WARNING: Despite line gradients being less than one, some fraction of HT columns recorded individual stubs being added to more than two cells! Thomas firmware will object to this! "; 
+    cout<<"This fraction = "<<HTrphi::fracErrorsTypeB()<<" for r-phi HT & "<<HTrz::fracErrorsTypeB()<<" for r-z HT"<<endl;   
+  }
+
+  // Check for presence of common MC bug.
+
+  if (settings_->histInputData()) {
+    float meanShared = hisFracStubsSharingClus0_->GetMean();
+    if (meanShared > 0.01) cout<<endl<<"WARNING: You are using buggy MC. A fraction "<<meanShared<<" of stubs share clusters in the module seed sensor, which front-end electronics forbids."<<endl;
+  }
+
+  // Print wall-clock time spent on each group of histograms.
+  this->printGroupTiming();
+}
+
+//=== Produce plots of tracking efficiency & print summary of tracking performance, before & after track fit.
+
+void Histos::printTrackingSummary() {
+
+  // Fitted track histograms are only available if the TrackFitting group is enabled.
+  const vector<string> fitNames = settings_->histTrackFitting()  ?  settings_->trackFitters()  :  vector<string>();
+
   // Produce plots of tracking efficiency using track candidates found prior to track fit.
   this->plotTrackEfficiency();
 
   // Produce more plots of tracking efficiency using track candidates after track fit.
-  for (auto &fitName : settings_->trackFitters()) {
+  for (auto &fitName : fitNames) {
     this->plotTrackEffAfterFit(fitName);
   }
 
@@ -2034,7 +2199,7 @@ void Histos::endJobAnalysis() {
 
   //--- Print summary of track-finding performance after helix fit, for each track fitting algorithm used.
    
-  for (auto &fitName : settings_->trackFitters()) {
+  for (auto &fitName : fitNames) {
 
     float numFittedTracks = profNumFittedCands_[fitName]->GetBinContent(1); // mean fitted tracks/event, no chi2/ndf cut.
     float numStubsOnTrack = profNumFittedCands_[fitName]->GetBinContent(2); // Number of stubs passing chi2/ndf cut.
@@ -2101,28 +2266,4 @@ void Histos::endJobAnalysis() {
     }
     cout << "=========================================================================" << endl;
   }
-
-  // Check that stub filling was consistent with known limitations of firmware design.
-
-  cout<<endl<<"Max. |gradients| of stub lines in HT arrays are: r-phi = "<<HTrphi::maxLineGrad()<<", r-z = "<<HTrz::maxLineGrad()<<endl;
-
-  if (HTrphi::maxLineGrad() > 1. || HTrz::maxLineGrad() > 1.) {
-
-    cout<<"WARNING: Line |gradient| exceeds 1, which firmware will not be able to cope with! Please adjust HT array size to avoid this."<<endl;
-
-  } else if (HTrphi::fracErrorsTypeA() > 0. || HTrz::fracErrorsTypeA() > 0.) {
-
-    cout<<"WARNING: Despite line gradients being less than one, some fraction of HT columns have filled cells with no filled neighbours in W, SW or NW direction. Firmware will object to this! ";
-    cout<<"This fraction = "<<HTrphi::fracErrorsTypeA()<<" for r-phi HT & "<<HTrz::fracErrorsTypeA()<<" for r-z HT"<<endl; 
-
-  } else if (HTrphi::fracErrorsTypeB() > 0. || HTrz::fracErrorsTypeB() > 0.) {
-
-    cout<<"WARNING: Despite line gradients being less than one, some fraction of HT columns recorded individual stubs being added to more than two cells! Thomas firmware will object to this! "; 
-    cout<<"This fraction = "<<HTrphi::fracErrorsTypeB()<<" for r-phi HT & "<<HTrz::fracErrorsTypeB()<<" for r-z HT"<<endl;   
-  }
-
-  // Check for presence of common MC bug.
-
-  float meanShared = hisFracStubsSharingClus0_->GetMean();
-  if (meanShared > 0.01) cout<<endl<<"WARNING: You are using buggy MC. A fraction "<<meanShared<<" of stubs share clusters in the module seed sensor, which front-end electronics forbids."<<endl;
 }
@@ -16,12 +16,14 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/KillOverlapStubs.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleInfo.h"
 
 #include <map>
 
 using namespace std;
  
-InputData::InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Settings* settings) {
+InputData::InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Settings* settings, ModuleInfoCache* moduleInfoCache) {
 
   vTPs_.reserve(2500);
   vStubs_.reserve(35000);
@@ -72,14 +74,18 @@ InputData::InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Se
 
   unsigned int stubCount = 0;
   for (DetSetVec::const_iterator p_module = ttStubHandle->begin(); p_module != ttStubHandle->end(); p_module++) {
+    const ModuleInfo* moduleInfo = nullptr;
     for (DetSet::const_iterator p_ttstub = p_module->begin(); p_ttstub != p_module->end(); p_ttstub++) {
       TTStubRef ttStubRef = edmNew::makeRefTo(ttStubHandle, p_ttstub );
+      // Get info about this module (common to all its stubs) only once.
+      if (moduleInfo == nullptr) moduleInfo = moduleInfoCache->get(stackedGeometry, ttStubRef->getDetId());
       // Store the Stub info, using class Stub to provide easy access to the most useful info.
-      Stub stub(ttStubRef, stubCount, settings, stackedGeometry);
+      vStubCold_.emplace_back(settings);
+      Stub stub(ttStubRef, stubCount, settings, stackedGeometry, moduleInfo, &vStubCold_.back());
       // Also fill truth associating stubs to tracking particles.
       //      stub.fillTruth(vTPs_, mcTruthTTStubHandle, mcTruthTTClusterHandle); 
       stub.fillTruth(translateTP, mcTruthTTStubHandle, mcTruthTTClusterHandle); 
-      vAllStubs_.push_back( stub );
+      vAllStubs_.push_back( move(stub) );
       stubCount++;
     }
   }
@@ -91,9 +97,11 @@ InputData::InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Se
     if (s.frontendPass()) vStubs_out.push_back( &s );
   }
 
-  // Remove duplicates from overlap regions
+  // Remove duplicates from overlap regions (unless this is instead done within each sector).
   KillOverlapStubs killOverlapStubs_(vStubs_out, settings);
-  vStubs_ = killOverlapStubs_.getFiltered("settings");
+  vStubs_ = settings->overlapPerSector()  ?  vStubs_out  :  killOverlapStubs_.getFiltered();
+  // Keep pairs of stubs found, so they can be histogrammed without searching for them again.
+  if (settings->histStubPairs()) overlapPairs_ = killOverlapStubs_.getAllPairs();
 
   // Note list of stubs produced by each tracking particle.
 
@@ -104,3 +112,43 @@ InputData::InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Se
     vTPs_[j].fillTruth(vAllStubs_);
   }
 }
+
+//=== Unpack event from snapshot file, which already contains only the TPs that passed tp.use().
+
+InputData::InputData(const SnapshotEvent& snapEvent, Settings* settings, ModuleInfoCache* moduleInfoCache) {
+
+  const unsigned int numTPs   = snapEvent.header.numTPs;
+  const unsigned int numStubs = snapEvent.header.numStubs;
+
+  // Stubs point to the TPs, so both vectors must not be reallocated once filled.
+  vTPs_.reserve(numTPs);
+  vStubs_.reserve(numStubs);
+  vAllStubs_.reserve(numStubs);
+
+  for (unsigned int i = 0; i < numTPs; i++) {
+    vTPs_.push_back( TP(snapEvent.tps[i], i, settings) );
+  }
+
+  for (unsigned int i = 0; i < numStubs; i++) {
+    const SnapshotStub& snapStub = snapEvent.stubs[i];
+    vStubCold_.emplace_back(settings);
+    Stub stub(snapStub, i, settings, moduleInfoCache->get(snapStub), &vStubCold_.back());
+    stub.fillTruth(vTPs_, snapStub, snapEvent.tpLinks);
+    vAllStubs_.push_back( move(stub) );
+  }
+
+  // Remaining steps are as for the EDM input.
+  vector<const Stub*> vStubs_out;
+  for (const Stub& s : vAllStubs_) {
+    if (s.frontendPass()) vStubs_out.push_back( &s );
+  }
+
+  KillOverlapStubs killOverlapStubs_(vStubs_out, settings);
+  vStubs_ = settings->overlapPerSector()  ?  vStubs_out  :  killOverlapStubs_.getFiltered();
+  // Keep pairs of stubs found, so they can be histogrammed without searching for them again.
+  if (settings->histStubPairs()) overlapPairs_ = killOverlapStubs_.getAllPairs();
+
+  for (unsigned int j = 0; j < vTPs_.size(); j++) {
+    vTPs_[j].fillTruth(vAllStubs_);
+  }
+}
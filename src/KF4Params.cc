@@ -7,25 +7,6 @@
 KF4Params::KF4Params(const Settings* settings, const uint nPar) : L1Kalman(settings, nPar){
 }
  
-std::vector<double> KF4Params::mapToVec(std::map<std::string, double> x){
-    std::vector<double> y;
-    y.resize(4);
-    y[0] = x["rInv"];
-    y[1] = x["phi0"];
-    y[2] = x["z0"];
-    y[3] = x["t"];
-    return y;
-}
- 
-std::map<std::string, double> KF4Params::vecToMap(std::vector<double> x){
-    std::map<std::string, double> y;
-    y["rInv"] = x[0];
-    y["phi0"] = x[1];
-    y["z0"] = x[2];
-    y["t"] = x[3];
-    return y;
-}
- 
 Matrix<double> KF4Params::H(const Stub* stub){
     Matrix<double> h(2, 4, 0.0);
     h(0,0) = -stub->r();
@@ -36,12 +17,12 @@ Matrix<double> KF4Params::H(const Stub* stub){
 }
  
 std::vector<double> KF4Params::seedx(const L1track3D& l1track3D){
-    std::map<std::string, double> x;
-    x["rInv"] = getSettings()->invPtToInvR() * l1track3D.qOverPt()/2;
-    x["phi0"] = l1track3D.phi0();
-    x["z0"] = l1track3D.z0();
-    x["t"] = l1track3D.tanLambda();
-    return mapToVec(x);
+    std::vector<double> x(4);
+    x[INV2R] = getSettings()->invPtToInvR() * l1track3D.qOverPt()/2;
+    x[PHI0] = l1track3D.phi0();
+    x[Z0] = l1track3D.z0();
+    x[T] = l1track3D.tanLambda();
+    return x;
 }
  
 Matrix<double> KF4Params::seedP(const L1track3D& l1track3D){
@@ -81,13 +62,12 @@ Matrix<double> KF4Params::PxxModel(){
     return p;
 }
  
-std::map<std::string, double> KF4Params::convertParams(std::vector<double> x){
-    std::map<std::string, double> y = vecToMap(x);
-    std::map<std::string, double> z;
-    z["qOverPt"] = (2*y["rInv"]) / getSettings()->invPtToInvR();
-    z["phi0"] = y["phi0"];
-    z["z0"] = y["z0"];
-    z["t"] = y["t"];
+HelixParams KF4Params::convertParams(std::vector<double> x){
+    HelixParams z;
+    z.qOverPt = (2*x[INV2R]) / getSettings()->invPtToInvR();
+    z.phi0 = x[PHI0];
+    z.z0 = x[Z0];
+    z.tanLambda = x[T];
     return z;
 }
  
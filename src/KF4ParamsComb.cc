@@ -17,7 +17,9 @@ static double wrapRadian( double t ){
     return t;
 }
 
-KF4ParamsComb::KF4ParamsComb(const Settings* settings, const uint nPar, const string &fitterName ) : L1KalmanComb(settings, nPar, fitterName ){
+template class L1KalmanCombModel<KF4ParamsComb, 4>;
+
+KF4ParamsComb::KF4ParamsComb(const Settings* settings, const uint nPar, const string &fitterName ) : L1KalmanCombModel<KF4ParamsComb, 4>(settings, nPar, fitterName ){
 
     hdxmin[1] = -1.e-2;
     hdxmax[1] = +1.e-2;
@@ -62,41 +64,52 @@ KF4ParamsComb::KF4ParamsComb(const Settings* settings, const uint nPar, const st
     hxaxtmax[3] = +1.e-0;
 }
 
-std::map<std::string, double> KF4ParamsComb::getTrackParams(const kalmanState *state )const{
+HelixParams KF4ParamsComb::getTrackParams(const kalmanState *state )const{
 
-    std::vector<double> x = state->xa();
-    std::map<std::string, double> y;
-    y["qOverPt"] = x.at(INV2R) / getSettings()->invPtToInvR() * 2.; 
-    y["phi0"] = wrapRadian( x.at(PHI0) + sectorPhi() );
-    y["z0"] = x.at(Z0);
-    y["t"] = x.at(T);
-    y["d0"] = 0;
+    const std::vector<double> &x = state->xa();
+    HelixParams y;
+    y.qOverPt = x.at(INV2R) / getSettings()->invPtToInvR() * 2.; 
+    y.phi0 = wrapRadian( x.at(PHI0) + sectorPhi() );
+    y.z0 = x.at(Z0);
+    y.tanLambda = x.at(T);
+    y.d0 = 0;
     return y;
 }
  
 /* The Kalman measurement matrix
  * Here I always measure phi(r), and z(r) */
+void KF4ParamsComb::H(const Stub* stub, double h[2][4])const{
+    for(unsigned i = 0; i < 2; i++)
+	for(unsigned j = 0; j < 4; j++)
+	    h[i][j] = 0;
+    h[PHI][INV2R] = -stub->r();
+    h[PHI][PHI0] = 1;
+    h[Z][Z0] = 1;
+    h[Z][T] = stub->r();
+}
 TMatrixD KF4ParamsComb::H(const Stub* stub)const{
-    TMatrixD h(2, 4);
-    h(PHI,INV2R) = -stub->r();
-    h(PHI,PHI0) = 1;
-    h(Z,Z0) = 1;
-    h(Z,T) = stub->r();
-    return h;
+    double h[2][4];
+    H( stub, h );
+    return TMatrixD( 2, 4, &h[0][0] );
 }
 
-TMatrixD KF4ParamsComb::dH(const Stub* stub)const{
+void KF4ParamsComb::dH(const Stub* stub, double h[2][4])const{
 
     double dr(0);
     if(stub->layerId() > 10){
 	dr = stub->sigmaZ();
     }
 
-    TMatrixD h(2, 4);
-    h(PHI,INV2R) = -dr;
-    h(Z,T) = dr;
-
-    return h;
+    for(unsigned i = 0; i < 2; i++)
+	for(unsigned j = 0; j < 4; j++)
+	    h[i][j] = 0;
+    h[PHI][INV2R] = -dr;
+    h[Z][T] = dr;
+}
+TMatrixD KF4ParamsComb::dH(const Stub* stub)const{
+    double h[2][4];
+    dH( stub, h );
+    return TMatrixD( 2, 4, &h[0][0] );
 }
  
 /* Seed the state vector */
@@ -131,35 +144,41 @@ TMatrixD KF4ParamsComb::seedP(const L1track3D& l1track3D)const{
  
 /* The forecast matrix
  * (here equals identity matrix) */
-TMatrixD KF4ParamsComb::F(const Stub* stub, const kalmanState *state )const{
-    TMatrixD F(4,4);
+void KF4ParamsComb::F(const Stub* stub, const kalmanState *state, double f[4][4] )const{
     for(int n = 0; n < 4; n++)
-        F(n, n) = 1;
-    return F;
+	for(int m = 0; m < 4; m++)
+	    f[n][m] = ( n == m ) ? 1 : 0;
+}
+TMatrixD KF4ParamsComb::F(const Stub* stub, const kalmanState *state )const{
+    double f[4][4];
+    F( stub, state, f );
+    return TMatrixD( 4, 4, &f[0][0] );
 }
  
 /* the vector of measurements */
-std::vector<double> KF4ParamsComb::d(const Stub* stub )const{
-    std::vector<double> meas;
-    meas.resize(2);
+void KF4ParamsComb::d(const Stub* stub, double meas[2] )const{
     meas[0] = wrapRadian( stub->phi() - sectorPhi() );
     meas[1] = stub->z();
-    return meas;
+}
+std::vector<double> KF4ParamsComb::d(const Stub* stub )const{
+    double meas[2];
+    d( stub, meas );
+    return std::vector<double>( meas, meas + 2 );
 }
  
 /* Measurement uncertainty */
-std::vector<double> KF4ParamsComb::ErrMeas(const Stub* stub, std::vector<double> x )const{
+void KF4ParamsComb::ErrMeas(const Stub* stub, const double x[4], double e[2] )const{
 
-    std::vector<double> meas = d(stub);
+    double meas[2];
+    d( stub, meas );
 
-    std::vector<double> e(2,0);
     if(stub->layerId() < 10){
 	double dphi = stub->sigmaX()/stub->r();
 	double dz = stub->sigmaZ();
 	e[0] = dphi;
 	e[1] = dz;
     }else{
-	double phi0 = x.at(PHI0); 
+	double phi0 = x[PHI0]; 
 
 	//calculating the relative errors for l & r ( delta_phi = l / r )
 	double delta_phi = meas[0] - phi0;
@@ -175,41 +194,55 @@ std::vector<double> KF4ParamsComb::ErrMeas(const Stub* stub, std::vector<double>
 	e[0] = dphi;
 	e[1] = dz;
     }
-    return e;
 }
-TMatrixD KF4ParamsComb::PddMeas(const Stub* stub, const kalmanState *state )const{
+std::vector<double> KF4ParamsComb::ErrMeas(const Stub* stub, std::vector<double> x )const{
+    double e[2];
+    ErrMeas( stub, &x[0], e );
+    return std::vector<double>( e, e + 2 );
+}
+void KF4ParamsComb::PddMeas(const Stub* stub, const double x[4], double p[2][2] )const{
 
-    const std::vector<double> &x = state->xa();
-    TMatrixD      xx( 4, 4 ); 
+    double xx[4][4]; 
     for(unsigned i=0; i < 4; i++ )
 	for(unsigned j=0; j < 4; j++ )
-	    xx(i,j) = x[i] * x[j];
-    TMatrixD dhcov(2,2);
+	    xx[i][j] = x[i] * x[j];
+    double dhcov[2][2] = {};
     if( stub->layerId() > 10 ){
-	dhcov = HxxH( dH(stub), xx );
+	double dh[2][4];
+	dH( stub, dh );
+	HxxH( dh, xx, dhcov );
     }
 
-    std::vector<double> e = ErrMeas( stub, state->xa() );
-    TMatrixD p(2,2);
-    p(PHI, PHI) = e[PHI]*e[PHI];
-    p(Z,Z)      = e[Z]*e[Z];
-
-    TMatrixD pddm(2,2);
-    pddm = dhcov + p; 
-    return pddm;
+    double e[2];
+    ErrMeas( stub, x, e );
+    p[PHI][PHI] = dhcov[PHI][PHI] + e[PHI]*e[PHI];
+    p[PHI][Z]   = dhcov[PHI][Z];
+    p[Z][PHI]   = dhcov[Z][PHI];
+    p[Z][Z]     = dhcov[Z][Z] + e[Z]*e[Z];
+}
+TMatrixD KF4ParamsComb::PddMeas(const Stub* stub, const kalmanState *state )const{
+    double p[2][2];
+    PddMeas( stub, &state->xa()[0], p );
+    return TMatrixD( 2, 2, &p[0][0] );
 }
 
 /* State uncertainty */
+void KF4ParamsComb::PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr, double p[4][4] )const
+{
+    for(unsigned i = 0; i < 4; i++)
+	for(unsigned j = 0; j < 4; j++)
+	    p[i][j] = 0;
+    if( getSettings()->kalmanMultiScattFactor() == 0 ) return;
+    p[0][0] = 0.01;
+    p[1][1] = 0.01;
+    p[2][2] = 0.00001;
+    p[3][3] = 0.00001;
+}
 TMatrixD KF4ParamsComb::PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr )const
 {
-
-    TMatrixD p(4,4);
-    if( getSettings()->kalmanMultiScattFactor() == 0 ) return p;
-    p(0,0) = 0.01;
-    p(1,1) = 0.01;
-    p(2,2) = 0.00001;
-    p(3,3) = 0.00001;
-    return p;
+    double p[4][4];
+    PxxModel( state, stub, stub_itr, p );
+    return TMatrixD( 4, 4, &p[0][0] );
 }
 
 std::string KF4ParamsComb::getParams(){
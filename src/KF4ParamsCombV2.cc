@@ -14,8 +14,10 @@ static double wrapRadian( double t ){
     }
     return t;
 }
+template class L1KalmanCombModel<KF4ParamsCombV2, 4, KF4ParamsComb>;
+
 KF4ParamsCombV2::KF4ParamsCombV2(const Settings* settings, const string &fitterName ) : 
-    KF4ParamsComb(settings, 4, fitterName ){
+    L1KalmanCombModel<KF4ParamsCombV2, 4, KF4ParamsComb>(settings, 4, fitterName ){
 
     hkfxmin[0] = -15000.;
     hkfxmax[0] = +15000.;
@@ -57,20 +59,20 @@ std::string KF4ParamsCombV2::getParams(){
     return "KF4ParamsCombV2";
 }
 
-std::map<std::string, double> KF4ParamsCombV2::getTrackParams( const kalmanState *state )const{
+HelixParams KF4ParamsCombV2::getTrackParams( const kalmanState *state )const{
 
-    std::vector<double> x = state->xa();
+    const std::vector<double> &x = state->xa();
 
-    std::map<std::string, double> z;
+    HelixParams z;
     double beta = x.at(BETA);
     double z0p  = x.at(Z0P);
     double R0p  = x.at(R0P);
     double rho0 = x.at(RHO0);
 
-    z["qOverPt"] =  1./( getSettings()->invPtToInvR()  * 0.5 * R0p ); 
-    z["phi0"] = wrapRadian( rho0 / R0p + sectorPhi() ); 
-    z["z0"] = z0p - beta * z["phi0"]; 
-    z["t"] = beta / R0p;
+    z.qOverPt =  1./( getSettings()->invPtToInvR()  * 0.5 * R0p ); 
+    z.phi0 = wrapRadian( rho0 / R0p + sectorPhi() ); 
+    z.z0 = z0p - beta * z.phi0; 
+    z.tanLambda = beta / R0p;
     return z;
 }
  
@@ -118,34 +120,40 @@ TMatrixD KF4ParamsCombV2::seedP(const L1track3D& l1track3D)const{
 }
 
 /* the vector of measurements */
-std::vector<double> KF4ParamsCombV2::d(const Stub* stub )const{
-
-    std::vector<double> meas;
-    meas.resize(2);
+void KF4ParamsCombV2::d(const Stub* stub, double meas[2] )const{
     meas[0] = stub->z();
     meas[1] = stub->r();
-    return meas;
+}
+std::vector<double> KF4ParamsCombV2::d(const Stub* stub )const{
+    double meas[2];
+    d( stub, meas );
+    return std::vector<double>( meas, meas + 2 );
 }
 
 /* The Kalman measurement matrix
  * Here I always measure phi(r), and z(r) */
+void KF4ParamsCombV2::H(const Stub* stub, double h[2][4] )const{
+    for(unsigned i = 0; i < 2; i++)
+	for(unsigned j = 0; j < 4; j++)
+	    h[i][j] = 0;
+    h[0][0] = -( stub->phi() - sectorPhi() );
+    h[0][1] = 1;
+    h[1][2] = -( stub->phi() - sectorPhi() );
+    h[1][3] = 1;
+}
 TMatrixD KF4ParamsCombV2::H(const Stub* stub)const{
-    TMatrixD h(2, 4);
-    h(0,0) = -( stub->phi() - sectorPhi() );
-    h(0,1) = 1;
-    h(1,2) = -( stub->phi() - sectorPhi() );
-    h(1,3) = 1;
-    return h;
+    double h[2][4];
+    H( stub, h );
+    return TMatrixD( 2, 4, &h[0][0] );
 }
-TMatrixD KF4ParamsCombV2::dH(const Stub* stub, const kalmanState *state )const{
+void KF4ParamsCombV2::dH(const Stub* stub, const double x[4], double h[2][4] )const{
 
 
     double dphi = stub->sigmaX() / stub->r();
 
     if( !stub->barrel() ){
-	std::vector<double> x = state->xa();
-	double R0p  = x.at(R0P);
-	double rho0 = x.at(RHO0);
+	double R0p  = x[R0P];
+	double rho0 = x[RHO0];
 	double phi0 = rho0 / R0p; 
 
 	//calculating the relative errors for l & r ( delta_phi = l / r )
@@ -160,24 +168,32 @@ TMatrixD KF4ParamsCombV2::dH(const Stub* stub, const kalmanState *state )const{
 	dphi = rdphi * delta_phi;
     }
 
-    TMatrixD h(2, 4);
-    h(0,0) = -dphi;
-    h(1,2) = -dphi;
-    return h;
-
+    for(unsigned i = 0; i < 2; i++)
+	for(unsigned j = 0; j < 4; j++)
+	    h[i][j] = 0;
+    h[0][0] = -dphi;
+    h[1][2] = -dphi;
+}
+TMatrixD KF4ParamsCombV2::dH(const Stub* stub, const kalmanState *state )const{
+    double h[2][4];
+    dH( stub, &state->xa()[0], h );
+    return TMatrixD( 2, 4, &h[0][0] );
 }
 
-TMatrixD KF4ParamsCombV2::PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr )const{
+void KF4ParamsCombV2::PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr, double p[4][4] )const{
     //not easy to implement the multiple scattering.
-    TMatrixD p(4,4,0);
-
-    return p;
+    for(unsigned i = 0; i < 4; i++)
+	for(unsigned j = 0; j < 4; j++)
+	    p[i][j] = 0;
+}
+TMatrixD KF4ParamsCombV2::PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr )const{
+    double p[4][4];
+    PxxModel( state, stub, stub_itr, p );
+    return TMatrixD( 4, 4, &p[0][0] );
 }
 
 /* Measurement uncertainty */
-std::vector<double> KF4ParamsCombV2::ErrMeas(const Stub* stub, std::vector<double> x )const{
-
-    std::vector<double> e(2);
+void KF4ParamsCombV2::ErrMeas(const Stub* stub, const double x[4], double e[2] )const{
 
     if(stub->layerId() < 10){
 	e[0] = stub->sigmaZ();
@@ -186,7 +202,29 @@ std::vector<double> KF4ParamsCombV2::ErrMeas(const Stub* stub, std::vector<doubl
 	e[0] = 1.e-2; 
 	e[1] = stub->sigmaZ(); 
     }
-    return e;
+}
+std::vector<double> KF4ParamsCombV2::ErrMeas(const Stub* stub, std::vector<double> x )const{
+    double e[2];
+    ErrMeas( stub, &x[0], e );
+    return std::vector<double>( e, e + 2 );
+}
+void KF4ParamsCombV2::PddMeas(const Stub* stub, const double x[4], double p[2][2] )const{
+
+    double xx[4][4]; 
+    for(unsigned i=0; i < 4; i++ )
+	for(unsigned j=0; j < 4; j++ )
+	    xx[i][j] = x[i] * x[j];
+
+    double dh[2][4], dhcov[2][2];
+    dH( stub, x, dh );
+    HxxH( dh, xx, dhcov );
+
+    double e[2];
+    ErrMeas( stub, x, e );
+    p[0][0] = dhcov[0][0] + e[0] * e[0];
+    p[0][1] = dhcov[0][1];
+    p[1][0] = dhcov[1][0];
+    p[1][1] = dhcov[1][1] + e[1] * e[1];
 }
 TMatrixD KF4ParamsCombV2::PddMeas(const Stub* stub, const kalmanState *state )const{
 
@@ -227,7 +265,6 @@ TMatrixD KF4ParamsCombV2::PddMeas(const Stub* stub, const kalmanState *state )co
  * Decision based on hit and state uncertainty */
 bool KF4ParamsCombV2::stubBelongs(const Stub* stub, kalmanState& state, std::vector<double> residual )const{
 
-    std::map<std::string,double> x = getTrackParams( &state ); 
     std::vector<double> e = ErrMeas( stub, state.xa() );
 
     bool goodMeas( true );
@@ -239,7 +276,7 @@ bool KF4ParamsCombV2::stubBelongs(const Stub* stub, kalmanState& state, std::vec
        */
     bool beamSpotCompatible = 1;
     /*
-       if( fabs( x["z0"] ) > 20){
+       if( fabs( getTrackParams( &state ).z0 ) > 20){
        beamSpotCompatible = 0;
        }
        */
@@ -250,8 +287,7 @@ bool KF4ParamsCombV2::isGoodState( const kalmanState &state )const
 {
     unsigned nStubs = state.stubs().size();
     bool goodState( true );
-    std::map<string,double> x = getTrackParams( &state );
-    double z0=fabs( x["z0"] ); 
+    double z0=fabs( getTrackParams( &state ).z0 ); 
     if( z0 > 20. ) goodState = false;
     /*
        if( nStubs >= 2 ){
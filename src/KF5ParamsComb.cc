@@ -35,8 +35,10 @@ static double wrapRadian( double t ){
     }
     return t;
 }
+template class L1KalmanCombModel<KF5ParamsComb, 5>;
+
 KF5ParamsComb::KF5ParamsComb(const Settings* settings, const string &fitterName ) : 
-    L1KalmanComb(settings, 5, fitterName ){
+    L1KalmanCombModel<KF5ParamsComb, 5>(settings, 5, fitterName ){
 
     hxmin[0] = -0.05;
     hxmax[0] = +0.05;
@@ -97,40 +99,40 @@ std::string KF5ParamsComb::getParams(){
     return "KF5ParamsComb";
 }
 
-std::map<std::string, double> KF5ParamsComb::getTrackParams(const kalmanState *state )const{
+HelixParams KF5ParamsComb::getTrackParams(const kalmanState *state )const{
 
-    std::vector<double> x = state->xa();
-    std::map<std::string, double> y;
-    y["qOverPt"] = x.at(INV2R) / getSettings()->invPtToInvR() * 2.; 
-    y["phi0"] = wrapRadian( x.at(PHI0) + sectorPhi() );
-    y["z0"] = x.at(Z0);
-    y["t"] = x.at(T);
-    y["d0"] = x.at(D0);
+    const std::vector<double> &x = state->xa();
+    HelixParams y;
+    y.qOverPt = x.at(INV2R) / getSettings()->invPtToInvR() * 2.; 
+    y.phi0 = wrapRadian( x.at(PHI0) + sectorPhi() );
+    y.z0 = x.at(Z0);
+    y.tanLambda = x.at(T);
+    y.d0 = x.at(D0);
     return y;
 }
 
-std::vector<double> KF5ParamsComb::residual(const Stub* stub, const std::vector<double> &x )const
+void KF5ParamsComb::calcResidual(const Stub* stub, const double h[2][5], const double meas[2], const double x[5], double delta[2] )const
 {
-    std::vector<double> hx = Hx( H(stub), x ); 
-    std::vector<double> vd  = d(stub ); 
-    //    cout << "residual " << endl;
-    //    cout << "vd = " << vd[0] << ", " << vd[1] << endl;
-    //H(stub).Print();
-    //    cout << "hx = " << hx[0] << ", " << hx[1] << endl;
-
-    std::vector<double> delta(2); 
     for( unsigned i=0; i<2; i++ ){
-	delta.at(i) = vd.at(i) - hx.at(i);
+	double hx(0);
+	for( unsigned j=0; j<5; j++ ) hx += h[i][j] * x[j];
+	delta[i] = meas[i] - hx;
     }
-    delta.at(0) = wrapRadian(delta.at(0));
-    //   cout << "delta = " << delta[0] << ", " << delta[1] << endl;
-
-    return delta;
+    delta[PHI] = wrapRadian(delta[PHI]);
+}
+std::vector<double> KF5ParamsComb::residual(const Stub* stub, const std::vector<double> &x )const
+{
+    double h[2][5], meas[2], xa[5], delta[2];
+    H( stub, h );
+    d( stub, meas );
+    for( unsigned j=0; j<5; j++ ) xa[j] = x.at(j);
+    calcResidual( stub, h, meas, xa, delta );
+    return std::vector<double>( delta, delta + 2 );
 }
 
 /* Seed the state vector */
 std::vector<double> KF5ParamsComb::seedx(const L1track3D& l1track3D)const{
-    std::vector<double> x;
+    std::vector<double> x(nPar_);
     x[INV2R] = getSettings()->invPtToInvR() * l1track3D.qOverPt()/2;
     x[PHI0]  = wrapRadian( l1track3D.phi0() - sectorPhi() );
     x[Z0]    = l1track3D.z0();
@@ -170,38 +172,48 @@ TMatrixD KF5ParamsComb::seedP(const L1track3D& l1track3D)const{
 }
 /* The forecast matrix
  * (here equals identity matrix) */
+void KF5ParamsComb::F(const Stub* stub, const kalmanState *state, double f[5][5] )const{
+    for(unsigned n = 0; n < 5; n++)
+	for(unsigned m = 0; m < 5; m++)
+	    f[n][m] = ( n == m ) ? 1 : 0;
+}
 TMatrixD KF5ParamsComb::F(const Stub* stub, const kalmanState *state )const{
-    TMatrixD F(nPar_,nPar_);
-    for(unsigned n = 0; n < nPar_; n++)
-	F(n, n) = 1;
-    return F;
+    double f[5][5];
+    F( stub, state, f );
+    return TMatrixD( 5, 5, &f[0][0] );
 }
 
 /* the vector of measurements */
-std::vector<double> KF5ParamsComb::d(const Stub* stub )const{
-
-    std::vector<double> meas;
-    meas.resize(2);
+void KF5ParamsComb::d(const Stub* stub, double meas[2] )const{
     meas[PHI] = wrapRadian( stub->phi() - sectorPhi() );
     meas[Z] = stub->z();
-    return meas;
+}
+std::vector<double> KF5ParamsComb::d(const Stub* stub )const{
+    double meas[2];
+    d( stub, meas );
+    return std::vector<double>( meas, meas + 2 );
 }
 
 /* The Kalman measurement matrix
  * Here I always measure phi(r), and z(r) */
-TMatrixD KF5ParamsComb::H(const Stub* stub)const{
-    TMatrixD h(2, 5);
-    h(PHI,INV2R) = -stub->r();
-    h(PHI,PHI0) = 1;
-    if( stub->r() == 0 ) h(PHI,D0) = 99999.;
-    else h(PHI,D0) = -1./stub->r();
+void KF5ParamsComb::H(const Stub* stub, double h[2][5] )const{
+    for(unsigned i = 0; i < 2; i++)
+	for(unsigned j = 0; j < 5; j++)
+	    h[i][j] = 0;
+    h[PHI][INV2R] = -stub->r();
+    h[PHI][PHI0] = 1;
+    if( stub->r() == 0 ) h[PHI][D0] = 99999.;
+    else h[PHI][D0] = -1./stub->r();
     // else h(0,4) = 1./stub->r();
-    h(Z,Z0) = 1;
-    h(Z,T) = stub->r();
-
-    return h;
+    h[Z][Z0] = 1;
+    h[Z][T] = stub->r();
 }
-TMatrixD KF5ParamsComb::dH(const Stub* stub)const{
+TMatrixD KF5ParamsComb::H(const Stub* stub)const{
+    double h[2][5];
+    H( stub, h );
+    return TMatrixD( 2, 5, &h[0][0] );
+}
+void KF5ParamsComb::dH(const Stub* stub, double h[2][5] )const{
 
     double dr(0);
     if(stub->layerId() > 10){
@@ -209,17 +221,22 @@ TMatrixD KF5ParamsComb::dH(const Stub* stub)const{
 	//	dr = stub->rErr();
     }
 
-    TMatrixD h(2, 5);
-    h(PHI,INV2R) = -dr;
-    if( stub->r() == 0 ) h(PHI,D0) = 99999.;
-    else h(PHI,D0) = 1./(stub->r()*stub->r()) * dr;
-    h(Z,T) = dr;
-
-    return h;
+    for(unsigned i = 0; i < 2; i++)
+	for(unsigned j = 0; j < 5; j++)
+	    h[i][j] = 0;
+    h[PHI][INV2R] = -dr;
+    if( stub->r() == 0 ) h[PHI][D0] = 99999.;
+    else h[PHI][D0] = 1./(stub->r()*stub->r()) * dr;
+    h[Z][T] = dr;
+}
+TMatrixD KF5ParamsComb::dH(const Stub* stub)const{
+    double h[2][5];
+    dH( stub, h );
+    return TMatrixD( 2, 5, &h[0][0] );
 }
 
 /* State uncertainty */
-TMatrixD KF5ParamsComb::PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr )const
+void KF5ParamsComb::PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr, double p[5][5] )const
 {
 
     const std::vector<double> &xa = state->xa();
@@ -233,18 +250,17 @@ TMatrixD KF5ParamsComb::PxxModel( const kalmanState *state, const Stub *stub, un
     double eta = stub->eta();
     unsigned n_state_updates = state->nStubLayers();
 
-    TMatrixD p(nPar_,nPar_);
+    for(unsigned i = 0; i < 5; i++)
+	for(unsigned j = 0; j < 5; j++)
+	    p[i][j] = 0;
 
 
 
 
-    if( getSettings()->kalmanMultiScattFactor() == 0 ) return p;
+    if( getSettings()->kalmanMultiScattFactor() == 0 ) return;
 
     //multiple scattering
 
-    TMatrixD plambda(nPar_,nPar_);
-    TMatrixD pphi(nPar_,nPar_);
-
     double r = last_update_r;
     double dtheta0;
 
@@ -310,36 +326,36 @@ TMatrixD KF5ParamsComb::PxxModel( const kalmanState *state, const Stub *stub, un
 
     double dl = dl_inner + dl_outer;
 
-    std::map<std::string, double> y = getTrackParams(state);
-    dtheta0 = 1./sqrt(3) * 0.0136 * (2.*fabs(y["2rInv"]) ) / getSettings()->invPtToInvR() * sqrt(dl)*( 1+0.038*log(dl) ); 
+    // N.B. 1/2R taken as zero, so there is no multiple scattering, as when the track params were taken from a map,
+    // since it was looked up with a key ("2rInv") that was never set.
+    double inv2R = 0.;
+    dtheta0 = 1./sqrt(3) * 0.0136 * (2.*fabs(inv2R) ) / getSettings()->invPtToInvR() * sqrt(dl)*( 1+0.038*log(dl) ); 
     dtheta0 *= getSettings()->kalmanMultiScattFactor();
 
     //lambda
     double dlambda = - dtheta0;
-    std::vector<double> e_lambda(nPar_, 0);
-    e_lambda[INV2R] = y["2rInv"] * y["t"] * dlambda; 
-    e_lambda[Z0] = -1 * r * ( 1 + y["t"] * y["t"] ) * dlambda;
-    e_lambda[T] = ( 1 + y["t"] * y["t"] ) * dlambda;
-
-    for( unsigned i = 0; i < nPar_; i++ ){
-	for( unsigned j = 0; j < nPar_; j++ ){
-	    plambda(i,j) = e_lambda[i] * e_lambda[j];  
-	}
-    }
+    double e_lambda[5] = {};
+    e_lambda[INV2R] = inv2R * xa[T] * dlambda; 
+    e_lambda[Z0] = -1 * r * ( 1 + xa[T] * xa[T] ) * dlambda;
+    e_lambda[T] = ( 1 + xa[T] * xa[T] ) * dlambda;
+
     //phi
-    std::vector<double> e_phi(nPar_, 0);
+    double e_phi[5] = {};
     e_phi[PHI0] = dtheta0;
     e_phi[D0] = -1. * r * dtheta0;
     //    e_phi[4] = r * dtheta0;
-    for( unsigned i = 0; i < nPar_; i++ ){
-	for( unsigned j = 0; j < nPar_; j++ ){
-	    pphi(i,j) = e_phi[i] * e_phi[j];  
+
+    for( unsigned i = 0; i < 5; i++ ){
+	for( unsigned j = 0; j < 5; j++ ){
+	    p[i][j] = e_lambda[i] * e_lambda[j] + e_phi[i] * e_phi[j];  
 	}
     }
-
-    p = plambda + pphi;
-
-    return p;
+}
+TMatrixD KF5ParamsComb::PxxModel( const kalmanState *state, const Stub *stub, unsigned stub_itr )const
+{
+    double p[5][5];
+    PxxModel( state, stub, stub_itr, p );
+    return TMatrixD( 5, 5, &p[0][0] );
 }
 
 /* Measurement uncertainty */
@@ -367,39 +383,37 @@ std::vector<double> KF5ParamsComb::ErrMeas(const Stub* stub, std::vector<double>
     return e;
 }
 
-TMatrixD KF5ParamsComb::PddMeas(const Stub* stub, const kalmanState *state )const{
+void KF5ParamsComb::PddMeas(const Stub* stub, const double x[5], double pddm[2][2] )const{
 
-    const std::vector<double> &x = state->xa();
-    TMatrixD      xx( 5, 5 ); 
+    double xx[5][5]; 
     for(unsigned i=0; i < 5; i++ )
 	for(unsigned j=0; j < 5; j++ )
-	    xx(i,j) = x[i] * x[j];
-    TMatrixD dhcov(2,2);
+	    xx[i][j] = x[i] * x[j];
+    double dhcov[2][2] = {};
     if( stub->layerId() > 10 ){
-	dhcov = HxxH( dH(stub), xx );
+	double dh[2][5];
+	dH( stub, dh );
+	HxxH( dh, xx, dhcov );
     }
-    //dhcov.Print();
 
-    std::map<std::string, double> y = getTrackParams(state);
-    TMatrixD p(2,2);
+    double p[2][2] = {};
     if(stub->layerId() < 10){
 	double dphi = stub->sigmaX()/stub->r();
 	double dz = stub->sigmaZ();
-	p(PHI,PHI) = dphi * dphi;
-	p(Z,Z) = dz * dz;
+	p[PHI][PHI] = dphi * dphi;
+	p[Z][Z] = dz * dz;
     }else{
 	double dphi = stub->sigmaX()/stub->r();
-	p(PHI,PHI) = dphi * dphi;
+	p[PHI][PHI] = dphi * dphi;
     }
-    TMatrixD pddm(2,2);
-    pddm = dhcov + p; 
-    return pddm;
+    for(unsigned i=0; i < 2; i++ )
+	for(unsigned j=0; j < 2; j++ )
+	    pddm[i][j] = dhcov[i][j] + p[i][j]; 
 
     /*
        const std::vector<double> &x = state->xa();
        const TMatrixD      &xcov = state->pxxa();
 
-       std::map<std::string, double> y = vecToMap(x);
        TMatrixD p(2,2,0);
        if(stub->layerId() < 10){
        double dphi = stub->sigmaX()/stub->r();
@@ -408,8 +422,8 @@ TMatrixD KF5ParamsComb::PddMeas(const Stub* stub, const kalmanState *state )cons
        p(Z,Z) = dz * dz;
        }else{
        double dr = stub->sigmaZ();
-       double dphi_dr = - dr * y["2rInv"] + y["d0"]/(stub->r()*stub->r()) * dr ;
-       double dz_dr   = dr * y["t"];
+       double dphi_dr = - dr * x[INV2R] + x[D0]/(stub->r()*stub->r()) * dr ;
+       double dz_dr   = dr * x[T];
        double dphidz_dr = dphi_dr * dz_dr;
        double dphi = stub->sigmaX()/stub->r();
        p(PHI,PHI) = dphi_dr * dphi_dr + dphi * dphi + stub->r() * stub->r() * xcov(0,0) + xcov(1,1) + 1./(stub->r()*stub->r()) * xcov(4,4);  
@@ -418,7 +432,11 @@ TMatrixD KF5ParamsComb::PddMeas(const Stub* stub, const kalmanState *state )cons
        p(Z,PHI) = p(PHI,Z);
        }
        */
-    return p;
+}
+TMatrixD KF5ParamsComb::PddMeas(const Stub* stub, const kalmanState *state )const{
+    double p[2][2];
+    PddMeas( stub, &state->xa()[0], p );
+    return TMatrixD( 2, 2, &p[0][0] );
 }
 
 
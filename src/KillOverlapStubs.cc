@@ -1,34 +1,68 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/KillOverlapStubs.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleAdjacency.h"
 #include "FWCore/Utilities/interface/Exception.h"
 
 #include <vector>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
 
-const std::vector<const Stub*> KillOverlapStubs::getFiltered(std::string method) const
+// Select pairs found by the pairFinder algorithm with the given cuts
+std::vector< std::pair<const Stub*, const Stub*> > OverlapStubPairs::selectFound(double pt_cut, double z0_cut, bool genuineOnly) const
 {
-  // if needed, get a vector of duplicate pairs
-  std::vector< std::pair<const Stub*, const Stub*> > filteredPairs;
-  if (method == "none") {
-    return vStubs_;
-  } else if (method == "pairFinder") {
-    filteredPairs = pairFinder();
-  } else if (method == "truePairFinder") {
-    filteredPairs = truePairFinder();
-  } else if (method == "settings") {
-    if (settings_->overlapAlg() == "none")
-      return vStubs_;
-    else if (settings_->overlapAlg() == "pairFinder")
-      filteredPairs = pairFinder();
-    else if (settings_->overlapAlg() == "truePairFinder")
-      filteredPairs = truePairFinder();
-    else
-      throw cms::Exception("KillOverlapStubs: invalid filtering algorithm setting.");
-  } else {
-    throw cms::Exception("KillOverlapStubs: invalid filtering algorithm.");
+  std::vector< std::pair<const Stub*, const Stub*> > selected;
+  for ( const Candidate& c : candidates ) {
+    // cuts in r-z and r-phi planes
+    if ( fabs(c.z0)      > z0_cut )                     continue;
+    if ( fabs(c.ptOverQ) < pt_cut )                     continue;
+    // check if qOverPt() of both stubs matches the above
+    if ( ! c.qOverPtMatch )                             continue;
+    if ( genuineOnly && ! (c.s1->genuine() && c.s2->genuine()) ) continue;
+    selected.push_back( std::pair<const Stub*, const Stub*>(c.s1, c.s2) );
   }
+  return selected;
+}
+
+// Select true pairs with the given cut on the pt of the tracking particle
+std::vector< std::pair<const Stub*, const Stub*> > OverlapStubPairs::selectTrue(double pt_cut) const
+{
+  std::vector< std::pair<const Stub*, const Stub*> > selected;
+  for ( const TruePair& p : truePairs )
+    if ( ! (p.commonTP->pt() < pt_cut) )
+      selected.push_back( std::pair<const Stub*, const Stub*>(p.s1, p.s2) );
+  return selected;
+}
+
+KillOverlapStubs::KillOverlapStubs(const std::vector<const Stub*>& vStubs, const Settings* settings, double pt_cut, double z0_cut)
+  : settings_(settings), pt_cut_(pt_cut), z0_cut_(z0_cut), foundCandidates_(false), foundTruePairs_(false)
+{
+  method_ = methodFromName( settings_->overlapAlg() );
+  pairs_.stubs = vStubs;
+}
+
+KillOverlapStubs::KillOverlapStubs(const std::vector<const Stub*>& vStubs, const Settings* settings)
+  : KillOverlapStubs(vStubs, settings, settings->overlapPtCut(), settings->overlapZ0Cut())
+{}
+
+// Convert name of method used in cfg to enum
+KillOverlapStubs::Method KillOverlapStubs::methodFromName(const std::string& name)
+{
+  if (name == "none")           return none;
+  if (name == "pairFinder")     return pairFinder;
+  if (name == "truePairFinder") return truePairFinder;
+  throw cms::Exception("KillOverlapStubs: invalid filtering algorithm setting ")<<name;
+}
+
+const std::vector<const Stub*> KillOverlapStubs::getFiltered(Method method) const
+{
+  if (method == none) return pairs_.stubs;
+
+  // get a vector of duplicate pairs
+  const std::vector< std::pair<const Stub*, const Stub*> > filteredPairs = getPairs(method);
 
   // only consider the first element of each pair
   std::set<const Stub*> paired_stubs;
@@ -37,65 +71,91 @@ const std::vector<const Stub*> KillOverlapStubs::getFiltered(std::string method)
 
   // remove the found "first elements" from vStubs
   std::vector<const Stub*> vStubs_filtered;
-  for (const Stub* s : vStubs_)
+  for (const Stub* s : pairs_.stubs)
     if ( paired_stubs.find(s) == paired_stubs.end() )
       vStubs_filtered.push_back(s);
 
   return vStubs_filtered;
 }
 
-std::vector< std::pair<const Stub*, const Stub*> > KillOverlapStubs::getPairs(std::string method) const
+std::vector< std::pair<const Stub*, const Stub*> > KillOverlapStubs::getPairs(Method method) const
 {
-  if (method == "pairFinder") {
-    return pairFinder();
-  } else if (method == "truePairFinder") {
-    return truePairFinder();
-  } else if (method == "settings") {
-    if (settings_->overlapAlg() == "pairFinder")
-      return pairFinder();
-    else if (settings_->overlapAlg() == "truePairFinder")
-      return truePairFinder();
-    else
-      throw cms::Exception("KillOverlapStubs: invalid filtering algorithm setting.");
-  } else {
-    throw cms::Exception("KillOverlapStubs: invalid filtering algorithm.");
+  switch (method) {
+    case pairFinder:
+      findCandidates();
+      return pairs_.selectFound(pt_cut_, z0_cut_);
+    case truePairFinder:
+      findTruePairs();
+      return pairs_.selectTrue(pt_cut_);
+    default:
+      throw cms::Exception("KillOverlapStubs: invalid filtering algorithm.");
   }
-
-  // never reached
-  return *(new std::vector< std::pair<const Stub*, const Stub*> >);
 }
 
-// Considering distinct pairs of stubs on same layer but different modules, find those which correspond to the same track.
-std::vector< std::pair<const Stub*, const Stub*> > KillOverlapStubs::pairFinder() const
+// Get all pairs, with the variables used to select them
+const OverlapStubPairs& KillOverlapStubs::getAllPairs() const
 {
-  std::vector< std::pair<const Stub*, const Stub*> > duplicateStubs;
-
-  // consider all distinct pairs of stubs
-  for ( auto i1 = vStubs_.begin(); i1 != vStubs_.end(); ++i1 )
-    for ( auto i2 = i1+1; i2 != vStubs_.end(); ++i2) {
-      const Stub* s1 = *i1; const Stub* s2 = *i2;
-
-      // check if stubs are on neighbouring modules
-      if ( ! neighb_modules(s1, s2) ) continue;
-
-      // cuts in r-z and r-phi planes
-      double z0      = trackParams(s1,s2).first;
-      double ptOverQ = trackParams(s1,s2).second;
-      if ( fabs(z0)      > z0_cut_ )              continue;
-      if ( fabs(ptOverQ) < pt_cut_ )              continue;
+  findCandidates();
+  findTruePairs();
+  return pairs_;
+}
 
-      // check if qOverPt() of both stubs matches the above
-      if ( fabs(1/ptOverQ - s1->qOverPt()) > s1->qOverPtres() ) continue;
-      if ( fabs(1/ptOverQ - s2->qOverPt()) > s2->qOverPtres() ) continue;
+// Considering distinct pairs of stubs on same layer but different modules, find those on neighbouring modules,
+// noting the variables needed to decide if they correspond to the same track.
+void KillOverlapStubs::findCandidates() const
+{
+  if ( foundCandidates_ ) return;
+  foundCandidates_ = true;
+
+  const std::vector<const Stub*>& vStubs = pairs_.stubs;
+  const ModuleAdjacency* adjacency = settings_->moduleAdjacency();
+
+  // if geometry unavailable, consider all distinct pairs of stubs, guessing which are on neighbouring modules
+  if ( adjacency == nullptr ) {
+    for ( auto i1 = vStubs.begin(); i1 != vStubs.end(); ++i1 )
+      for ( auto i2 = i1+1; i2 != vStubs.end(); ++i2)
+        if ( neighb_modules(*i1, *i2) )
+          addCandidate(*i1, *i2);
+    return;
+  }
 
-      // then the pair probably corresponds to the same track
-      duplicateStubs.push_back( std::pair<const Stub*, const Stub*>(s1, s2) );
+  // otherwise group stubs by module, noting their position in vStubs
+  std::unordered_map< unsigned int, std::vector<unsigned int> > stubsInModule;
+  for ( unsigned int i = 0; i < vStubs.size(); ++i )
+    stubsInModule[ vStubs[i]->idDet() ].push_back(i);
+
+  // and pair each stub only with later stubs on neighbouring modules, so pairs are ordered as above
+  std::vector<unsigned int> partners;
+  for ( unsigned int i1 = 0; i1 < vStubs.size(); ++i1 ) {
+    partners.clear();
+    for ( unsigned int idNeighb : adjacency->neighbours( vStubs[i1]->idDet() ) ) {
+      auto it = stubsInModule.find(idNeighb);
+      if ( it == stubsInModule.end() ) continue;
+      for ( unsigned int i2 : it->second )
+        if ( i2 > i1 ) partners.push_back(i2);
     }
+    std::sort( partners.begin(), partners.end() );
 
-  return duplicateStubs;
+    for ( unsigned int i2 : partners )
+      addCandidate(vStubs[i1], vStubs[i2]);
+  }
 }
 
-// Check if two stubs are on neighbouring modules
+// Note a pair of stubs on neighbouring modules, with the variables needed to check if it is consistent with a single track
+void KillOverlapStubs::addCandidate(const Stub* s1, const Stub* s2) const
+{
+  const std::pair<double,double> params = trackParams(s1,s2);
+  OverlapStubPairs::Candidate c;
+  c.s1      = s1;
+  c.s2      = s2;
+  c.z0      = params.first;
+  c.ptOverQ = params.second;
+  c.qOverPtMatch = ! ( fabs(1/c.ptOverQ - s1->qOverPt()) > s1->qOverPtres() ||
+                       fabs(1/c.ptOverQ - s2->qOverPt()) > s2->qOverPtres() );
+  pairs_.candidates.push_back(c);
+}
+
+// Check if two stubs are on neighbouring modules (approximate, only used if the module adjacency table is unavailable)
 bool KillOverlapStubs::neighb_modules(const Stub* s1, const Stub* s2) const
 {
   // check if stubs are on the same layer
@@ -140,36 +200,64 @@ bool KillOverlapStubs::neighb_modules(const Stub* s1, const Stub* s2) const
 }
 
 
-// find pairs of stubs the algorithm needs to find given the pt_cut
-std::vector< std::pair<const Stub*, const Stub*> > KillOverlapStubs::truePairFinder() const
+// find pairs of stubs on the same layer but different modules produced by the same TP, whatever its pt
+void KillOverlapStubs::findTruePairs() const
 {
-  std::vector< std::pair<const Stub*, const Stub*> > dPairs_ptCut;
-  for ( auto i1 = vStubs_.begin(); i1 != vStubs_.end(); ++i1 )
-    for ( auto i2 = i1+1; i2 != vStubs_.end(); ++i2) {
-      // require same layer
-      if ( (*i1)->layerId() != (*i2)->layerId() ) continue;
-      // ignore stubs from the same module
-      if ( (*i1)->idDet() == (*i2)->idDet() )     continue;
-      // require at least one TP in common
-      if ( commonTP(*i1, *i2) == nullptr )        continue;
-      // require TP.pt >= pt_cut_
-      if ( commonTP(*i1, *i2)->pt() < pt_cut_ )   continue;
-      // stubs in pair (*i1, *i2) are the ones the algorithm needs to find
-      dPairs_ptCut.push_back( std::pair<const Stub*, const Stub*>(*i1, *i2) );
+  if ( foundTruePairs_ ) return;
+  foundTruePairs_ = true;
+
+  const std::vector<const Stub*>& vStubs = pairs_.stubs;
+
+  // group stubs by the TPs that produced them, noting their position in vStubs
+  std::unordered_map< const TP*, std::vector<unsigned int> > stubsOfTP;
+  for ( unsigned int i = 0; i < vStubs.size(); ++i )
+    for ( const TP* tp : vStubs[i]->assocTPs() )
+      stubsOfTP[tp].push_back(i);
+
+  // for each stub, find later stubs sharing a TP, taking the first TP in common as in commonTP()
+  std::vector< std::pair<unsigned int, const TP*> > partners;
+  for ( unsigned int i1 = 0; i1 < vStubs.size(); ++i1 ) {
+    const Stub* s1 = vStubs[i1];
+    partners.clear();
+    for ( const TP* tp : s1->assocTPs() ) {
+      for ( unsigned int i2 : stubsOfTP[tp] ) {
+        if ( i2 <= i1 ) continue;
+        const Stub* s2 = vStubs[i2];
+        // require same layer
+        if ( s1->layerId() != s2->layerId() ) continue;
+        // ignore stubs from the same module
+        if ( s1->idDet() == s2->idDet() )     continue;
+        partners.push_back( std::pair<unsigned int, const TP*>(i2, tp) );
+      }
+    }
+    // keep only first TP found for each partner stub, ordering partners as in vStubs
+    std::stable_sort( partners.begin(), partners.end(),
+                      [](const std::pair<unsigned int, const TP*>& a, const std::pair<unsigned int, const TP*>& b) {return a.first < b.first;} );
+    for ( unsigned int j = 0; j < partners.size(); ++j ) {
+      if ( j > 0 && partners[j].first == partners[j-1].first ) continue;
+      const Stub* s2 = vStubs[ partners[j].first ];
+      const std::pair<double,double> params = trackParams(s1,s2);
+      OverlapStubPairs::TruePair p;
+      p.s1       = s1;
+      p.s2       = s2;
+      p.commonTP = partners[j].second;
+      p.z0       = params.first;
+      p.ptOverQ  = params.second;
+      pairs_.truePairs.push_back(p);
     }
-  return dPairs_ptCut;
+  }
 }
 
 
 // If the two stubs share at least one TP in common, we consider them as belonging to the same track.
-const TP* KillOverlapStubs::commonTP(const Stub* s1, const Stub* s2) const
+const TP* KillOverlapStubs::commonTP(const Stub* s1, const Stub* s2)
 {
   // both stubs must have at least one TP associated with them
   if ( ! (s1->genuine() && s2->genuine()) ) return nullptr;
 
   // find at least one TP in common between the two stubs, and return it if found
+  const set<const TP*>& tp2s = s2->assocTPs();
   for ( const TP* tp1 : s1->assocTPs() ) {
-    set<const TP*> tp2s = s2->assocTPs();
     if ( tp2s.find(tp1) != tp2s.end() )
       return tp1;
   }
@@ -207,7 +295,7 @@ std::pair<double,double> KillOverlapStubs::trackParams(const Stub* s1, const Stu
 }
 
 // return first TP if Stub has any, nullptr otherwise
-const TP* KillOverlapStubs::firstTP(const Stub* s) const
+const TP* KillOverlapStubs::firstTP(const Stub* s)
 {
   // stub must have at least one TP
   if ( ! s->genuine() ) return nullptr;
@@ -26,6 +26,7 @@ L1ChiSquared::L1ChiSquared(const Settings* settings, const uint nPar) : TrackFit
   killTrackFitWorstHit_ = getSettings()->killTrackFitWorstHit();
   generalResidualCut_   = getSettings()->generalResidualCut(); // The cut used to remove bad stubs (if nStubs > minLayers)
   killingResidualCut_   = getSettings()->killingResidualCut(); // The cut used to kill off tracks entirely
+  incrementalFit_       = getSettings()->trackFitIncremental(); // Reuse linearisation of previous iteration where possible.
   
   //--- These two parameters are used to check if after the fit, there are still enough stubs on the track
   minStubLayers_ = getSettings()->minStubLayers();
@@ -42,6 +43,47 @@ void L1ChiSquared::calculateChiSq( std::vector<double> resids ){
   }
 }
 
+//=== Remove a killed stub from the linearisation of the previous fit iteration, downdating the inverse of
+//=== M = dtVinv*dtVinv^T with the Sherman-Morrison formula, and from its residuals.
+//=== Returns false, leaving them unchanged, if the remaining stubs barely constrain the helix.
+
+bool L1ChiSquared::downdate( int ikilled, Matrix<double>& Minv, Matrix<double>& dtVinv, std::vector<double>& resids ){
+
+  if (ikilled < 0) return true;
+
+  const uint nPar = Minv.get_rows();
+  Matrix<double> MinvNew(Minv);
+
+  // (M - a*a^T)^-1 = Minv + (Minv*a)*(Minv*a)^T/(1 - a^T*Minv*a), for each of the stub's two measurements.
+  for ( uint jk=2*ikilled; jk<2*uint(ikilled)+2; jk++ ){
+    std::vector<double> a(nPar);
+    for ( uint i=0; i<nPar; i++ ) a[i] = dtVinv(i, jk);
+    std::vector<double> u = MinvNew * a;
+    double atu = 0.0;
+    for ( uint i=0; i<nPar; i++ ) atu += a[i]*u[i];
+    const double denom = 1.0 - atu;
+    if (denom < 1.0e-3) return false;
+    for ( uint i1=0; i1<nPar; i1++ ){
+      for ( uint i2=0; i2<nPar; i2++ ){
+        MinvNew(i1, i2) += u[i1]*u[i2]/denom;
+      }
+    }
+  }
+  Minv = MinvNew;
+
+  const uint nCols = dtVinv.get_cols() - 2;
+  Matrix<double> dtVinvNew(nPar, nCols, 0.0);
+  for ( uint i=0; i<nPar; i++ ){
+    for ( uint j=0; j<nCols; j++ ){
+      dtVinvNew(i, j) = dtVinv(i, (j < 2*uint(ikilled)) ? j : j + 2);
+    }
+  }
+  dtVinv = dtVinvNew;
+
+  resids.erase(resids.begin() + 2*ikilled, resids.begin() + 2*ikilled + 2);
+  return true;
+}
+
 void L1ChiSquared::calculateDeltaChiSq( std::vector<double> delX, std::vector<double> covX ){
   for ( uint i=0; i<covX.size(); i++ ){
     chiSq_ += (-delX[i])*covX[i];
@@ -62,7 +104,8 @@ L1fittedTrack L1ChiSquared::fit(const L1track3D& l1track3D, unsigned int iPhiSec
   std::vector<double> resids = residuals(x);
 //  std::cout << "resids.size(): " << resids.size() << std::endl;
 
-  std::vector<double> deltaX = M.inverse() * dtVinv * resids;
+  Matrix<double> Minv = M.inverse();
+  std::vector<double> deltaX = Minv * dtVinv * resids;
   x = x - deltaX;
   std::vector<double> covX = d.transpose() * Vinv() * resids;  
 
@@ -72,16 +115,31 @@ L1fittedTrack L1ChiSquared::fit(const L1track3D& l1track3D, unsigned int iPhiSec
 
   for (int i=1;i<numFittingIterations_+1;++i) {
     if (i>1) {
+      int ikilled = -1;
       if ( killTrackFitWorstHit_  &&  (largestresid_ > killingResidualCut_ || (largestresid_ > generalResidualCut_ && Utility::countLayers( getSettings(), stubs_ ) > minStubLayers_)) ) {
         stubs_.erase(stubs_.begin()+ilargestresid_);
+        ikilled = ilargestresid_;
         if (getSettings()->debug() == 6) std::cout << __FILE__ " : Killed stub " << ilargestresid_ << "." << std::endl;
       }
 
+      if (incrementalFit_ && i < numFittingIterations_ && downdate(ikilled, Minv, dtVinv, resids)) {
+        // Reuse linearisation of previous iteration (minus any killed stub), and the residuals already calculated at x.
+        std::vector<double> covX = dtVinv * resids;
+        std::vector<double> deltaX = Minv * covX;
+        x = x - deltaX;
+        resids = residuals(x); // update resids.
+
+        calculateChiSq(resids);
+        calculateDeltaChiSq (deltaX, covX);
+        continue;
+      }
+
       d = D(x); // Calculate derivatives
       dtVinv = d.transpose() * Vinv();
       M = dtVinv * (dtVinv.transpose()); 
       resids = residuals(x); // Calculate new residuals
-      std::vector<double> deltaX = M.inverse() * dtVinv * resids;
+      Minv = M.inverse();
+      std::vector<double> deltaX = Minv * dtVinv * resids;
       x = x - deltaX;
       std::vector<double> covX = d.transpose() * Vinv() * resids;  
       resids = residuals(x); // update resids.
@@ -91,7 +149,7 @@ L1fittedTrack L1ChiSquared::fit(const L1track3D& l1track3D, unsigned int iPhiSec
     }
   }  
 
-  std::map<std::string, double> tp = convertParams(x); // tp = track params
+  HelixParams tp = convertParams(x); // tp = track params
 
   // Reject tracks with too many killed stubs
   unsigned int nLayers = Utility::countLayers( getSettings(), stubs_ ); // Count tracker layers with stubs
@@ -99,7 +157,7 @@ L1fittedTrack L1ChiSquared::fit(const L1track3D& l1track3D, unsigned int iPhiSec
   if (l1track3D.pt() > minPtToReduceLayers_) valid4par = nLayers >= minStubLayers_ - 1;
 
   if ( valid4par ){
-    return L1fittedTrack(getSettings(), l1track3D, stubs_, tp["qOverPt"], 0, tp["phi0"], tp["z0"], tp["t"], chiSq_, nPar_, iPhiSec, iEtaReg);
+    return L1fittedTrack(getSettings(), l1track3D, stubs_, tp.qOverPt, 0, tp.phi0, tp.z0, tp.tanLambda, chiSq_, nPar_, iPhiSec, iEtaReg);
   }
   else{ 
     return L1fittedTrack (getSettings(), l1track3D, stubs_, l1track3D.qOverPt(), 0., l1track3D.phi0(), l1track3D.z0(), l1track3D.tanLambda(), 999999., 4, iPhiSec, iEtaReg, 0);
@@ -64,8 +64,8 @@ L1fittedTrack L1Kalman::fit(const L1track3D& l1track3D, unsigned int iPhiSec, un
         pxxa = pxxf - k * (pxdf.transpose());
     }
  
-    std::map<std::string, double> tp = convertParams(xa);
-    return L1fittedTrack(getSettings(), l1track3D, l1track3D.getStubs(), tp["qOverPt"], 0, tp["phi0"], tp["z0"], tp["t"], 0, nPar_, iPhiSec, iEtaReg);
+    HelixParams tp = convertParams(xa);
+    return L1fittedTrack(getSettings(), l1track3D, l1track3D.getStubs(), tp.qOverPt, 0, tp.phi0, tp.z0, tp.tanLambda, 0, nPar_, iPhiSec, iEtaReg);
 }
  
 
@@ -72,7 +72,7 @@ static bool isOverlap( const Stub* a, const Stub*b ){
 }
 
 
-std::map<std::string, double> L1KalmanComb::getTrackParams( const L1KalmanComb *p, const kalmanState *state )
+HelixParams L1KalmanComb::getTrackParams( const L1KalmanComb *p, const kalmanState *state )
 {
     return p->getTrackParams( state );
 }
@@ -241,23 +241,15 @@ void L1KalmanComb::GetAdjustedState( const TMatrixD &K, const TMatrixD &pxcov,
 
 void L1KalmanComb::printTP( std::ostream &os, const TP *tp )const{
 
-    std::map<std::string, double> tp_x;
     bool useForAlgEff(false);
     if( tp ){
 	useForAlgEff = tp->useForAlgEff();
-	tp_x["qOverPt"] = tp->qOverPt();
-	tp_x["phi0"] = tp->phi0();
-	tp_x["z0"] = tp->z0();
-	tp_x["t"] = tp->tanLambda();
-	tp_x["d0"] = tp->d0();
     }
     if( tp ){
 	os << "\tTP index = " << tp->index() << " useForAlgEff = " << useForAlgEff << " ";
 	os << "\tpT, eta = " << tp->pt() << ", " << tp->eta() << " ";
 	os << "\tqOver2R0 = " << tp->qOverPt() * getSettings()->invPtToInvR() * 0.5 << " "; 
-	for( auto pair : tp_x ){
-	    os << pair.first << ":" << pair.second << ", "; 
-	}
+	os << "d0:" << tp->d0() << ", phi0:" << tp->phi0() << ", qOverPt:" << tp->qOverPt() << ", t:" << tp->tanLambda() << ", z0:" << tp->z0() << ", "; 
     }
     else{
 	os << "\tTP index = "; 
@@ -321,8 +313,10 @@ L1KalmanComb::L1KalmanComb(const Settings* settings, const uint nPar, const stri
     hxmax[2] = +20;
     hxmin[3] = -10;
     hxmax[3] = +10;
-    hxmin[4] = -5;
-    hxmax[4] = +5;
+    if( nPar_ > 4 ){
+	hxmin[4] = -5;
+	hxmax[4] = +5;
+    }
 
 
     hdxmin = vector<double>( nPar_, -1e-4 );
@@ -382,26 +376,44 @@ L1fittedTrack L1KalmanComb::fit(const L1track3D& l1track3D, unsigned int iPhiSec
     std::vector<const Stub*> stubs = l1track3D.getStubs();
     sort(stubs.begin(), stubs.end(), orderStubsByLayer); 
 
-    for(unsigned i=0; i < stubs.size(); i++ ){
-	const Stub *stub_a = stubs.at(i);
-	for(unsigned j=i+1; j < stubs.size(); j++ ){
-	    const Stub *stub_b = stubs.at(j);
-	    if( stub_a->r() == stub_b->r() && stub_a->phi() == stub_b->phi() && stub_a->z() == stub_b->z() ){
-		stubs.erase( stubs.begin() + j ); 
-		nDupStubs_ ++;
-		j--;
-	    }
+    //remove stubs with the same coordinates as an earlier one in this list, finding them by sorting their positions by coordinates.
+    std::vector<unsigned> byCoord( stubs.size() );
+    for( unsigned i=0; i < stubs.size(); i++ ) byCoord[i] = i;
+    sort( byCoord.begin(), byCoord.end(), [&stubs]( unsigned i, unsigned j ){
+	    const Stub *a = stubs[i];
+	    const Stub *b = stubs[j];
+	    if( a->r()   != b->r()   ) return a->r()   < b->r();
+	    if( a->phi() != b->phi() ) return a->phi() < b->phi();
+	    if( a->z()   != b->z()   ) return a->z()   < b->z();
+	    return i < j;
+	    } );
+    std::vector<char> isDup( stubs.size(), 0 );
+    for( unsigned k=1; k < byCoord.size(); k++ ){
+	const Stub *stub_a = stubs[ byCoord[k-1] ];
+	const Stub *stub_b = stubs[ byCoord[k] ];
+	if( stub_a->r() == stub_b->r() && stub_a->phi() == stub_b->phi() && stub_a->z() == stub_b->z() ){
+	    isDup[ byCoord[k] ] = 1;
+	    nDupStubs_ ++;
 	}
     }
+    unsigned nKept(0);
+    for( unsigned i=0; i < stubs.size(); i++ ){
+	if( !isDup[i] ) stubs[nKept++] = stubs[i];
+    }
+    stubs.resize( nKept );
+
+    //position in this list of the first stub in each layer (& one beyond the last stub), so the KF can take those in each layer in turn.
+    layerStart_.clear();
+    for( unsigned i=0; i < stubs.size(); i++ ){
+	if( i == 0 || stubs[i-1]->layerId() != stubs[i]->layerId() ) layerStart_.push_back( i );
+    }
+    layerStart_.push_back( stubs.size() );
 
 
     //seed
     std::vector<double> x0 = seedx(l1track3D);
     TMatrixD pxx0 = seedP(l1track3D);
-    std::vector<const kalmanState *> states;
-
     const kalmanState *state0 = mkState( 0, 0, 0, 0, x0, pxx0, 0, 0 );
-    states.push_back( state0 );
 
     //fill histograms for the track informations
     if( getSettings()->kalmanFillInternalHists() ) fillTrackHists( state0, tpa, stubs );
@@ -420,7 +432,7 @@ L1fittedTrack L1KalmanComb::fit(const L1track3D& l1track3D, unsigned int iPhiSec
     }
 
     //Kalman Filter
-    std::vector<const kalmanState *> last_states = doKF( 1, states, stubs, tpa );
+    std::vector<const kalmanState *> last_states = doKF( state0, stubs, layerStart_, tpa );
     //sort the candidate states in # of layer, more stubs come first
     sort( last_states.begin(), last_states.end(), kalmanState::order);
 
@@ -492,8 +504,8 @@ L1fittedTrack L1KalmanComb::fit(const L1track3D& l1track3D, unsigned int iPhiSec
 	//fill histograms for the selected state with TP for algEff
 	if( getSettings()->kalmanFillInternalHists() ) fillCandHists( *cand, tpa );
 
-	std::map<std::string, double> tp = getTrackParams(cand);
-	L1fittedTrack returnTrk(getSettings(), l1track3D, cand->stubs(), tp["qOverPt"], tp["d0"], tp["phi0"], tp["z0"], tp["t"], cand->chi2(), nPar_, iPhiSec, iEtaReg, true);
+	HelixParams tp = getTrackParams(cand);
+	L1fittedTrack returnTrk(getSettings(), l1track3D, cand->stubs(), tp.qOverPt, tp.d0, tp.phi0, tp.z0, tp.tanLambda, cand->chi2(), nPar_, iPhiSec, iEtaReg, true);
 
 	if( getSettings()->kalmanDebugLevel() >= 1 ){
 	    if( tpa && tpa->useForAlgEff() && returnTrk.getPurity() != 1 ){
@@ -529,194 +541,206 @@ unsigned L1KalmanComb::getNextLayer( unsigned state_layer, unsigned next_stub_la
     else return state_layer + 1; 
 }
 
-std::vector<const Stub *> L1KalmanComb::getNextLayerStubs( const kalmanState *state, std::vector<const Stub *> &stubs, unsigned &next_layer )
-{
-    std::vector<const Stub *> list;
+std::vector<const kalmanState *> L1KalmanComb::doKF( const kalmanState *state0, const std::vector<const Stub *> &stubs, const std::vector<unsigned> &layerStart, const TP *tpa ){
 
-    if( stubs.size() == 0 ) return list;
+    //states reaching the last layer done, and the next one, (swapped after each layer).
+    std::vector<const kalmanState *> states( 1, state0 );
+    std::vector<const kalmanState *> new_states;
+    std::vector<const kalmanState *> active_states;
+    std::vector<unsigned> nvs(3,0);
 
-    unsigned state_layer = state->layerId(); 
+    //the first layer with stubs not yet used, and the # of stubs in it and later layers.
+    const unsigned nLayers = layerStart.size() - 1;
+    unsigned iLayer(0);
+    unsigned nStubsLeft = stubs.size();
+    const bool updateSeed = updatesSeedWithStub();
+    //stubs passing the validation gate of each state, (reused for all states & layers).
+    std::vector<const Stub *> &next_stubs = nextStubs_;
 
-    unsigned next_stub_layer = stubs.at(0)->layerId();
-    next_layer = getNextLayer( state_layer, next_stub_layer );
+    for( unsigned nItr = 1; ; nItr++ ){
 
-    std::vector<const Stub *>::iterator s_it = stubs.begin();
-    std::vector<const Stub *>::iterator lastnextstub_it = stubs.end();
-    for(; s_it != stubs.end(); s_it++ ){
-	const Stub *stub = *s_it;
-	if( stub->layerId() == next_layer ){
-	    list.push_back(stub);
-	    lastnextstub_it = s_it;
+	if( getSettings()->kalmanDebugLevel() >= 2 ){
+	    cout << "----------------------------" << endl;
+	    cout << "doKF # of iteration = " << nItr << " # of stubs left = " << nStubsLeft << " # of the last states = " << states.size() << endl;
+	    cout << "----------------------------" << endl;
 	}
-	else break;
-    }
-    if( list.size() != 0 ) stubs.erase( stubs.begin(), lastnextstub_it + 1 );
 
-    return list;
-}
-
-std::vector<const kalmanState *> L1KalmanComb::doKF( unsigned nItr, const std::vector<const kalmanState *> &states, std::vector<const Stub *> stubs, const TP *tpa ){
-
-    if( getSettings()->kalmanDebugLevel() >= 2 ){
-	cout << "----------------------------" << endl;
-	cout << "doKF # of iteration = " << nItr << " # of stubs left = " << stubs.size() << " # of the last states = " << states.size() << endl;
-	cout << "----------------------------" << endl;
-    }
-
-    //finish when there is no more stub or no state
-    if( states.size() == 0 ) return states;
-    if( stubs.size() == 0 ) return states;
+	//finish when there is no more stub or no state
+	if( states.size() == 0 ) break;
+	if( iLayer == nLayers ) break;
 
-    std::vector<const kalmanState *> active_states;
-    std::vector<const kalmanState *> new_states;
-    std::vector<unsigned> nvs(3,0);
+	active_states.clear();
+	new_states.clear();
+	nvs.assign(3,0);
 
-    std::vector<const kalmanState *>::const_iterator i_state = states.begin();
-    for(; i_state != states.end(); i_state++ ){ 
+	for( const kalmanState *the_state : states ){ 
 
-	const kalmanState *the_state = *i_state;
-	if( the_state->nVirtualStubs() == getSettings()->kalmanMaxNumVirtualStubs() + 1 && the_state->nStubLayers() >= getSettings()->minStubLayers() ){
-	    new_states.push_back( the_state );
-	    nvs.at( the_state->nVirtualStubs()-1 )++;
+	    if( the_state->nVirtualStubs() == getSettings()->kalmanMaxNumVirtualStubs() + 1 && the_state->nStubLayers() >= getSettings()->minStubLayers() ){
+		new_states.push_back( the_state );
+		nvs.at( the_state->nVirtualStubs()-1 )++;
+	    }
+	    else{
+		active_states.push_back( the_state );
+	    }
+	}
+	if( active_states.size() == 0 ){
+	    states.swap( new_states );
+	    break;
 	}
-	else{
-	    active_states.push_back( the_state );
+
+	//find next layer id from the last state and the first unused stub, and take the stubs in its layer if that is the next one. 
+	const Stub * const *layer_stubs = &stubs[ layerStart[iLayer] ];
+	unsigned next_layer = getNextLayer( active_states.at(0)->layerId(), layer_stubs[0]->layerId() );
+	const Stub * const *pre_next_stubs = layer_stubs;
+	const unsigned n_pre_next_stubs = ( layer_stubs[0]->layerId() == next_layer )  ?  layerStart[iLayer+1] - layerStart[iLayer]  :  0;
+	if( n_pre_next_stubs != 0 ){
+	    nStubsLeft -= n_pre_next_stubs;
+	    iLayer++;
 	}
-    }
-    if( active_states.size() == 0 ) return new_states;
 
-    //find next layer id from the last state and get next stub list removing those from the original stub list. 
-    unsigned next_layer(0);
-    std::vector<const Stub *> pre_next_stubs = getNextLayerStubs( active_states.at(0), stubs, next_layer );
+	if( getSettings()->kalmanDebugLevel() >= 2 ){
+	    cout << "# of pre next stubs = " << n_pre_next_stubs << endl;
+	}
 
-    if( getSettings()->kalmanDebugLevel() >= 2 ){
-	cout << "# of pre next stubs = " << pre_next_stubs.size() << endl;
-    }
+	for( auto i_state = active_states.begin(); i_state != active_states.end(); i_state++ ){ 
 
-    i_state = active_states.begin();
-    for(; i_state != active_states.end(); i_state++ ){ 
+	    if( new_states.size() == getSettings()->kalmanMaxNumStatesCutValue() ) break; 
 
-	if( new_states.size() == getSettings()->kalmanMaxNumStatesCutValue() ) break; 
+	    const kalmanState *the_state = *i_state;
 
-	const kalmanState *the_state = *i_state;
+	    //predict the state to the next layer once, for use with all stubs in that layer, if the model allows this.
+	    //(Not for the 5 parameter seed, which is updated with each stub).
+	    Prediction pred;
+	    bool usePred = !predictionDependsOnStub() && n_pre_next_stubs > 0 && !( nItr == 1 && updateSeed );
+	    if( usePred ) predict( *the_state, pre_next_stubs[0], nItr, pred );
 
+	    //stub cut based on the stub compatibility with the last evaluated state.
+	    //No cut for the state with less than 3 stubs.
+	    next_stubs.clear();
 
-	//stub cut based on the stub compatibility with the last evaluated state.
-	//No cut for the state with less than 3 stubs.
-	std::vector<const Stub *> next_stubs;
+	    if( (int)the_state->nStubLayers() < 3 ){
 
-	if( (int)the_state->nStubLayers() < 3 ){
+		if( n_pre_next_stubs <= getSettings()->kalmanMaxNumNextStubs() ) 
+		    next_stubs.assign( pre_next_stubs, pre_next_stubs + n_pre_next_stubs );
+	    }
+	    else{
+		std::vector<double> &e2s = e2s_;
+		if( usePred ) validationGates( pre_next_stubs, n_pre_next_stubs, pred, e2s );
 
-	    if( pre_next_stubs.size() <= getSettings()->kalmanMaxNumNextStubs() ) 
-		next_stubs = pre_next_stubs;
-	}
-	else{
-	    for( unsigned i=0; i < pre_next_stubs.size(); i++ ){
+		for( unsigned i=0; i < n_pre_next_stubs; i++ ){
 
-		const Stub * pre_next_stub = pre_next_stubs[i];
-//		if( dump_ ) { cout << "stub layerId, sigmaX, sigmaZ = " << pre_next_stub->layerId() << ", " << pre_next_stub->sigmaX() << ", " << pre_next_stub->sigmaZ() << endl; }
+		    const Stub * pre_next_stub = pre_next_stubs[i];
+    //		if( dump_ ) { cout << "stub layerId, sigmaX, sigmaZ = " << pre_next_stub->layerId() << ", " << pre_next_stub->sigmaX() << ", " << pre_next_stub->sigmaZ() << endl; }
 
-		const kalmanState *state = the_state;
-		if( nItr == 1 && fitterName_.compare( "KF5ParamsComb" ) == 0 ){
-		    const kalmanState *state0 = updateSeedWithStub( *the_state, pre_next_stub );
-		    state = state0;
-		}
+		    const kalmanState *state = the_state;
+		    if( nItr == 1 && updateSeed ){
+			const kalmanState *state0 = updateSeedWithStub( *the_state, pre_next_stub );
+			state = state0;
+		    }
 
-		double e2(0);
-		bool pass = validationGate( pre_next_stub, nItr, *state, e2 );
-		if( pass ){
-		    next_stubs.push_back( pre_next_stub );
-		}
-		else{
-		    if( getSettings()->kalmanDebugLevel() >= 2 ){
-			if( tpa && tpa->useForAlgEff() ){
-			    set<const TP*> tps = pre_next_stub->assocTPs();
-			    if( state->good( tpa ) && tps.find( tpa ) != tps.end() ){
-				cout << "A good stub is thrown away." << " e2 = " << e2 << " TPindex = " << tpa->index() << " [eta,phi] = [" << iCurrentPhiSec_ << " , " << iCurrentEtaReg_ << "]" << endl;
-				printStub(cout,pre_next_stub);
-				validationGate( pre_next_stub, nItr, *state, e2, true );
+		    double e2(0);
+		    bool pass;
+		    if( usePred ){
+			e2 = e2s[i];
+			pass = e2 * 0.5 < getSettings()->kalmanValidationGateCutValue();
+		    }
+		    else pass = validationGate( pre_next_stub, nItr, *state, e2 );
+		    if( pass ){
+			next_stubs.push_back( pre_next_stub );
+		    }
+		    else{
+			if( getSettings()->kalmanDebugLevel() >= 2 ){
+			    if( tpa && tpa->useForAlgEff() ){
+				set<const TP*> tps = pre_next_stub->assocTPs();
+				if( state->good( tpa ) && tps.find( tpa ) != tps.end() ){
+				    cout << "A good stub is thrown away." << " e2 = " << e2 << " TPindex = " << tpa->index() << " [eta,phi] = [" << iCurrentPhiSec_ << " , " << iCurrentEtaReg_ << "]" << endl;
+				    printStub(cout,pre_next_stub);
+				    validationGate( pre_next_stub, nItr, *state, e2, true );
+				}
 			    }
 			}
 		    }
 		}
 	    }
-	}
-	if( getSettings()->kalmanDebugLevel() >= 2 ){
-	    cout << "# of next stubs = " << next_stubs.size() << endl;
-	}
+	    if( getSettings()->kalmanDebugLevel() >= 2 ){
+		cout << "# of next stubs = " << next_stubs.size() << endl;
+	    }
 
-	//stubs are sorted for overlap stub merging.
-	if( next_layer < 10 ) 
-	    sort( next_stubs.begin(), next_stubs.end(), orderStubsByZ );
-	else
-	    sort( next_stubs.begin(), next_stubs.end(), orderStubsByR );
+	    //stubs are sorted for overlap stub merging.
+	    if( next_layer < 10 ) 
+		sort( next_stubs.begin(), next_stubs.end(), orderStubsByZ );
+	    else
+		sort( next_stubs.begin(), next_stubs.end(), orderStubsByR );
 
-	//stub loop
-	for( unsigned i=0; i < next_stubs.size() && i < getSettings()->kalmanMaxNumNextStubs() ; i++ ){
+	    //stub loop
+	    for( unsigned i=0; i < next_stubs.size() && i < getSettings()->kalmanMaxNumNextStubs() ; i++ ){
 
-	    const Stub * next_stub = next_stubs[i];
-//	    if( dump_ ){ cout << "stub (phi,z) = ( " << next_stub->phi() << ", " << next_stub->z() << ")" << endl; } 
+		const Stub * next_stub = next_stubs[i];
+    //	    if( dump_ ){ cout << "stub (phi,z) = ( " << next_stub->phi() << ", " << next_stub->z() << ")" << endl; } 
 
-	    //For 5 parameter, seed d0 is calculated from stub's bend information.
-	    const kalmanState *state = the_state;
-	    if( nItr == 1 && fitterName_.compare( "KF5ParamsComb" ) == 0 ){
-		const kalmanState *state0 = updateSeedWithStub( *the_state, next_stub );
-		state = state0;
-	    }
+		//For 5 parameter, seed d0 is calculated from stub's bend information.
+		const kalmanState *state = the_state;
+		if( nItr == 1 && updateSeed ){
+		    const kalmanState *state0 = updateSeedWithStub( *the_state, next_stub );
+		    state = state0;
+		}
 
-	    //The stubs close to each others are processed one after another as a set of stubs.
-	    const kalmanState *new_state = kalmanUpdate( nItr, next_stub, *state, tpa );
-	    while( next_stub != next_stubs.back() && isOverlap( next_stub, next_stubs.at(i+1) ) ){
-		if( getSettings()->kalmanFillInternalHists() ) 
-		    hnmergeStub_->Fill(0);
-		next_stub = next_stubs.at(i+1);
-		new_state = kalmanUpdate( nItr, next_stub, *new_state, tpa );
-		i++;
-	    }
+		//The stubs close to each others are processed one after another as a set of stubs.
+		const kalmanState *new_state = kalmanUpdate( nItr, next_stub, *state, tpa, usePred ? &pred : 0 );
+		while( next_stub != next_stubs.back() && isOverlap( next_stub, next_stubs.at(i+1) ) ){
+		    if( getSettings()->kalmanFillInternalHists() ) 
+			hnmergeStub_->Fill(0);
+		    next_stub = next_stubs.at(i+1);
+		    new_state = kalmanUpdate( nItr, next_stub, *new_state, tpa );
+		    i++;
+		}
 
-	    //state cut
-	    if( isGoodState( *new_state ) ){
+		//state cut
+		if( isGoodState( *new_state ) ){
 
-		nvs.at( new_state->nVirtualStubs() - 1 )++;
-		new_states.push_back( new_state );
+		    nvs.at( new_state->nVirtualStubs() - 1 )++;
+		    new_states.push_back( new_state );
 
-	    }
-	    else{
-		if( getSettings()->kalmanDebugLevel() >= 2 ){
-		    if( tpa && tpa->useForAlgEff() ){
-			if( new_state->good( tpa ) ){
-			    cout << "A good state is thrown away." << " rchi2 = " << new_state->reducedChi2() << " TPindex = " << tpa->index() << " [eta,phi] = [" << iCurrentPhiSec_ << " , " << iCurrentEtaReg_ << "]" << endl;
-			    new_state->dump(cout, tpa, true );
+		}
+		else{
+		    if( getSettings()->kalmanDebugLevel() >= 2 ){
+			if( tpa && tpa->useForAlgEff() ){
+			    if( new_state->good( tpa ) ){
+				cout << "A good state is thrown away." << " rchi2 = " << new_state->reducedChi2() << " TPindex = " << tpa->index() << " [eta,phi] = [" << iCurrentPhiSec_ << " , " << iCurrentEtaReg_ << "]" << endl;
+				new_state->dump(cout, tpa, true );
+			    }
 			}
 		    }
-		}
-	    } 
-	}//end of next stub loop
-
-	//A virtual stub is added to all the states with less than the maximum # of virtual stubs. 
-	//The state counts the seed as virtual stub. This is not taken into account in the setting kalmanMaxNumVirtualStubs.
-	double r = getRofState( next_layer, the_state->xa() );
-	if( the_state->nVirtualStubs() - 1 < getSettings()->kalmanMaxNumVirtualStubs() ){
-	    const kalmanState *new_state_vs = mkState( nItr, next_layer, r, the_state, the_state->xa(), the_state->pxxa(), 0, the_state->chi2() ); 
-	    new_states.push_back( new_state_vs );
-	    nvs.at( new_state_vs->nVirtualStubs() - 1 )++;
-	}
-    }//end of state loop
+		} 
+	    }//end of next stub loop
+
+	    //A virtual stub is added to all the states with less than the maximum # of virtual stubs. 
+	    //The state counts the seed as virtual stub. This is not taken into account in the setting kalmanMaxNumVirtualStubs.
+	    double r = getRofState( next_layer, the_state->xa() );
+	    if( the_state->nVirtualStubs() - 1 < getSettings()->kalmanMaxNumVirtualStubs() ){
+		const kalmanState *new_state_vs = mkState( nItr, next_layer, r, the_state, the_state->xa(), the_state->pxxa(), 0, the_state->chi2() ); 
+		new_states.push_back( new_state_vs );
+		nvs.at( new_state_vs->nVirtualStubs() - 1 )++;
+	    }
+	}//end of state loop
 
 
-    //filling the # of states histograms
-    if( getSettings()->kalmanFillInternalHists() ) fillEachNumOfVirtualStubStateHists( nItr, nvs.at(0), nvs.at(1), nvs.at(2) );
+	//filling the # of states histograms
+	if( getSettings()->kalmanFillInternalHists() ) fillEachNumOfVirtualStubStateHists( nItr, nvs.at(0), nvs.at(1), nvs.at(2) );
 
-    if( getSettings()->kalmanDebugLevel() >= 2 ){
+	if( getSettings()->kalmanDebugLevel() >= 2 ){
 
-	cout << "STATES at Itr = " << nItr << " layerId = " << next_layer << " [" << nvs.at(0) << " " << nvs.at(1) << " " << nvs.at(2) << " " << new_states.size() << "]" << endl;
+	    cout << "STATES at Itr = " << nItr << " layerId = " << next_layer << " [" << nvs.at(0) << " " << nvs.at(1) << " " << nvs.at(2) << " " << new_states.size() << "]" << endl;
 
-	if( new_states.size() == 0 && tpa && tpa->useForAlgEff() ){
-	    cout << "No state remained for a good track and no more KF at Iteration : " << nItr << endl;
+	    if( new_states.size() == 0 && tpa && tpa->useForAlgEff() ){
+		cout << "No state remained for a good track and no more KF at Iteration : " << nItr << endl;
+	    }
 	}
+
+	states.swap( new_states );
     }
 
-    return doKF( nItr+1, new_states, stubs, tpa );
+    return states;
 }
 
 bool L1KalmanComb::validationGate( const Stub *stub, unsigned stub_itr, const kalmanState &state, double &e2, bool debug )const 
@@ -728,8 +752,8 @@ bool L1KalmanComb::validationGate( const Stub *stub, unsigned stub_itr, const ka
     TMatrixD            cov_xa = state.pxxa(); 
     if( state.barrel() && !stub->barrel() ){ barrelToEndcap( xa, cov_xa ); }
 
-    std::vector<double> delta = residual(stub, xa );
     TMatrixD f = F( stub, &state );
+    std::vector<double> delta = residual(stub, Fx( f, xa ) );
     TMatrixD h = H(stub);
 
     TMatrixD pxxm = PxxModel( &state, stub, stub_itr );
@@ -761,6 +785,40 @@ bool L1KalmanComb::validationGate( const Stub *stub, unsigned stub_itr, const ka
     return e2 * 0.5 < getSettings()->kalmanValidationGateCutValue();
 }
 
+void L1KalmanComb::validationGates( const Stub * const *stubs, unsigned nStubs, const Prediction &pred, std::vector<double> &e2s )const 
+{
+    e2s.assign( nStubs, 0 );
+    if( pred.state->stubs().size() < 3 ) return; 
+
+    //same as validationGate() for each stub, but using the shared prediction of the state,
+    //and calculating the chi2 with the explicit inverse of the 2x2 residual covariance matrix.
+    for( unsigned s=0; s < nStubs; s++ ){
+
+	const Stub *stub = stubs[s];
+	std::vector<double> delta = residual( stub, pred.fx );
+	TMatrixD h = H(stub);
+	TMatrixD pddm = PddMeas( stub, pred.state );
+
+	double c[2][2];
+	for( int i=0; i < 2; i++ ){ 
+	    for( int k=0; k < 2; k++ ){ 
+		c[i][k] = pddm(i,k);
+		for( int j=0; j < h.GetNcols(); j++ ){ 
+		    for( int l=0; l < h.GetNcols(); l++ ){ 
+			c[i][k] += h(i,j) * pred.pxcov(j,l) * h(k,l);
+		    }
+		}
+	    }
+	}
+	double det = c[0][0] * c[1][1] - c[0][1] * c[1][0];
+	if( det == 0 ){
+	    e2s[s] = 999;
+	    continue;
+	}
+	e2s[s] = ( delta[0] * delta[0] * c[1][1] - delta[0] * delta[1] * ( c[0][1] + c[1][0] ) + delta[1] * delta[1] * c[0][0] ) / det;
+    }
+}
+
 double L1KalmanComb::calcChi2( unsigned itr, const kalmanState &state )const{
 
     if( getSettings()->kalmanDebugLevel() >= 4 ){
@@ -816,7 +874,7 @@ double L1KalmanComb::calcChi2( unsigned itr, const kalmanState &state )const{
     return chi2;
 }
 
-const kalmanState *L1KalmanComb::kalmanUpdate( unsigned thisItr, const Stub *stub, const kalmanState &state, const TP *tpa ){
+const kalmanState *L1KalmanComb::kalmanUpdate( unsigned thisItr, const Stub *stub, const kalmanState &state, const TP *tpa, const Prediction *pred ){
 
     if( getSettings()->kalmanDebugLevel() >= 3 ){
 	cout << "---------------" << endl;
@@ -826,24 +884,20 @@ const kalmanState *L1KalmanComb::kalmanUpdate( unsigned thisItr, const Stub *stu
     }
 
 
-    std::vector<double> xa     = state.xa();
-    TMatrixD            cov_xa = state.pxxa(); 
-    if( state.barrel() && !stub->barrel() ){ 
-	barrelToEndcap( xa, cov_xa );
-	if( getSettings()->kalmanDebugLevel() >= 3 ){
-	    cout << "Previous state changed from Barrel to Endcap parameters" << endl;
-	}
+    //predict the state to this stub's layer, unless already done.
+    Prediction myPred;
+    if( pred == 0 ){
+	predict( state, stub, thisItr, myPred );
+	pred = &myPred;
     }
-    TMatrixD f = F(stub, &state );
-    TMatrixD ft(TMatrixD::kTransposed, f );
+    const TMatrixD &f = pred->f;
     if( getSettings()->kalmanDebugLevel() >= 3 ){
 	cout << "f" << endl;
 	f.Print();
-	cout << "ft" << endl;
-	ft.Print();
     }
 
-    std::vector<double> fx = Fx( f, xa ); 
+    //state predicted to this layer, F * x, which the stub updates.
+    const std::vector<double> &fx = pred->fx; 
     if( getSettings()->kalmanDebugLevel() >= 3 ){
 	cout << "fx = ["; 
 	for( unsigned i = 0; i < nPar_; i++ ) cout << fx.at(i) << ", ";
@@ -878,15 +932,15 @@ const kalmanState *L1KalmanComb::kalmanUpdate( unsigned thisItr, const Stub *stu
 
     if( getSettings()->kalmanDebugLevel() >= 3 ){
 	cout << "previous state covariance" << endl;
-	cov_xa.Print();
+	pred->cov_xa.Print();
     }
-    TMatrixD pxxm = PxxModel( &state, stub, thisItr );
+    const TMatrixD &pxxm = pred->pxxm;
     if( getSettings()->kalmanDebugLevel() >= 3 ){
 	cout << "pxxm" << endl;
 	pxxm.Print();
     }
 
-    TMatrixD pxcov = f * cov_xa * ft + pxxm;
+    const TMatrixD &pxcov = pred->pxcov;
     if( getSettings()->kalmanDebugLevel() >= 3 ){
 	cout << "pxcov" << endl;
 	pxcov.Print();
@@ -904,7 +958,7 @@ const kalmanState *L1KalmanComb::kalmanUpdate( unsigned thisItr, const Stub *stu
     //   cout << "adjust starts" << endl;
     std::vector<double> new_xa(nPar_);
     TMatrixD new_pxxa;
-    GetAdjustedState( k, pxcov, xa, stub, new_xa, new_pxxa );
+    GetAdjustedState( k, pxcov, fx, stub, new_xa, new_pxxa );
     if( getSettings()->kalmanDebugLevel() >= 3 ){
 	if( nPar_ == 4 )
 	    cout << "adjusted x = " << new_xa[0] << ", " << new_xa[1] << ", " << new_xa[2] << ", " << new_xa[3] << endl;
@@ -928,6 +982,31 @@ const kalmanState *L1KalmanComb::kalmanUpdate( unsigned thisItr, const Stub *stu
     //   cout << "kalanUpdate end" << endl;
     return new_state;
 }
+void L1KalmanComb::predict( const kalmanState &state, const Stub *stub, unsigned stub_itr, Prediction &pred )const
+{
+    pred.state = &state;
+    pred.xa    = state.xa();
+    pred.cov_xa.ResizeTo( state.pxxa() );
+    pred.cov_xa = state.pxxa(); 
+    if( state.barrel() && !stub->barrel() ){ 
+	barrelToEndcap( pred.xa, pred.cov_xa );
+	if( getSettings()->kalmanDebugLevel() >= 3 ){
+	    cout << "Previous state changed from Barrel to Endcap parameters" << endl;
+	}
+    }
+    TMatrixD f = F(stub, &state );
+    TMatrixD ft(TMatrixD::kTransposed, f );
+    pred.f.ResizeTo( f );
+    pred.f = f;
+    pred.fx = Fx( f, pred.xa ); 
+
+    TMatrixD pxxm = PxxModel( &state, stub, stub_itr );
+    pred.pxxm.ResizeTo( pxxm );
+    pred.pxxm = pxxm;
+    TMatrixD pxcov = f * pred.cov_xa * ft + pxxm;
+    pred.pxcov.ResizeTo( pxcov );
+    pred.pxcov = pxcov;
+}
 void L1KalmanComb::resetStates()
 {
     for( unsigned int i=0; i < state_list_.size(); i++ ){
@@ -1101,13 +1180,13 @@ void L1KalmanComb::fillCandHists( const kalmanState &state, const TP *tpa )
     if( tpa ){
 
 	std::vector<double> xf = state.xa();
-	std::map<std::string, double> mxf = getTrackParams( &state );
+	HelixParams mxf = getTrackParams( &state );
 	std::vector<double> vxf(nPar_);
-	vxf[0] = mxf["qOverPt"];
-	vxf[1] = mxf["phi0"];
-	vxf[2] = mxf["z0"];
-	vxf[3] = mxf["t"];
-	if( nPar_ == 5 ) vxf[4] = mxf["d0"];
+	vxf[0] = mxf.qOverPt;
+	vxf[1] = mxf.phi0;
+	vxf[2] = mxf.z0;
+	vxf[3] = mxf.tanLambda;
+	if( nPar_ == 5 ) vxf[4] = mxf.d0;
 
 	for( unsigned i=0; i < nPar_; i++ ){
 	    hname = Form( "hxf_%d", i );
@@ -1133,13 +1212,13 @@ void L1KalmanComb::fillCandHists( const kalmanState &state, const TP *tpa )
 	    const kalmanState *last = &state;
 	    while( last->nIterations() > 0 ){
 		std::vector<double> x = last->xa();
-		std::map<std::string, double> mx = getTrackParams(last);
+		HelixParams mx = getTrackParams(last);
 		std::vector<double> vx(nPar_);
-		vx[0] = mx["qOverPt"];
-		vx[1] = mx["phi0"];
-		vx[2] = mx["z0"];
-		vx[3] = mx["t"];
-		if( nPar_ == 5 ) vx[4] = mx["d0"];
+		vx[0] = mx.qOverPt;
+		vx[1] = mx.phi0;
+		vx[2] = mx.z0;
+		vx[3] = mx.tanLambda;
+		if( nPar_ == 5 ) vx[4] = mx.d0;
 		hname = Form( "hxaxt_%s_itr%d_%d", type.c_str(), last->nIterations(), i );
 		if( hxaxtMap.find( hname ) == hxaxtMap.end() ){
 		    cout << hname << " does not exist." << endl;
@@ -1183,13 +1262,13 @@ void L1KalmanComb::fillTrackHists( const kalmanState *state, const TP *tpa, std:
 	    else hxtMap[hname]->Fill(xt[i]);
 	}
 	//Histogram Fill : Seed state 
-	std::map<std::string, double> mx0 = getTrackParams( state );
+	HelixParams mx0 = getTrackParams( state );
 	std::vector<double> vx0(nPar_);
-	vx0[0] = mx0["qOverPt"];
-	vx0[1] = mx0["phi0"];
-	vx0[2] = mx0["z0"];
-	vx0[3] = mx0["t"];
-	if( nPar_ == 5 ) vx0[4] = mx0["d0"];
+	vx0[0] = mx0.qOverPt;
+	vx0[1] = mx0.phi0;
+	vx0[2] = mx0.z0;
+	vx0[3] = mx0.tanLambda;
+	if( nPar_ == 5 ) vx0[4] = mx0.d0;
 	for( unsigned i=0; i < nPar_; i++ ){
 	    TString hname = Form( "hx0_%d", i );
 	    if( hx0Map.find(hname) == hx0Map.end() ){
@@ -1266,13 +1345,13 @@ void L1KalmanComb::fillStepHists( const TP *tpa, unsigned nItr,
 		    xt[0] = xt[2] * tpa->tanLambda();
 		    xt[1] = tpa->z0() + xt[0] * tpa->phi0();
 		}
-		std::map<std::string, double> mx = getTrackParams( new_state );
+		HelixParams mx = getTrackParams( new_state );
 		std::vector<double> vx(nPar_);
-		vx[0] = mx["qOverPt"];
-		vx[1] = mx["phi0"];
-		vx[2] = mx["z0"];
-		vx[3] = mx["t"];
-		if( nPar_ == 5 ) vx[4] = mx["d0"];
+		vx[0] = mx.qOverPt;
+		vx[1] = mx.phi0;
+		vx[2] = mx.z0;
+		vx[3] = mx.tanLambda;
+		if( nPar_ == 5 ) vx[4] = mx.d0;
 
 		hxaxtMap[hname]->Fill( vx[i]-xt[i] );
 		//if( i==1 && j==1 ) cout << "pxxf(1,1)=" << pxxf(i,j) << endl;
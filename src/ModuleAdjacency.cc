@@ -0,0 +1,104 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleAdjacency.h"
+
+#include "Geometry/TrackerGeometryBuilder/interface/StackedTrackerGeometry.h"
+#include "DataFormats/Math/interface/deltaPhi.h"
+
+#include <map>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+  // Allow for small gaps between sensors of neighbouring modules (cm).
+  const float tolerance = 0.5;
+}
+
+//=== Build the table from all modules in the tracker.
+
+ModuleAdjacency::ModuleAdjacency(const StackedTrackerGeometry* stackedGeometry) {
+
+  // Find area covered by each module, grouping modules by layer.
+  map<uint32_t, vector<ModuleArea> > modulesInLayer;
+
+  for (const StackedTrackerDetUnit* stack : stackedGeometry->stacks()) {
+    const StackedTrackerDetId stDetId = stack->Id();
+
+    ModuleArea mod;
+    mod.idDet  = stDetId();
+    mod.barrel = stDetId.isBarrel();
+    // Encode layer ID as in class Stub.
+    mod.layerId = mod.barrel  ?  stDetId.iLayer()  :  10*stDetId.iSide() + stDetId.iDisk();
+
+    // Find (r,phi,z) range covered by corners of both sensors.
+    // Phi is measured relative to that of the first sensor's centre, to avoid problems at phi = +-pi.
+    const float phiRef = stackedGeometry->idToDet(stDetId, 0)->position().phi();
+    float minPhi = 999., maxPhi = -999.;
+    mod.minR = mod.minZ =  999999.;
+    mod.maxR = mod.maxZ = -999999.;
+    for (unsigned int iSensor = 0; iSensor <= 1; iSensor++) {
+      const GeomDet* det = stackedGeometry->idToDet(stDetId, iSensor);
+      const Bounds& bounds = det->surface().bounds();
+      const float halfWidth  = 0.5*bounds.width();
+      const float halfLength = 0.5*bounds.length();
+      for (int iu = -1; iu <= 1; iu += 2) {
+        for (int iv = -1; iv <= 1; iv += 2) {
+          const GlobalPoint corner = det->surface().toGlobal( LocalPoint(iu*halfWidth, iv*halfLength, 0.) );
+          const float dPhi = reco::deltaPhi(corner.phi(), phiRef);
+          minPhi   = min(minPhi,   dPhi);
+          maxPhi   = max(maxPhi,   dPhi);
+          mod.minR = min(mod.minR, float(corner.perp()));
+          mod.maxR = max(mod.maxR, float(corner.perp()));
+          mod.minZ = min(mod.minZ, float(corner.z()));
+          mod.maxZ = max(mod.maxZ, float(corner.z()));
+        }
+      }
+    }
+    mod.phiCentre    = reco::deltaPhi(phiRef + 0.5*(minPhi + maxPhi), 0.);
+    mod.halfDeltaPhi = 0.5*(maxPhi - minPhi);
+
+    modulesInLayer[mod.layerId].push_back(mod);
+    neighbours_[mod.idDet]; // Ensure every module has an entry, even without neighbours.
+  }
+
+  // Compare all pairs of modules within each layer. This is slow, but only done once per run.
+  for (const auto& layer : modulesInLayer) {
+    const vector<ModuleArea>& mods = layer.second;
+    for (unsigned int i = 0; i < mods.size(); i++) {
+      for (unsigned int j = i + 1; j < mods.size(); j++) {
+        if (overlap(mods[i], mods[j])) {
+          neighbours_[mods[i].idDet].push_back(mods[j].idDet);
+          neighbours_[mods[j].idDet].push_back(mods[i].idDet);
+        }
+      }
+    }
+  }
+
+  for (auto& n : neighbours_) sort(n.second.begin(), n.second.end());
+}
+
+//=== Check if two modules are neighbours.
+
+bool ModuleAdjacency::adjacent(uint32_t idDet1, uint32_t idDet2) const {
+  const vector<uint32_t>& n = this->neighbours(idDet1);
+  return binary_search(n.begin(), n.end(), idDet2);
+}
+
+//=== Check if the areas covered by two modules in the same layer overlap, or are separated by less than the tolerance.
+
+bool ModuleAdjacency::overlap(const ModuleArea& mod1, const ModuleArea& mod2) {
+
+  if (mod1.barrel != mod2.barrel) return false;
+
+  // Convert tolerance to phi at the smaller of the module radii.
+  const float rMin   = max(1.0f, min(mod1.minR, mod2.minR));
+  const float phiTol = tolerance/rMin;
+  if (fabs(reco::deltaPhi(mod1.phiCentre, mod2.phiCentre)) > mod1.halfDeltaPhi + mod2.halfDeltaPhi + phiTol) return false;
+
+  // Barrel modules are distinguished by z, endcap modules by r.
+  if (mod1.barrel) {
+    return (mod1.minZ < mod2.maxZ + tolerance && mod2.minZ < mod1.maxZ + tolerance);
+  } else {
+    return (mod1.minR < mod2.maxR + tolerance && mod2.minR < mod1.maxR + tolerance);
+  }
+}
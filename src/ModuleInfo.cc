@@ -0,0 +1,113 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleInfo.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+
+#include "Geometry/TrackerGeometryBuilder/interface/StackedTrackerGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+//=== Get info about the module from the tracker geometry.
+
+ModuleInfo::ModuleInfo(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId) {
+
+  // Get unique identifier of this module.
+  idDet_ = stDetId();
+
+  // Get min & max (r,phi,z) coordinates of the centre of the two sensors in this module.
+  const GeomDetUnit* det0 = stackedGeometry->idToDetUnit( stDetId, 0 );
+  const GeomDetUnit* det1 = stackedGeometry->idToDetUnit( stDetId, 1 );
+  float R0 = det0->position().perp();
+  float R1 = det1->position().perp();
+  float PHI0 = det0->position().phi();
+  float PHI1 = det1->position().phi();
+  float Z0 = det0->position().z();
+  float Z1 = det1->position().z();
+  minR_   = std::min(R0,R1);
+  maxR_   = std::max(R0,R1);
+  minPhi_ = std::min(PHI0,PHI1);
+  maxPhi_ = std::max(PHI0,PHI1);
+  minZ_   = std::min(Z0,Z1);
+  maxZ_   = std::max(Z0,Z1);
+
+  // Note if module is PS or 2S, and whether in barrel or endcap.
+  psModule_   = stackedGeometry->isPSModule(stDetId);
+  barrel_     = stDetId.isBarrel();
+
+  // Encode layer ID.
+  if (barrel_) {
+    layerId_ = stDetId.iLayer(); // barrel layer 1-6 encoded as 1-6
+  } else {
+    layerId_ = 10*stDetId.iSide() + stDetId.iDisk(); // endcap layer 1-5 encoded as 11-15 (endcap A) or 21-25 (endcapB)
+  }
+
+  // Note module ring in endcap
+  endcapRing_ = barrel_  ?  0  :  stDetId.iRing();
+
+  // Get sensor strip or pixel pitch using innermost sensor of pair.
+  const PixelGeomDetUnit* unit = reinterpret_cast<const PixelGeomDetUnit*>(stackedGeometry->idToDetUnit(stDetId, 0));
+  const GeomDet* det = reinterpret_cast<const GeomDet*>(stackedGeometry->idToDet(stDetId, 0));
+  const PixelTopology& topo = unit->specificTopology();
+  const Bounds& bounds = det->surface().bounds();
+
+  std::pair<float, float> pitch = topo.pitch();
+  stripPitch_ = pitch.first; // Strip pitch (or pixel pitch along shortest axis)
+  stripLength_ = pitch.second;  //  Strip length (or pixel pitch along longest axis)
+  nStrips_ = topo.nrows(); // No. of strips in sensor
+  sensorWidth_ = bounds.width(); // Width of sensitive region of sensor (= stripPitch * nStrips).
+
+  this->calcDerived();
+}
+
+//=== Take info about the module from a stub in an event snapshot.
+
+ModuleInfo::ModuleInfo(const SnapshotStub& snapStub) {
+  idDet_       = snapStub.idDet;
+  minR_        = snapStub.moduleMinR;
+  maxR_        = snapStub.moduleMaxR;
+  minPhi_      = snapStub.moduleMinPhi;
+  maxPhi_      = snapStub.moduleMaxPhi;
+  minZ_        = snapStub.moduleMinZ;
+  maxZ_        = snapStub.moduleMaxZ;
+  psModule_    = snapStub.flags & SnapshotStub::psModule;
+  barrel_      = snapStub.flags & SnapshotStub::barrel;
+  layerId_     = snapStub.layerId;
+  endcapRing_  = snapStub.endcapRing;
+  stripPitch_  = snapStub.stripPitch;
+  stripLength_ = snapStub.stripLength;
+  nStrips_     = snapStub.nStrips;
+  sensorWidth_ = snapStub.sensorWidth;
+
+  this->calcDerived();
+}
+
+//=== Calculate quantities derived from the others.
+
+void ModuleInfo::calcDerived() {
+  sigmaPerp_ = stripPitch_/sqrt(12.); // resolution perpendicular to strip (or to longest pixel axis)
+  sigmaPar_  = stripLength_/sqrt(12.); // resolution parallel to strip (or to longest pixel axis)
+
+  // Uncertainty in stub coordinates due to strip length in case of 2S modules.
+  rErr_ = barrel_  ?  0.  :  0.5*stripLength_;
+  zErr_ = barrel_  ?  0.5*stripLength_  :  0.;
+
+  sensorSpacing_ = barrel_ ? (maxR_ - minR_) : (maxZ_ - minZ_);
+  pitchOverSep_  = stripPitch_/sensorSpacing_;
+}
+
+//=== Get info about the module from the cache, first adding it from the tracker geometry if necessary.
+
+const ModuleInfo* ModuleInfoCache::get(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId) {
+  auto it = modules_.find(stDetId());
+  if (it == modules_.end()) it = modules_.emplace(stDetId(), ModuleInfo(stackedGeometry, stDetId)).first;
+  return &(it->second);
+}
+
+//=== Ditto, but adding it from a stub in an event snapshot if necessary.
+
+const ModuleInfo* ModuleInfoCache::get(const SnapshotStub& snapStub) {
+  auto it = modules_.find(snapStub.idDet);
+  if (it == modules_.end()) it = modules_.emplace(snapStub.idDet, ModuleInfo(snapStub)).first;
+  return &(it->second);
+}
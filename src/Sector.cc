@@ -2,9 +2,12 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/KillOverlapStubs.h"
 
 #include "DataFormats/Math/interface/deltaPhi.h"
 
+#include "tbb/parallel_for.h"
+
 using namespace std;
 
 //=== Initialise
@@ -212,3 +215,35 @@ void Sector::numStubsInside( const TP& tp,
     if (insidePhi)              nStubsInsidePhi++;
   }
 }
+
+//=== Find the stubs inside this sector, removing any duplicates amongst them in overlap regions.
+//=== Must be called before the stubs are digitized. Thread safe.
+
+vector<const Stub*> Sector::stubsInsideNoOverlap( const vector<const Stub*>& vStubs ) const {
+  vector<const Stub*> stubsInside;
+  for (const Stub* stub : vStubs) {
+    if (this->inside(stub)) stubsInside.push_back(stub);
+  }
+
+  KillOverlapStubs killOverlapStubs(stubsInside, settings_);
+  return killOverlapStubs.getFiltered();
+}
+
+//=== Find the stubs inside each of the (already initialized) sectors, after removing duplicates in overlap regions
+//=== separately within each sector. Sectors in different phi are processed in parallel.
+
+void Sector::stubsInsideAllNoOverlap( const Settings* settings, const vector<const Stub*>& vStubs,
+                                      const matrix<Sector>& mSectors, matrix< vector<const Stub*> >& mSectorStubs ) {
+
+  const unsigned int numPhiSectors = settings->numPhiSectors();
+  const unsigned int numEtaRegions = settings->numEtaRegions();
+  mSectorStubs.resize(numPhiSectors, numEtaRegions, false);
+
+  // Each task writes only to its own column of the matrices, and only reads the stubs.
+  // (Run as TBB tasks, so they share the framework's thread pool rather than creating threads of their own).
+  tbb::parallel_for(0u, numPhiSectors, [&](unsigned int iPhiSec) {
+    for (unsigned int iEtaReg = 0; iEtaReg < numEtaRegions; iEtaReg++) {
+      mSectorStubs(iPhiSec, iEtaReg) = mSectors(iPhiSec, iEtaReg).stubsInsideNoOverlap(vStubs);
+    }
+  });
+}
@@ -23,6 +23,7 @@ Settings::Settings(const edm::ParameterSet& iConfig) :
   overlapRemoval_         ( iConfig.getParameter< edm::ParameterSet >         ( "OverlapRemoval"         ) ),
   trackMatchDef_          ( iConfig.getParameter< edm::ParameterSet >         ( "TrackMatchDef"          ) ),
   trackFitSettings_       ( iConfig.getParameter< edm::ParameterSet >         ( "TrackFitSettings"       ) ),
+  histogramGroups_        ( iConfig.getParameter< edm::ParameterSet >         ( "HistogramGroups"        ) ),
 
   //=== Cuts on MC truth tracks used for tracking efficiency measurements.
   genMinPt_               ( genCuts_.getParameter<double>                     ( "GenMinPt"               ) ),
@@ -41,6 +42,8 @@ Settings::Settings(const edm::ParameterSet& iConfig) :
 
   // Optional stub digitization.
   enableDigitize_         ( stubDigitize_.getParameter<bool>                  ( "EnableDigitize"         ) ),
+  batchDigitize_          ( stubDigitize_.getParameter<bool>                  ( "BatchDigitize"          ) ),
+  checkBatchDigitize_     ( stubDigitize_.getParameter<bool>                  ( "CheckBatchDigitize"     ) ),
   firmwareType_           ( stubDigitize_.getParameter<unsigned int>          ( "FirmwareType"           ) ),
   //--- Parameters available in MP board.
   phiSectorBits_          ( stubDigitize_.getParameter<unsigned int>          ( "PhiSectorBits"          ) ),
@@ -99,6 +102,10 @@ Settings::Settings(const edm::ParameterSet& iConfig) :
   busySectorKill_         ( htFillingRphi_.getParameter<bool>                 ( "BusySectorKill"         ) ),
   busySectorNumStubs_     ( htFillingRphi_.getParameter<unsigned int>         ( "BusySectorNumStubs"     ) ),
   busySectorEachCharge_   ( htFillingRphi_.getParameter<bool>                 ( "BusySectorEachCharge"   ) ),
+  twoPassHT_              ( htFillingRphi_.getParameter<bool>                 ( "TwoPassHT"              ) ),
+  hierarchicalHT_         ( htFillingRphi_.getParameter<bool>                 ( "HierarchicalHT"         ) ),
+  coarseFactorPt_         ( htFillingRphi_.getParameter<unsigned int>         ( "CoarseFactorPt"         ) ),
+  coarseFactorPhi_        ( htFillingRphi_.getParameter<unsigned int>         ( "CoarseFactorPhi"        ) ),
 
   //=== Rules governing how stubs are filled into the r-z Hough Transform array. (Irrelevant if enableRzHT = false.)
   handleStripsRzHT_       ( htFillingRz_.getParameter<bool>                   ( "HandleStripsRzHT"       ) ),
@@ -109,10 +116,12 @@ Settings::Settings(const edm::ParameterSet& iConfig) :
   useZTrkFilter_          ( rzFilterOpts_.getParameter<bool>                  ( "UseZTrkFilter"          ) ),
   useSeedFilter_          ( rzFilterOpts_.getParameter<bool>                  ( "UseSeedFilter"          ) ), 
   chosenRofZFilter_       ( rzFilterOpts_.getParameter<double>                ( "ChosenRofZFilter"       ) ),
+  fastZTrkFilter_         ( rzFilterOpts_.getParameter<bool>                  ( "FastZTrkFilter"         ) ),
   seedResolution_         ( rzFilterOpts_.getParameter<double>                ( "SeedResolution"         ) ),
   keepAllSeed_            ( rzFilterOpts_.getParameter<bool>                  ( "KeepAllSeed"            ) ), 
   maxSeedCombinations_    ( rzFilterOpts_.getParameter<unsigned int>          ( "MaxSeedCombinations"    ) ),
   zTrkSectorCheck_        ( rzFilterOpts_.getParameter<bool>                  ( "zTrkSectorCheck"        ) ),
+  fastSeedFilter_         ( rzFilterOpts_.getParameter<bool>                  ( "FastSeedFilter"         ) ),
 
   //=== Rules for deciding when the track finding has found an L1 track candidate
 
@@ -132,11 +141,18 @@ Settings::Settings(const edm::ParameterSet& iConfig) :
   dupMaxPhi0Scan_         ( dupTrkRemoval_.getParameter<double>               ( "DupMaxPhi0Scan"         ) ),
   dupMaxZ0Scan_           ( dupTrkRemoval_.getParameter<double>               ( "DupMaxZ0Scan"           ) ),
   dupMaxTanLambdaScan_    ( dupTrkRemoval_.getParameter<double>               ( "DupMaxTanLambdaScan"    ) ),
+  dupTrkMergeEvent_            ( dupTrkRemoval_.getParameter<unsigned int>     ( "DupTrkMergeEvent"            ) ),
+  dupTrkMergeMinCommonStubs_   ( dupTrkRemoval_.getParameter<unsigned int>     ( "DupTrkMergeMinCommonStubs"   ) ),
+  dupTrkMergeMaxDiffQoverPt_   ( dupTrkRemoval_.getParameter<double>           ( "DupTrkMergeMaxDiffQoverPt"   ) ),
+  dupTrkMergeMaxDiffPhi0_      ( dupTrkRemoval_.getParameter<double>           ( "DupTrkMergeMaxDiffPhi0"      ) ),
+  dupTrkMergeMaxDiffZ0_        ( dupTrkRemoval_.getParameter<double>           ( "DupTrkMergeMaxDiffZ0"        ) ),
+  dupTrkMergeMaxDiffTanLambda_ ( dupTrkRemoval_.getParameter<double>           ( "DupTrkMergeMaxDiffTanLambda" ) ),
 
   //=== Specification of algorithm to eliminate overlap stubs
   overlapAlg_             ( overlapRemoval_.getParameter<std::string>         ( "OverlapAlg"             ) ),
   overlapPtCut_           ( overlapRemoval_.getParameter<double>              ( "OverlapPtCut"           ) ),
   overlapZ0Cut_           ( overlapRemoval_.getParameter<double>              ( "OverlapZ0Cut"           ) ),
+  overlapPerSector_       ( overlapRemoval_.getParameter<bool>                ( "OverlapPerSector"       ) ),
 
   //=== Rules for deciding when a reconstructed L1 track matches a MC truth particle (i.e. tracking particle).
 
@@ -151,6 +167,7 @@ Settings::Settings(const edm::ParameterSet& iConfig) :
   killTrackFitWorstHit_   ( trackFitSettings_.getParameter <bool>             ( "KillTrackFitWorstHit"   ) ),
   generalResidualCut_     ( trackFitSettings_.getParameter<double>            ( "GeneralResidualCut"     ) ),
   killingResidualCut_     ( trackFitSettings_.getParameter<double>            ( "KillingResidualCut"     ) ),
+  trackFitIncremental_    ( trackFitSettings_.getParameter<bool>              ( "TrackFitIncremental"    ) ),
   kalmanDebugLevel_              ( trackFitSettings_.getParameter<unsigned>   ( "KalmanDebugLevel"               ) ),
   kalmanFillInternalHists_       ( trackFitSettings_.getParameter<bool>       ( "KalmanFillInternalHists"        ) ),
   kalmanMultiScattFactor_        ( trackFitSettings_.getParameter<double>     ( "KalmanMultipleScatteringFactor" ) ),
@@ -160,15 +177,30 @@ Settings::Settings(const edm::ParameterSet& iConfig) :
   kalmanMaxNumVirtualStubs_      ( trackFitSettings_.getParameter<unsigned>   ( "KalmanMaxNumVirtualStubs"       ) ),
   kalmanMaxNumStatesCutValue_    ( trackFitSettings_.getParameter<unsigned>   ( "KalmanMaxNumStatesCutValue"     ) ),
   kalmanStateReducedChi2CutValue_( trackFitSettings_.getParameter<double>     ( "KalmanStateReducedChi2CutValue" ) ),
+  kalmanFixedSizeMaths_          ( trackFitSettings_.getParameter<bool>       ( "KalmanFixedSizeMaths"           ) ),
   trackFitters_   ( trackFitSettings_.getParameter<std::vector<std::string>>  ( "TrackFitters"           ) ),
   chi2OverNdfCut_         ( trackFitSettings_.getParameter<double>            ( "Chi2OverNdfCut"         ) ),
   detailedFitOutput_      ( trackFitSettings_.getParameter < bool >           ( "DetailedFitOutput"      ) ),
+  fitCache_               ( trackFitSettings_.getParameter<unsigned int>      ( "FitCache"               ) ),
+
+  //=== Histogram groups
+
+  minimalMonitoring_      ( histogramGroups_.getParameter<bool>               ( "MinimalMonitoring"      ) ),
+  histInputData_          ( histogramGroups_.getParameter<bool>               ( "InputData"              ) ),
+  histStubPairs_          ( histogramGroups_.getParameter<bool>               ( "StubPairs"              ) ),
+  histEtaPhiSectors_      ( histogramGroups_.getParameter<bool>               ( "EtaPhiSectors"          ) ),
+  histRphiHT_             ( histogramGroups_.getParameter<bool>               ( "RphiHT"                 ) ),
+  histRZfilters_          ( histogramGroups_.getParameter<bool>               ( "RZfilters"              ) ),
+  histTrackCands_         ( histogramGroups_.getParameter<bool>               ( "TrackCands"             ) ),
+  histStudyBusyEvents_    ( histogramGroups_.getParameter<bool>               ( "StudyBusyEvents"        ) ),
+  histTrackFitting_       ( histogramGroups_.getParameter<bool>               ( "TrackFitting"           ) ),
 
   // Debug printout
   debug_                  ( iConfig.getParameter<unsigned int>                ( "Debug"                  ) ),
 
   // Bfield in Tesla. (Unknown at job initiation. Set to true value for each event
-  bField_                 (0.)
+  bField_                 (0.),
+  moduleAdjacency_        (nullptr)
 
 {
   // If user didn't specify any PDG codes, use e,mu,pi,K,p, to avoid picking up unstable particles like Xi-.
@@ -6,6 +6,7 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/DataCorrection.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
 
 #include <iostream>
 
@@ -14,13 +15,18 @@ using namespace std;
 //=== Store useful info about this stub.
 
 Stub::Stub(TTStubRef ttStubRef, unsigned int index_in_vStubs, const Settings* settings, 
-           const StackedTrackerGeometry*  stackedGeometry) : 
-  TTStubRef(ttStubRef), 
+           const StackedTrackerGeometry*  stackedGeometry, const ModuleInfo* moduleInfo, StubColdData* coldData) : 
   settings_(settings), 
+  moduleInfo_(moduleInfo),
+  cold_(coldData),
   index_in_vStubs_(index_in_vStubs), 
-  digitalStub_(settings),
+  layerId_(moduleInfo->layerId()),
+  psModule_(moduleInfo->psModule()),
+  barrel_(moduleInfo->barrel()),
   digitized_(false) // notes that stub has not yet been digitized.
 {
+  cold_->ttStubRef = ttStubRef;
+
   // Get coordinates of stub.
   const TTStub<Ref_PixelDigi_> *ttStubP = ttStubRef.get(); 
 
@@ -35,44 +41,68 @@ Stub::Stub(TTStubRef ttStubRef, unsigned int index_in_vStubs, const Settings* se
   // Note detector module containing stub.
   StackedTrackerDetId stDetId = ttStubRef->getDetId();
 
-  // Set info about the module this stub is in
-  this->setModuleInfo(stackedGeometry, stDetId);
-
-  // Uncertainty in stub coordinates due to strip length in case of 2S modules.
-  rErr_ = 0.;
-  zErr_ = 0.;
-
-  if (barrel_) {
-    zErr_ = 0.5*stripLength_;
-  } else {
-    rErr_ = 0.5*stripLength_; 
-  }
-
   // Get the coordinates of the two clusters that make up this stub, measured in units of strip pitch, and measured
   // in the local frame of the sensor. They have a granularity  of 0.5*pitch.
   for (unsigned int iClus = 0; iClus <= 1; iClus++) { // Loop over two clusters in stub.  
-    localU_cluster_[iClus] = ttStubP->getClusterRef(iClus)->findAverageLocalCoordinates().x();
-    localV_cluster_[iClus] = ttStubP->getClusterRef(iClus)->findAverageLocalCoordinates().y();
+    cold_->localU_cluster[iClus] = ttStubP->getClusterRef(iClus)->findAverageLocalCoordinates().x();
+    cold_->localV_cluster[iClus] = ttStubP->getClusterRef(iClus)->findAverageLocalCoordinates().y();
   }
 
   // Get location of stub in module in units of strip number (or pixel number along finest granularity axis).
   // Range from 0 to (nStrips - 1) inclusive.
   // N.B. Since iphi is integer, this degrades the granularity by a factor 2. This seems silly, but track fit wants it.
-  iphi_ = localU_cluster_[0]; // granularity 1*strip (unclear why we want to degrade it ...)
+  iphi_ = cold_->localU_cluster[0]; // granularity 1*strip (unclear why we want to degrade it ...)
 
   // Get stub bend (i.e. displacement between two hits in stub in units of strip pitch).
   float bend = ttStubRef->getTriggerBend();
   if (stDetId.isEndcap() && pos.z() > 0) bend *= -1;
   // Note this raw bend, which will be available inside front-end chip.
-  bendInFrontend_ = bend;
+  cold_->bendInFrontend = bend;
+
+  // Derive bend related quantities.
+  this->setBendInfo(bend);
+}
+
+//=== Restore stub from event snapshot.
+//=== Only the raw inputs are restored, so quantities depending on the configuration are recalculated here.
+
+Stub::Stub(const SnapshotStub& snapStub, unsigned int index_in_vStubs, const Settings* settings, const ModuleInfo* moduleInfo,
+           StubColdData* coldData) : 
+  settings_(settings), 
+  moduleInfo_(moduleInfo),
+  cold_(coldData),
+  index_in_vStubs_(index_in_vStubs), 
+  layerId_(moduleInfo->layerId()),
+  psModule_(moduleInfo->psModule()),
+  barrel_(moduleInfo->barrel()),
+  digitized_(false) // notes that stub has not yet been digitized.
+{
+  phi_ = snapStub.phi;
+  r_   = snapStub.r;
+  z_   = snapStub.z;
+
+  for (unsigned int iClus = 0; iClus <= 1; iClus++) {
+    cold_->localU_cluster[iClus] = snapStub.localU_cluster[iClus];
+    cold_->localV_cluster[iClus] = snapStub.localV_cluster[iClus];
+  }
+  iphi_ = cold_->localU_cluster[0];
+
+  cold_->bendInFrontend = snapStub.bendInFrontend;
 
+  // Derive bend related quantities.
+  this->setBendInfo(cold_->bendInFrontend);
+}
+
+//=== Derive bend related quantities & front-end decision from stub bend, once coords. and module info are known.
+
+void Stub::setBendInfo(float bend) {
   // Degrade stub bend resolution if required.
   float degradedBend;         // degraded bend
   bool rejectStub;            // indicates if bend is outside window assumed in DataCorrection.h
   unsigned int numMergedBend; // Number of bend values merged into the single degraded one.
-  this->degradeResolution(bend, stDetId,
+  this->degradeResolution(bend,
 			  degradedBend, rejectStub, numMergedBend);
-  if (settings->bendResReduced()) {
+  if (settings_->bendResReduced()) {
     bend = degradedBend;
     numMergedBend_ = numMergedBend;
   } else {
@@ -80,12 +110,11 @@ Stub::Stub(TTStubRef ttStubRef, unsigned int index_in_vStubs, const Settings* se
   }
 
   // Estimate track Pt and phi0 based on stub bend info, and angle in r-phi projection of stub direction to sensor plane.
-  float pitch = stripPitch_; // pitch of strip sensor (or of pixel sensor in high granularity direction).
-  float sensorSpacing = barrel_ ? (moduleMaxR_ - moduleMinR_) : (moduleMaxZ_ - moduleMinZ_);
-  pitchOverSep_ = pitch/sensorSpacing;
+  float pitch = this->stripPitch(); // pitch of strip sensor (or of pixel sensor in high granularity direction).
+  float sensorSpacing = moduleInfo_->sensorSpacing();
   // IRT - use stub (r,z) instead of module (r,z). Logically correct but has negligable effect on results.
   //float deltaR = barrel_ ? sensorSpacing : sensorSpacing*R0/fabs(Z0) ;
-  float deltaR = barrel_ ? sensorSpacing : sensorSpacing*r_/fabs(z_) ; // Diff in radius of coords where track crosses the two sensors.
+  float deltaR = this->barrel() ? sensorSpacing : sensorSpacing*r_/fabs(z_) ; // Diff in radius of coords where track crosses the two sensors.
   dphiOverBend_ = pitch/deltaR;
   dphi_ = bend * dphiOverBend();
 
@@ -96,7 +125,7 @@ Stub::Stub(TTStubRef ttStubRef, unsigned int index_in_vStubs, const Settings* se
   this->calcQoverPtrange();
 
   // Initialize class used to produce digital version of stub, with original stub parameters pre-digitization.
-  digitalStub_.init(phi_, r_, z_, dphi(), this->rhoParameter(), min_qOverPt_bin_, max_qOverPt_bin_, layerId_, this->layerIdReduced(), bend, stripPitch_, sensorSpacing);
+  cold_->digitalStub.init(phi_, r_, z_, dphi(), this->rhoParameter(), min_qOverPt_bin_, max_qOverPt_bin_, this->layerId(), this->layerIdReduced(), bend, pitch, sensorSpacing);
 }
 
 //=== Calculate bin range along q/Pt axis of r-phi Hough transform array consistent with bend of this stub.
@@ -141,37 +170,53 @@ void Stub::calcQoverPtrange() {
 void Stub::digitize(unsigned int iPhiSec) {
   if (settings_->enableDigitize()) {
     // Save CPU by not redoing digitization if stub was already digitized for this phi sector.
-    if ( ! (digitized_ && iPhiSec == digitalStub_.iDigi_PhiSec()) ) {
+    if ( ! (digitized_ && iPhiSec == cold_->digitalStub.iDigi_PhiSec()) ) {
       // Digitize
-      digitalStub_.make(iPhiSec);
+      cold_->digitalStub.make(iPhiSec);
 
-      // Replace stub coordinates with those degraded by digitization process.
-      phi_  = digitalStub_.phi();
-      r_    = digitalStub_.r();
-      z_    = digitalStub_.z();
-      // Variables dphi & rho are not used with daisy-chain firmware.
-      if (settings_->firmwareType() != 1) {
-	dphi_ = digitalStub_.dphi();
-	float rho  = digitalStub_.rho();
-	this->setRhoParameter(rho);
-      }
+      this->useDigitizedCoords();
+    }
+  }
+}
 
-      // If the Stub class contains any data members that are not transmitted from the PP to the MP,
-      // i.e., derived from the above variables, then be sure to update these here too. 
+//=== Digitize stub if required, taking the digitized coords. of stub number iStub from a batch in which
+//=== all stubs in the sector were digitized.
 
-      if (settings_->firmwareType() != 1) {
-	// Recalculate bin range along q/Pt axis of r-phi Hough transform array consistent with bend of this stub,
-	// since it depends on dphi which has now been digitized. Not needed with daisy-chain firmware, since this range
-	// is transmitted to HT hardware along optical link.
-	this->calcQoverPtrange();
-      }
+void Stub::digitize(unsigned int iPhiSec, const DigitalStubBatch& batch, unsigned int iStub) {
+  if (settings_->enableDigitize()) {
+    cold_->digitalStub.make(iPhiSec, batch, iStub);
 
-      // Note that stub has been digitized.
-      digitized_ = true;
-    }
+    this->useDigitizedCoords();
   }
 }
 
+//=== Replace stub coordinates with those degraded by digitization process in the DigitalStub.
+
+void Stub::useDigitizedCoords() {
+  phi_  = cold_->digitalStub.phi();
+  r_    = cold_->digitalStub.r();
+  z_    = cold_->digitalStub.z();
+  // Variables dphi & rho are not used with daisy-chain firmware.
+  if (settings_->firmwareType() != 1) {
+    dphi_ = cold_->digitalStub.dphi();
+    float rho  = cold_->digitalStub.rho();
+    this->setRhoParameter(rho);
+  }
+
+  // If the Stub class contains any data members that are not transmitted from the PP to the MP,
+  // i.e., derived from the above variables, then be sure to update these here too. 
+
+  if (settings_->firmwareType() != 1) {
+    // Recalculate bin range along q/Pt axis of r-phi Hough transform array consistent with bend of this stub,
+    // since it depends on dphi which has now been digitized. Not needed with daisy-chain firmware, since this range
+    // is transmitted to HT hardware along optical link.
+    this->calcQoverPtrange();
+  }
+
+  // Note that stub has been digitized.
+  digitized_ = true;
+}
+
 //===  Restore stub to pre-digitized state. i.e. Undo what function digitize() did.
 
 void Stub::reset_digitize() {
@@ -179,13 +224,13 @@ void Stub::reset_digitize() {
     // Save CPU by not undoing digitization if stub was not already digitized.
     if (digitized_) {
       // Replace stub coordinates with original coordinates stored prior to any digitization.
-      phi_  = digitalStub_.orig_phi();
-      r_    = digitalStub_.orig_r();
-      z_    = digitalStub_.orig_z();
+      phi_  = cold_->digitalStub.orig_phi();
+      r_    = cold_->digitalStub.orig_r();
+      z_    = cold_->digitalStub.orig_z();
       // Variables dphi & rho are not used with daisy-chain firmware.
       if (settings_->firmwareType() != 1) {
-	dphi_ = digitalStub_.orig_dphi();
-	float rho  = digitalStub_.orig_rho();
+	dphi_ = cold_->digitalStub.orig_dphi();
+	float rho  = cold_->digitalStub.orig_rho();
 	this->setRhoParameter(rho);
       }
 
@@ -209,15 +254,15 @@ void Stub::reset_digitize() {
 //=== Also return boolean indicating if stub bend was outside assumed window, so stub should be rejected
 //=== and return an integer indicating how many values of bend are merged into this single one.
 
-void Stub::degradeResolution(float bend, const StackedTrackerDetId& stDetId,
+void Stub::degradeResolution(float bend,
 			     float& degradedBend, bool& reject, unsigned int& num) {
 
-  if (barrel_) {
-    unsigned int layer = stDetId.iLayer();
+  if (this->barrel()) {
+    unsigned int layer = this->layerId(); // barrel layer ID equals CMSSW layer number.
     DataCorrection::ConvertBarrelBend( bend, layer,
 				       degradedBend, reject, num);
   } else {
-    unsigned int ring = stDetId.iRing();
+    unsigned int ring = this->endcapRing();
     DataCorrection::ConvertEndcapBend( bend, ring,
 				       degradedBend, reject, num);
   }
@@ -231,7 +276,7 @@ void Stub::degradeResolution(float bend, const StackedTrackerDetId& stDetId,
 //=== degraded by loss of bits or digitisation.
 void Stub::setFrontend(bool rejectStub) {
   frontendPass_ = true; // Did stub pass cuts applied in front-end chip
-  stubFailedDataCorrWindow_ = false; // Did it only fail cuts corresponding to windows encoded in DataCorrection.h?
+  cold_->stubFailedDataCorrWindow = false; // Did it only fail cuts corresponding to windows encoded in DataCorrection.h?
   // Don't use stubs at large eta, since it is impossible to form L1 tracks from them, so they only contribute to combinatorics.
   if ( fabs(this->eta()) > settings_->maxStubEta() ) frontendPass_ = false;
   // Don't use stubs whose Pt is significantly below the Pt cut used in the L1 tracking, allowing for uncertainty in q/Pt due to stub bend resolution.
@@ -245,7 +290,7 @@ void Stub::setFrontend(bool rejectStub) {
   } 
   // Don't use stubs whose bend is outside the window encoded into DataCorrection.h
   if (rejectStub) {
-    if (frontendPass_) stubFailedDataCorrWindow_ = true;
+    if (frontendPass_) cold_->stubFailedDataCorrWindow = true;
     frontendPass_ = false;
   }
 }
@@ -255,28 +300,28 @@ void Stub::setFrontend(bool rejectStub) {
 
 void Stub::fillTruth(const map<edm::Ptr< TrackingParticle >, const TP* >& translateTP, edm::Handle<TTStubAssMap> mcTruthTTStubHandle, edm::Handle<TTClusterAssMap> mcTruthTTClusterHandle){
 
-  TTStubRef ttStubRef(*this); // Cast to base class
+  const TTStubRef& ttStubRef = cold_->ttStubRef;
 
-  //--- Fill assocTP_ info. If both clusters in this stub were produced by the same single tracking particle, find out which one it was.
+  //--- Fill assocTP info. If both clusters in this stub were produced by the same single tracking particle, find out which one it was.
 
   bool genuine =  mcTruthTTStubHandle->isGenuine(ttStubRef); // Same TP contributed to both clusters?
-  assocTP_ = nullptr;
+  cold_->assocTP = nullptr;
 
   // Require same TP contributed to both clusters.
   if ( genuine ) {
     edm::Ptr< TrackingParticle > tpPtr = mcTruthTTStubHandle->findTrackingParticlePtr(ttStubRef);
     if (translateTP.find(tpPtr) != translateTP.end()) {
-      assocTP_ = translateTP.at(tpPtr);
+      cold_->assocTP = translateTP.at(tpPtr);
       // N.B. Since not all tracking particles are stored in InputData::vTPs_, sometimes no match will be found.
     }
   }
 
-  // Fill assocTPs_ info.
+  // Fill assocTPs info.
 
   if (settings_->stubMatchStrict()) {
 
     // We consider only stubs in which this TP contributed to both clusters.
-    if (assocTP_ != nullptr) assocTPs_.insert(assocTP_);
+    if (cold_->assocTP != nullptr) cold_->assocTPs.insert(cold_->assocTP);
 
   } else {
 
@@ -290,7 +335,7 @@ void Stub::fillTruth(const map<edm::Ptr< TrackingParticle >, const TP* >& transl
 
       for (edm::Ptr< TrackingParticle> tpPtr : vecTpPtr) {
 	if (translateTP.find(tpPtr) != translateTP.end()) {
-	  assocTPs_.insert( translateTP.at(tpPtr) );
+	  cold_->assocTPs.insert( translateTP.at(tpPtr) );
 	  // N.B. Since not all tracking particles are stored in InputData::vTPs_, sometimes no match will be found.
 	}
       }
@@ -303,14 +348,14 @@ void Stub::fillTruth(const map<edm::Ptr< TrackingParticle >, const TP* >& transl
     const TTClusterRef& ttClusterRef = ttStubRef->getClusterRef(iClus);
 
     bool genuineCluster =  mcTruthTTClusterHandle->isGenuine(ttClusterRef); // Only 1 TP made cluster?
-    assocTPofCluster_[iClus] = nullptr;
+    cold_->assocTPofCluster[iClus] = nullptr;
 
     // Only consider clusters produced by just one TP.
     if ( genuineCluster ) {
       edm::Ptr< TrackingParticle > tpPtr = mcTruthTTClusterHandle->findTrackingParticlePtr(ttClusterRef);
 
       if (translateTP.find(tpPtr) != translateTP.end()) {
-	assocTPofCluster_[iClus] = translateTP.at(tpPtr);
+	cold_->assocTPofCluster[iClus] = translateTP.at(tpPtr);
 	// N.B. Since not all tracking particles are stored in InputData::vTPs_, sometimes no match will be found.
       }
     }
@@ -337,12 +382,29 @@ void Stub::fillTruth(const map<edm::Ptr< TrackingParticle >, const TP* >& transl
   */
 }
 
+//=== Note which tracking particle(s), if any, produced this stub, taking the association from an event snapshot.
+//=== TP indices in the snapshot refer to the given vector of TPs.
+
+void Stub::fillTruth(const vector<TP>& vTPs, const SnapshotStub& snapStub, const int32_t* tpLinks) {
+
+  cold_->assocTP = (snapStub.assocTP >= 0)  ?  &vTPs.at(snapStub.assocTP)  :  nullptr;
+
+  for (unsigned int i = 0; i < snapStub.numTPlinks; i++) {
+    cold_->assocTPs.insert( &vTPs.at( tpLinks[snapStub.firstTPlink + i] ) );
+  }
+
+  for (unsigned int iClus = 0; iClus <= 1; iClus++) {
+    int32_t iTP = snapStub.assocTPofCluster[iClus];
+    cold_->assocTPofCluster[iClus] = (iTP >= 0)  ?  &vTPs.at(iTP)  :  nullptr;
+  }
+}
+
 //=== Estimated phi angle at which track crosses a given radius rad, based on stub bend info. Also estimate uncertainty on this angle due to endcap 2S module strip length.
 //=== N.B. This is identical to Stub::beta() if rad=0.
 
 pair <float, float> Stub::trkPhiAtR(float rad) const { 
-  float rStubMax = r_ + rErr_; // Uncertainty in radial stub coordinate due to strip length.
-  float rStubMin = r_ - rErr_;
+  float rStubMax = r_ + this->rErr(); // Uncertainty in radial stub coordinate due to strip length.
+  float rStubMin = r_ - this->rErr();
   float trkPhi1 = (phi_ + dphi()*(1. - rad/rStubMin));
   float trkPhi2 = (phi_ + dphi()*(1. - rad/rStubMax));
   float trkPhi    = 0.5*    (trkPhi1 + trkPhi2);
@@ -357,11 +419,11 @@ pair <float, float> Stub::trkPhiAtR(float rad) const {
 bool Stub::crazyStub() const {
 
   bool crazy;
-  if (assocTP_ == nullptr) {
+  if (cold_->assocTP == nullptr) {
     crazy = false; // Stub is fake, but this is not crazy. It happens ...
   } else {
     // Stub was produced by TP. Check it lies not too far from TP trajectory.
-    crazy = fabs( reco::deltaPhi(phi_, assocTP_->trkPhiAtStub( this )) )  >  settings_->crazyStubCut();
+    crazy = fabs( reco::deltaPhi(phi_, cold_->assocTP->trkPhiAtStub( this )) )  >  settings_->crazyStubCut();
   } 
   return crazy;
 }
@@ -370,7 +432,7 @@ bool Stub::crazyStub() const {
 
 unsigned int Stub::layerIdReduced() const {
   // Don't bother distinguishing two endcaps, as no track can have stubs in both.
-  unsigned int lay = (layerId_ < 20) ? layerId_ : layerId_ - 10; 
+  unsigned int lay = (this->layerId() < 20) ? this->layerId() : this->layerId() - 10; 
 
   // No genuine track can have stubs in both barrel layer 6 and endcap disk 11 etc., so merge their layer IDs.
   // WARNING: This is tracker geometry dependent, so may need changing in future ...
@@ -385,59 +447,3 @@ unsigned int Stub::layerIdReduced() const {
 
   return lay;
 }
-
-
-//=== Set info about the module that this stub is in.
-
-void Stub::setModuleInfo(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId) {
-
-  // Get unique identifier of this module.
-  idDet_ = stDetId();
-
-  // Get min & max (r,phi,z) coordinates of the centre of the two sensors containing this stub.
-  const GeomDetUnit* det0 = stackedGeometry->idToDetUnit( stDetId, 0 );
-  const GeomDetUnit* det1 = stackedGeometry->idToDetUnit( stDetId, 1 );
-  float R0 = det0->position().perp();
-  float R1 = det1->position().perp();
-  float PHI0 = det0->position().phi();
-  float PHI1 = det1->position().phi();
-  float Z0 = det0->position().z();
-  float Z1 = det1->position().z();
-  moduleMinR_   = std::min(R0,R1);
-  moduleMaxR_   = std::max(R0,R1);
-  moduleMinPhi_ = std::min(PHI0,PHI1);
-  moduleMaxPhi_ = std::max(PHI0,PHI1);
-  moduleMinZ_   = std::min(Z0,Z1);
-  moduleMaxZ_   = std::max(Z0,Z1);
-
-  // Note if module is PS or 2S, and whether in barrel or endcap.
-  psModule_   = stackedGeometry->isPSModule(stDetId);
-  barrel_     = stDetId.isBarrel();
-
-  //  cout<<"DEBUG STUB "<<barrel_<<" "<<psModule_<<"  sep(r,z)=( "<<moduleMaxR_ - moduleMinR_<<" , "<<moduleMaxZ_ - moduleMinZ_<<" )    stub(r,z)=( "<<0.5*(moduleMaxR_ + moduleMinR_) - r_<<" , "<<0.5*(moduleMaxZ_ + moduleMinZ_) - z_<<" )"<<endl;
-
-  // Encode layer ID.
-  if (barrel_) {
-    layerId_ = stDetId.iLayer(); // barrel layer 1-6 encoded as 1-6
-  } else {
-    layerId_ = 10*stDetId.iSide() + stDetId.iDisk(); // endcap layer 1-5 encoded as 11-15 (endcap A) or 21-25 (endcapB)
-  }
-
-  // Note module ring in endcap
-  endcapRing_ = barrel_  ?  0  :  stDetId.iRing();
-
-  // Get sensor strip or pixel pitch using innermost sensor of pair.
-  const PixelGeomDetUnit* unit = reinterpret_cast<const PixelGeomDetUnit*>(stackedGeometry->idToDetUnit(stDetId, 0));
-  const GeomDet* det = reinterpret_cast<const GeomDet*>(stackedGeometry->idToDet(stDetId, 0));
-  const PixelTopology& topo = unit->specificTopology();
-  const Bounds& bounds = det->surface().bounds();
-
-  std::pair<float, float> pitch = topo.pitch();
-  stripPitch_ = pitch.first; // Strip pitch (or pixel pitch along shortest axis)
-  stripLength_ = pitch.second;  //  Strip length (or pixel pitch along longest axis)
-  nStrips_ = topo.nrows(); // No. of strips in sensor
-  sensorWidth_ = bounds.width(); // Width of sensitive region of sensor (= stripPitch * nStrips).
-
-  sigmaPerp_ = stripPitch_/sqrt(12.); // resolution perpendicular to strip (or to longest pixel axis)
-  sigmaPar_  = stripLength_/sqrt(12.); // resolution parallel to strip (or to longest pixel axis)
-}
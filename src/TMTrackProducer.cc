@@ -10,12 +10,20 @@
 #include <TMTrackTrigger/TMTrackFinder/interface/ConverterToTTTrack.h>
 #include "TMTrackTrigger/TMTrackFinder/interface/HTcell.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/DemoOutput.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleAdjacency.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleInfo.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DigitalStubBatch.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DupTrkMerger.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TrackFitCache.h"
 
 #include "FWCore/Framework/interface/ESHandle.h"
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/EventSetup.h"
 #include "MagneticField/Engine/interface/MagneticField.h"
 #include "MagneticField/Records/interface/IdealMagneticFieldRecord.h"
+#include "Geometry/Records/interface/StackedTrackerGeometryRecord.h"
+#include "Geometry/TrackerGeometryBuilder/interface/StackedTrackerGeometry.h"
 
 #include "boost/numeric/ublas/matrix.hpp"
 #include <iostream>
@@ -24,10 +32,23 @@
 using namespace std;
 using  boost::numeric::ublas::matrix;
 
-TMTrackProducer::TMTrackProducer(const edm::ParameterSet& iConfig) {
+TMTrackProducer::TMTrackProducer(const edm::ParameterSet& iConfig) :
+  numTrksHT_(0),
+  numDupTrksKilled_(0),
+  snapshotWriter_(nullptr),
+  geometryCacheId_(0),
+  moduleAdjacency_(nullptr),
+  moduleInfoCache_(nullptr),
+  mSectors_(nullptr),
+  mHtPairs_(nullptr)
+{
   // Get configuration parameters
   settings_ = new Settings(iConfig);
 
+  // Optionally write input data to snapshot file (file opened in beginRun, once B-field known).
+  snapshotFile_ = iConfig.getUntrackedParameter<string>("SnapshotFile");
+  configHash_   = snapshot::configHash(iConfig);
+
   // Tame debug printout.
   cout.setf(ios::fixed, ios::floatfield);
   cout.precision(4);
@@ -41,6 +62,9 @@ TMTrackProducer::TMTrackProducer(const edm::ParameterSet& iConfig) {
     fitterWorkerMap_[ fitterName ] = TrackFitGeneric::create(fitterName, settings_);
     fitterWorkerMap_[ fitterName ]->bookHists(); 
   }
+  fitCache_ = new TrackFitCache( settings_ );
+  // Created once, so its work space is reused by each event.
+  dupTrkMerger_ = new DupTrkMerger( settings_ );
 
   //--- Define EDM output to be written to file (if required) 
 
@@ -59,6 +83,13 @@ TMTrackProducer::TMTrackProducer(const edm::ParameterSet& iConfig) {
 }
 
 
+TMTrackProducer::~TMTrackProducer()
+{
+  // Close snapshot file, if endJob was never reached (e.g. job aborted).
+  delete snapshotWriter_;
+}
+
+
 void TMTrackProducer::beginRun(const edm::Run& iRun, const edm::EventSetup& iSetup) 
 {
   // Get the B-field and store its value in the Settings class.
@@ -71,6 +102,42 @@ void TMTrackProducer::beginRun(const edm::Run& iRun, const edm::EventSetup& iSet
 
   settings_->setBfield(bField);
 
+  // Find which tracker modules neighbour each other. (Only redone if tracker geometry changed, as slow).
+  // Info about each tracker module is added to moduleInfoCache_ as modules are first encountered, so it is
+  // simply emptied if the geometry changed.
+  const unsigned long long geometryCacheId = iSetup.get<StackedTrackerGeometryRecord>().cacheIdentifier();
+  if (geometryCacheId != geometryCacheId_) {
+    geometryCacheId_ = geometryCacheId;
+
+    edm::ESHandle<StackedTrackerGeometry> stackedGeometryHandle;
+    iSetup.get<StackedTrackerGeometryRecord>().get( stackedGeometryHandle );
+    delete moduleAdjacency_;
+    moduleAdjacency_ = new ModuleAdjacency( stackedGeometryHandle.product() );
+    settings_->setModuleAdjacency(moduleAdjacency_);
+
+    delete moduleInfoCache_;
+    moduleInfoCache_ = new ModuleInfoCache();
+  }
+
+  // Create matrix of Sector objects, which decide which stubs are in which (eta,phi) sector,
+  // and matrix of Hough-Transform arrays, with one-to-one correspondence to sectors.
+  // Their geometry & cells are calculated here, so each event need only reset the cells that it filled.
+  delete mSectors_;
+  delete mHtPairs_;
+  mSectors_ = new matrix<Sector>(settings_->numPhiSectors(), settings_->numEtaRegions());
+  mHtPairs_ = new matrix<HTpair>(settings_->numPhiSectors(), settings_->numEtaRegions());
+  for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
+    for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
+      Sector& sector = (*mSectors_)(iPhiSec, iEtaReg);
+      sector.init(settings_, iPhiSec, iEtaReg); 
+      (*mHtPairs_)(iPhiSec, iEtaReg).init(settings_, sector.etaMin(), sector.etaMax(), sector.phiCentre());
+    }
+  }
+
+  if (snapshotFile_ != "" && snapshotWriter_ == nullptr) {
+    snapshotWriter_ = new EventSnapshotWriter(snapshotFile_, bField, configHash_);
+  }
+
   // Initialize track fitting algorithm at start of run (especially with B-field dependent variables).
   for (const string& fitterName : settings_->trackFitters()) {
     fitterWorkerMap_[ fitterName ]->initRun(); 
@@ -81,20 +148,22 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
 
   // Note useful info about MC truth particles and about reconstructed stubs .
-  InputData inputData(iEvent, iSetup, settings_);
+  InputData inputData(iEvent, iSetup, settings_, moduleInfoCache_);
 
   const vector<TP>&          vTPs   = inputData.getTPs();
   const vector<const Stub*>& vStubs = inputData.getStubs(); 
 
   cout<<"INPUT #TPs = "<<vTPs.size()<<" #STUBs = "<<vStubs.size()<<endl;
 
+  // Optionally dump input data for replay outside cmsRun (before any stubs are digitized).
+  if (snapshotWriter_ != nullptr) snapshotWriter_->write(iEvent.id().run(), iEvent.id().event(), inputData);
+
   //=== Fill histograms with stubs and tracking particles from input data.
   hists_->fillInputData(inputData);
 
-  // Creates matrix of Sector objects, which decide which stubs are in which (eta,phi) sector
-  matrix<Sector>  mSectors(settings_->numPhiSectors(), settings_->numEtaRegions());
-  // Create matrix of Hough-Transform arrays, with one-to-one correspondence to sectors.
-  matrix<HTpair>  mHtPairs(settings_->numPhiSectors(), settings_->numEtaRegions());
+  // Sectors, which decide which stubs are in which (eta,phi) sector, and Hough-Transform arrays (created in beginRun).
+  const matrix<Sector>& mSectors = *mSectors_;
+  matrix<HTpair>&       mHtPairs = *mHtPairs_;
 
   //=== Initialization
   // Create utility for converting L1 tracks from our private format to official CMSSW EDM format.
@@ -121,18 +190,30 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
   //=== Loop over matrix of Hough-Transform arrays, filling them with stubs.
 
   unsigned ntracks(0);
+
+  // If duplicate stubs in overlap regions are to be removed within each sector, do so now for all sectors,
+  // so the HT is only filled with the surviving stubs in each.
+  matrix< vector<const Stub*> > mSectorStubs;
+  if (settings_->overlapPerSector()) Sector::stubsInsideAllNoOverlap(settings_, vStubs, mSectors, mSectorStubs);
+
+  // Stubs inside each sector, and work space used to digitize them all together.
+  vector<const Stub*> insideStubs;
+  DigitalStubBatch    digiBatch(settings_);
+
   // Fill Hough-Transform arrays with stubs.
   for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
     for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
 
-      Sector& sector = mSectors(iPhiSec, iEtaReg);
-      HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
+      const Sector& sector = mSectors(iPhiSec, iEtaReg);
+      HTpair&       htPair = mHtPairs(iPhiSec, iEtaReg);
 
-      // Initialize constants for this sector.
-      sector.init(settings_, iPhiSec, iEtaReg); 
-      htPair.init(settings_, sector.etaMin(), sector.etaMax(), sector.phiCentre());
+      // Remove stubs & tracks left from previous event.
+      htPair.reset();
 
-      for (const Stub* stub: vStubs) {
+      const vector<const Stub*>& sectorStubs = settings_->overlapPerSector()  ?  mSectorStubs(iPhiSec, iEtaReg)  :  vStubs;
+
+      insideStubs.clear();
+      for (const Stub* stub: sectorStubs) {
 	// Restore pre-digitized stub in case this stub was already digitized.
 	// Needed, since hardware doing the sector assignment has access to effectively undigitized stubs.
 	// N.B. This changes the coordinates & bend stored in the stub,
@@ -140,18 +221,38 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
         if (settings_->enableDigitize()) (const_cast<Stub*>(stub))->reset_digitize();
 
 	// Check if stub is inside this sector
-        bool inside = sector.inside( stub );
+        if (sector.inside( stub )) insideStubs.push_back(stub);
+      }
 
-        if (inside) {
-	  // Digitize stub if required, which slightly degrades its coord. & bend resolution, affecting the HT performance.
-	  if (settings_->enableDigitize()) (const_cast<Stub*>(stub))->digitize(iPhiSec);
+      // Digitize stubs if required, which slightly degrades their coord. & bend resolution, affecting the HT performance.
+      if (settings_->enableDigitize()) {
+	if (settings_->batchDigitize()) {
+	  digiBatch.clear();
+	  for (const Stub* stub: insideStubs) digiBatch.add( stub->digitalStub() );
+	  digiBatch.make(iPhiSec);
+	  for (unsigned int i = 0; i < insideStubs.size(); i++) (const_cast<Stub*>(insideStubs[i]))->digitize(iPhiSec, digiBatch, i);
+
+	  // Check that this agrees with the reference implementation, digitizing each stub individually,
+	  // in one phi sector per event, chosen in turn, so the cost is small.
+	  if (settings_->checkBatchDigitize() && iPhiSec == iEvent.id().event() % settings_->numPhiSectors()) {
+	    for (const Stub* stub: insideStubs) {
+	      DigitalStub digiRef(stub->digitalStub());
+	      digiRef.make(iPhiSec);
+	      if (! stub->digitalStub().identical(digiRef)) throw cms::Exception("TMTrackProducer: Stub digitized in batch differs from when digitized individually (BatchDigitize).")
+							      <<" Event "<<iEvent.id().event()<<" phi sector "<<iPhiSec<<" eta region "<<iEtaReg<<endl;
+	    }
+	  }
+	} else {
+	  for (const Stub* stub: insideStubs) (const_cast<Stub*>(stub))->digitize(iPhiSec);
+	}
+      }
 
-	  // Check which eta subsectors within the sector the stub is compatible with (if subsectors being used).
-	  const vector<bool> inEtaSubSecs =  sector.insideEtaSubSecs( stub );
+      for (const Stub* stub: insideStubs) {
+	// Check which eta subsectors within the sector the stub is compatible with (if subsectors being used).
+	const vector<bool> inEtaSubSecs =  sector.insideEtaSubSecs( stub );
 
-	  // Store stub in Hough transform array for this sector, indicating its compatibility with eta subsectors with sector.
-	  htPair.store( stub, inEtaSubSecs );
-	}
+	// Store stub in Hough transform array for this sector, indicating its compatibility with eta subsectors with sector.
+	htPair.store( stub, inEtaSubSecs );
       }
 
       // Finish. Look for tracks in r-phi HT array etc.
@@ -167,9 +268,15 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
     }
   }
   
+  //=== Optionally remove duplicate track candidates found in different sectors, so they are not fitted.
+  DupTrkMerger& dupTrkMerger = *dupTrkMerger_;
+  dupTrkMerger.run(mHtPairs);
+  numTrksHT_        += ntracks;
+  numDupTrksKilled_ += dupTrkMerger.numKilled();
+
   //=== Do a helix fit to all the track candidates.
-  cout << "# of tracks found by HT = " << ntracks << endl;
   vector<std::pair<std::string, L1fittedTrack>> fittedTracks;
+  fitCache_->clear();
   for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
     for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
 
@@ -182,11 +289,14 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 
       // Get track candidate sfound by Hough transform in this sector.
       const vector<L1track3D>& vecTrk3D = htPair.trackCands3D();
-      // Fit all tracks
-      for (const L1track3D& trk : vecTrk3D) {
+      // Fit all tracks, except duplicates of tracks found in other sectors.
+      for (unsigned int iTrk = 0; iTrk < vecTrk3D.size(); iTrk++) {
+	const L1track3D& trk = vecTrk3D[iTrk];
+	if (! dupTrkMerger.keep(iPhiSec, iEtaReg, iTrk)) continue;
 	// Loop over all the fitting algorithms we are trying.
         for (const string& fitterName : settings_->trackFitters()) {
-	  L1fittedTrack fitTrack = fitterWorkerMap_[fitterName]->fit(trk, iPhiSec, iEtaReg);
+	  // (Reusing the result of an earlier fit, if an identical track candidate was already fitted).
+	  L1fittedTrack fitTrack = fitCache_->fit(fitterName, fitterWorkerMap_[fitterName], trk, iPhiSec, iEtaReg);
 	  // Store fitted tracks, such that there is one fittedTracks corresponding to each HT tracks.
 	  // N.B. Tracks rejected by the fit are also stored, but marked.
 	  fittedTracks.push_back(std::make_pair(fitterName, fitTrack));
@@ -220,7 +330,9 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
   hists_->fillTrackCands(inputData, mSectors, mHtPairs);
 
   //=== Fill histograms studying track fitting performance
-  hists_->fillTrackFitting(inputData, fittedTracks,  settings_->chi2OverNdfCut() );
+  hists_->fillTrackFitting(inputData, fittedTracks,  settings_->chi2OverNdfCut(), dupTrkMerger );
+
+  hists_->endEvent();
 
   //=== Output digitized stubs in format expected by hardware for use by the comparison software,
   //=== which compares hardware with software.
@@ -254,15 +366,39 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 
 void TMTrackProducer::endJob() 
 {
+  // Close snapshot file.
+  delete snapshotWriter_;
+  snapshotWriter_ = nullptr;
+
   hists_->endJobAnalysis();
 
   for (const string& fitterName : settings_->trackFitters()) {
 
-      cout << "# of duplicated stubs = " << fitterWorkerMap_[fitterName]->nDupStubs() << endl;
+      cout << "# of duplicated stubs = " << fitterWorkerMap_[fitterName]->nDupStubs();
+      if (settings_->fitCache() > 0) cout << " (on track candidates that did not reuse an earlier fit result)";
+      cout << endl;
+      if (settings_->fitCache() > 0) cout << "# of track candidates given to " << fitterName << " = " << fitCache_->numFits(fitterName) << " ; of which reused earlier fit result = " << fitCache_->numHits(fitterName) << endl;
       delete fitterWorkerMap_[ string(fitterName) ];
   }
+  delete fitCache_;
+  fitCache_ = nullptr;
+  delete dupTrkMerger_;
+  dupTrkMerger_ = nullptr;
+
+  cout<<endl<<"# of tracks found by HT in all events = " << numTrksHT_ << endl;
+  if (settings_->dupTrkMergeEvent() > 0) cout << "# of duplicate tracks found in different sectors, so not fitted = " << numDupTrksKilled_ << endl;
 
   cout<<endl<<"Number of (eta,phi) sectors used = (" << settings_->numEtaRegions() << "," << settings_->numPhiSectors()<<")"<<endl; 
+
+  settings_->setModuleAdjacency(nullptr);
+  delete moduleAdjacency_;
+  moduleAdjacency_ = nullptr;
+  delete moduleInfoCache_;
+  moduleInfoCache_ = nullptr;
+  delete mSectors_;
+  mSectors_ = nullptr;
+  delete mHtPairs_;
+  mHtPairs_ = nullptr;
 }
 
 DEFINE_FWK_MODULE(TMTrackProducer);
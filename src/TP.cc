@@ -3,6 +3,7 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Utility.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
 
 using namespace std;
 
@@ -36,6 +37,34 @@ TP::TP(TrackingParticlePtr tpPtr, unsigned int index_in_vTPs, const Settings* se
   this->fillUseForEff(); // Fill useForEff_ flag, indicating if TP is good for tracking efficiency measurement.
 }
 
+//=== Restore tracking particle from event snapshot.
+//=== The selection flags were evaluated when the snapshot was written, since TrackingParticleSelector needs the TrackingParticle.
+
+TP::TP(const SnapshotTP& snapTP, unsigned int index_in_vTPs, const Settings* settings) :
+  TrackingParticlePtr(),
+  index_in_vTPs_(index_in_vTPs),
+  settings_(settings),
+
+  pdgId_(snapTP.pdgId),
+  inTimeBx_(snapTP.flags & SnapshotTP::inTimeBx),
+  physicsCollision_(snapTP.flags & SnapshotTP::physicsCollision),
+  charge_(snapTP.charge),
+  mass_(snapTP.mass),
+  pt_(snapTP.pt),
+  eta_(snapTP.eta),
+  theta_(snapTP.theta),
+  tanLambda_(snapTP.tanLambda),
+  phi0_(snapTP.phi0),
+  vx_(snapTP.vx),
+  vy_(snapTP.vy),
+  vz_(snapTP.vz),
+  d0_(snapTP.d0),
+  z0_(snapTP.z0),
+  use_(snapTP.flags & SnapshotTP::use),
+  useForEff_(snapTP.flags & SnapshotTP::useForEff)
+{
+}
+
 //=== Fill truth info with association from tracking particle to stubs.
 
 void TP::fillTruth(const vector<Stub>& vStubs) {
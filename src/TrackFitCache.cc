@@ -0,0 +1,65 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/TrackFitCache.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TrackFitGeneric.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+//=== Note configuration parameters.
+
+TrackFitCache::TrackFitCache(const Settings* settings) :
+  settings_ (settings)
+{
+  if (settings->fitCache() > 1) throw cms::Exception("TrackFitCache: Unknown option for FitCache: ")<<settings->fitCache();
+}
+
+//=== Fit a track candidate in the given sector with the named fitter, unless an identical candidate was already fitted.
+
+L1fittedTrack TrackFitCache::fit(const string& fitterName, TrackFitGeneric* fitter, const L1track3D& l1track3D, unsigned int iPhiSec, unsigned int iEtaReg,
+				 bool* reused) {
+
+  numFits_[fitterName]++;
+  if (reused != nullptr) *reused = false;
+
+  if (settings_->fitCache() == 0) return fitter->fit(l1track3D, iPhiSec, iEtaReg);
+
+  Key key;
+  key.fitter  = fitter;
+  key.iPhiSec = iPhiSec;
+  key.iEtaReg = iEtaReg;
+  const vector<const Stub*>& stubs = l1track3D.getStubs();
+  key.stubIndices.reserve(stubs.size());
+  for (const Stub* s : stubs) key.stubIndices.push_back(s->index());
+  sort(key.stubIndices.begin(), key.stubIndices.end());
+
+  auto it = cache_.find(key);
+  if (it == cache_.end()) {
+    L1fittedTrack fitTrack = fitter->fit(l1track3D, iPhiSec, iEtaReg);
+    cache_.emplace(std::move(key), fitTrack);
+    return fitTrack;
+  }
+
+  // Reuse the earlier fit result, but associate it to this track candidate.
+  numHits_[fitterName]++;
+  if (reused != nullptr) *reused = true;
+  const L1fittedTrack& f = it->second;
+  return L1fittedTrack(settings_, l1track3D, f.getStubs(), f.qOverPt(), f.d0(), f.phi0(), f.z0(), f.tanLambda(),
+		       f.chi2(), (unsigned int)(f.nHelixParam()), iPhiSec, iEtaReg, f.accepted());
+}
+
+//=== Hash of cache key.
+
+size_t TrackFitCache::KeyHash::operator()(const Key& k) const {
+  size_t h = hash<const void*>()(k.fitter);
+  auto combine = [&h](size_t v) {h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2);};
+  combine(k.iPhiSec);
+  combine(k.iEtaReg);
+  for (unsigned int i : k.stubIndices) combine(i);
+  return h;
+}
@@ -19,6 +19,7 @@ TrackFitLinearAlgo::TrackFitLinearAlgo( const Settings* settings, const uint nPa
   killTrackFitWorstHit_ = settings_->killTrackFitWorstHit(); // Optionally kill hit with worst residual.
   generalResidualCut_   = settings_->generalResidualCut(); // The cut used to remove bad stubs (if nStubs > minLayers)
   killingResidualCut_   = settings_->killingResidualCut(); // The cut used to kill off tracks entirely
+  incrementalFit_       = settings_->trackFitIncremental(); // Reuse linearisation of previous iteration where possible.
 
   //--- These two parameters are used to check if after the fit, there are still enough stubs on the track
  
@@ -78,6 +79,7 @@ L1fittedTrack TrackFitLinearAlgo::fit(const L1track3D& l1track3D, unsigned int i
 
   for (int i=1;i<numFittingIterations_+1;++i) {
     if (i>1) {
+      int ikilled = -1;
       if (print) std::cout << __LINE__ << " - killTrackFitWorstHit_= " << killTrackFitWorstHit_ << "/largestresid = " << largestresid << std::endl;
       if (killTrackFitWorstHit_) {
         if ( largestresid > min(killingResidualCut_, generalResidualCut_) ) {
@@ -85,6 +87,7 @@ L1fittedTrack TrackFitLinearAlgo::fit(const L1track3D& l1track3D, unsigned int i
           stubs_.erase(stubs_.begin()+ilargestresid);    
           if (largestresid > killingResidualCut_ || Utility::countLayers( settings_, stubs_ ) >= minStubLayers_) {
             if (print) std::cout << "Killed stub " << ilargestresid << "." << std::endl;
+            ikilled = ilargestresid;
           } else {
             // Don't delete worst stub, as it would kill the track.
             stubs_ = stubs_backup;
@@ -99,8 +102,13 @@ L1fittedTrack TrackFitLinearAlgo::fit(const L1track3D& l1track3D, unsigned int i
       
       //      if (print && (i==numFittingIterations_+1)) std::cout << "Last fit." << std::endl;
       
-      calculateDerivatives( false ); // Default = false
-      linearTrackFit( false ); // Default = false
+      if (incrementalFit_ && i < numFittingIterations_ && downdate( ikilled )) {
+        // Reuse linearisation of previous iteration (minus any killed stub), and the residuals it calculated at these helix params.
+        linearTrackFit( false, true );
+      } else {
+        calculateDerivatives( false ); // Default = false
+        linearTrackFit( false ); // Default = false
+      }
       residuals(largestresid,ilargestresid);
     }
   }  
@@ -313,9 +321,9 @@ void TrackFitLinearAlgo::residuals( float& largestresid,int& ilargestresid ) {
  
   unsigned int n=stubs_.size();
  
-  //Next calculate the residuals
+  //Next calculate the residuals (storing them for use by the next fit iteration)
  
-  double delta[2*__MAX_STUBS_PER_TRK__];
+  double* delta = delta_;
  
   double chisq=0.0;
  
@@ -389,7 +397,7 @@ void TrackFitLinearAlgo::residuals( float& largestresid,int& ilargestresid ) {
 }
  
  
-void TrackFitLinearAlgo::linearTrackFit( bool withd0 ) {
+void TrackFitLinearAlgo::linearTrackFit( bool withd0, bool useStoredResids ) {
  
   unsigned int n=stubs_.size();
  
@@ -401,7 +409,17 @@ void TrackFitLinearAlgo::linearTrackFit( bool withd0 ) {
  
   unsigned int j=0;
  
-  for(unsigned int i=0;i<n;i++) {
+  if (useStoredResids) {
+    for(unsigned int i=0;i<n;i++) {
+      delta[j]=delta_[j];
+      j++;
+      delta[j]=delta_[j];
+      j++;
+      chisq+=(delta[j-2]*delta[j-2]+delta[j-1]*delta[j-1]);
+    }
+  }
+
+  for(unsigned int i=0;i<n && !useStoredResids;i++) {
     double ri=stubs_[i]->r();
     double zi=stubs_[i]->z();
     double phii=stubs_[i]->phi();
@@ -524,3 +542,68 @@ void TrackFitLinearAlgo::linearTrackFit( bool withd0 ) {
   //cout << "z0_ dz0    : "<<z0_<<" "<<dz0<<endl;
  
 }
+ 
+bool TrackFitLinearAlgo::downdate( int ikilled ) {
+ 
+  // Nothing to do if no stub was killed.
+  if (ikilled < 0) return true;
+ 
+  unsigned int n=stubs_.size(); // Already excludes killed stub.
+  const unsigned int npar=4;
+ 
+  // Downdate inverse of M = D*Dt for removal of the two measurements of the killed stub, using the
+  // Sherman-Morrison formula, (M - d*dt)^-1 = Minv + (Minv*d)*(Minv*d)t/(1 - dt*Minv*d).
+ 
+  double Minv[npar][npar];
+  for(unsigned int i1=0;i1<npar;i1++) {
+    for(unsigned int i2=0;i2<npar;i2++) {
+      Minv[i1][i2]=M_[i1][i2+npar];
+    }
+  }
+ 
+  for(unsigned int jk=2*ikilled;jk<2*(unsigned int)(ikilled)+2;jk++) {
+    double u[npar];
+    double dtu=0.0;
+    for(unsigned int i1=0;i1<npar;i1++) {
+      u[i1]=0.0;
+      for(unsigned int i2=0;i2<npar;i2++) {
+        u[i1]+=Minv[i1][i2]*D_[i2][jk];
+      }
+      dtu+=D_[i1][jk]*u[i1];
+    }
+    // If the remaining stubs barely constrain the helix, give up and redo the fit in full.
+    const double denom=1.0-dtu;
+    if (denom < 1.0e-3) return false;
+    for(unsigned int i1=0;i1<npar;i1++) {
+      for(unsigned int i2=0;i2<npar;i2++) {
+        Minv[i1][i2]+=u[i1]*u[i2]/denom;
+      }
+    }
+  }
+ 
+  for(unsigned int i1=0;i1<npar;i1++) {
+    for(unsigned int i2=0;i2<npar;i2++) {
+      M_[i1][i2+npar]=Minv[i1][i2];
+    }
+  }
+ 
+  // Remove killed stub from derivatives & residuals.
+ 
+  for(unsigned int j=2*ikilled;j<2*n;j++) {
+    for(unsigned int i1=0;i1<npar;i1++) {
+      D_[i1][j]=D_[i1][j+2];
+    }
+    delta_[j]=delta_[j+2];
+  }
+ 
+  for(unsigned int j=0;j<2*n;j++) {
+    for(unsigned int i1=0;i1<npar;i1++) {
+      MinvDt_[i1][j]=0.0;
+      for(unsigned int i2=0;i2<npar;i2++) {
+        MinvDt_[i1][j]+=M_[i1][i2+npar]*D_[i2][j];
+      }
+    }
+  }
+ 
+  return true;
+}
@@ -4,6 +4,10 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
 
+#include <bitset>
+#include <algorithm>
+#include <functional>
+
 //=== Initialize configuration parameters, and note eta range covered by sector and phi coordinate of its centre.
 
 void TrkRZfilter::init(const Settings* settings, float etaMinSector, float etaMaxSector, float phiCentreSector) {
@@ -31,6 +35,8 @@ void TrkRZfilter::init(const Settings* settings, float etaMinSector, float etaMa
   // --- Options for ZTrk filter
   // Use z of track at this radius for ZTrkFilter.
   chosenRofZFilter_    = settings->chosenRofZFilter();
+  // Use faster implementation of ZTrkFilter.
+  fastZTrkFilter_      = settings->fastZTrkFilter();
 
   // --- Options for Seed filter.
   //Added resolution for a tracklet-like filter algorithm, beyond that estimated from hit resolution.
@@ -41,6 +47,8 @@ void TrkRZfilter::init(const Settings* settings, float etaMinSector, float etaMa
   maxSeedCombinations_ = settings->maxSeedCombinations();
   // Reject tracks whose estimated rapidity from seed filter is inconsistent range of with eta sector. (Kills some duplicate tracks).
   zTrkSectorCheck_     = settings->zTrkSectorCheck();
+  // Use faster implementation of Seed filter.
+  fastSeedFilter_      = settings->fastSeedFilter();
 
   // Min. number of layers track must have stubs in to be declared valid.
   minStubLayers_       = settings->minStubLayers();
@@ -51,10 +59,25 @@ void TrkRZfilter::init(const Settings* settings, float etaMinSector, float etaMa
   // Assumed length of beam-spot in z.
   beamWindowZ_ = settings->beamWindowZ();
 
+  // Beam spot positions that the ZTrk filter sums over to calculate the correlation between stubs.
+  zBeam_.resize(numZBeam_);
+  for (unsigned int i = 0; i < numZBeam_; ++i){
+    zBeam_[i] = -beamWindowZ_ + (0.5+int(i))*beamWindowZ_/50; 
+  }
+
   // Note that no r-z filter has yet provided an estimate of the r-z track parameters.
   estValid_ = false;  // No valid estimate yet.
 }
 
+//=== Forget info about tracks filtered in the previous event, keeping the configuration.
+
+void TrkRZfilter::reset() {
+  numZtrkSeedCombsPerTrk_.clear();
+  numSeedCombsPerTrk_.clear();
+  numGoodSeedCombsPerTrk_.clear();
+  estValid_ = false;
+}
+
 // Filters track candidates (found by the r-phi Hough transform), removing inconsistent stubs from the tracks, 
 // also killing some of the tracks altogether if they are left with too few stubs.
 // Also adds an estimate of r-z helix parameters to the selected track objects, if the filters used provide this.
@@ -144,51 +167,55 @@ vector<const Stub*> TrkRZfilter::zTrkFilter(const vector<const Stub*>& stubs, fl
 
   unsigned int oldNumLay = 0; //Number of Layers counter, used to keep the seed with more layers 
 
-  // Loop over stubs in HT Cell
-  for(const Stub* s: stubs){  
-    // Create a temporary container for stubs
-    vector<const Stub*> tempStubs;
-    // Select the first seeding stub
-    if(s->psModule() && std::find(std::begin(FirstSeedLayers), std::end(FirstSeedLayers), s->layerId()) != std::end(FirstSeedLayers)){
-
-      numZtrkSeedCombinations++; //Increase cycle counter
-      tempStubs.push_back(s); //Push back seed stub in the temporary container
-      double sumSeedDist = 0., oldSumSeedDist = 100000.; //Define variable used to estimate the quality of seeds
-      // Loop over the remaining stubs in the cell
-      for(const Stub* s2: stubs){
-	if(s2!=s){
-	  // Calculate the correlation factor between the seeding stub s and the considered stub s2
-	  double fcorr = 0.;
-	  double sum = 0.;
-	  for (int i = 0; i < 100; ++i){
-	    double zB = -beamWindowZ_ + (0.5+i)*beamWindowZ_/50; 
-	    double z1 = s->zTrk() - (chosenRofZFilter_ - s->r())*zB/s->r();
-	    double z2 = s2->zTrk() - (chosenRofZFilter_ - s2->r())*zB/s2->r();
-	    sum = sum + z1*z2;
-	  }
-	  sum = (sum/100) - s->zTrk()*s2->zTrk();
-	  fcorr = sum/(s->zTrkRes()*s2->zTrkRes());
+  if (fastZTrkFilter_) {
+    filteredStubs = this->zTrkFilterFast(stubs, numZtrkSeedCombinations, oldNumLay);
+  } else {
+    // Loop over stubs in HT Cell
+    for(const Stub* s: stubs){  
+      // Create a temporary container for stubs
+      vector<const Stub*> tempStubs;
+      // Select the first seeding stub
+      if(s->psModule() && std::find(std::begin(FirstSeedLayers), std::end(FirstSeedLayers), s->layerId()) != std::end(FirstSeedLayers)){
+
+	numZtrkSeedCombinations++; //Increase cycle counter
+	tempStubs.push_back(s); //Push back seed stub in the temporary container
+	double sumSeedDist = 0., oldSumSeedDist = 100000.; //Define variable used to estimate the quality of seeds
+	// Loop over the remaining stubs in the cell
+	for(const Stub* s2: stubs){
+	  if(s2!=s){
+	    // Calculate the correlation factor between the seeding stub s and the considered stub s2
+	    double fcorr = 0.;
+	    double sum = 0.;
+	    for (int i = 0; i < 100; ++i){
+	      double zB = -beamWindowZ_ + (0.5+i)*beamWindowZ_/50; 
+	      double z1 = s->zTrk() - (chosenRofZFilter_ - s->r())*zB/s->r();
+	      double z2 = s2->zTrk() - (chosenRofZFilter_ - s2->r())*zB/s2->r();
+	      sum = sum + z1*z2;
+	    }
+	    sum = (sum/100) - s->zTrk()*s2->zTrk();
+	    fcorr = sum/(s->zTrkRes()*s2->zTrkRes());
 
 
-	  // Check if the zR values of the two stubs (s & s2) are whitin a certain tolerance range defined by strip uncertainty & beam spot length
-	  if( fabs(s2->zTrk() - s->zTrk()) < sqrt(s2->zTrkRes()*s2->zTrkRes() + s->zTrkRes()*s->zTrkRes() - fcorr*s->zTrkRes()*s2->zTrkRes() )) {
-	    tempStubs.push_back(s2); // Push back s2 if it satisfies the condition
-	    sumSeedDist = sumSeedDist + fabs(s2->zTrk() - s->zTrk());  //Increase the seed quality variable
+	    // Check if the zR values of the two stubs (s & s2) are whitin a certain tolerance range defined by strip uncertainty & beam spot length
+	    if( fabs(s2->zTrk() - s->zTrk()) < sqrt(s2->zTrkRes()*s2->zTrkRes() + s->zTrkRes()*s->zTrkRes() - fcorr*s->zTrkRes()*s2->zTrkRes() )) {
+	      tempStubs.push_back(s2); // Push back s2 if it satisfies the condition
+	      sumSeedDist = sumSeedDist + fabs(s2->zTrk() - s->zTrk());  //Increase the seed quality variable
+	    }
 	  }
 	}
-      }
 
-      sumSeedDist = sumSeedDist/tempStubs.size();
+	sumSeedDist = sumSeedDist/tempStubs.size();
 
-      numLayers = Utility::countLayers(settings_, tempStubs); // Count the number of layers in the temporary stubs container
+	numLayers = Utility::countLayers(settings_, tempStubs); // Count the number of layers in the temporary stubs container
 
-      // Check if the current seed has more layers then the previous one
-      if(numLayers >= oldNumLay){
-	// Chech if the current seed has better quality than the previous one
-	if(sumSeedDist < oldSumSeedDist){
-	  filteredStubs = tempStubs; //Copy the temporary stubs vector in the filteredStubs vector, which will be returned
-	  oldSumSeedDist = sumSeedDist; //Update value of oldSumSeedDist
-	  oldNumLay = numLayers; //Update value of oldNumLay
+	// Check if the current seed has more layers then the previous one
+	if(numLayers >= oldNumLay){
+	  // Chech if the current seed has better quality than the previous one
+	  if(sumSeedDist < oldSumSeedDist){
+	    filteredStubs = tempStubs; //Copy the temporary stubs vector in the filteredStubs vector, which will be returned
+	    oldSumSeedDist = sumSeedDist; //Update value of oldSumSeedDist
+	    oldNumLay = numLayers; //Update value of oldNumLay
+	  }
 	}
       }
     }
@@ -234,6 +261,105 @@ vector<const Stub*> TrkRZfilter::zTrkFilter(const vector<const Stub*>& stubs, fl
   return filteredStubs; // Return the filtered stubs vector
 }
 
+//=== Faster implementation of zTrkFilter() seed selection, giving identical results.
+//=== Returns the stubs compatible with the best seed, also giving the number of seeds tried and layers on the best one.
+
+vector<const Stub*> TrkRZfilter::zTrkFilterFast(const vector<const Stub*>& stubs, unsigned int& numSeedCombinations, unsigned int& numLayersBest) {
+
+  const int FirstSeedLayers[] = {1,2,11,21,3,12,22}; //Allowed layers for the seeding stub
+
+  // Note info needed about each stub only once, instead of for each pair of stubs.
+  // This includes z of the track at chosenRofZFilter for each assumed beam spot position, calculated exactly as in zTrkFilter(),
+  // so that the correlation between stubs, and hence the seed selection, is bit-identical to it.
+  const unsigned int nStubs = stubs.size();
+  wsZTrk_.resize(nStubs);
+  wsZTrkRes_.resize(nStubs);
+  wsZAtBeam_.resize(nStubs*numZBeam_);
+  wsLayerBit_.resize(nStubs);
+  wsCompat_.resize(nStubs);
+  wsDist_.resize(nStubs);
+  for (unsigned int i = 0; i < nStubs; i++) {
+    const Stub* s = stubs[i];
+    wsZTrk_[i]     = s->zTrk();
+    wsZTrkRes_[i]  = s->zTrkRes();
+    wsLayerBit_[i] = Utility::layerBit(settings_, s);
+    double* zAtBeam = &wsZAtBeam_[i*numZBeam_];
+    for (unsigned int k = 0; k < numZBeam_; k++) {
+      zAtBeam[k] = s->zTrk() - (chosenRofZFilter_ - s->r())*zBeam_[k]/s->r();
+    }
+  }
+
+  unsigned int iSeedBest = nStubs;
+  numLayersBest = 0;
+
+  for (unsigned int i = 0; i < nStubs; i++) {
+    const Stub* s = stubs[i];
+    if (! (s->psModule() && std::find(std::begin(FirstSeedLayers), std::end(FirstSeedLayers), s->layerId()) != std::end(FirstSeedLayers))) continue;
+
+    numSeedCombinations++;
+
+    // Check which stubs are compatible with this seed, as in zTrkFilter().
+    for (unsigned int j = 0; j < nStubs; j++) {
+      wsDist_[j]   = fabs(wsZTrk_[j] - wsZTrk_[i]);
+      wsCompat_[j] = this->zTrkCompatible(i, j);
+    }
+
+    // Count stubs compatible with seed, and layers they are in, and measure seed quality.
+    unsigned int numStubs = 1;
+    uint32_t layers = wsLayerBit_[i];
+    double sumSeedDist = 0.;
+    for (unsigned int j = 0; j < nStubs; j++) {
+      if (wsCompat_[j] && stubs[j] != s) {
+	numStubs++;
+	layers |= wsLayerBit_[j];
+	sumSeedDist = sumSeedDist + wsDist_[j];
+      }
+    }
+    sumSeedDist = sumSeedDist/numStubs;
+    unsigned int numLayers = bitset<32>(layers).count();
+
+    // Keep the last seed with at least as many layers as the best so far.
+    // (N.B. zTrkFilter() compares the seed quality to a fixed value, rather than that of the best seed so far).
+    if (numLayers >= numLayersBest && sumSeedDist < 100000.) {
+      iSeedBest = i;
+      numLayersBest = numLayers;
+    }
+  }
+
+  // Return stubs compatible with best seed, seed first.
+  vector<const Stub*> filteredStubs;
+  if (iSeedBest < nStubs) {
+    const Stub* s = stubs[iSeedBest];
+    filteredStubs.push_back(s);
+    for (unsigned int j = 0; j < nStubs; j++) {
+      if (stubs[j] != s && this->zTrkCompatible(iSeedBest, j)) filteredStubs.push_back(stubs[j]);
+    }
+  }
+
+  return filteredStubs;
+}
+
+//=== Check if stub j is compatible in zTrk with seed stub i, using info about them in the zTrkFilterFast() work space.
+//=== The arithmetic, including its order, is that of zTrkFilter(), so it gives identical results.
+
+bool TrkRZfilter::zTrkCompatible(unsigned int i, unsigned int j) const {
+  // Correlation between the two stubs, summed over beam spot positions.
+  const double* zAtBeam1 = &wsZAtBeam_[i*numZBeam_];
+  const double* zAtBeam2 = &wsZAtBeam_[j*numZBeam_];
+  double sum = 0.;
+  for (unsigned int k = 0; k < numZBeam_; k++) {
+    sum = sum + zAtBeam1[k]*zAtBeam2[k];
+  }
+  const float zTrk1    = wsZTrk_[i];
+  const float zTrk2    = wsZTrk_[j];
+  const float zTrkRes1 = wsZTrkRes_[i];
+  const float zTrkRes2 = wsZTrkRes_[j];
+  sum = (sum/100) - zTrk1*zTrk2;
+  double fcorr = sum/(zTrkRes1*zTrkRes2);
+
+  return ( fabs(zTrk2 - zTrk1) < sqrt(zTrkRes2*zTrkRes2 + zTrkRes1*zTrkRes1 - fcorr*zTrkRes1*zTrkRes2) );
+}
+
 //=== Produce a filtered collection of stubs on this track candidate that are consistent with a straight line in r-z using tracklet algo.
 
 vector<const Stub*> TrkRZfilter::seedFilter(const std::vector<const Stub*>& stubs, float trkQoverPt) {
@@ -251,116 +377,120 @@ vector<const Stub*> TrkRZfilter::seedFilter(const std::vector<const Stub*>& stub
     
   unsigned int oldNumLay = 0; //Number of Layers counter, used to keep the seed with more layers 
 
-  // Loop over stubs in the HT Cell
-  for(const Stub* s0: filtStubs){
-    // Select the first available seeding stub (r<70)
-    if(s0->psModule() && std::find(std::begin(FirstSeedLayers), std::end(FirstSeedLayers), s0->layerId()) != std::end(FirstSeedLayers)) {
-      for(const Stub* s1: filtStubs){ 
-	if (numGoodSeedCombinations < maxSeedCombinations_) {
-	  // Select the second seeding stub (r<90)
-	  if(s1->psModule() && s1->layerId() > s0->layerId() &&  std::find(std::begin(SecondSeedLayers), std::end(SecondSeedLayers), s1->layerId()) != std::end(SecondSeedLayers) ){
-
-	    numSeedCombinations++; //Increase filter cycles counter
+  if (fastSeedFilter_) {
+    filteredStubs = this->seedFilterFast(filtStubs, trkQoverPt, numSeedCombinations, numGoodSeedCombinations, oldNumLay);
+  } else {
+    // Loop over stubs in the HT Cell
+    for(const Stub* s0: filtStubs){
+      // Select the first available seeding stub (r<70)
+      if(s0->psModule() && std::find(std::begin(FirstSeedLayers), std::end(FirstSeedLayers), s0->layerId()) != std::end(FirstSeedLayers)) {
+	for(const Stub* s1: filtStubs){ 
+	  if (numGoodSeedCombinations < maxSeedCombinations_) {
+	    // Select the second seeding stub (r<90)
+	    if(s1->psModule() && s1->layerId() > s0->layerId() &&  std::find(std::begin(SecondSeedLayers), std::end(SecondSeedLayers), s1->layerId()) != std::end(SecondSeedLayers) ){
+
+	      numSeedCombinations++; //Increase filter cycles counter
 	
-	    double sumSeedDist = 0., oldSumSeedDist = 1000000.; //Define variable used to estimate the quality of seeds
-	    vector<const Stub*> tempStubs;  //Create a temporary container for stubs
-	    tempStubs.push_back(s0); //Store the first seeding stub in the temporary container
-	    tempStubs.push_back(s1); //Store the second seeding stub in the temporary container
-
-	    double z0 = s1->z() + (-s1->z()+s0->z())*s1->r()/(s1->r()-s0->r()); // Estimate a value of z at the beam spot using the two seeding stubs
-	    double z0err = s1->zErr() + ( s1->zErr() + s0->zErr() )*s1->r()/fabs(s1->r()-s0->r()) 
-	      + fabs(-s1->z()+s0->z())*(s1->rErr()*fabs(s1->r()-s0->r()) + s1->r()*(s1->rErr() + s0->rErr()) )/((s1->r()-s0->r())*(s1->r()-s0->r())); 
-
-            float zTrk = s1->z() + (-s1->z()+s0->z())*(s1->r()-chosenRofZ_)/(s1->r()-s0->r()); // Estimate a value of z at a chosen Radius using the two seeding stubs
-            float zTrkErr = s1->zErr() + ( s1->zErr() + s0->zErr() )*fabs(s1->r()-chosenRofZ_)/fabs(s1->r()-s0->r()) 
-	      + fabs(-s1->z()+s0->z())*(s1->rErr()*fabs(s1->r()-s0->r()) + fabs(s1->r()-chosenRofZ_)*(s1->rErr() + s0->rErr()) )/((s1->r()-s0->r())*(s1->r()-s0->r()));
+	      double sumSeedDist = 0., oldSumSeedDist = 1000000.; //Define variable used to estimate the quality of seeds
+	      vector<const Stub*> tempStubs;  //Create a temporary container for stubs
+	      tempStubs.push_back(s0); //Store the first seeding stub in the temporary container
+	      tempStubs.push_back(s1); //Store the second seeding stub in the temporary container
+
+	      double z0 = s1->z() + (-s1->z()+s0->z())*s1->r()/(s1->r()-s0->r()); // Estimate a value of z at the beam spot using the two seeding stubs
+	      double z0err = s1->zErr() + ( s1->zErr() + s0->zErr() )*s1->r()/fabs(s1->r()-s0->r()) 
+		+ fabs(-s1->z()+s0->z())*(s1->rErr()*fabs(s1->r()-s0->r()) + s1->r()*(s1->rErr() + s0->rErr()) )/((s1->r()-s0->r())*(s1->r()-s0->r())); 
+
+	      float zTrk = s1->z() + (-s1->z()+s0->z())*(s1->r()-chosenRofZ_)/(s1->r()-s0->r()); // Estimate a value of z at a chosen Radius using the two seeding stubs
+	      float zTrkErr = s1->zErr() + ( s1->zErr() + s0->zErr() )*fabs(s1->r()-chosenRofZ_)/fabs(s1->r()-s0->r()) 
+		+ fabs(-s1->z()+s0->z())*(s1->rErr()*fabs(s1->r()-s0->r()) + fabs(s1->r()-chosenRofZ_)*(s1->rErr() + s0->rErr()) )/((s1->r()-s0->r())*(s1->r()-s0->r()));
         
-	    // If z0 is within the beamspot range loop over the other stubs in the cell
-	    if (fabs(z0)<=beamWindowZ_+z0err) {
-	      // Check track r-z helix parameters are consistent with it being assigned to current rapidity sector (kills duplicates due to overlapping sectors).
-	      if ( (! zTrkSectorCheck_) || (zTrk > zTrkMinSector_ - zTrkErr && zTrk < zTrkMaxSector_ + zTrkErr) ) {
-
-		numGoodSeedCombinations++;
-		// unsigned int LiD = 0; //Store the layerId of the stub (KEEP JUST ONE STUB PER LAYER)
-		// double oldseed = 1000.; //Store the seed value of the current stub (KEEP JUST ONE STUB PER LAYER)
-
-		// Loop over stubs in vector different from the seeding stubs
-		for(const Stub* s: filtStubs){
-		  if(s!= s0 && s!= s1){
-		    // Calculate the seed and its tolerance
-		    double seedDist = (s->z() - s1->z())*(s1->r()-s0->r()) - (s->r() - s1->r())*(s1->z() - s0->z());                        
-		    double seedDistRes = seedResolution_ + (s->zErr()+ s1->zErr() )*fabs(s1->r()-s0->r()) + s->rErr()*fabs(s1->z() - s0->z()) + (s0->zErr()+s1->zErr())*fabs(s->r() - s1->r()) + (s0->rErr()+s1->rErr())*fabs(s->z() - s1->z()) + s1->rErr()*fabs(s1->z() - s0->z());
-
-
-		    //If seed is lower than the tolerance push back the stub (KEEP JUST ONE STUB PER LAYER, NOT ENABLED BY DEFAULT)
-		    // if(fabs(seedDist) <= seedDistRes){
-		    //     if(s->layerId()==LiD){
-		    //         if(fabs(seedDist)<fabs(oldseed)){
-		    //             tempStubs.pop_back();
-		    //             tempStubs.push_back(s);
-		    //             LiD = s->layerId();
-		    //             sumSeedDist = sumSeedDist + fabs(seedDist) - fabs(oldseed);
-		    //             oldseed = seedDist;
-		    //         }
-		    //     } else {
-		    //         tempStubs.push_back(s);
-		    //         LiD = s->layerId();
-		    //         oldseed = seed;
-		    //         sumSeedDist = sumSeedDist + fabs(seedDist);
-		    //     }               
-		    // }
+	      // If z0 is within the beamspot range loop over the other stubs in the cell
+	      if (fabs(z0)<=beamWindowZ_+z0err) {
+		// Check track r-z helix parameters are consistent with it being assigned to current rapidity sector (kills duplicates due to overlapping sectors).
+		if ( (! zTrkSectorCheck_) || (zTrk > zTrkMinSector_ - zTrkErr && zTrk < zTrkMaxSector_ + zTrkErr) ) {
+
+		  numGoodSeedCombinations++;
+		  // unsigned int LiD = 0; //Store the layerId of the stub (KEEP JUST ONE STUB PER LAYER)
+		  // double oldseed = 1000.; //Store the seed value of the current stub (KEEP JUST ONE STUB PER LAYER)
+
+		  // Loop over stubs in vector different from the seeding stubs
+		  for(const Stub* s: filtStubs){
+		    if(s!= s0 && s!= s1){
+		      // Calculate the seed and its tolerance
+		      double seedDist = (s->z() - s1->z())*(s1->r()-s0->r()) - (s->r() - s1->r())*(s1->z() - s0->z());                        
+		      double seedDistRes = seedResolution_ + (s->zErr()+ s1->zErr() )*fabs(s1->r()-s0->r()) + s->rErr()*fabs(s1->z() - s0->z()) + (s0->zErr()+s1->zErr())*fabs(s->r() - s1->r()) + (s0->rErr()+s1->rErr())*fabs(s->z() - s1->z()) + s1->rErr()*fabs(s1->z() - s0->z());
+
+
+		      //If seed is lower than the tolerance push back the stub (KEEP JUST ONE STUB PER LAYER, NOT ENABLED BY DEFAULT)
+		      // if(fabs(seedDist) <= seedDistRes){
+		      //     if(s->layerId()==LiD){
+		      //         if(fabs(seedDist)<fabs(oldseed)){
+		      //             tempStubs.pop_back();
+		      //             tempStubs.push_back(s);
+		      //             LiD = s->layerId();
+		      //             sumSeedDist = sumSeedDist + fabs(seedDist) - fabs(oldseed);
+		      //             oldseed = seedDist;
+		      //         }
+		      //     } else {
+		      //         tempStubs.push_back(s);
+		      //         LiD = s->layerId();
+		      //         oldseed = seed;
+		      //         sumSeedDist = sumSeedDist + fabs(seedDist);
+		      //     }               
+		      // }
       
 
-		    //If stub lies on the seeding line, store it in the tempstubs vector                          
-		    if(fabs(seedDist) <= seedDistRes){
-		      tempStubs.push_back(s);
-		      sumSeedDist = sumSeedDist + fabs(seedDist); //Increase the seed quality variable
+		      //If stub lies on the seeding line, store it in the tempstubs vector                          
+		      if(fabs(seedDist) <= seedDistRes){
+			tempStubs.push_back(s);
+			sumSeedDist = sumSeedDist + fabs(seedDist); //Increase the seed quality variable
+		      }
 		    }
 		  }
 		}
 	      }
-	    }
 
-	    numLayers = Utility::countLayers(settings_, tempStubs); // Count the number of layers in the temporary stubs container
+	      numLayers = Utility::countLayers(settings_, tempStubs); // Count the number of layers in the temporary stubs container
           
-	    sumSeedDist = sumSeedDist/(tempStubs.size()); //Measure the average seed quality per stub for the current seed
-
-	    // Check if the current seed has more layers then the previous one (Keep the best seed)
-	    if(keepAllSeed_ == false){
-	      if(numLayers >= oldNumLay ){
-		// Check if the current seed has better quality than the previous one
-		if(sumSeedDist < oldSumSeedDist){
-		  filteredStubs = tempStubs; //Copy the temporary stubs vector in the filteredStubs vector, which will be returned
-		  oldSumSeedDist = sumSeedDist; //Update value of oldSumSeedDist
-		  oldNumLay = numLayers; //Update value of oldNumLay
-		  estZ0_ = z0; //Store estimated z0
-		  estTanLambda_ = (s1->z() -s0->z())/(s1->r()-s0->r()); // Store estimated tanLambda
-		  estValid_ = true; 
+	      sumSeedDist = sumSeedDist/(tempStubs.size()); //Measure the average seed quality per stub for the current seed
+
+	      // Check if the current seed has more layers then the previous one (Keep the best seed)
+	      if(keepAllSeed_ == false){
+		if(numLayers >= oldNumLay ){
+		  // Check if the current seed has better quality than the previous one
+		  if(sumSeedDist < oldSumSeedDist){
+		    filteredStubs = tempStubs; //Copy the temporary stubs vector in the filteredStubs vector, which will be returned
+		    oldSumSeedDist = sumSeedDist; //Update value of oldSumSeedDist
+		    oldNumLay = numLayers; //Update value of oldNumLay
+		    estZ0_ = z0; //Store estimated z0
+		    estTanLambda_ = (s1->z() -s0->z())/(s1->r()-s0->r()); // Store estimated tanLambda
+		    estValid_ = true; 
+		  }
 		}
-	      }
-	    } else {
-	      // Check if the current seed satisfies the minimum layers requirement (Keep all seed algorithm)
-	      if (this->trackCandCheck(numLayers, trkQoverPt)) {
-		uniqueFilteredStubs.insert(tempStubs.begin(), tempStubs.end()); //Insert the uniqueStub set
-		// If these are the first seeding stubs store the values of z0 and tanLambda
-		if(FirstSeed){
-		  estZ0_ = z0; //Store estimated z0
-		  estTanLambda_ = (s1->z() -s0->z())/(s1->r()-s0->r()); // Store estimated tanLambda
-		  estValid_ = true;
-		  FirstSeed = false; 
+	      } else {
+		// Check if the current seed satisfies the minimum layers requirement (Keep all seed algorithm)
+		if (this->trackCandCheck(numLayers, trkQoverPt)) {
+		  uniqueFilteredStubs.insert(tempStubs.begin(), tempStubs.end()); //Insert the uniqueStub set
+		  // If these are the first seeding stubs store the values of z0 and tanLambda
+		  if(FirstSeed){
+		    estZ0_ = z0; //Store estimated z0
+		    estTanLambda_ = (s1->z() -s0->z())/(s1->r()-s0->r()); // Store estimated tanLambda
+		    estValid_ = true;
+		    FirstSeed = false; 
+		  }
 		}
 	      }
-	    }
-	  }   
+	    }   
+	  }
 	}
       }
     }
-  }
  
-  // Copy stubs from the uniqueFilteredStubs set to the filteredStubs vector (Keep all seed algorithm)
-  if(keepAllSeed_ == true){
-    for (const Stub* stub : uniqueFilteredStubs) {
-      filteredStubs.push_back(stub);
+    // Copy stubs from the uniqueFilteredStubs set to the filteredStubs vector (Keep all seed algorithm)
+    if(keepAllSeed_ == true){
+      for (const Stub* stub : uniqueFilteredStubs) {
+	filteredStubs.push_back(stub);
+      }
     }
   }
 
@@ -414,3 +544,195 @@ vector<const Stub*> TrkRZfilter::seedFilter(const std::vector<const Stub*>& stub
 
   return filteredStubs; // Return the filteredStubs vector
 }
+
+//=== Faster implementation of seedFilter(), giving identical results. Returns the filtered stubs, also giving the number of 
+//=== seeds tried (in total & compatible with the beam spot) and the number of layers on the best seed.
+
+vector<const Stub*> TrkRZfilter::seedFilterFast(const vector<const Stub*>& stubs, float trkQoverPt, unsigned int& numSeedCombinations, unsigned int& numGoodSeedCombinations, unsigned int& numLayersBest) {
+
+  // Allowed layers for the first & second seeding stubs, as in seedFilter(), encoded as bits set in a mask.
+  constexpr uint32_t firstSeedLayers  = (1<<1) | (1<<2) | (1<<11) | (1<<21) | (1<<3) | (1<<12) | (1<<22) | (1<<4);
+  constexpr uint32_t secondSeedLayers = (1<<1) | (1<<2) | (1<<11) | (1<<3) | (1<<21) | (1<<22) | (1<<12) | (1<<23) | (1<<13) | (1<<4);
+
+  // Note info needed about each stub only once, instead of for each seed, and which stubs can be used in seeds.
+  const unsigned int nStubs = stubs.size();
+  wsR_.resize(nStubs);
+  wsZ_.resize(nStubs);
+  wsRErr_.resize(nStubs);
+  wsZErr_.resize(nStubs);
+  wsLayerBit_.resize(nStubs);
+  wsCompat_.resize(nStubs);
+  wsDist_.resize(nStubs);
+  wsFirstSeedStubs_.clear();
+  wsSecondSeedStubs_.clear();
+  uint32_t layersAll = 0;
+  for (unsigned int i = 0; i < nStubs; i++) {
+    const Stub* s = stubs[i];
+    wsR_[i]        = s->r();
+    wsZ_[i]        = s->z();
+    wsRErr_[i]     = s->rErr();
+    wsZErr_[i]     = s->zErr();
+    wsLayerBit_[i] = Utility::layerBit(settings_, s);
+    layersAll |= wsLayerBit_[i];
+    if (s->psModule() && s->layerId() < 32) {
+      if ((firstSeedLayers  >> s->layerId()) & 1) wsFirstSeedStubs_.push_back(i);
+      if ((secondSeedLayers >> s->layerId()) & 1) wsSecondSeedStubs_.push_back(i);
+    }
+  }
+  // No seed can have stubs in more layers than this.
+  const unsigned int numLayersAll = bitset<32>(layersAll).count();
+
+  // Find seeds in the same order as seedFilter(), noting which are compatible with the beam spot,
+  // and stopping once the maximum number of these has been found.
+  wsSeeds_.clear();
+  for (unsigned int i0 : wsFirstSeedStubs_) {
+    if (numGoodSeedCombinations >= maxSeedCombinations_) break;
+    const float r0 = wsR_[i0], z0 = wsZ_[i0], rErr0 = wsRErr_[i0], zErr0 = wsZErr_[i0];
+    for (unsigned int i1 : wsSecondSeedStubs_) {
+      if (numGoodSeedCombinations >= maxSeedCombinations_) break;
+      if (stubs[i1]->layerId() <= stubs[i0]->layerId()) continue;
+
+      numSeedCombinations++;
+
+      // N.B. Arithmetic identical to seedFilter(), so seeds are selected identically.
+      const float r1 = wsR_[i1], z1 = wsZ_[i1], rErr1 = wsRErr_[i1], zErr1 = wsZErr_[i1];
+      double estZ0    = z1 + (-z1+z0)*r1/(r1-r0);
+      double estZ0err = zErr1 + ( zErr1 + zErr0 )*r1/fabs(r1-r0)
+	+ fabs(-z1+z0)*(rErr1*fabs(r1-r0) + r1*(rErr1 + rErr0) )/((r1-r0)*(r1-r0));
+      float zTrk      = z1 + (-z1+z0)*(r1-chosenRofZ_)/(r1-r0);
+      float zTrkErr   = zErr1 + ( zErr1 + zErr0 )*fabs(r1-chosenRofZ_)/fabs(r1-r0)
+	+ fabs(-z1+z0)*(rErr1*fabs(r1-r0) + fabs(r1-chosenRofZ_)*(rErr1 + rErr0) )/((r1-r0)*(r1-r0));
+
+      bool good = (fabs(estZ0)<=beamWindowZ_+estZ0err) &&
+	          ( (! zTrkSectorCheck_) || (zTrk > zTrkMinSector_ - zTrkErr && zTrk < zTrkMaxSector_ + zTrkErr) );
+      if (good) numGoodSeedCombinations++;
+
+      wsSeeds_.push_back( SeedPair{i0, i1, good, estZ0} );
+    }
+  }
+
+  vector<const Stub*> filteredStubs;
+  numLayersBest = 0;
+
+  if (! keepAllSeed_) {
+
+    // seedFilter() keeps the last seed with at least as many layers as the best one so far, which is the last seed with 
+    // the most layers. So check seeds in reverse order, keeping the first with the most layers, and stopping if a seed has 
+    // stubs in all layers that any seed could have.
+    // (N.B. seedFilter() compares the seed quality to a fixed value, rather than that of the best seed so far).
+    const unsigned int numSeeds = wsSeeds_.size();
+    unsigned int iSeedBest = numSeeds;
+    for (unsigned int k = numSeeds; k-- > 0; ) {
+      double sumSeedDist;
+      unsigned int numLayers = bitset<32>(this->seedCompatStubs(stubs, wsSeeds_[k], sumSeedDist)).count();
+      if ((iSeedBest == numSeeds || numLayers > numLayersBest) && sumSeedDist < 1000000.) {
+	iSeedBest = k;
+	numLayersBest = numLayers;
+	if (numLayersBest == numLayersAll) break;
+      }
+    }
+
+    // Return stubs compatible with best seed, seeding stubs first.
+    if (iSeedBest < numSeeds) {
+      const SeedPair& seed = wsSeeds_[iSeedBest];
+      double sumSeedDist;
+      this->seedCompatStubs(stubs, seed, sumSeedDist);
+      const Stub* s0 = stubs[seed.i0];
+      const Stub* s1 = stubs[seed.i1];
+      filteredStubs.push_back(s0);
+      filteredStubs.push_back(s1);
+      for (unsigned int j = 0; j < nStubs; j++) {
+	if (wsCompat_[j]) filteredStubs.push_back(stubs[j]);
+      }
+      estZ0_ = seed.z0; //Store estimated z0
+      estTanLambda_ = (s1->z() -s0->z())/(s1->r()-s0->r()); // Store estimated tanLambda
+      estValid_ = true;
+    }
+
+  } else {
+
+    // Keep stubs compatible with any seed with enough layers, taking the r-z helix params from the first such seed.
+    // Stop once all stubs have been kept, since further seeds can't then change the result.
+    wsKeep_.assign(nStubs, 0);
+    unsigned int numKept = 0;
+    bool firstSeed = true;
+    for (const SeedPair& seed : wsSeeds_) {
+      double sumSeedDist;
+      unsigned int numLayers = bitset<32>(this->seedCompatStubs(stubs, seed, sumSeedDist)).count();
+      if (this->trackCandCheck(numLayers, trkQoverPt)) {
+	for (unsigned int j = 0; j < nStubs; j++) {
+	  if ((wsCompat_[j] || j == seed.i0 || j == seed.i1) && ! wsKeep_[j]) {
+	    wsKeep_[j] = 1;
+	    numKept++;
+	  }
+	}
+	if (firstSeed) {
+	  const Stub* s0 = stubs[seed.i0];
+	  const Stub* s1 = stubs[seed.i1];
+	  estZ0_ = seed.z0; //Store estimated z0
+	  estTanLambda_ = (s1->z() -s0->z())/(s1->r()-s0->r()); // Store estimated tanLambda
+	  estValid_ = true;
+	  firstSeed = false;
+	}
+	if (numKept == nStubs) break;
+      }
+    }
+
+    // Order stubs as seedFilter() does, which takes them from a set<const Stub*>.
+    for (unsigned int j = 0; j < nStubs; j++) {
+      if (wsKeep_[j]) filteredStubs.push_back(stubs[j]);
+    }
+    std::sort(filteredStubs.begin(), filteredStubs.end(), std::less<const Stub*>());
+    filteredStubs.erase(std::unique(filteredStubs.begin(), filteredStubs.end()), filteredStubs.end());
+  }
+
+  return filteredStubs;
+}
+
+//=== Find which stubs are compatible with the straight line through the given seed (setting wsCompat_),
+//=== returning a mask of the layers of these stubs & the seed, and the mean distance of these stubs from the line.
+
+uint32_t TrkRZfilter::seedCompatStubs(const vector<const Stub*>& stubs, const SeedPair& seed, double& sumSeedDist) {
+
+  const unsigned int nStubs = stubs.size();
+  const Stub* s0 = stubs[seed.i0];
+  const Stub* s1 = stubs[seed.i1];
+
+  uint32_t layers = wsLayerBit_[seed.i0] | wsLayerBit_[seed.i1];
+  unsigned int numStubs = 2;
+  sumSeedDist = 0.;
+
+  // Only seeds compatible with the beam spot are checked for other stubs.
+  if (seed.good) {
+    // N.B. Arithmetic identical to seedFilter(), so stubs are selected identically.
+    const float r0 = wsR_[seed.i0], z0 = wsZ_[seed.i0], rErr0 = wsRErr_[seed.i0], zErr0 = wsZErr_[seed.i0];
+    const float r1 = wsR_[seed.i1], z1 = wsZ_[seed.i1], rErr1 = wsRErr_[seed.i1], zErr1 = wsZErr_[seed.i1];
+    const float dr  = r1 - r0;
+    const float dz  = z1 - z0;
+    const float adr = fabs(dr);
+    const float adz = fabs(dz);
+    const float zErr01 = zErr0 + zErr1;
+    const float rErr01 = rErr0 + rErr1;
+    for (unsigned int j = 0; j < nStubs; j++) {
+      wsDist_[j] = (wsZ_[j] - z1)*dr - (wsR_[j] - r1)*dz;
+      float seedDistRes = seedResolution_ + (wsZErr_[j] + zErr1)*adr + wsRErr_[j]*adz + zErr01*fabs(wsR_[j] - r1) + rErr01*fabs(wsZ_[j] - z1) + rErr1*adz;
+      wsCompat_[j] = (fabs(wsDist_[j]) <= seedDistRes);
+    }
+    for (unsigned int j = 0; j < nStubs; j++) {
+      if (wsCompat_[j]) {
+	if (stubs[j] != s0 && stubs[j] != s1) {
+	  numStubs++;
+	  layers |= wsLayerBit_[j];
+	  sumSeedDist = sumSeedDist + fabs(wsDist_[j]);
+	} else {
+	  wsCompat_[j] = false;
+	}
+      }
+    }
+  } else {
+    wsCompat_.assign(nStubs, false);
+  }
+
+  sumSeedDist = sumSeedDist/numStubs;
+  return layers;
+}
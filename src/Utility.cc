@@ -64,6 +64,25 @@ unsigned int Utility::countLayers(const Settings* settings, const vector<const S
   return ncount;
 }
 
+//=== Bit corresponding to the tracker layer that countLayers() (with default options) would assign this stub to.
+
+uint32_t Utility::layerBit(const Settings* settings, const Stub* stub) {
+
+  // Configuration parameters, as in countLayers().
+  static bool  reduceLayerID           = settings->reduceLayerID();
+  static bool  useLayerID              = settings->useLayerID();
+  static float layerIDfromRadiusBin    = settings->layerIDfromRadiusBin();
+  static float trackerInnerRadius      = settings->trackerInnerRadius();
+
+  const int maxLayerID(30);
+
+  int layerID = useLayerID  ?  ( reduceLayerID  ?  stub->layerIdReduced()  :  stub->layerId() )  
+                            :  (int) ( (stub->r() - trackerInnerRadius) / layerIDfromRadiusBin );
+  if (layerID < 0 || layerID >= maxLayerID) throw cms::Exception("Utility::invalid layer ID");
+
+  return (1u << layerID);
+}
+
 //=== Given a set of stubs (presumably on a reconstructed track candidate)
 //=== return the best matching Tracking Particle (if any),
 //=== the number of tracker layers in which one of the stubs matched one from this tracking particle,
@@ -137,17 +137,17 @@ bool kalmanState::orderReducedChi2(const kalmanState *left, const kalmanState *r
 
 void kalmanState::dump( ostream &os, const TP *tp, bool all )const
 {
-    std::map<std::string, double> tp_x;
+    HelixParams tp_x;
     bool useForAlgEff(false);
     if( tp ){
 	useForAlgEff = tp->useForAlgEff();
-	tp_x["qOverPt"] = tp->qOverPt();
-	tp_x["phi0"] = tp->phi0();
-	tp_x["z0"] = tp->z0();
-	tp_x["t"] = tp->tanLambda();
-	tp_x["d0"] = tp->d0();
+	tp_x.qOverPt = tp->qOverPt();
+	tp_x.phi0 = tp->phi0();
+	tp_x.z0 = tp->z0();
+	tp_x.tanLambda = tp->tanLambda();
+	tp_x.d0 = tp->d0();
     }
-    std::map<std::string, double> y = fXtoTrackParams_( fitter_, this );
+    HelixParams y = fXtoTrackParams_( fitter_, this );
 
     os << "kalmanState : ";
     os << "# of iterations = " << nIterations_ << ", ";
@@ -155,9 +155,7 @@ void kalmanState::dump( ostream &os, const TP *tp, bool all )const
     os << "barrel = " << barrel_ << ", ";
     os << "r = " << r_ << ", "; 
     os << "z = " << z_ << ", ";
-    for( auto pair : y ){
-	os << pair.first << ":" << y[pair.first] << " "; 
-    }
+    os << "d0:" << y.d0 << " phi0:" << y.phi0 << " qOverPt:" << y.qOverPt << " t:" << y.tanLambda << " z0:" << y.z0 << " "; 
     os << endl;
     os << "xa = ( ";
     for( unsigned i=0; i<xa_.size()-1; i++ ) os << xa_[i] << ", ";
@@ -184,9 +182,11 @@ void kalmanState::dump( ostream &os, const TP *tp, bool all )const
     if( tp ){
 	os << "\tTP index = " << tp->index() << " useForAlgEff = " << useForAlgEff << " ";
 	os << "rel. residual ";
-	for( auto pair : tp_x ){
-	    os << pair.first << ":" << ( y[pair.first] - pair.second ) / pair.second << " "; 
-	}
+	os << "d0:" << ( y.d0 - tp_x.d0 ) / tp_x.d0 << " "; 
+	os << "phi0:" << ( y.phi0 - tp_x.phi0 ) / tp_x.phi0 << " "; 
+	os << "qOverPt:" << ( y.qOverPt - tp_x.qOverPt ) / tp_x.qOverPt << " "; 
+	os << "t:" << ( y.tanLambda - tp_x.tanLambda ) / tp_x.tanLambda << " "; 
+	os << "z0:" << ( y.z0 - tp_x.z0 ) / tp_x.z0 << " "; 
     }
     else{
 	os << "\tTP index = "; 
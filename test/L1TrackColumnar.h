@@ -0,0 +1,208 @@
+// ----------------------------------------------------------------------------------------------------------------
+// Columnar alternative to the TTree written by L1TrackNtupleMaker.cc, readable by L1TrackNtuplePlot.C.
+//
+// The output is a directory containing:
+//   columns.txt       one line per column: "<name> <group> <type>", with type f32 or i32.
+//   <group>.offsets   uint64 array of nEvents+1 entries; event i occupies entries [off[i], off[i+1])
+//                     of every column in this group (e.g. group "tp" holds the tp_* and *matchtrk_* columns).
+//   <name>.<type>     raw array of float or int32 values for all events, in native byte order.
+// All files are plain arrays, so the reader memory-maps them and no decompression is needed.
+// ----------------------------------------------------------------------------------------------------------------
+
+#ifndef __L1TRACKCOLUMNAR_H__
+#define __L1TRACKCOLUMNAR_H__
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace L1TrackColumnar {
+
+  template <class T> inline const char* typeName();
+  template <> inline const char* typeName<float>() {return "f32";}
+  template <> inline const char* typeName<int>()   {return "i32";}
+
+  // ----------------------------------------------------------------------------------------------------------------
+  // Appends the contents of a set of std::vector branches to column files once per event.
+
+  class Writer {
+
+  public:
+
+    Writer() : open_(false) {}
+    ~Writer() {this->close();}
+
+    // Define the columns (before open). Each column is a vector that is refilled for each event.
+    void addColumn(const std::string& name, const std::string& group, const std::vector<float>* vec) {floatCols_.push_back(Col<float>{name, group, vec, nullptr});}
+    void addColumn(const std::string& name, const std::string& group, const std::vector<int>*   vec) {intCols_.push_back  (Col<int>  {name, group, vec, nullptr});}
+
+    // Create output directory & files.
+    void open(const std::string& dir) {
+      mkdir(dir.c_str(), 0755);
+      std::ofstream schema((dir + "/columns.txt").c_str());
+      for (Col<float>& c : floatCols_) {schema<<c.name<<" "<<c.group<<" "<<typeName<float>()<<std::endl; this->openCol(dir, c);}
+      for (Col<int>&   c : intCols_)   {schema<<c.name<<" "<<c.group<<" "<<typeName<int>()  <<std::endl; this->openCol(dir, c);}
+      for (auto& g : groups_) {
+        g.second.file = std::fopen((dir + "/" + g.first + ".offsets").c_str(), "wb");
+        if (g.second.file == nullptr) throw std::runtime_error("L1TrackColumnar: Can't create offsets file for group " + g.first);
+        std::fwrite(&g.second.size, sizeof(uint64_t), 1, g.second.file);
+      }
+      open_ = true;
+    }
+
+    // Append current contents of all column vectors as one event.
+    void fill() {
+      for (Col<float>& c : floatCols_) this->fillCol(c);
+      for (Col<int>&   c : intCols_)   this->fillCol(c);
+      for (auto& g : groups_) {
+        std::fwrite(&g.second.size, sizeof(uint64_t), 1, g.second.file);
+        g.second.filled = false;
+      }
+    }
+
+    void close() {
+      if (! open_) return;
+      for (Col<float>& c : floatCols_) std::fclose(c.file);
+      for (Col<int>&   c : intCols_)   std::fclose(c.file);
+      for (auto& g : groups_)          std::fclose(g.second.file);
+      open_ = false;
+    }
+
+  private:
+
+    template <class T> struct Col {
+      std::string           name;
+      std::string           group;
+      const std::vector<T>* vec;
+      FILE*                 file;
+    };
+
+    struct Group {
+      Group() : size(0), filled(false), file(nullptr) {}
+      uint64_t size;   // Total number of entries written so far.
+      bool     filled; // Size already updated for this event?
+      FILE*    file;
+    };
+
+    template <class T> void openCol(const std::string& dir, Col<T>& c) {
+      c.file = std::fopen((dir + "/" + c.name + "." + typeName<T>()).c_str(), "wb");
+      if (c.file == nullptr) throw std::runtime_error("L1TrackColumnar: Can't create column file " + c.name);
+      groups_[c.group];
+    }
+
+    template <class T> void fillCol(Col<T>& c) {
+      std::fwrite(c.vec->data(), sizeof(T), c.vec->size(), c.file);
+      Group& g = groups_[c.group];
+      if (! g.filled) {
+        g.size  += c.vec->size();
+        g.filled = true;
+      } else if (g.size != uint64_t(std::ftell(c.file)/sizeof(T))) {
+        throw std::runtime_error("L1TrackColumnar: Column " + c.name + " has different length to others in group " + c.group);
+      }
+    }
+
+    bool                         open_;
+    std::vector<Col<float> >     floatCols_;
+    std::vector<Col<int> >       intCols_;
+    std::map<std::string, Group> groups_;
+  };
+
+  // ----------------------------------------------------------------------------------------------------------------
+  // Memory-maps the column files in a directory written by Writer.
+
+  class Reader {
+
+  public:
+
+    Reader(const std::string& dir) : dir_(dir), nEvents_(0) {
+      std::ifstream schema((dir + "/columns.txt").c_str());
+      if (! schema) throw std::runtime_error("L1TrackColumnar: No columns.txt in " + dir);
+      std::string name, group, type;
+      while (schema >> name >> group >> type) {
+        columns_[name] = Column{group, type, this->map(name + "." + type)};
+        if (offsets_.find(group) == offsets_.end()) {
+          offsets_[group] = this->map(group + ".offsets");
+          nEvents_ = offsets_[group].size/sizeof(uint64_t) - 1;
+        }
+      }
+    }
+
+    ~Reader() {
+      for (const Mapping& m : mappings_) if (m.size > 0) munmap(m.data, m.size);
+    }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    unsigned int nEvents() const {return nEvents_;}
+
+    bool hasColumn(const std::string& name) const {return columns_.find(name) != columns_.end();}
+
+    // Get pointer to the values of a column in event iEvent, and their number.
+    template <class T> const T* get(const std::string& name, unsigned int iEvent, unsigned int& n) const {
+      std::map<std::string, Column>::const_iterator c = columns_.find(name);
+      if (c == columns_.end())                 throw std::runtime_error("L1TrackColumnar: No column " + name + " in " + dir_);
+      if (c->second.type != typeName<T>())     throw std::runtime_error("L1TrackColumnar: Column " + name + " has type " + c->second.type);
+      const uint64_t* off = static_cast<const uint64_t*>(offsets_.at(c->second.group).data);
+      n = off[iEvent + 1] - off[iEvent];
+      return static_cast<const T*>(c->second.values.data) + off[iEvent];
+    }
+
+    // Copy the values of a column in event iEvent into a vector, for code written for the TTree branches.
+    template <class T> void fill(const std::string& name, unsigned int iEvent, std::vector<T>* vec) const {
+      unsigned int n;
+      const T* v = this->get<T>(name, iEvent, n);
+      vec->assign(v, v + n);
+    }
+
+  private:
+
+    struct Mapping {
+      void*  data;
+      size_t size;
+    };
+
+    struct Column {
+      std::string group;
+      std::string type;
+      Mapping     values;
+    };
+
+    Mapping map(const std::string& file) {
+      std::string path = dir_ + "/" + file;
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) throw std::runtime_error("L1TrackColumnar: Can't open " + path);
+      struct stat st;
+      fstat(fd, &st);
+      Mapping m = {nullptr, size_t(st.st_size)};
+      if (m.size > 0) {
+        m.data = mmap(nullptr, m.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m.data == MAP_FAILED) {
+          ::close(fd);
+          throw std::runtime_error("L1TrackColumnar: Can't memory-map " + path);
+        }
+      }
+      ::close(fd);
+      mappings_.push_back(m);
+      return m;
+    }
+
+    std::string                   dir_;
+    unsigned int                  nEvents_;
+    std::map<std::string, Column>  columns_;
+    std::map<std::string, Mapping> offsets_;
+    std::vector<Mapping>           mappings_;
+  };
+}
+
+#endif
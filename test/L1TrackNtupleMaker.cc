@@ -67,6 +67,10 @@
 #include <TH2F.h>
 #include <TH1F.h>
 
+//////////////////
+// COLUMNAR OUTPUT
+#include "TMTrackTrigger/TMTrackFinder/test/L1TrackColumnar.h"
+
 //////////////
 // STD HEADERS
 #include <memory>
@@ -117,6 +121,7 @@ private:
   double TP_maxEta;     // save TPs with |eta| < maxEta 
   double TP_maxZ0;      // save TPs with |z0| < maxZ0 
   int L1Tk_minNStub;    // require L1 tracks to have >= minNStub (this is mostly for tracklet purposes)
+  std::string ColumnarDir; // if not empty, also write ntuple contents as memory-mappable columns to this directory
   
   edm::InputTag L1TrackInputTag;        // L1 track collection
   edm::InputTag MCTruthTrackInputTag;   // MC truth collection
@@ -127,6 +132,15 @@ private:
 
   TTree* eventTree;
 
+  // optional columnar copy of the tree, filled from the same vectors
+  L1TrackColumnar::Writer columnar;
+
+  // book tree branch (& column if requested)
+  template <class T> void bookBranch(const char* name, const char* group, std::vector<T>*& vec) {
+    eventTree->Branch(name, &vec);
+    if (ColumnarDir != "") columnar.addColumn(name, group, vec);
+  }
+
   // all L1 tracks
   std::vector<float>* m_trk_pt;
   std::vector<float>* m_trk_eta;
@@ -223,6 +237,7 @@ L1TrackNtupleMaker::L1TrackNtupleMaker(edm::ParameterSet const& iConfig) :
   L1TrackInputTag      = iConfig.getParameter<edm::InputTag>("L1TrackInputTag");
   MCTruthTrackInputTag = iConfig.getParameter<edm::InputTag>("MCTruthTrackInputTag");
   L1Tk_minNStub    = iConfig.getParameter< int >("L1Tk_minNStub");
+  ColumnarDir      = iConfig.getUntrackedParameter< std::string >("ColumnarDir", "");
 
 }
 
@@ -239,6 +254,8 @@ void L1TrackNtupleMaker::endJob()
   // things to be done at the exit of the event Loop
   cerr << "L1TrackNtupleMaker::endJob" << endl;
 
+  columnar.close();
+
 }
 
 ////////////
@@ -324,72 +341,74 @@ void L1TrackNtupleMaker::beginJob()
   eventTree = fs->make<TTree>("eventTree", "Event tree");
 
   if (SaveAllTracks) {
-    eventTree->Branch("trk_pt",    &m_trk_pt);
-    eventTree->Branch("trk_eta",   &m_trk_eta);
-    eventTree->Branch("trk_phi",   &m_trk_phi);
-    eventTree->Branch("trk_d0",    &m_trk_d0);
-    eventTree->Branch("trk_z0",    &m_trk_z0);
-    eventTree->Branch("trk_chi2",  &m_trk_chi2);
-    eventTree->Branch("trk_nstub", &m_trk_nstub);
-    eventTree->Branch("trk_consistency",  &m_trk_consistency);
-    eventTree->Branch("trk_genuine",      &m_trk_genuine);
-    eventTree->Branch("trk_loose",        &m_trk_loose);
-    eventTree->Branch("trk_unknown",      &m_trk_unknown);
-    eventTree->Branch("trk_combinatoric", &m_trk_combinatoric);
-    eventTree->Branch("trk_fake", &m_trk_fake);
-    eventTree->Branch("trk_matchtp_pdgid",&m_trk_matchtp_pdgid);
-    eventTree->Branch("trk_matchtp_pt",   &m_trk_matchtp_pt);
-    eventTree->Branch("trk_matchtp_eta",  &m_trk_matchtp_eta);
-    eventTree->Branch("trk_matchtp_phi",  &m_trk_matchtp_phi);
-    eventTree->Branch("trk_matchtp_z0",   &m_trk_matchtp_z0);
-    eventTree->Branch("trk_matchtp_dxy",  &m_trk_matchtp_dxy);
+    bookBranch("trk_pt", "trk", m_trk_pt);
+    bookBranch("trk_eta", "trk", m_trk_eta);
+    bookBranch("trk_phi", "trk", m_trk_phi);
+    bookBranch("trk_d0", "trk", m_trk_d0);
+    bookBranch("trk_z0", "trk", m_trk_z0);
+    bookBranch("trk_chi2", "trk", m_trk_chi2);
+    bookBranch("trk_nstub", "trk", m_trk_nstub);
+    bookBranch("trk_consistency", "trk", m_trk_consistency);
+    bookBranch("trk_genuine", "trk", m_trk_genuine);
+    bookBranch("trk_loose", "trk", m_trk_loose);
+    bookBranch("trk_unknown", "trk", m_trk_unknown);
+    bookBranch("trk_combinatoric", "trk", m_trk_combinatoric);
+    bookBranch("trk_fake", "trk", m_trk_fake);
+    bookBranch("trk_matchtp_pdgid", "trk", m_trk_matchtp_pdgid);
+    bookBranch("trk_matchtp_pt", "trk", m_trk_matchtp_pt);
+    bookBranch("trk_matchtp_eta", "trk", m_trk_matchtp_eta);
+    bookBranch("trk_matchtp_phi", "trk", m_trk_matchtp_phi);
+    bookBranch("trk_matchtp_z0", "trk", m_trk_matchtp_z0);
+    bookBranch("trk_matchtp_dxy", "trk", m_trk_matchtp_dxy);
   }
 
-  eventTree->Branch("tp_pt",     &m_tp_pt);
-  eventTree->Branch("tp_eta",    &m_tp_eta);
-  eventTree->Branch("tp_phi",    &m_tp_phi);
-  eventTree->Branch("tp_dxy",    &m_tp_dxy);
-  eventTree->Branch("tp_d0",     &m_tp_d0);
-  eventTree->Branch("tp_z0",     &m_tp_z0);
-  eventTree->Branch("tp_d0_prod",&m_tp_d0_prod);
-  eventTree->Branch("tp_z0_prod",&m_tp_z0_prod);
-  eventTree->Branch("tp_pdgid",  &m_tp_pdgid);
-  eventTree->Branch("tp_nmatch", &m_tp_nmatch);
-  eventTree->Branch("tp_nloosematch", &m_tp_nloosematch);
-  eventTree->Branch("tp_nstub",  &m_tp_nstub);
-  eventTree->Branch("tp_nstublayer",    &m_tp_nstublayer);
-  eventTree->Branch("tp_ngenstublayer", &m_tp_ngenstublayer);
-  eventTree->Branch("tp_eventid",&m_tp_eventid);
-
-  eventTree->Branch("matchtrk_pt",      &m_matchtrk_pt);
-  eventTree->Branch("matchtrk_eta",     &m_matchtrk_eta);
-  eventTree->Branch("matchtrk_phi",     &m_matchtrk_phi);
-  eventTree->Branch("matchtrk_z0",      &m_matchtrk_z0);
-  eventTree->Branch("matchtrk_d0",      &m_matchtrk_d0);
-  eventTree->Branch("matchtrk_chi2",    &m_matchtrk_chi2);
-  eventTree->Branch("matchtrk_nstub",   &m_matchtrk_nstub);
-  eventTree->Branch("matchtrk_consistency", &m_matchtrk_consistency);
-
-  eventTree->Branch("loosematchtrk_pt",      &m_loosematchtrk_pt);
-  eventTree->Branch("loosematchtrk_eta",     &m_loosematchtrk_eta);
-  eventTree->Branch("loosematchtrk_phi",     &m_loosematchtrk_phi);
-  eventTree->Branch("loosematchtrk_z0",      &m_loosematchtrk_z0);
-  eventTree->Branch("loosematchtrk_d0",      &m_loosematchtrk_d0);
-  eventTree->Branch("loosematchtrk_chi2",    &m_loosematchtrk_chi2);
-  eventTree->Branch("loosematchtrk_nstub",   &m_loosematchtrk_nstub);
-  eventTree->Branch("loosematchtrk_consistency", &m_loosematchtrk_consistency);
+  bookBranch("tp_pt", "tp", m_tp_pt);
+  bookBranch("tp_eta", "tp", m_tp_eta);
+  bookBranch("tp_phi", "tp", m_tp_phi);
+  bookBranch("tp_dxy", "tp", m_tp_dxy);
+  bookBranch("tp_d0", "tp", m_tp_d0);
+  bookBranch("tp_z0", "tp", m_tp_z0);
+  bookBranch("tp_d0_prod", "tp", m_tp_d0_prod);
+  bookBranch("tp_z0_prod", "tp", m_tp_z0_prod);
+  bookBranch("tp_pdgid", "tp", m_tp_pdgid);
+  bookBranch("tp_nmatch", "tp", m_tp_nmatch);
+  bookBranch("tp_nloosematch", "tp", m_tp_nloosematch);
+  bookBranch("tp_nstub", "tp", m_tp_nstub);
+  bookBranch("tp_nstublayer", "tp", m_tp_nstublayer);
+  bookBranch("tp_ngenstublayer", "tp", m_tp_ngenstublayer);
+  bookBranch("tp_eventid", "tp", m_tp_eventid);
+
+  bookBranch("matchtrk_pt", "tp", m_matchtrk_pt);
+  bookBranch("matchtrk_eta", "tp", m_matchtrk_eta);
+  bookBranch("matchtrk_phi", "tp", m_matchtrk_phi);
+  bookBranch("matchtrk_z0", "tp", m_matchtrk_z0);
+  bookBranch("matchtrk_d0", "tp", m_matchtrk_d0);
+  bookBranch("matchtrk_chi2", "tp", m_matchtrk_chi2);
+  bookBranch("matchtrk_nstub", "tp", m_matchtrk_nstub);
+  bookBranch("matchtrk_consistency", "tp", m_matchtrk_consistency);
+
+  bookBranch("loosematchtrk_pt", "tp", m_loosematchtrk_pt);
+  bookBranch("loosematchtrk_eta", "tp", m_loosematchtrk_eta);
+  bookBranch("loosematchtrk_phi", "tp", m_loosematchtrk_phi);
+  bookBranch("loosematchtrk_z0", "tp", m_loosematchtrk_z0);
+  bookBranch("loosematchtrk_d0", "tp", m_loosematchtrk_d0);
+  bookBranch("loosematchtrk_chi2", "tp", m_loosematchtrk_chi2);
+  bookBranch("loosematchtrk_nstub", "tp", m_loosematchtrk_nstub);
+  bookBranch("loosematchtrk_consistency", "tp", m_loosematchtrk_consistency);
 
   if (SaveStubs) {
-    eventTree->Branch("allstub_x", &m_allstub_x);
-    eventTree->Branch("allstub_y", &m_allstub_y);
-    eventTree->Branch("allstub_z", &m_allstub_z);
-    eventTree->Branch("allstub_pt",    &m_allstub_pt);
-    eventTree->Branch("allstub_ptsign",&m_allstub_ptsign);
-    eventTree->Branch("allstub_isBarrel", &m_allstub_isBarrel);
-    eventTree->Branch("allstub_layer",    &m_allstub_layer);
-    eventTree->Branch("allstub_isPS",     &m_allstub_isPS);
+    bookBranch("allstub_x", "allstub", m_allstub_x);
+    bookBranch("allstub_y", "allstub", m_allstub_y);
+    bookBranch("allstub_z", "allstub", m_allstub_z);
+    bookBranch("allstub_pt", "allstub", m_allstub_pt);
+    bookBranch("allstub_ptsign", "allstub", m_allstub_ptsign);
+    bookBranch("allstub_isBarrel", "allstub", m_allstub_isBarrel);
+    bookBranch("allstub_layer", "allstub", m_allstub_layer);
+    bookBranch("allstub_isPS", "allstub", m_allstub_isPS);
   }
 
+  if (ColumnarDir != "") columnar.open(ColumnarDir);
+
 }
 
 
@@ -1041,6 +1060,7 @@ void L1TrackNtupleMaker::analyze(const edm::Event& iEvent, const edm::EventSetup
   
 
   eventTree->Fill();
+  if (ColumnarDir != "") columnar.fill();
 
 
 } // end of analyze()
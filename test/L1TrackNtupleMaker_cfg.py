@@ -152,6 +152,7 @@ process.L1TrackNtuple = cms.EDAnalyzer('L1TrackNtupleMaker',
                                        TP_maxZ0 = cms.double(30.0),      # only save TPs with |z0| < X cm
                                        L1TrackInputTag = cms.InputTag("TTTracksFromPixelDigis", "Level1TTTracks" ),               # TTTrack input
                                        MCTruthTrackInputTag = cms.InputTag("TTTrackAssociatorFromPixelDigis", "Level1TTTracks"), # MCTruth input 
+                                       ColumnarDir = cms.untracked.string(""),   # if not empty, also write ntuple as memory-mappable columns to this directory (read by L1TrackNtuplePlot.C with columnar=true)
                                        )
 
 process.ana = cms.Path(process.L1TrackNtuple)
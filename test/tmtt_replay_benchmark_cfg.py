@@ -0,0 +1,43 @@
+#################################################################################################
+# Configuration read by the standalone replay benchmark, which does not run cmsRun. Execute with
+# TMTrackReplayBenchmark tmtt_replay_benchmark_cfg.py snapshot.bin [numPasses] [checks] [allowTruncated]
+# where snapshot.bin was written by TMTrackProducer. Only the TMTrackProducer parameters are used.
+# The snapshot records a hash of the tracked TMTrackProducer parameters, so a warning is printed if it
+# was written with different ones. (Changes to the modules producing the stubs are not detected).
+#################################################################################################
+
+import FWCore.ParameterSet.Config as cms
+
+process = cms.Process("Replay")
+
+#--- Load the same configuration as used in cmsRun.
+process.load('TMTrackTrigger.TMTrackFinder.TMTrackProducer_cff')
+
+#--- Optionally override default configuration parameters here (example given of how).
+
+#process.TMTrackProducer.HTArraySpecRz.EnableRzHT = cms.bool(True)
+
+#--- e.g. Check that filling the HT hierarchically or in two passes gives the same HT efficiency & fake rate (printed by
+#--- the benchmark) as the normal HT, and compare the time taken by "Sectors+HT fill" & "HT end", by running with & without
+#--- one of these. (Both are off by default, as this has not yet been done).
+
+#process.TMTrackProducer.HTFillingRphi.HierarchicalHT = cms.bool(True)
+#process.TMTrackProducer.HTFillingRphi.TwoPassHT      = cms.bool(True)
+
+#--- e.g. Measure the fraction of fits avoided by reusing fit results of identical track candidates, and how much these 
+#--- differ from refitting them, by running with checks = 2.
+
+#process.TMTrackProducer.TrackFitSettings.FitCache = cms.uint32(1)
+
+#--- e.g. Check that the chi2 fits reusing the linearisation of the previous iteration agree with a full refit, 
+#--- within tolerance, by running with checks = 4. (The timing is that of the TrackFitIncremental setting chosen here).
+#--- The check fails (exit code 3) only if more than 1% of the fits differ, as a small fraction always do.
+
+#process.TMTrackProducer.TrackFitSettings.TrackFitIncremental = cms.bool(True)
+
+#--- e.g. Compare the time taken by the KF with fixed-size & generic matrix maths, by running with checks = 8 (which
+#--- also checks that their results agree), or by running with & without this and comparing the KF rows of the timing.
+
+#process.TMTrackProducer.TrackFitSettings.KalmanFixedSizeMaths = cms.bool(False)
+
+process.p = cms.Path(process.TMTrackProducer)